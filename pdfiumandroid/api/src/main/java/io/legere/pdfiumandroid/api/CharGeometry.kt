@@ -0,0 +1,134 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+/**
+ * The geometry of a run of characters on a text page, laid out as one array per attribute and
+ * filled by a single native call, for building selection and hit testing without a native call,
+ * and an array, per character.
+ *
+ * Character `i` of the run is character [startIndex] + `i` of the page. Boxes are in page
+ * coordinates, four values per character in the order left, top, right, bottom; origins are two,
+ * x then y. The arrays grow to fit the largest run asked for and are reused after that, so keep
+ * one instance and fill it page after page; only the first [count] characters' entries are
+ * meaningful.
+ *
+ * @param capacity How many characters the arrays start with room for.
+ */
+@Keep
+class CharGeometry(
+    capacity: Int = 0,
+) {
+    /** The page index of the first character. */
+    var startIndex: Int = 0
+        private set
+
+    /** How many characters the arrays hold. */
+    var count: Int = 0
+        private set
+
+    /** Each character's Unicode code point, or 0 if it has none. */
+    var unicodes = IntArray(capacity)
+        private set
+
+    /** Each character's loose box, covering its font's full ascent and descent. */
+    var looseBoxes = FloatArray(capacity * BOX_VALUES)
+        private set
+
+    /** Each character's tight box, covering the glyph itself. */
+    var tightBoxes = FloatArray(capacity * BOX_VALUES)
+        private set
+
+    /** Each character's origin, where its baseline starts. */
+    var origins = FloatArray(capacity * ORIGIN_VALUES)
+        private set
+
+    /** Each character's rotation in radians, counter-clockwise, or -1 if it is unknown. */
+    var angles = FloatArray(capacity)
+        private set
+
+    /** Each character's font size in points. */
+    var fontSizes = FloatArray(capacity)
+        private set
+
+    /** Each character's [FLAG_GENERATED], [FLAG_HYPHEN] and [FLAG_UNICODE_MAP_ERROR] bits. */
+    var flags = IntArray(capacity)
+        private set
+
+    /** How many characters the arrays have room for. */
+    val capacity: Int
+        get() = unicodes.size
+
+    /**
+     * Make room for [count] characters starting at page index [startIndex], growing the arrays if
+     * they are too small. Growing drops what they held. Called by the text page before it fills them.
+     */
+    fun prepare(
+        startIndex: Int,
+        count: Int,
+    ) {
+        require(count >= 0) { "count must not be negative" }
+        if (count > capacity) {
+            unicodes = IntArray(count)
+            looseBoxes = FloatArray(count * BOX_VALUES)
+            tightBoxes = FloatArray(count * BOX_VALUES)
+            origins = FloatArray(count * ORIGIN_VALUES)
+            angles = FloatArray(count)
+            fontSizes = FloatArray(count)
+            flags = IntArray(count)
+        }
+        this.startIndex = startIndex
+        this.count = count
+    }
+
+    /** The character at [i] of the run. */
+    fun char(i: Int): Char = unicodes[i].toChar()
+
+    /** Whether PDFium generated the character at [i] of the run, such as a space or line break it inferred. */
+    fun isGenerated(i: Int): Boolean = flags[i] and FLAG_GENERATED != 0
+
+    /** Whether the character at [i] of the run is a hyphen that breaks a word across lines. */
+    fun isHyphen(i: Int): Boolean = flags[i] and FLAG_HYPHEN != 0
+
+    /** Whether the font's Unicode map gave the character at [i] of the run no usable code point. */
+    fun hasUnicodeMapError(i: Int): Boolean = flags[i] and FLAG_UNICODE_MAP_ERROR != 0
+
+    /**
+     * @suppress
+     */
+    companion object {
+        /** Values per character in [looseBoxes] and [tightBoxes]. */
+        const val BOX_VALUES = 4
+
+        /** Values per character in [origins]. */
+        const val ORIGIN_VALUES = 2
+
+        /** Set in [flags] for a character PDFium generated. */
+        const val FLAG_GENERATED = 1
+
+        /** Set in [flags] for a line-breaking hyphen. */
+        const val FLAG_HYPHEN = 2
+
+        /** Set in [flags] for a character whose Unicode mapping failed. */
+        const val FLAG_UNICODE_MAP_ERROR = 4
+    }
+}
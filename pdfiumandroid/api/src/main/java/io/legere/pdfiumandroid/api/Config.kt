@@ -38,12 +38,54 @@ import androidx.annotation.Keep
  *                              page as soon as its last holder releases it, which is the behaviour
  *                              of releases before this setting existed.
  *                              Defaults to [DEFAULT_PAGE_RETENTION].
+ * @property fileOpenMode How documents opened from a file descriptor are read.
+ *                        Defaults to [FileOpenMode.READ].
+ * @property tileCacheBudgetBytes How much native memory rendered page tiles may use. When it is
+ *                                set, pages rendered to a surface or window buffer with a scale and
+ *                                translate matrix and an opaque page background are drawn from
+ *                                256 pixel tiles cached across renders, so scrolling or panning at
+ *                                the same zoom only rasterizes the tiles that come into view. The
+ *                                least recently drawn tiles are evicted once the budget is spent.
+ *                                Set to 0 to render every frame from scratch. Defaults to 0.
+ * @property ditherRgb565 Whether pages rendered to RGB_565 bitmaps are ordered-dithered, which
+ *                        hides the banding of gradients and shaded images at 16 bits per pixel
+ *                        at the cost of a fine regular pattern. Turning it on applies to every
+ *                        render in the process. Defaults to `false`.
+ * @property pageRetentionBudgetBytes How much native memory the retained pages may hold between
+ *                                    them. A page with large images can hold a hundred times what
+ *                                    a page of text does, so once the estimated size of the
+ *                                    retained pages and their text pages passes this budget the
+ *                                    least recently released are closed, even below
+ *                                    [pageRetentionCount]. A single page larger than the budget is
+ *                                    closed as soon as it is released. Each page is measured by
+ *                                    walking its objects, once per load. Set to 0 to retain by
+ *                                    count alone. Defaults to 0.
+ * @property libraryLifetime When PDFium's global state is set up and torn down. Setting it up
+ *                           registers PDFium's modules and builds its font mapper, which is much of
+ *                           the cost of opening a small document.
+ *                           Defaults to [LibraryLifetime.REFERENCE_COUNTED].
+ * @property libraryIdleTimeoutMillis How long a [LibraryLifetime.REFERENCE_COUNTED] library stays set
+ *                                    up after the last document closes, so that opening another soon
+ *                                    after does not pay for it again. Set to 0 to tear it down as
+ *                                    soon as the last document closes, which is the behaviour of
+ *                                    releases before this setting existed.
+ *                                    Defaults to [DEFAULT_LIBRARY_IDLE_TIMEOUT_MILLIS].
+ * @property initLibraryOnLoad Whether the library is set up on the background thread that loads the
+ *                             native libraries, ahead of the first document, rather than when that
+ *                             document is opened. Defaults to `true`.
  */
 @Keep
 data class Config(
     val logger: LoggerInterface = DefaultLogger(),
     val alreadyClosedBehavior: AlreadyClosedBehavior = AlreadyClosedBehavior.EXCEPTION,
     val pageRetentionCount: Int = DEFAULT_PAGE_RETENTION,
+    val fileOpenMode: FileOpenMode = FileOpenMode.READ,
+    val tileCacheBudgetBytes: Long = 0,
+    val ditherRgb565: Boolean = false,
+    val pageRetentionBudgetBytes: Long = 0,
+    val libraryLifetime: LibraryLifetime = LibraryLifetime.REFERENCE_COUNTED,
+    val libraryIdleTimeoutMillis: Long = DEFAULT_LIBRARY_IDLE_TIMEOUT_MILLIS,
+    val initLibraryOnLoad: Boolean = true,
 )
 
 /**
@@ -52,6 +94,48 @@ data class Config(
  */
 const val DEFAULT_PAGE_RETENTION = 8
 
+/**
+ * The default for [Config.libraryIdleTimeoutMillis]: long enough to cover going back to a document
+ * picker and opening the next document.
+ */
+const val DEFAULT_LIBRARY_IDLE_TIMEOUT_MILLIS = 30_000L
+
+/**
+ * How a document opened from a file descriptor is read.
+ */
+@Keep
+enum class FileOpenMode {
+    /** PDFium reads each block it needs from the file descriptor as it needs it. */
+    READ,
+
+    /**
+     * The file is memory-mapped read-only and PDFium reads it in place. Opening and loading pages
+     * of large documents no longer costs a system call per block, and documents opened from the
+     * same file share the kernel's cached pages. The mapping lasts until the document is closed.
+     * Files that can't be mapped are read as with [READ].
+     */
+    MEMORY_MAP,
+}
+
+/**
+ * When PDFium's global state is set up and torn down, see [Config.libraryLifetime]. Whichever is
+ * chosen, the library is set up before a document opens and stays set up while any is open.
+ */
+@Keep
+enum class LibraryLifetime {
+    /**
+     * Torn down once the last document closes and no other opens within
+     * [Config.libraryIdleTimeoutMillis].
+     */
+    REFERENCE_COUNTED,
+
+    /** Set up once and kept for the life of the process. */
+    PROCESS,
+
+    /** Kept until the app calls `PdfiumCore.destroyLibrary` with no document open. */
+    EXPLICIT,
+}
+
 /**
  * Defines the behavior when an operation is attempted on an already closed PDFium object.
  */
@@ -0,0 +1,64 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+import java.nio.ByteBuffer
+
+/**
+ * The text of a run of pages, extracted into one direct [ByteBuffer] with a table of where each
+ * page's text starts and ends, for indexing a document without a string per page.
+ *
+ * Page `i` is page [firstPage] + `i` of the document. Its text is the bytes from [pageStart] to
+ * [pageEnd] of [buffer], in [encoding], with nothing between one page's text and the next.
+ *
+ * @property buffer The text of every page, from position 0 to its limit.
+ * @property encoding The encoding of the text.
+ * @property firstPage The index in the document of the first page.
+ * @property pageEnds The end offset in [buffer] of each page's text.
+ */
+@Keep
+class DocumentText(
+    val buffer: ByteBuffer,
+    val encoding: TextEncoding,
+    val firstPage: Int,
+    private val pageEnds: IntArray,
+) {
+    /** How many pages the text covers. */
+    val pageCount: Int
+        get() = pageEnds.size
+
+    /** Where page [i]'s text starts in [buffer]. */
+    fun pageStart(i: Int): Int = if (i == 0) 0 else pageEnds[i - 1]
+
+    /** Where page [i]'s text ends in [buffer]. */
+    fun pageEnd(i: Int): Int = pageEnds[i]
+
+    /** A view of page [i]'s text in [buffer], sharing its memory. */
+    fun pageBuffer(i: Int): ByteBuffer {
+        val view = buffer.duplicate()
+        view.limit(pageEnd(i))
+        view.position(pageStart(i))
+        return view.slice()
+    }
+
+    /** Page [i]'s text decoded to a [String]. */
+    fun pageText(i: Int): String = encoding.charset.decode(pageBuffer(i)).toString()
+}
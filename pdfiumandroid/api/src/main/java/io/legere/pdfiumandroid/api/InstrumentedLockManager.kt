@@ -0,0 +1,158 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.atomic.AtomicLongArray
+
+/**
+ * The tags the library locks with, naming the operation that takes the lock, see [LockManager.withLockBlocking].
+ */
+object LockTag {
+    /** Calls that don't name their operation. */
+    const val UNTAGGED = "untagged"
+    const val OPEN_DOCUMENT = "openDocument"
+    const val OPEN_PAGE = "openPage"
+    const val OPEN_TEXT_PAGE = "openTextPage"
+    const val RENDER_PAGE = "renderPage"
+    const val RENDER_PAGES = "renderPages"
+    const val FIND_START = "findStart"
+    const val EXTRACT_TEXT = "extractText"
+    const val SEARCH = "search"
+
+    /** A job run by a render scheduler. */
+    const val RENDER_JOB = "renderJob"
+
+    /** A batch of operations run under one lock acquisition. */
+    const val BATCH = "batch"
+}
+
+/**
+ * A [LockManager] that locks with [delegate] and records, per operation tag, how long each call waited for the
+ * lock and how long it held it, so that time spent waiting can be told apart from time spent rendering.
+ *
+ * Install it with `PdfiumCore.setLockManager(InstrumentedLockManager(lockManager))`. Recording is lock-free: a
+ * call adds to atomic counters after it releases the lock. A reentrant call is recorded on its own too, its
+ * hold time also counted in the outer call's.
+ *
+ * @param delegate The lock manager that does the locking.
+ */
+class InstrumentedLockManager(
+    private val delegate: LockManager,
+) : LockManager {
+    private val operations = ConcurrentHashMap<String, OperationRecorder>()
+
+    override suspend fun <T> withLock(block: suspend () -> T): T = withLock(LockTag.UNTAGGED, block)
+
+    override fun <T> withLockBlocking(block: () -> T): T = withLockBlocking(LockTag.UNTAGGED, block)
+
+    override suspend fun <T> withLock(
+        tag: String,
+        block: suspend () -> T,
+    ): T {
+        val requested = System.nanoTime()
+        var acquired = NOT_ACQUIRED
+        try {
+            return delegate.withLock(tag) {
+                acquired = System.nanoTime()
+                block()
+            }
+        } finally {
+            record(tag, requested, acquired)
+        }
+    }
+
+    override fun <T> withLockBlocking(
+        tag: String,
+        block: () -> T,
+    ): T {
+        val requested = System.nanoTime()
+        var acquired = NOT_ACQUIRED
+        try {
+            return delegate.withLockBlocking(tag) {
+                acquired = System.nanoTime()
+                block()
+            }
+        } finally {
+            record(tag, requested, acquired)
+        }
+    }
+
+    override fun status(): Boolean = delegate.status()
+
+    /**
+     * The timings recorded since this was created or last [reset]. Calls finishing while the snapshot is taken
+     * may be only partly in it.
+     */
+    fun snapshot(): LockStats =
+        LockStats(
+            operations.mapValues { (tag, recorder) ->
+                LockOperationStats(tag, recorder.wait.snapshot(), recorder.hold.snapshot())
+            },
+        )
+
+    /** Drops the timings recorded so far. */
+    fun reset() {
+        operations.clear()
+    }
+
+    private fun record(
+        tag: String,
+        requested: Long,
+        acquired: Long,
+    ) {
+        if (acquired == NOT_ACQUIRED) return
+        val recorder = operations.getOrPut(tag) { OperationRecorder() }
+        recorder.wait.record(acquired - requested)
+        recorder.hold.record(System.nanoTime() - acquired)
+    }
+
+    private class OperationRecorder {
+        val wait = HistogramRecorder()
+        val hold = HistogramRecorder()
+    }
+
+    private class HistogramRecorder {
+        private val buckets = AtomicLongArray(LockTimeHistogram.BUCKET_COUNT)
+        private val count = AtomicLong()
+        private val totalNanos = AtomicLong()
+        private val maxNanos = AtomicLong()
+
+        fun record(nanos: Long) {
+            buckets.incrementAndGet(LockTimeHistogram.bucketFor(nanos))
+            count.incrementAndGet()
+            totalNanos.addAndGet(nanos)
+            maxNanos.accumulateAndGet(nanos) { max, next -> maxOf(max, next) }
+        }
+
+        fun snapshot(): LockTimeHistogram =
+            LockTimeHistogram(
+                count = count.get(),
+                totalNanos = totalNanos.get(),
+                maxNanos = maxNanos.get(),
+                buckets = List(LockTimeHistogram.BUCKET_COUNT) { buckets.get(it) },
+            )
+    }
+
+    private companion object {
+        const val NOT_ACQUIRED = Long.MIN_VALUE
+    }
+}
@@ -38,6 +38,24 @@ interface LockManager {
      */
     fun <T> withLockBlocking(block: () -> T): T
 
+    /**
+     * Executes the given [block] function while holding the lock, on behalf of the operation named [tag].
+     * The tag only labels the call for instrumentation, see [InstrumentedLockManager]; by default it is ignored.
+     */
+    suspend fun <T> withLock(
+        tag: String,
+        block: suspend () -> T,
+    ): T = withLock(block)
+
+    /**
+     * Executes the given [block] function while holding the lock, on behalf of the operation named [tag].
+     * The tag only labels the call for instrumentation, see [InstrumentedLockManager]; by default it is ignored.
+     */
+    fun <T> withLockBlocking(
+        tag: String,
+        block: () -> T,
+    ): T = withLockBlocking(block)
+
     /**
      * Returns the status of the lock.
      */
@@ -0,0 +1,103 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+import kotlin.math.ceil
+
+/**
+ * A snapshot of the durations recorded for one measure of a lock, see [InstrumentedLockManager].
+ *
+ * Durations are counted in power-of-two buckets of nanoseconds: bucket 0 holds 0 and 1 ns, and bucket `i` above
+ * that holds `[2^i, 2^(i+1))` ns, the last bucket also holding everything longer.
+ *
+ * @property count Durations recorded.
+ * @property totalNanos The recorded durations added up.
+ * @property maxNanos The longest duration recorded.
+ * @property buckets How many durations fell in each bucket, [BUCKET_COUNT] of them.
+ */
+@Keep
+data class LockTimeHistogram(
+    val count: Long,
+    val totalNanos: Long,
+    val maxNanos: Long,
+    val buckets: List<Long>,
+) {
+    /** The mean duration, in nanoseconds, or 0 before any has been recorded. */
+    val meanNanos: Long
+        get() = if (count == 0L) 0 else totalNanos / count
+
+    /**
+     * An upper bound on the [percentile] (0 to 100) duration, in nanoseconds: the top of the bucket it falls in,
+     * but never more than [maxNanos]. 0 before any duration has been recorded.
+     */
+    fun percentileNanos(percentile: Double): Long {
+        if (count == 0L) return 0
+        val rank = ceil(percentile.coerceIn(0.0, PERCENT) / PERCENT * count).toLong().coerceAtLeast(1)
+        var seen = 0L
+        buckets.forEachIndexed { index, bucketCount ->
+            seen += bucketCount
+            if (seen >= rank) return minOf(bucketUpperBoundNanos(index), maxNanos)
+        }
+        return maxNanos
+    }
+
+    companion object {
+        /** The number of buckets, enough to tell apart durations up to about 18 minutes. */
+        const val BUCKET_COUNT = 41
+
+        private const val PERCENT = 100.0
+
+        /** The bucket a duration of [nanos] is counted in. */
+        fun bucketFor(nanos: Long): Int =
+            (Long.SIZE_BITS - 1 - nanos.coerceAtLeast(1).countLeadingZeroBits()).coerceAtMost(BUCKET_COUNT - 1)
+
+        /** The longest duration, in nanoseconds, counted in bucket [index]. */
+        fun bucketUpperBoundNanos(index: Int): Long =
+            if (index >= BUCKET_COUNT - 1) Long.MAX_VALUE else (1L shl (index + 1)) - 1
+    }
+}
+
+/**
+ * The lock timings of one operation, see [InstrumentedLockManager].
+ *
+ * @property tag The operation's name, the tag it locks with.
+ * @property wait The time from asking for the lock to holding it.
+ * @property hold The time from getting the lock to releasing it.
+ */
+@Keep
+data class LockOperationStats(
+    val tag: String,
+    val wait: LockTimeHistogram,
+    val hold: LockTimeHistogram,
+)
+
+/**
+ * The lock timings of an [InstrumentedLockManager], per operation.
+ *
+ * @property operations The timings of each operation that has taken the lock, by tag.
+ */
+@Keep
+data class LockStats(
+    val operations: Map<String, LockOperationStats>,
+) {
+    /** The timings of the operation tagged [tag], or `null` if it hasn't taken the lock. */
+    operator fun get(tag: String): LockOperationStats? = operations[tag]
+}
@@ -0,0 +1,132 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import android.graphics.RectF
+import androidx.annotation.Keep
+
+/**
+ * The words of a text page and the lines they sit on, segmented natively in one pass over its
+ * characters and read straight from the packed array the native call returns, without an object
+ * per word.
+ *
+ * Words are in page order. Each is a run of letters and digits, or a single ideograph, given by
+ * its character offset and length on the page and one rectangle covering it in page coordinates;
+ * spaces and punctuation between words are not part of any word. A word never spans two lines: a
+ * word broken across lines by a hyphen is two words, the first one [isHyphenated].
+ *
+ * @property data The packed words, [WORD_VALUES] floats each.
+ */
+@Keep
+@Suppress("TooManyFunctions")
+class PageWords(
+    private val data: FloatArray,
+) {
+    /** How many words the page has. */
+    val wordCount: Int
+        get() = data.size / WORD_VALUES
+
+    /** How many lines hold at least one word. */
+    val lineCount: Int
+        get() = if (wordCount == 0) 0 else line(wordCount - 1) + 1
+
+    /** The page offset of the first character of word [i]. */
+    fun start(i: Int): Int = data[i * WORD_VALUES + START_OFFSET].toInt()
+
+    /** How many characters word [i] has. */
+    fun length(i: Int): Int = data[i * WORD_VALUES + LENGTH_OFFSET].toInt()
+
+    /** The 0-based line word [i] is on. */
+    fun line(i: Int): Int = data[i * WORD_VALUES + LINE_OFFSET].toInt()
+
+    /** Whether word [i] ends in a hyphen breaking it across lines, so the next word finishes it. */
+    fun isHyphenated(i: Int): Boolean = data[i * WORD_VALUES + FLAGS_OFFSET].toInt() and FLAG_HYPHENATED != 0
+
+    /** The left edge of word [i]. */
+    fun left(i: Int): Float = data[i * WORD_VALUES + LEFT_OFFSET]
+
+    /** The top edge of word [i]. */
+    fun top(i: Int): Float = data[i * WORD_VALUES + TOP_OFFSET]
+
+    /** The right edge of word [i]. */
+    fun right(i: Int): Float = data[i * WORD_VALUES + RIGHT_OFFSET]
+
+    /** The bottom edge of word [i]. */
+    fun bottom(i: Int): Float = data[i * WORD_VALUES + BOTTOM_OFFSET]
+
+    /**
+     * Copy the rectangle of word [i] into [out].
+     *
+     * @return [out]
+     */
+    fun getRect(
+        i: Int,
+        out: RectF = RectF(),
+    ): RectF {
+        out.set(left(i), top(i), right(i), bottom(i))
+        return out
+    }
+
+    /**
+     * Find the word holding the character at page offset [charIndex], as for selecting the word
+     * under a double tap.
+     *
+     * @return the word's index, or -1 if the character is a space or punctuation between words
+     */
+    fun indexOfWordAt(charIndex: Int): Int {
+        var low = 0
+        var high = wordCount - 1
+        while (low <= high) {
+            val mid = (low + high) ushr 1
+            when {
+                charIndex < start(mid) -> high = mid - 1
+                charIndex >= start(mid) + length(mid) -> low = mid + 1
+                else -> return mid
+            }
+        }
+        return -1
+    }
+
+    /** The words as [WordRangeRect]s, the form `textPageGetRectsForRanges` returns. */
+    fun toWordRangeRects(): List<WordRangeRect> = List(wordCount) { WordRangeRect(start(it), length(it), getRect(it)) }
+
+    /**
+     * @suppress
+     */
+    companion object {
+        /** Floats per word in the packed array. */
+        const val WORD_VALUES = 8
+
+        /** Set in a word's flags when it ends in a line-breaking hyphen. */
+        const val FLAG_HYPHENATED = 1
+
+        private const val LEFT_OFFSET = 0
+        private const val TOP_OFFSET = 1
+        private const val RIGHT_OFFSET = 2
+        private const val BOTTOM_OFFSET = 3
+        private const val START_OFFSET = 4
+        private const val LENGTH_OFFSET = 5
+        private const val LINE_OFFSET = 6
+        private const val FLAGS_OFFSET = 7
+
+        /** A page without words. */
+        val EMPTY = PageWords(FloatArray(0))
+    }
+}
@@ -29,9 +29,15 @@ internal const val CACHE_SIZE = 64L
 /**
  * A thread-safe, concurrent LRU cache for PDF page objects.
  * This base class holds the core Guava LoadingCache logic.
+ *
+ * @property maxSize The most pages the cache holds, used when [maxBytes] is 0.
+ * @property maxBytes The most native memory the cached pages may hold, as measured by [weigh]. When
+ * it is set the cache is bounded by bytes rather than by [maxSize], so it keeps many pages of text
+ * but only a few image-heavy ones.
  */
 abstract class PdfPageCacheBase<H : AutoCloseable>(
     val maxSize: Long = CACHE_SIZE,
+    val maxBytes: Long = 0,
 ) : AutoCloseable {
     private val removalListener =
         RemovalListener<Int, H> {
@@ -41,8 +47,19 @@ abstract class PdfPageCacheBase<H : AutoCloseable>(
     private val pageCache: LoadingCache<Int, H> =
         CacheBuilder
             .newBuilder()
-            .maximumSize(maxSize)
-            .removalListener(removalListener)
+            .apply {
+                if (maxBytes > 0) {
+                    // Guava splits the weight budget between segments, which would turn away any page
+                    // weighing more than a segment's share; pages are opened one at a time anyway.
+                    concurrencyLevel(1)
+                    maximumWeight(maxBytes)
+                    weigher<Int, H> { pageIndex, holder ->
+                        weigh(pageIndex, holder).coerceIn(1, Int.MAX_VALUE.toLong()).toInt()
+                    }
+                } else {
+                    maximumSize(maxSize)
+                }
+            }.removalListener(removalListener)
             .build(
                 CacheLoader.from { pageIndex ->
                     openPageAndText(pageIndex) ?: error("Page $pageIndex not found")
@@ -54,6 +71,15 @@ abstract class PdfPageCacheBase<H : AutoCloseable>(
      */
     protected abstract fun openPageAndText(pageIndex: Int): H?
 
+    /**
+     * The native memory, in bytes, that [holder] keeps open for the page at [pageIndex]. Only used
+     * when [maxBytes] is set, once for each page as it is loaded into the cache.
+     */
+    protected open fun weigh(
+        pageIndex: Int,
+        holder: H,
+    ): Long = 1
+
     /**
      * Gets the page and text page holder from the cache, creating it if necessary.
      */
@@ -0,0 +1,78 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+/**
+ * Lets one thread stop a render that another thread is running.
+ *
+ * Pass a token to a progressive render and call [cancel] from anywhere — typically the UI thread once
+ * the user has scrolled past the page. PDFium checks the token between rendering steps, so a render in
+ * flight stops within a few milliseconds and releases the lock it holds, rather than finishing a page
+ * nobody will see. A search across pages checks the token between runs of pages in the same way.
+ * A token can be shared by several renders; cancelling it cancels all of them.
+ * Once cancelled, a token stays cancelled.
+ */
+@Keep
+class RenderCancellationToken {
+    @Volatile
+    var isCancelled: Boolean = false
+        private set
+
+    private val listeners = mutableListOf<() -> Unit>()
+
+    /**
+     * Cancel every render using this token. Safe to call from any thread, any number of times.
+     */
+    fun cancel() {
+        val toNotify =
+            synchronized(this) {
+                if (isCancelled) return
+                isCancelled = true
+                listeners.toList().also { listeners.clear() }
+            }
+        toNotify.forEach { it() }
+    }
+
+    /**
+     * Register [listener] to run when the token is cancelled. Runs it right away if the token already is.
+     * For internal use only.
+     */
+    fun invokeOnCancel(listener: () -> Unit) {
+        synchronized(this) {
+            if (!isCancelled) {
+                listeners.add(listener)
+                return
+            }
+        }
+        listener()
+    }
+
+    /**
+     * Unregister a listener added with [invokeOnCancel].
+     * For internal use only.
+     */
+    fun removeOnCancel(listener: () -> Unit) {
+        synchronized(this) {
+            listeners.remove(listener)
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+/**
+ * How urgent a job given to a render scheduler is. Jobs run in this order, most urgent first, and in the order
+ * they were submitted within a priority.
+ */
+@Keep
+enum class RenderPriority {
+    /** Pages on screen now. */
+    VISIBLE,
+
+    /** Pages next to the viewport, likely to be on screen soon. */
+    NEAR_PREFETCH,
+
+    /** Thumbnails, for a page strip or grid. */
+    THUMBNAIL,
+
+    /** Work nobody is waiting on, such as text extraction for search. */
+    BACKGROUND,
+}
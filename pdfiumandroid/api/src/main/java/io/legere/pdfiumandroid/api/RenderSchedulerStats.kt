@@ -0,0 +1,74 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+private const val NANOS_PER_MILLI = 1_000_000.0
+
+/**
+ * Counters of a render scheduler for one [RenderPriority].
+ *
+ * @property priority The priority these counters are for.
+ * @property queued Jobs waiting to run now.
+ * @property submitted Jobs scheduled, not counting those coalesced into a job already scheduled. A job
+ * raised by a more urgent request is counted under the priority it was raised to.
+ * @property coalesced Requests that were handed a job already scheduled for the same key.
+ * @property started Jobs that have started running.
+ * @property completed Jobs that ran to completion, including those that failed.
+ * @property cancelled Jobs cancelled before or while running.
+ * @property totalWaitNanos Time the started jobs spent queued, in total.
+ * @property maxWaitNanos The longest time a started job spent queued.
+ */
+@Keep
+data class RenderPriorityStats(
+    val priority: RenderPriority,
+    val queued: Int,
+    val submitted: Long,
+    val coalesced: Long,
+    val started: Long,
+    val completed: Long,
+    val cancelled: Long,
+    val totalWaitNanos: Long,
+    val maxWaitNanos: Long,
+) {
+    /** The mean time a started job spent queued, in milliseconds, or 0 before any job has started. */
+    val meanWaitMillis: Double
+        get() = if (started == 0L) 0.0 else totalWaitNanos / NANOS_PER_MILLI / started
+}
+
+/**
+ * Counters of a render scheduler, one entry per [RenderPriority], most urgent first.
+ *
+ * @property priorities The counters for each priority.
+ */
+@Keep
+data class RenderSchedulerStats(
+    val priorities: List<RenderPriorityStats>,
+) {
+    /** Jobs waiting to run now, at all priorities. */
+    val queueDepth: Int
+        get() = priorities.sumOf { it.queued }
+
+    /**
+     * The counters for [priority].
+     */
+    operator fun get(priority: RenderPriority): RenderPriorityStats = priorities[priority.ordinal]
+}
@@ -0,0 +1,57 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+/**
+ * Where a progressive render stands after a call that ran it.
+ *
+ * @property value the status code the native layer reports
+ */
+@Suppress("MagicNumber")
+@Keep
+enum class RenderStatus(
+    val value: Int,
+) {
+    /** The render paused, either because its time budget ran out or because it was cancelled mid-flight. */
+    INCOMPLETE(1),
+
+    /** The page is fully rendered into the target. */
+    DONE(2),
+
+    /** PDFium could not render the page. The target's contents are undefined. */
+    FAILED(3),
+
+    /** The render was cancelled through its [RenderCancellationToken] before it finished. */
+    CANCELLED(4),
+    ;
+
+    /** `true` once the render will not make any more progress. */
+    val isFinished: Boolean
+        get() = this != INCOMPLETE
+
+    companion object {
+        /**
+         * Map a native status code to a [RenderStatus]. Unknown codes are treated as [FAILED].
+         */
+        fun fromValue(value: Int): RenderStatus = entries.firstOrNull { it.value == value } ?: FAILED
+    }
+}
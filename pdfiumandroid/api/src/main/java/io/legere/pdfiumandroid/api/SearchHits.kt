@@ -0,0 +1,135 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import android.graphics.RectF
+import androidx.annotation.Keep
+
+/**
+ * The matches of a search across pages, found natively in one call per run of pages and read
+ * straight from the packed array it returns, without an object per hit.
+ *
+ * Hits are in page order, and in text order within a page. Each is given by its page, its
+ * character offset and length on that page, and the rectangles that highlight it in page
+ * coordinates, one per line the match spans.
+ *
+ * @property data The packed hits: page index, first character, character count and rect count,
+ * then [RECT_VALUES] floats per rect.
+ */
+@Keep
+@Suppress("TooManyFunctions")
+class SearchHits(
+    private val data: FloatArray,
+) {
+    private val offsets: IntArray = indexHits(data)
+
+    /** How many hits there are. */
+    val hitCount: Int
+        get() = offsets.size
+
+    /** The index of the page hit [i] is on. */
+    fun pageIndex(i: Int): Int = data[offsets[i] + PAGE_OFFSET].toInt()
+
+    /** The page offset of the first character of hit [i]. */
+    fun start(i: Int): Int = data[offsets[i] + START_OFFSET].toInt()
+
+    /** How many characters hit [i] has. */
+    fun length(i: Int): Int = data[offsets[i] + LENGTH_OFFSET].toInt()
+
+    /** How many rectangles highlight hit [i]. */
+    fun rectCount(i: Int): Int = data[offsets[i] + RECT_COUNT_OFFSET].toInt()
+
+    /**
+     * Copy rectangle [rect] of hit [i] into [out].
+     *
+     * @return [out]
+     */
+    fun getRect(
+        i: Int,
+        rect: Int,
+        out: RectF = RectF(),
+    ): RectF {
+        val at = offsets[i] + HIT_HEADER_VALUES + rect * RECT_VALUES
+        out.set(data[at], data[at + 1], data[at + 2], data[at + 3])
+        return out
+    }
+
+    /** The rectangles that highlight hit [i]. */
+    fun rects(i: Int): List<RectF> = List(rectCount(i)) { getRect(i, it) }
+
+    /** The hits on page [pageIndex], as indexes into these hits. */
+    fun hitsOnPage(pageIndex: Int): IntRange {
+        val first = firstHitAtOrAfter(pageIndex)
+        return first until firstHitAtOrAfter(pageIndex + 1)
+    }
+
+    private fun firstHitAtOrAfter(pageIndex: Int): Int {
+        var low = 0
+        var high = hitCount
+        while (low < high) {
+            val mid = (low + high) ushr 1
+            if (pageIndex(mid) < pageIndex) low = mid + 1 else high = mid
+        }
+        return low
+    }
+
+    /** These hits followed by [other]'s, which must come from later pages. */
+    operator fun plus(other: SearchHits): SearchHits =
+        when {
+            other.hitCount == 0 -> this
+            hitCount == 0 -> other
+            else -> SearchHits(data + other.data)
+        }
+
+    /**
+     * @suppress
+     */
+    companion object {
+        /** Floats per hit in the packed array before its rects. */
+        const val HIT_HEADER_VALUES = 4
+
+        /** Floats per rect in the packed array. */
+        const val RECT_VALUES = 4
+
+        private const val PAGE_OFFSET = 0
+        private const val START_OFFSET = 1
+        private const val LENGTH_OFFSET = 2
+        private const val RECT_COUNT_OFFSET = 3
+
+        /** No hits. */
+        val EMPTY = SearchHits(FloatArray(0))
+
+        private fun indexHits(data: FloatArray): IntArray {
+            var count = 0
+            var at = 0
+            while (at < data.size) {
+                count++
+                at += HIT_HEADER_VALUES + data[at + RECT_COUNT_OFFSET].toInt() * RECT_VALUES
+            }
+            val offsets = IntArray(count)
+            at = 0
+            for (i in 0 until count) {
+                offsets[i] = at
+                at += HIT_HEADER_VALUES + data[at + RECT_COUNT_OFFSET].toInt() * RECT_VALUES
+            }
+            return offsets
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+/**
+ * A [PdfiumSource] whose data is still arriving, such as a file being downloaded or fetched from a
+ * content store. Opened with a streaming loader, PDFium only reads ranges this source reports as
+ * available, so a linearized document's first page can be shown before the rest of the file is
+ * present.
+ */
+interface StreamingPdfiumSource : PdfiumSource {
+    /**
+     * Whether every byte of the range is available to [read] now. Once a range is reported
+     * available it must stay available.
+     *
+     * @param position byte offset from the beginning of the data source
+     * @param size the number of bytes in the range
+     * @return `true` if the whole range can be read
+     */
+    fun isDataAvailable(
+        position: Long,
+        size: Long,
+    ): Boolean
+
+    /**
+     * A hint that PDFium is waiting for the range, so a source that fetches data in some order can
+     * fetch it next. Ranges may overlap each other and data that is already available.
+     *
+     * @param position byte offset from the beginning of the data source
+     * @param size the number of bytes in the range
+     */
+    fun requestData(
+        position: Long,
+        size: Long,
+    ) {
+        // Sources that fetch in a fixed order can ignore hints.
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import java.nio.charset.Charset
+
+/**
+ * The encodings [DocumentText] can hold a document's text in.
+ *
+ * @property charset The [Charset] that decodes the text.
+ */
+enum class TextEncoding(
+    val charset: Charset,
+) {
+    /** Little-endian UTF-16, PDFium's own encoding, copied out without transcoding. */
+    UTF_16LE(Charsets.UTF_16LE),
+
+    /** UTF-8, about half the size for mostly Latin text, transcoded natively. */
+    UTF_8(Charsets.UTF_8),
+}
@@ -0,0 +1,46 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import androidx.annotation.Keep
+
+/**
+ * Counters of the native tile cache, see [Config.tileCacheBudgetBytes].
+ *
+ * @property hits Tiles drawn from the cache.
+ * @property misses Tiles that had to be rendered.
+ * @property evictions Tiles dropped to make room for new ones.
+ * @property tileCount Tiles currently cached.
+ * @property bytesAllocated Native memory the cache holds for tile pixels, never more than [budgetBytes].
+ * @property budgetBytes The cache's byte budget.
+ */
+@Keep
+data class TileCacheStats(
+    val hits: Long,
+    val misses: Long,
+    val evictions: Long,
+    val tileCount: Long,
+    val bytesAllocated: Long,
+    val budgetBytes: Long,
+) {
+    /** The share of tiles drawn from the cache, or 0 before any tile has been drawn. */
+    val hitRate: Double
+        get() = if (hits + misses == 0L) 0.0 else hits.toDouble() / (hits + misses)
+}
@@ -21,22 +21,35 @@
 
 package io.legere.pdfiumandroid.arrow
 
+import android.graphics.Bitmap
 import android.graphics.Matrix
 import android.graphics.RectF
 import android.view.Surface
 import arrow.core.Either
+import arrow.core.getOrElse
+import arrow.core.left
+import arrow.core.right
 import io.legere.pdfiumandroid.PdfDocument
 import io.legere.pdfiumandroid.PdfiumCore
 import io.legere.pdfiumandroid.api.Bookmark
+import io.legere.pdfiumandroid.api.DocumentText
+import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Meta
 import io.legere.pdfiumandroid.api.PdfWriteCallback
+import io.legere.pdfiumandroid.api.SearchHits
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.ThumbnailSource
+import io.legere.pdfiumandroid.core.unlocked.DocumentSearchU
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU
+import io.legere.pdfiumandroid.core.unlocked.TextExtractionU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.sync.withLock
 import kotlinx.coroutines.withContext
 import java.io.Closeable
+import java.nio.ByteBuffer
 
 /**
  * PdfDocumentKtF represents a PDF file and allows you to load pages from it.
@@ -57,6 +70,38 @@ class PdfDocumentKtF internal constructor(
             document.getPageCount()
         }
 
+    /**
+     *  suspend version of [PdfDocument.isPageAvailable]
+     */
+    suspend fun isPageAvailable(pageIndex: Int): Either<PdfiumKtFErrors, Boolean> =
+        wrapEither(dispatcher) {
+            document.isPageAvailable(pageIndex)
+        }
+
+    /**
+     *  suspend version of [PdfDocument.getFirstAvailablePage]
+     */
+    suspend fun getFirstAvailablePage(): Either<PdfiumKtFErrors, Int> =
+        wrapEither(dispatcher) {
+            document.getFirstAvailablePage()
+        }
+
+    /**
+     *  suspend version of [PdfDocument.setOnPageAvailableListener]
+     */
+    suspend fun setOnPageAvailableListener(listener: ((pageIndex: Int) -> Unit)?): Either<PdfiumKtFErrors, Unit> =
+        wrapEither(dispatcher) {
+            document.setOnPageAvailableListener(listener)
+        }
+
+    /**
+     *  suspend version of [PdfDocument.notifyDataAvailable]
+     */
+    suspend fun notifyDataAvailable(): Either<PdfiumKtFErrors, List<Int>> =
+        wrapEither(dispatcher) {
+            document.notifyDataAvailable()
+        }
+
     /**
      *  suspend version of [PdfDocument.getPageCharCounts]
      */
@@ -65,6 +110,53 @@ class PdfDocumentKtF internal constructor(
             document.getPageCharCounts()
         }
 
+    /**
+     * suspend version of [PdfDocument.extractText], suspending rather than blocking between chunks of pages
+     */
+    suspend fun extractText(
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        encoding: TextEncoding = TextEncoding.UTF_16LE,
+        pagesPerLock: Int = TextExtractionU.DEFAULT_PAGES_PER_LOCK,
+    ): Either<PdfiumKtFErrors, DocumentText?> {
+        val extraction =
+            wrapEither(dispatcher, LockTag.EXTRACT_TEXT) {
+                document.startTextExtraction(firstPage, pageCount, encoding)
+            }.getOrElse { return it.left() } ?: return null.right()
+        var done = false
+        while (!done) {
+            done = wrapEither(dispatcher, LockTag.EXTRACT_TEXT) { extraction.extractNext(pagesPerLock) }.getOrElse { return it.left() }
+        }
+        return extraction.result().right()
+    }
+
+    /**
+     * suspend version of [PdfDocument.search], suspending rather than blocking between runs of pages and
+     * stopping there when the coroutine is cancelled
+     */
+    @Suppress("LongParameterList")
+    suspend fun search(
+        query: String,
+        flags: Set<FindFlags> = emptySet(),
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        pagesPerLock: Int = DocumentSearchU.DEFAULT_PAGES_PER_LOCK,
+        onPagesSearched: (suspend (hits: SearchHits, pagesSearched: Int) -> Unit)? = null,
+    ): Either<PdfiumKtFErrors, SearchHits?> {
+        val search =
+            wrapEither(dispatcher, LockTag.SEARCH) {
+                document.startSearch(query, flags, firstPage, pageCount)
+            }.getOrElse { return it.left() } ?: return null.right()
+        while (!search.isFinished) {
+            val hits =
+                wrapEither(dispatcher, LockTag.SEARCH) {
+                    search.searchNext(pagesPerLock)
+                }.getOrElse { return it.left() } ?: return null.right()
+            onPagesSearched?.invoke(hits, search.pagesDone)
+        }
+        return search.result().right()
+    }
+
     /**
      * suspend version of [PdfDocument.getPageSize]
      */
@@ -84,11 +176,23 @@ class PdfDocumentKtF internal constructor(
             document.getPageSizes(screenDpi)
         }
 
+    /**
+     * Run [block] with the lock taken once, rather than once per call, for a run of operations such as rendering a
+     * page and reading its links and text geometry. The block runs on the dispatcher with the document's unlocked
+     * operations; see [PdfBatchKtF] for what it may do. It should not block on anything but PDFium, since every other
+     * caller waits for it.
+     * @return the result of [block], or the error it threw
+     */
+    suspend fun <T> batch(block: PdfBatchKtF.() -> T): Either<PdfiumKtFErrors, T> =
+        wrapEither(dispatcher, LockTag.BATCH) {
+            PdfBatchKtF(document).block()
+        }
+
     /**
      * suspend version of [PdfDocument.openPage]
      */
     suspend fun openPage(pageIndex: Int): Either<PdfiumKtFErrors, PdfPageKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_PAGE) {
             document.openPage(pageIndex)?.let {
                 PdfPageKtF(it, dispatcher)
             } ?: error("Page is null")
@@ -101,7 +205,7 @@ class PdfDocumentKtF internal constructor(
         fromIndex: Int,
         toIndex: Int,
     ): Either<PdfiumKtFErrors, List<PdfPageKtF>> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_PAGE) {
             document.openPages(fromIndex, toIndex).map { PdfPageKtF(it, dispatcher) }
         }
 
@@ -139,6 +243,57 @@ class PdfDocumentKtF internal constructor(
         } ?: false
     }
 
+    /**
+     * Open a [SurfaceRenderLoopKtF] for a Surface, see [PdfDocument.openRenderLoop]
+     */
+    suspend fun openRenderLoop(surface: Surface): Either<PdfiumKtFErrors, SurfaceRenderLoopKtF?> =
+        wrapEither(dispatcher) {
+            document.openRenderLoop(surface)?.let { SurfaceRenderLoopKtF(it) }
+        }
+
+    /**
+     * Open a [SurfaceFrameKtF] for a Surface, see [PdfDocument.openSurfaceFrame]
+     */
+    fun openSurfaceFrame(): SurfaceFrameKtF = SurfaceFrameKtF(document.openSurfaceFrame())
+
+    /**
+     * suspend version of [PdfDocument.renderPages] that reuses the previous frame when this one is it scrolled
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderPages(
+        surface: Surface?,
+        frame: SurfaceFrameKtF,
+        pages: List<PdfPageKtF>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        scrollX: Int,
+        scrollY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        renderCoroutinesDispatcher: CoroutineDispatcher,
+    ): Boolean =
+        withContext(renderCoroutinesDispatcher) {
+            surface?.let {
+                PdfiumCore.surfaceMutex.withLock {
+                    document.renderPages(
+                        surface,
+                        frame.frame,
+                        pages.map { page -> page.page },
+                        matrices,
+                        clipRects,
+                        scrollX,
+                        scrollY,
+                        renderAnnot,
+                        textMask,
+                        canvasColor,
+                        pageBackgroundColor,
+                    )
+                }
+            } ?: false
+        }
+
     /**
      * suspend version of [PdfDocument.deletePage]
      */
@@ -147,6 +302,77 @@ class PdfDocumentKtF internal constructor(
             document.deletePage(pageIndex)
         }
 
+    /**
+     * suspend version of [PdfDocument.renderThumbnail]
+     */
+    suspend fun renderThumbnail(
+        pageIndex: Int,
+        bitmap: Bitmap,
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): Either<PdfiumKtFErrors, ThumbnailSource?> =
+        wrapEither(dispatcher) {
+            document.renderThumbnail(pageIndex, bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * suspend version of [PdfDocument.renderThumbnailAtlas]
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderThumbnailAtlas(
+        bitmap: Bitmap,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): Either<PdfiumKtFErrors, List<RectF>> =
+        wrapEither(dispatcher) {
+            document.renderThumbnailAtlas(
+                bitmap,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
+    /**
+     * suspend version of [PdfDocument.renderThumbnailAtlas]
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderThumbnailAtlas(
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): Either<PdfiumKtFErrors, List<RectF>> =
+        wrapEither(dispatcher) {
+            document.renderThumbnailAtlas(
+                buffer,
+                width,
+                height,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
     /**
      * suspend version of [PdfDocument.getDocumentMeta]
      */
@@ -170,7 +396,7 @@ class PdfDocumentKtF internal constructor(
         fromIndex: Int,
         toIndex: Int,
     ): Either<PdfiumKtFErrors, List<PdfTextPageKtF>> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_TEXT_PAGE) {
             document.openTextPages(fromIndex, toIndex).map { PdfTextPageKtF(it, dispatcher) }
         }
 
@@ -182,6 +408,14 @@ class PdfDocumentKtF internal constructor(
             document.saveAsCopy(callback)
         }
 
+    /**
+     * suspend version of [PdfDocument.trimMemory]
+     */
+    suspend fun trimMemory(level: Int): Either<PdfiumKtFErrors, Long> =
+        wrapEither(dispatcher) {
+            document.trimMemory(level)
+        }
+
     /**
      * Close the document
      * @throws IllegalArgumentException if document is closed
@@ -34,9 +34,11 @@ import arrow.core.right
 import io.legere.pdfiumandroid.PdfPage
 import io.legere.pdfiumandroid.PdfiumCore
 import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.PageAttributes
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.core.unlocked.PdfPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import kotlinx.coroutines.CoroutineDispatcher
@@ -62,7 +64,7 @@ class PdfPageKtF internal constructor(
      * @throws IllegalArgumentException if document is closed or the page cannot be loaded
      */
     suspend fun openTextPage(): Either<PdfiumKtFErrors, PdfTextPageKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_TEXT_PAGE) {
             PdfTextPageKtF(page.openTextPage(), dispatcher)
         }
 
@@ -293,19 +295,25 @@ class PdfPageKtF internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Either<PdfiumKtFErrors, Boolean> =
-        wrapEither(dispatcher) {
-            page.renderPageBitmap(
-                bitmap,
-                startX,
-                startY,
-                drawSizeX,
-                drawSizeY,
-                renderAnnot,
-                textMask,
-                canvasColor,
-                pageBackgroundColor,
-            )
-            true
+        withContext(dispatcher) {
+            // Not under the lock: the render takes it natively, for the rendering alone.
+            Either
+                .catch {
+                    page.renderPageBitmap(
+                        bitmap,
+                        startX,
+                        startY,
+                        drawSizeX,
+                        drawSizeY,
+                        renderAnnot,
+                        textMask,
+                        canvasColor,
+                        pageBackgroundColor,
+                    )
+                    true
+                }.mapLeft {
+                    exceptionToPdfiumKtFError(it)
+                }
         }
 
     /**
@@ -321,9 +329,35 @@ class PdfPageKtF internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Either<PdfiumKtFErrors, Boolean> =
+        withContext(dispatcher) {
+            // Not under the lock: the render takes it natively, for the rendering alone.
+            Either
+                .catch {
+                    page.renderPageBitmap(bitmap, matrix, clipRect, renderAnnot, textMask, canvasColor, pageBackgroundColor)
+                    true
+                }.mapLeft {
+                    exceptionToPdfiumKtFError(it)
+                }
+        }
+
+    /**
+     * suspend version of [PdfPage.renderThumbnail]
+     */
+    suspend fun renderThumbnail(
+        bitmap: Bitmap,
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): Either<PdfiumKtFErrors, ThumbnailSource?> =
+        wrapEither(dispatcher) {
+            page.renderThumbnail(bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * suspend version of [PdfPage.hasEmbeddedThumbnail]
+     */
+    suspend fun hasEmbeddedThumbnail(): Either<PdfiumKtFErrors, Boolean> =
         wrapEither(dispatcher) {
-            page.renderPageBitmap(bitmap, matrix, clipRect, renderAnnot, textMask, canvasColor, pageBackgroundColor)
-            true
+            page.hasEmbeddedThumbnail()
         }
 
     /**
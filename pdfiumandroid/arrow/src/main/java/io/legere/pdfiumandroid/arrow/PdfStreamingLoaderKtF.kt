@@ -0,0 +1,73 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+@file:Suppress("unused")
+
+package io.legere.pdfiumandroid.arrow
+
+import arrow.core.Either
+import io.legere.pdfiumandroid.PdfStreamingLoader
+import io.legere.pdfiumandroid.core.unlocked.PdfStreamingLoaderU
+import io.legere.pdfiumandroid.core.util.wrapLock
+import kotlinx.coroutines.CoroutineDispatcher
+import java.io.Closeable
+
+/**
+ * PdfStreamingLoaderKtF opens a document whose data is still arriving.
+ * @property loader the [PdfStreamingLoaderU] to wrap
+ * @property dispatcher the [CoroutineDispatcher] to use for suspending calls
+ * @constructor create a [PdfStreamingLoaderKtF] from a [PdfStreamingLoaderU]
+ */
+class PdfStreamingLoaderKtF internal constructor(
+    internal val loader: PdfStreamingLoaderU,
+    private val dispatcher: CoroutineDispatcher,
+) : Closeable {
+    /**
+     * suspend version of [PdfStreamingLoader.isLinearized]
+     */
+    suspend fun isLinearized(): Either<PdfiumKtFErrors, Boolean?> =
+        wrapEither(dispatcher) {
+            loader.isLinearized()
+        }
+
+    /**
+     * suspend version of [PdfStreamingLoader.isDocumentAvailable]
+     */
+    suspend fun isDocumentAvailable(): Either<PdfiumKtFErrors, Boolean> =
+        wrapEither(dispatcher) {
+            loader.isDocumentAvailable()
+        }
+
+    /**
+     * suspend version of [PdfStreamingLoader.openDocument]
+     */
+    suspend fun openDocument(password: String? = null): Either<PdfiumKtFErrors, PdfDocumentKtF> =
+        wrapEither(dispatcher) {
+            PdfDocumentKtF(loader.openDocument(password), dispatcher)
+        }
+
+    /**
+     * Close the loader and its source, unless a document has been opened
+     */
+    override fun close() {
+        wrapLock {
+            loader.close()
+        }
+    }
+}
@@ -24,7 +24,11 @@ package io.legere.pdfiumandroid.arrow
 import android.graphics.RectF
 import arrow.core.Either
 import io.legere.pdfiumandroid.PdfTextPage
+import io.legere.pdfiumandroid.api.CharGeometry
 import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
+import io.legere.pdfiumandroid.api.PageWords
 import io.legere.pdfiumandroid.api.WordRangeRect
 import io.legere.pdfiumandroid.core.unlocked.PdfTextPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
@@ -79,6 +83,18 @@ class PdfTextPageKtF internal constructor(
             page.textPageGetCharBox(index)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageGetCharGeometry]
+     */
+    suspend fun textPageGetCharGeometry(
+        geometry: CharGeometry = CharGeometry(),
+        startIndex: Int = 0,
+        count: Int = -1,
+    ): Either<PdfiumKtFErrors, CharGeometry> =
+        wrapEither(dispatcher) {
+            page.textPageGetCharGeometry(geometry, startIndex, count)
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageGetCharIndexAtPos]
      */
@@ -92,6 +108,39 @@ class PdfTextPageKtF internal constructor(
             page.textPageGetCharIndexAtPos(x, y, xTolerance, yTolerance)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestChar]
+     */
+    suspend fun textPageHitTestChar(
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ): Either<PdfiumKtFErrors, Int> =
+        wrapEither(dispatcher) {
+            page.textPageHitTestChar(x, y, xTolerance, yTolerance)
+        }
+
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestCharRange]
+     */
+    suspend fun textPageHitTestCharRange(rect: RectF): Either<PdfiumKtFErrors, IntRange> =
+        wrapEither(dispatcher) {
+            page.textPageHitTestCharRange(rect)
+        }
+
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestLink]
+     */
+    suspend fun textPageHitTestLink(
+        page: PdfPageKtF,
+        x: Double,
+        y: Double,
+    ): Either<PdfiumKtFErrors, Link?> =
+        wrapEither(dispatcher) {
+            this.page.textPageHitTestLink(page.page, x, y)
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageCountRects]
      */
@@ -119,6 +168,14 @@ class PdfTextPageKtF internal constructor(
             page.textPageGetRectsForRanges(wordRanges)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageGetWords]
+     */
+    suspend fun textPageGetWords(): Either<PdfiumKtFErrors, PageWords?> =
+        wrapEither(dispatcher) {
+            page.textPageGetWords()
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageGetBoundedText]
      */
@@ -143,7 +200,7 @@ class PdfTextPageKtF internal constructor(
         flags: Set<FindFlags>,
         startIndex: Int,
     ): Either<PdfiumKtFErrors, FindResultKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.FIND_START) {
             val findResult = page.findStart(findWhat, flags, startIndex)
             if (findResult == null) {
                 error("findResult is null")
@@ -20,6 +20,7 @@
 package io.legere.pdfiumandroid.arrow
 
 import arrow.core.Either
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU.Companion.lock
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.withContext
@@ -36,6 +37,7 @@ import kotlinx.coroutines.withContext
  * @param T The expected successful return type of the [block].
  * @param dispatcher The [CoroutineDispatcher] on which the [block] will be executed.
  *                   This should typically be an IO dispatcher for native calls.
+ * @param tag The operation's name, for an [io.legere.pdfiumandroid.api.InstrumentedLockManager]; see [LockTag].
  * @param block The suspendable block of code to execute. This block will be run inside
  *              a `withLock` block on a shared mutex to ensure thread safety with native calls.
  * @return An [Either] where:
@@ -44,10 +46,11 @@ import kotlinx.coroutines.withContext
  */
 suspend inline fun <reified T> wrapEither(
     dispatcher: CoroutineDispatcher,
+    tag: String = LockTag.UNTAGGED,
     crossinline block: () -> T,
 ): Either<PdfiumKtFErrors, T> =
     withContext(dispatcher) {
-        lock.withLock {
+        lock.withLock(tag) {
             Either
                 .catch {
                     block()
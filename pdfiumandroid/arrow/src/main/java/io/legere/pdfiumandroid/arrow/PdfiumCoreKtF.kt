@@ -26,10 +26,14 @@ import arrow.core.Either
 import io.legere.pdfiumandroid.PdfiumCore
 import io.legere.pdfiumandroid.api.Config
 import io.legere.pdfiumandroid.api.LockManager
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU.Companion.lock
 import kotlinx.coroutines.CoroutineDispatcher
+import java.nio.ByteBuffer
 
 /**
  * PdfiumCoreKtF is the main entry-point for access to the PDFium API.
@@ -45,7 +49,7 @@ class PdfiumCoreKtF(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(fd: ParcelFileDescriptor): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(fd), dispatcher)
         }
 
@@ -56,7 +60,7 @@ class PdfiumCoreKtF(
         fd: ParcelFileDescriptor,
         password: String?,
     ): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(fd, password), dispatcher)
         }
 
@@ -64,7 +68,7 @@ class PdfiumCoreKtF(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(data: ByteArray?): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(data), dispatcher)
         }
 
@@ -75,7 +79,26 @@ class PdfiumCoreKtF(
         data: ByteArray?,
         password: String?,
     ): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
+            PdfDocumentKtF(coreInternal.newDocument(data, password), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.newDocument]
+     */
+    suspend fun newDocument(data: ByteBuffer): Either<PdfiumKtFErrors, PdfDocumentKtF> =
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
+            PdfDocumentKtF(coreInternal.newDocument(data), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.newDocument]
+     */
+    suspend fun newDocument(
+        data: ByteBuffer,
+        password: String?,
+    ): Either<PdfiumKtFErrors, PdfDocumentKtF> =
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(data, password), dispatcher)
         }
 
@@ -83,7 +106,7 @@ class PdfiumCoreKtF(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(data: PdfiumSource): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(data), dispatcher)
         }
 
@@ -94,10 +117,58 @@ class PdfiumCoreKtF(
         data: PdfiumSource,
         password: String?,
     ): Either<PdfiumKtFErrors, PdfDocumentKtF> =
-        wrapEither(dispatcher) {
+        wrapEither(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKtF(coreInternal.newDocument(data, password), dispatcher)
         }
 
+    /**
+     * suspend version of [PdfiumCore.newStreamingLoader]
+     */
+    suspend fun newStreamingLoader(source: StreamingPdfiumSource): Either<PdfiumKtFErrors, PdfStreamingLoaderKtF> =
+        wrapEither(dispatcher) {
+            PdfStreamingLoaderKtF(coreInternal.newStreamingLoader(source), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.setTileCacheBudget]
+     */
+    suspend fun setTileCacheBudget(budgetBytes: Long): Either<PdfiumKtFErrors, Unit> =
+        wrapEither(dispatcher) {
+            coreInternal.setTileCacheBudget(budgetBytes)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.getTileCacheStats]
+     */
+    suspend fun getTileCacheStats(): Either<PdfiumKtFErrors, TileCacheStats> =
+        wrapEither(dispatcher) {
+            coreInternal.getTileCacheStats()
+        }
+
+    /**
+     * suspend version of [PdfiumCore.clearTileCache]
+     */
+    suspend fun clearTileCache(resetStats: Boolean = false): Either<PdfiumKtFErrors, Unit> =
+        wrapEither(dispatcher) {
+            coreInternal.clearTileCache(resetStats)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.trimMemory]
+     */
+    suspend fun trimMemory(level: Int): Either<PdfiumKtFErrors, Long> =
+        wrapEither(dispatcher) {
+            coreInternal.trimMemory(level)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.destroyLibrary]
+     */
+    suspend fun destroyLibrary(): Either<PdfiumKtFErrors, Boolean> =
+        wrapEither(dispatcher) {
+            coreInternal.destroyLibrary()
+        }
+
     fun setLockManager(lockManager: LockManager) {
         lock = lockManager
     }
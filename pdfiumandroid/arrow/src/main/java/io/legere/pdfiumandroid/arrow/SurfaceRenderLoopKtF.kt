@@ -0,0 +1,64 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.arrow
+
+import android.graphics.Matrix
+import android.graphics.RectF
+import io.legere.pdfiumandroid.api.RenderLoopStats
+import io.legere.pdfiumandroid.core.unlocked.SurfaceRenderLoopU
+import java.io.Closeable
+
+/**
+ * Arrow-module version of [io.legere.pdfiumandroid.SurfaceRenderLoop]: a render loop presenting frames to one
+ * Surface from its own native thread, opened with [PdfDocumentKtF.openRenderLoop]. Use one per Surface, and
+ * close it when the Surface is destroyed.
+ *
+ * @property loop The underlying unlocked render loop.
+ */
+class SurfaceRenderLoopKtF internal constructor(
+    internal val loop: SurfaceRenderLoopU,
+) : Closeable {
+    /**
+     * Post a frame to the loop, see [io.legere.pdfiumandroid.SurfaceRenderLoop.submit]
+     */
+    @Suppress("LongParameterList")
+    fun submit(
+        pages: List<PdfPageKtF>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        renderAnnot: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ) {
+        loop.submit(pages.map { it.page }, matrices, clipRects, renderAnnot, canvasColor, pageBackgroundColor)
+    }
+
+    /**
+     * Get how many frames were submitted, rendered and dropped.
+     */
+    fun getStats(): RenderLoopStats = loop.getStats()
+
+    /**
+     * Stop the loop, see [io.legere.pdfiumandroid.SurfaceRenderLoop.close]
+     */
+    override fun close() {
+        loop.close()
+    }
+}
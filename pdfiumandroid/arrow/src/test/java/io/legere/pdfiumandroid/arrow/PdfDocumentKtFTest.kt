@@ -288,4 +288,28 @@ class PdfDocumentKtFTest {
         assertThat(result).isNull()
         verify { pdfDocumentU.close() }
     }
+
+    @Test
+    fun batch() =
+        runTest {
+            val pageU = mockk<PdfPageU>()
+            val page = PdfPageKtF(pageU, Dispatchers.Main)
+            coEvery { pdfDocumentU.getPageCount() } returns 3
+            val result =
+                pdfDocument
+                    .batch {
+                        assertThat(page.unlocked).isSameInstanceAs(pageU)
+                        document.getPageCount()
+                    }.getOrNull()
+            assertThat(result).isEqualTo(3)
+            coVerify { pdfDocumentU.getPageCount() }
+        }
+
+    @Test
+    fun `batch - fails`() =
+        runTest {
+            coEvery { pdfDocumentU.getPageCount() } throws IllegalStateException()
+            val result = pdfDocument.batch { document.getPageCount() }
+            assertThat(result.isLeft()).isTrue()
+        }
 }
@@ -37,6 +37,7 @@ import kotlinx.coroutines.test.runTest
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
 import org.junit.jupiter.api.extension.ExtendWith
+import java.nio.ByteBuffer
 
 @ExtendWith(MockKExtension::class, StandardTestDispatcherExtension::class)
 class PdfiumCoreKtFTest {
@@ -94,6 +95,16 @@ class PdfiumCoreKtFTest {
             coVerify { coreInternal.newDocument(any<ByteArray>(), any()) }
         }
 
+    @Test
+    fun testNewDocumentByteBuffer() =
+        runTest {
+            val data = ByteBuffer.allocateDirect(4)
+            coEvery { coreInternal.newDocument(any<ByteBuffer>(), any()) } returns document
+            val result = core.newDocument(data, "password").getOrNull()
+            assertThat(result?.document).isEqualTo(document)
+            coVerify { coreInternal.newDocument(data, "password") }
+        }
+
     @Test
     fun testNewDocument3() =
         runTest {
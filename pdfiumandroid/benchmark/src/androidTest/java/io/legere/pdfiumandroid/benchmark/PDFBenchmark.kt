@@ -227,6 +227,19 @@ class PDFBenchmark {
         }
     }
 
+    @Test
+    fun textPageGetWords() {
+        pdfDocument.openPage(0)?.use { page ->
+            page.openTextPage().use { textPage ->
+                benchmarkRule.measureRepeated {
+                    val words = textPage.textPageGetWords()
+                    assertThat(words).isNotNull()
+                    assertThat(words?.wordCount).isGreaterThan(0)
+                }
+            }
+        }
+    }
+
     @Test
     fun getTextPageGetRects() {
         pdfDocument.openPage(0)?.use { page ->
@@ -71,14 +71,39 @@ extern "C" {
 #include "util.h"
 #include "include/fpdf_edit.h"
 #include "include/fpdf_formfill.h"
+#include "include/fpdf_progressive.h"
+#include "include/fpdf_dataavail.h"
+#include "include/fpdf_thumbnail.h"
 #include <vector>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
 #include <algorithm> // For std::min
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <cmath>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 static std::mutex sLibraryLock;
 
+// Open documents. While it is above 0 the library stays initialized whatever its lifetime.
 static int sLibraryReferenceCount = 0;
 
+// PDFium is not thread-safe, so every FPDF_* call in this file runs under this mutex. runSafe holds it for the
+// whole native; the render natives use runSafeUnlocked and take it only around their FPDF_* calls, so locking
+// pixels and windows, marshalling arrays and converting to RGB_565 run outside it. Recursive because helpers
+// that lock it also run inside natives that already hold it. Callbacks into Java made under it (custom
+// document reads, save writes) must not wait on a Kotlin lock held by a thread calling into this file.
+static std::recursive_mutex sPdfiumMutex;
+using PdfiumLock = std::lock_guard<std::recursive_mutex>;
+
 const int MATRIX_VALUES_LEN = 6;
 const int RECT_VALUES_LEN = 4;
 
@@ -95,24 +120,103 @@ struct ScopedBitmap {
     ScopedBitmap &operator=(const ScopedBitmap &) = delete;
 };
 
+// How long the library stays initialized, matching io.legere.pdfiumandroid.api.LibraryLifetime. Initializing it
+// registers PDFium's modules and builds its font mapper, which is most of the cost of opening a small document, so
+// by default it outlives the last document for a while in case another is opened.
+enum LibraryLifetime {
+    // Destroyed once the last document closes and no other has opened within the idle timeout.
+    LIBRARY_REFERENCE_COUNTED = 0,
+    // Never destroyed.
+    LIBRARY_PROCESS = 1,
+    // Destroyed only by nativeDestroyLibrary.
+    LIBRARY_EXPLICIT = 2,
+};
+
+// All guarded by sLibraryLock.
+static bool sLibraryInitialized = false;
+static int sLibraryLifetime = LIBRARY_REFERENCE_COUNTED;
+static std::chrono::milliseconds sLibraryIdleTimeout{0};
+// A teardown waiting for the idle timeout, and when it is due.
+static bool sLibraryIdlePending = false;
+static std::chrono::steady_clock::time_point sLibraryIdleDeadline;
+static bool sLibraryIdleThreadRunning = false;
+static std::condition_variable sLibraryIdleCondition;
+
+static void initLibraryLocked() {
+    sLibraryIdlePending = false;
+    sLibraryIdleCondition.notify_all();
+    if (sLibraryInitialized) return;
+    LOGD("Init FPDF library");
+    FPDF_LIBRARY_CONFIG config;
+    config.version = 2;
+    config.m_pUserFontPaths = nullptr;
+    config.m_pIsolate = nullptr;
+    config.m_v8EmbedderSlot = 0;
+    FPDF_InitLibraryWithConfig(&config);
+    sLibraryInitialized = true;
+}
+
+static void destroyLibraryLocked() {
+    sLibraryIdlePending = false;
+    if (!sLibraryInitialized) return;
+    LOGD("Destroy FPDF library");
+    FPDF_DestroyLibrary();
+    sLibraryInitialized = false;
+}
+
+// Waits out sLibraryIdleDeadline, which a newer release may push back, and destroys the library unless a document
+// opened in the meantime. There is at most one of these threads.
+static void libraryIdleLoop() {
+    std::unique_lock<std::mutex> lock(sLibraryLock);
+    while (sLibraryIdlePending) {
+        auto deadline = sLibraryIdleDeadline;
+        sLibraryIdleCondition.wait_until(lock, deadline, [&] {
+            return !sLibraryIdlePending || sLibraryIdleDeadline != deadline;
+        });
+        if (!sLibraryIdlePending || std::chrono::steady_clock::now() < sLibraryIdleDeadline) continue;
+
+        // Closing a document holds the PDFium lock while it takes this one, so take them in that order.
+        lock.unlock();
+        {
+            PdfiumLock pdfiumLock(sPdfiumMutex);
+            const std::lock_guard<std::mutex> relock(sLibraryLock);
+            if (sLibraryIdlePending && sLibraryReferenceCount == 0 && sLibraryLifetime == LIBRARY_REFERENCE_COUNTED) {
+                destroyLibraryLocked();
+            }
+        }
+        lock.lock();
+    }
+    sLibraryIdleThreadRunning = false;
+}
+
+// Called with sLibraryLock held once nothing needs the library, to destroy it now or after the idle timeout.
+static void releaseLibraryLocked() {
+    if (sLibraryReferenceCount > 0 || sLibraryLifetime != LIBRARY_REFERENCE_COUNTED) return;
+    if (sLibraryIdleTimeout.count() <= 0) {
+        destroyLibraryLocked();
+        return;
+    }
+    sLibraryIdlePending = true;
+    sLibraryIdleDeadline = std::chrono::steady_clock::now() + sLibraryIdleTimeout;
+    if (sLibraryIdleThreadRunning) {
+        sLibraryIdleCondition.notify_all();
+    } else {
+        sLibraryIdleThreadRunning = true;
+        std::thread(libraryIdleLoop).detach();
+    }
+}
+
 static void initLibraryIfNeed(){
     const std::lock_guard<std::mutex> lock(sLibraryLock);
-    if(sLibraryReferenceCount == 0){
-        LOGD("Init FPDF library");
-        FPDF_InitLibrary();
-    }
+    initLibraryLocked();
     sLibraryReferenceCount++;
-    sLibraryLock.unlock();
 }
 
 static void destroyLibraryIfNeed(){
     const std::lock_guard<std::mutex> lock(sLibraryLock);
     sLibraryReferenceCount--;
     LOGD("sLibraryReferenceCount %d", sLibraryReferenceCount);
-    if(sLibraryReferenceCount == 0){
-        LOGD("Destroy FPDF library");
-        FPDF_DestroyLibrary();
-    }
+    releaseLibraryLocked();
 }
 
 struct rgb {
@@ -149,6 +253,244 @@ bool jniDetachCurrentThread(bool attached) {
     return true;
 }
 
+jfieldID dataBuffer;
+jmethodID readMethod;
+jmethodID isDataAvailableMethod;
+jmethodID requestDataMethod;
+jmethodID rasterizeFrameMethod;
+
+// Size-bounded LRU cache of a PdfiumSource's bytes, sitting between PDFium's FPDF_FILEACCESS and the Kotlin
+// PdfiumNativeSourceBridge. PDFium asks for many small, often repeated ranges; each one that reaches Kotlin costs
+// an upcall, a field read and an array copy. The source is cached in aligned chunks, so repeated ranges never
+// leave native code, and a miss fetches every missing chunk the request spans in one upcall. Misses that follow
+// on from the previous fetch are treated as a sequential scan and read ahead, doubling up to
+// MAX_READ_AHEAD_CHUNKS per upcall. Requests at least that large bypass the cache so one big stream can't flush
+// it. PDFium only reads a document under the document's lock, so the cache needs none of its own.
+// A streaming cache only caches ranges the source reports as downloaded, and answers PDFium's availability
+// questions from the cache where it can.
+class SourceBlockCache {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_CHUNKS = 64; // 4 MiB per document
+    static constexpr size_t MAX_READ_AHEAD_CHUNKS = 16;
+
+    SourceBlockCache(jobject bridge, uint64_t length, bool streaming = false)
+            : bridge(bridge), length(length), streaming(streaming) {}
+
+    bool read(uint64_t position, uint8_t *out, size_t size) {
+        if (size == 0) return true;
+        if (position > length || size > length - position) return false;
+        if (size >= CHUNK_SIZE * MAX_READ_AHEAD_CHUNKS) {
+            return fetch(position, size, [out, position](uint64_t offset, const jbyte *bytes, size_t count) {
+                memcpy(out + (offset - position), bytes, count);
+            });
+        }
+
+        uint64_t last = (position + size - 1) / CHUNK_SIZE;
+        for (uint64_t index = position / CHUNK_SIZE; index <= last; ++index) {
+            auto found = chunks.find(index);
+            if (found == chunks.end()) {
+                if (!fetchChunks(index, last)) {
+                    // A streaming source may hold the requested bytes but not the rest of their chunks.
+                    return streaming && fetch(position, size, [out, position](uint64_t offset, const jbyte *bytes,
+                                                                            size_t count) {
+                        memcpy(out + (offset - position), bytes, count);
+                    });
+                }
+                found = chunks.find(index);
+            }
+            lru.splice(lru.begin(), lru, found->second); // most recently used first
+            uint64_t chunkStart = index * CHUNK_SIZE;
+            uint64_t from = std::max(position, chunkStart);
+            uint64_t to = std::min(position + size, chunkStart + found->second->data.size());
+            memcpy(out + (from - position), found->second->data.data() + (from - chunkStart), to - from);
+        }
+        return true;
+    }
+
+    bool isAvailable(uint64_t position, size_t size) {
+        if (!streaming || size == 0) return true;
+        bool cached = true;
+        for (uint64_t index = position / CHUNK_SIZE; cached && index <= (position + size - 1) / CHUNK_SIZE; ++index) {
+            cached = chunks.find(index) != chunks.end();
+        }
+        if (cached) return true;
+
+        JNIEnv *env = nullptr;
+        bool attached;
+        if (!jniAttachCurrentThread(&env, &attached)) {
+            return false;
+        }
+        jboolean available = env->CallBooleanMethod(bridge, isDataAvailableMethod, (jlong) position, (jlong) size);
+        jniDetachCurrentThread(attached);
+        return available;
+    }
+
+    void requestData(uint64_t position, size_t size) {
+        JNIEnv *env = nullptr;
+        bool attached;
+        if (!jniAttachCurrentThread(&env, &attached)) {
+            return;
+        }
+        env->CallVoidMethod(bridge, requestDataMethod, (jlong) position, (jlong) size);
+        jniDetachCurrentThread(attached);
+    }
+
+private:
+    struct Chunk {
+        uint64_t index;
+        std::vector<uint8_t> data;
+    };
+
+    jobject bridge;
+    uint64_t length;
+    bool streaming;
+    std::list<Chunk> lru;
+    std::unordered_map<uint64_t, std::list<Chunk>::iterator> chunks;
+    uint64_t sequentialChunk = UINT64_MAX; // the chunk after the last fetch
+    size_t readAheadChunks = 1;
+
+    // Fetch chunk [first] and the missing chunks after it up to [lastNeeded], plus read-ahead, in one upcall.
+    bool fetchChunks(uint64_t first, uint64_t lastNeeded) {
+        readAheadChunks = first == sequentialChunk ? std::min(readAheadChunks * 2, MAX_READ_AHEAD_CHUNKS) : 1;
+        uint64_t chunkCount = (length + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        uint64_t end = first + 1;
+        while (end < chunkCount && end - first < MAX_READ_AHEAD_CHUNKS &&
+               (end <= lastNeeded || end - first < readAheadChunks) && chunks.find(end) == chunks.end()) {
+            ++end;
+        }
+        if (streaming) {
+            // A chunk read past what the source has downloaded would cache garbage: drop the read-ahead if it
+            // isn't there yet, and give up on caching if even the requested chunks aren't complete.
+            if (!isAvailable(first * CHUNK_SIZE, std::min(end * CHUNK_SIZE, length) - first * CHUNK_SIZE)) {
+                end = std::min(end, lastNeeded + 1);
+                if (!isAvailable(first * CHUNK_SIZE, std::min(end * CHUNK_SIZE, length) - first * CHUNK_SIZE)) {
+                    return false;
+                }
+            }
+        }
+
+        std::vector<Chunk *> run;
+        for (uint64_t index = first; index < end; ++index) {
+            uint64_t chunkStart = index * CHUNK_SIZE;
+            run.push_back(&insertChunk(index, (size_t) std::min<uint64_t>(CHUNK_SIZE, length - chunkStart)));
+        }
+        uint64_t start = first * CHUNK_SIZE;
+        uint64_t runLength = std::min(end * CHUNK_SIZE, length) - start;
+        bool ok = fetch(start, (size_t) runLength, [&run, first](uint64_t offset, const jbyte *bytes, size_t count) {
+            while (count > 0) {
+                Chunk *chunk = run[offset / CHUNK_SIZE - first];
+                size_t within = offset % CHUNK_SIZE;
+                size_t n = std::min(count, chunk->data.size() - within);
+                memcpy(chunk->data.data() + within, bytes, n);
+                offset += n;
+                bytes += n;
+                count -= n;
+            }
+        });
+        if (!ok) {
+            for (uint64_t index = first; index < end; ++index) {
+                lru.erase(chunks[index]);
+                chunks.erase(index);
+            }
+            return false;
+        }
+        sequentialChunk = end;
+        return true;
+    }
+
+    Chunk &insertChunk(uint64_t index, size_t size) {
+        if (chunks.size() >= MAX_CHUNKS) {
+            // Recycle the least recently used chunk's storage.
+            chunks.erase(lru.back().index);
+            lru.splice(lru.begin(), lru, std::prev(lru.end()));
+        } else {
+            lru.emplace_front();
+        }
+        Chunk &chunk = lru.front();
+        chunk.index = index;
+        chunk.data.resize(size);
+        chunks[index] = lru.begin();
+        return chunk;
+    }
+
+    // Read [position, position + size) through the bridge, handing each piece it returns to [sink]. A source
+    // may return fewer bytes than asked for, so this keeps asking until the range is filled or a read fails.
+    template<typename Sink>
+    bool fetch(uint64_t position, size_t size, Sink sink) {
+        JNIEnv *env = nullptr;
+        bool attached;
+        if (!jniAttachCurrentThread(&env, &attached)) {
+            return false;
+        }
+        size_t filled = 0;
+        while (filled < size) {
+            jint bytesRead = env->CallIntMethod(bridge, readMethod, (jlong) (position + filled),
+                                                (jlong) (size - filled));
+            if (bytesRead <= 0) {
+                LOGE("Cannot read from custom source");
+                break;
+            }
+            auto count = std::min((size_t) bytesRead, size - filled);
+            auto buffer = (jbyteArray) env->GetObjectField(bridge, dataBuffer);
+            auto *bytes = static_cast<jbyte *>(env->GetPrimitiveArrayCritical(buffer, nullptr));
+            if (bytes != nullptr) {
+                sink(position + filled, bytes, count);
+                env->ReleasePrimitiveArrayCritical(buffer, bytes, JNI_ABORT);
+            }
+            env->DeleteLocalRef(buffer);
+            if (bytes == nullptr) break;
+            filled += count;
+        }
+        jniDetachCurrentThread(attached);
+        return filled == size;
+    }
+};
+
+// A custom-source document opened progressively through PDFium's data availability API: the source reports which
+// byte ranges it already holds, and PDFium's download hints for the ranges it is waiting on are passed back to
+// it. Owned by the Kotlin loader until the document is opened, then by the DocumentFile.
+class AvailSource : public FX_FILEAVAIL, public FX_DOWNLOADHINTS {
+public:
+    jobject bridge;
+    SourceBlockCache cache;
+    FPDF_FILEACCESS fileAccess{}; // PDFium keeps pointers to this and to the FX_FILEAVAIL base
+    FPDF_AVAIL avail = nullptr;
+
+    // Holds a library reference of its own, as PDFium is used before any document is open.
+    AvailSource(jobject bridge, uint64_t length) : bridge(bridge), cache(bridge, length, true) {
+        initLibraryIfNeed();
+        FX_FILEAVAIL::version = 1;
+        IsDataAvail = &isDataAvail;
+        FX_DOWNLOADHINTS::version = 1;
+        AddSegment = &addSegment;
+    }
+
+    ~AvailSource() {
+        if (avail != nullptr) {
+            FPDFAvail_Destroy(avail);
+        }
+        JNIEnv *env;
+        bool attached;
+        if (jniAttachCurrentThread(&env, &attached)) {
+            env->DeleteGlobalRef(bridge);
+            jniDetachCurrentThread(attached);
+        }
+        destroyLibraryIfNeed();
+    }
+
+    FX_DOWNLOADHINTS *hints() { return this; }
+
+private:
+    static FPDF_BOOL isDataAvail(FX_FILEAVAIL *pThis, size_t offset, size_t size) {
+        return static_cast<AvailSource *>(pThis)->cache.isAvailable(offset, size);
+    }
+
+    static void addSegment(FX_DOWNLOADHINTS *pThis, size_t offset, size_t size) {
+        static_cast<AvailSource *>(pThis)->cache.requestData(offset, size);
+    }
+};
+
 class DocumentFile {
 
 public:
@@ -156,13 +498,307 @@ public:
 
 public:
     jobject nativeSourceBridgeGlobalRef = nullptr;
+    // Cache in front of nativeSourceBridgeGlobalRef; FPDF_FILEACCESS reads a custom document through it.
+    SourceBlockCache *sourceCache = nullptr;
+    // Availability provider of a streaming document; PDFium reads the document through it.
+    AvailSource *availSource = nullptr;
+    // Direct ByteBuffer PDFium reads a buffer-backed document from; the global ref keeps its memory alive.
+    jobject directBufferGlobalRef = nullptr;
     jbyte *cDataCopy = nullptr;
+    // Read-only mapping of the file a mapped document was opened from; PDFium reads straight out of it.
+    void *mappedData = nullptr;
+    size_t mappedLength = 0;
 
     DocumentFile() { initLibraryIfNeed(); }
     ~DocumentFile();
+
+    FPDF_FORMHANDLE getFormHandle();
+    void onPageLoaded(FPDF_PAGE page, int pageIndex);
+    void onPageClosing(FPDF_PAGE page);
+
+private:
+    // The form-fill environment is created on the first render that draws form fields and lives until the
+    // document closes; PDFium keeps a pointer to the callbacks, so they live here too.
+    FPDF_FORMFILLINFO formCallbacks{};
+    FPDF_FORMHANDLE formHandle = nullptr;
+    bool formInitialized = false;
+};
+
+// The document each loaded page belongs to, and its index in it. PDFium has no page -> document lookup, and the
+// calls that only get a page pointer (closing it, the matrix and surface renders) still need the document's form
+// handle, and the tile cache needs a key that outlives the page pointer. [generation] is unique to each load, so a
+// render that let go of the PDFium lock can tell its page from a different page loaded at the same address since.
+struct PageEntry {
+    DocumentFile *doc;
+    int pageIndex;
+    uint64_t generation;
+};
+
+static std::mutex sPageDocumentsLock;
+static std::unordered_map<FPDF_PAGE, PageEntry> sPageDocuments;
+static uint64_t sPageGeneration = 0;
+
+static DocumentFile *documentForPage(FPDF_PAGE page) {
+    const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+    auto it = sPageDocuments.find(page);
+    return it == sPageDocuments.end() ? nullptr : it->second.doc;
+}
+
+// The load generation of [page], or 0 if it isn't open.
+static uint64_t pageGeneration(FPDF_PAGE page) {
+    const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+    auto it = sPageDocuments.find(page);
+    return it == sPageDocuments.end() ? 0 : it->second.generation;
+}
+
+static bool pageEntryFor(FPDF_PAGE page, PageEntry *entry) {
+    const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+    auto it = sPageDocuments.find(page);
+    if (it == sPageDocuments.end()) return false;
+    *entry = it->second;
+    return true;
+}
+
+// The form handle to draw [page]'s form fields with, or null when its document has no form.
+static FPDF_FORMHANDLE formForPage(FPDF_PAGE page) {
+    DocumentFile *doc = documentForPage(page);
+    return doc == nullptr ? nullptr : doc->getFormHandle();
+}
+
+FPDF_FORMHANDLE DocumentFile::getFormHandle() {
+    if (formInitialized) return formHandle;
+    formInitialized = true;
+    if (pdfDocument == nullptr || FPDF_GetFormType(pdfDocument) == FORMTYPE_NONE) return nullptr;
+
+    formCallbacks.version = 2;
+    formHandle = FPDFDOC_InitFormFillEnvironment(pdfDocument, &formCallbacks);
+    if (formHandle == nullptr) return nullptr;
+
+    // Pages loaded before the first form render haven't been announced to the form module yet.
+    const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+    for (auto &entry : sPageDocuments) {
+        if (entry.second.doc == this) FORM_OnAfterLoadPage(entry.first, formHandle);
+    }
+    return formHandle;
+}
+
+void DocumentFile::onPageLoaded(FPDF_PAGE page, int pageIndex) {
+    {
+        const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+        sPageDocuments[page] = PageEntry{this, pageIndex, ++sPageGeneration};
+    }
+    if (formHandle != nullptr) FORM_OnAfterLoadPage(page, formHandle);
+}
+
+void DocumentFile::onPageClosing(FPDF_PAGE page) {
+    if (formHandle != nullptr) FORM_OnBeforeClosePage(page, formHandle);
+    const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+    sPageDocuments.erase(page);
+}
+
+// Rendered tiles of pages, kept so that a page drawn again at the same scale - every frame of a scroll, or
+// panning at a fixed zoom - is copied out of memory instead of rasterized again. A tile is a TILE_SIZE square of
+// the page as rendered at one scale, keyed by the document, page index, scale (quantized, so float noise in the
+// viewer's matrix doesn't defeat the cache), tile position, render flags and page background color.
+//
+// Tile pixels live in fixed-size blocks. Blocks are allocated up to the byte budget, then reused: a miss with the
+// budget spent takes the block of the least recently used tile, and the blocks of a closed document's tiles are
+// kept for the next tiles instead of being freed. A budget smaller than one block disables the cache.
+//
+// Every method takes the cache's lock; renders hold it while they composite, so a tile can't be evicted from
+// under a copy.
+class TileCache {
+public:
+    static constexpr int TILE_SIZE = 256;
+    static constexpr size_t BLOCK_BYTES = (size_t) TILE_SIZE * TILE_SIZE * 4;
+    // Scales are keyed, and rendered, in steps of 1/SCALE_STEPS.
+    static constexpr double SCALE_STEPS = 4096.0;
+
+    struct Key {
+        DocumentFile *doc;
+        int pageIndex;
+        int scaleX;
+        int scaleY;
+        int tileX;
+        int tileY;
+        int flags;
+        int backgroundColor;
+
+        bool operator==(const Key &other) const {
+            return doc == other.doc && pageIndex == other.pageIndex && scaleX == other.scaleX &&
+                   scaleY == other.scaleY && tileX == other.tileX && tileY == other.tileY &&
+                   flags == other.flags && backgroundColor == other.backgroundColor;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            size_t hash = std::hash<void *>()(key.doc);
+            for (int value : {key.pageIndex, key.scaleX, key.scaleY, key.tileX, key.tileY, key.flags,
+                              key.backgroundColor}) {
+                hash = hash * 31 + std::hash<int>()(value);
+            }
+            return hash;
+        }
+    };
+
+    struct Tile {
+        Key key;
+        uint8_t *pixels;
+        int width;
+        int height;
+    };
+
+    std::mutex lock;
+
+    ~TileCache() { clear(); }
+
+    bool enabled() const { return budget >= BLOCK_BYTES; }
+
+    // The cached tile for [key], now the most recently used, or null.
+    Tile *find(const Key &key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        tiles.splice(tiles.begin(), tiles, it->second);
+        return &*it->second;
+    }
+
+    // A new, most recently used tile for [key] whose pixels the caller renders, or null if the budget doesn't
+    // hold a single block.
+    Tile *insert(const Key &key, int width, int height) {
+        uint8_t *pixels = acquireBlock();
+        if (pixels == nullptr) return nullptr;
+        tiles.push_front(Tile{key, pixels, width, height});
+        index[key] = tiles.begin();
+        return &tiles.front();
+    }
+
+    // Drops a tile whose render failed.
+    void remove(Tile *tile) {
+        auto it = index.find(tile->key);
+        if (it == index.end()) return;
+        freeBlocks.push_back(it->second->pixels);
+        tiles.erase(it->second);
+        index.erase(it);
+    }
+
+    // Drops every tile of [doc]; their blocks are kept for reuse.
+    void invalidate(DocumentFile *doc) {
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (it->key.doc == doc) {
+                index.erase(it->key);
+                freeBlocks.push_back(it->pixels);
+                it = tiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void setBudget(size_t bytes) {
+        budget = bytes;
+        while (blockCount * BLOCK_BYTES > budget && !freeBlocks.empty()) {
+            free(freeBlocks.back());
+            freeBlocks.pop_back();
+            blockCount--;
+        }
+        while (blockCount * BLOCK_BYTES > budget && !tiles.empty()) {
+            evictOldest();
+            free(freeBlocks.back());
+            freeBlocks.pop_back();
+            blockCount--;
+        }
+    }
+
+    void clear() {
+        for (auto &tile : tiles) free(tile.pixels);
+        for (auto *block : freeBlocks) free(block);
+        tiles.clear();
+        index.clear();
+        freeBlocks.clear();
+        blockCount = 0;
+    }
+
+    // hits, misses, evictions, cached tiles, bytes allocated, budget.
+    static constexpr int STATS_LEN = 6;
+
+    void getStats(jlong *stats) const {
+        stats[0] = (jlong) hits;
+        stats[1] = (jlong) misses;
+        stats[2] = (jlong) evictions;
+        stats[3] = (jlong) tiles.size();
+        stats[4] = (jlong) (blockCount * BLOCK_BYTES);
+        stats[5] = (jlong) budget;
+    }
+
+    void resetStats() {
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+private:
+    size_t budget = 0;
+    size_t blockCount = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    std::list<Tile> tiles; // most recently used first
+    std::unordered_map<Key, std::list<Tile>::iterator, KeyHash> index;
+    std::vector<uint8_t *> freeBlocks;
+
+    uint8_t *acquireBlock() {
+        if (!enabled()) return nullptr;
+        if (freeBlocks.empty()) {
+            if ((blockCount + 1) * BLOCK_BYTES <= budget) {
+                auto *block = static_cast<uint8_t *>(malloc(BLOCK_BYTES));
+                if (block != nullptr) {
+                    blockCount++;
+                    return block;
+                }
+            }
+            if (tiles.empty()) return nullptr;
+            evictOldest();
+        }
+        uint8_t *block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return block;
+    }
+
+    void evictOldest() {
+        Tile &oldest = tiles.back();
+        index.erase(oldest.key);
+        freeBlocks.push_back(oldest.pixels);
+        tiles.pop_back();
+        evictions++;
+    }
 };
 
+static TileCache sTileCache;
+
 DocumentFile::~DocumentFile(){
+    {
+        const std::lock_guard<std::mutex> lock(sTileCache.lock);
+        sTileCache.invalidate(this);
+    }
+    {
+        const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+        for (auto it = sPageDocuments.begin(); it != sPageDocuments.end();) {
+            if (it->second.doc == this) {
+                it = sPageDocuments.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if(formHandle != nullptr){
+        FPDFDOC_ExitFormFillEnvironment(formHandle);
+        formHandle = nullptr;
+    }
     if(pdfDocument != nullptr){
         FPDF_CloseDocument(pdfDocument);
         pdfDocument = nullptr;
@@ -171,11 +807,20 @@ DocumentFile::~DocumentFile(){
         free(cDataCopy);
         cDataCopy = nullptr;
     }
-    if(nativeSourceBridgeGlobalRef != nullptr){
+    if(mappedData != nullptr){
+        munmap(mappedData, mappedLength);
+        mappedData = nullptr;
+    }
+    delete sourceCache;
+    sourceCache = nullptr;
+    delete availSource;
+    availSource = nullptr;
+    if(nativeSourceBridgeGlobalRef != nullptr || directBufferGlobalRef != nullptr){
         JNIEnv *env;
         bool attached;
         if(jniAttachCurrentThread(&env, &attached)){
-            env->DeleteGlobalRef(nativeSourceBridgeGlobalRef);
+            if(nativeSourceBridgeGlobalRef != nullptr) env->DeleteGlobalRef(nativeSourceBridgeGlobalRef);
+            if(directBufferGlobalRef != nullptr) env->DeleteGlobalRef(directBufferGlobalRef);
             jniDetachCurrentThread(attached);
         }
     }
@@ -268,22 +913,182 @@ int jniThrowExceptionFmt(JNIEnv* env, const char* className, const char* fmt, ..
 //    return env->NewObject(cls, methodID, value);
 //}
 
-uint16_t rgbTo565(rgb *color) {
-    return ((color->red >> 3) << 11) | ((color->green >> 2) << 5) | (color->blue >> 3);
+// Whether RGB_565 output is ordered-dithered; set from Kotlin, read by every RGB_565 render.
+static std::atomic<bool> sDitherRgb565{false};
+
+// Set from Kotlin while the app is short of memory. Renders then pass FPDF_RENDER_LIMITEDIMAGECACHE, so PDFium stops
+// keeping every decoded image cached on its page.
+static std::atomic<bool> sLimitedImageCache{false};
+
+// The flags every render starts from.
+static int baseRenderFlags() {
+    return FPDF_REVERSE_BYTE_ORDER |
+           (sLimitedImageCache.load(std::memory_order_relaxed) ? FPDF_RENDER_LIMITEDIMAGECACHE : 0);
+}
+
+// 4x4 ordered-dither (Bayer) thresholds, 0..15. Going to RGB_565, red and blue lose 3 bits and green loses 2, so a
+// pixel gets its threshold >> 1 added to red and blue and >> 2 added to green before they are truncated.
+static const uint8_t BAYER_4X4[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+static inline uint16_t pack565(unsigned red, unsigned green, unsigned blue) {
+    return (uint16_t) (((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3));
 }
 
-void rgbBitmapTo565(void *source, int sourceStride, void *dest, AndroidBitmapInfo *info) {
-    rgb *srcLine;
-    uint16_t *dstLine;
-    int y, x;
-    for (y = 0; y < info->height; y++) {
-        srcLine = (rgb*) source;
-        dstLine = (uint16_t*) dest;
-        for (x = 0; x < info->width; x++) {
-            dstLine[x] = rgbTo565(&srcLine[x]);
+// Converts one row of [width] pixels to RGB_565. Source pixels are [bytesPerPixel] apart and start with red, green,
+// blue - the order PDFium writes with FPDF_REVERSE_BYTE_ORDER. [y] picks the row of the dither pattern. The vector
+// loops step a multiple of 4 pixels from x = 0, so every step lines up with the same 4-wide pattern.
+static void rowTo565(const uint8_t *src, int bytesPerPixel, uint16_t *dst, int width, int y, bool dither) {
+    const uint8_t *bayer = BAYER_4X4[y & 3];
+    int x = 0;
+#if defined(__ARM_NEON)
+    uint8_t redBlueSteps[16], greenSteps[16];
+    for (int i = 0; i < 16; ++i) {
+        redBlueSteps[i] = dither ? bayer[i & 3] >> 1 : 0;
+        greenSteps[i] = dither ? bayer[i & 3] >> 2 : 0;
+    }
+    const uint8x16_t redBlueThreshold = vld1q_u8(redBlueSteps);
+    const uint8x16_t greenThreshold = vld1q_u8(greenSteps);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t red, green, blue;
+        if (bytesPerPixel == 4) {
+            uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+            red = pixels.val[0];
+            green = pixels.val[1];
+            blue = pixels.val[2];
+        } else {
+            uint8x16x3_t pixels = vld3q_u8(src + x * 3);
+            red = pixels.val[0];
+            green = pixels.val[1];
+            blue = pixels.val[2];
+        }
+        red = vqaddq_u8(red, redBlueThreshold);
+        green = vqaddq_u8(green, greenThreshold);
+        blue = vqaddq_u8(blue, redBlueThreshold);
+        // Red in the top byte, then green and blue shifted in below it, each keeping the bits above.
+        uint16x8_t low = vshll_n_u8(vget_low_u8(red), 8);
+        low = vsriq_n_u16(low, vshll_n_u8(vget_low_u8(green), 8), 5);
+        low = vsriq_n_u16(low, vshll_n_u8(vget_low_u8(blue), 8), 11);
+        uint16x8_t high = vshll_n_u8(vget_high_u8(red), 8);
+        high = vsriq_n_u16(high, vshll_n_u8(vget_high_u8(green), 8), 5);
+        high = vsriq_n_u16(high, vshll_n_u8(vget_high_u8(blue), 8), 11);
+        vst1q_u16(dst + x, low);
+        vst1q_u16(dst + x + 8, high);
+    }
+#elif defined(__SSE2__)
+    if (bytesPerPixel == 4) {
+        uint8_t steps[16];
+        for (int i = 0; i < 4; ++i) {
+            steps[i * 4] = steps[i * 4 + 2] = dither ? bayer[i] >> 1 : 0;
+            steps[i * 4 + 1] = dither ? bayer[i] >> 2 : 0;
+            steps[i * 4 + 3] = 0;
+        }
+        const __m128i threshold = _mm_loadu_si128(reinterpret_cast<const __m128i *>(steps));
+        const __m128i redMask = _mm_set1_epi32(0xF8);
+        const __m128i greenMask = _mm_set1_epi32(0xFC00);
+        const __m128i blueMask = _mm_set1_epi32(0xF80000);
+        // Four 32-bit pixels per vector, red in the low byte; each becomes a 565 value in its low 16 bits, which
+        // are sign-extended so the signed pack keeps them intact.
+        auto to565 = [&](__m128i pixels) {
+            pixels = _mm_adds_epu8(pixels, threshold);
+            __m128i packed = _mm_or_si128(
+                    _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pixels, redMask), 8),
+                                 _mm_srli_epi32(_mm_and_si128(pixels, greenMask), 5)),
+                    _mm_srli_epi32(_mm_and_si128(pixels, blueMask), 19));
+            return _mm_srai_epi32(_mm_slli_epi32(packed, 16), 16);
+        };
+        for (; x + 8 <= width; x += 8) {
+            __m128i first = to565(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4)));
+            __m128i second = to565(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 4 + 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packs_epi32(first, second));
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        const uint8_t *pixel = src + x * bytesPerPixel;
+        unsigned redBlueStep = dither ? bayer[x & 3] >> 1 : 0;
+        unsigned greenStep = dither ? bayer[x & 3] >> 2 : 0;
+        dst[x] = pack565(std::min(255u, pixel[0] + redBlueStep), std::min(255u, pixel[1] + greenStep),
+                         std::min(255u, pixel[2] + redBlueStep));
+    }
+}
+
+// Converts [height] rows to RGB_565. [firstRow] is the first row's y in the whole bitmap, for the dither pattern.
+void rgbBitmapTo565(const void *source, int sourceStride, int bytesPerPixel, void *dest, int destStride,
+                    int width, int height, int firstRow, bool dither) {
+    for (int y = 0; y < height; y++) {
+        rowTo565(static_cast<const uint8_t *>(source) + (size_t) y * sourceStride, bytesPerPixel,
+                 reinterpret_cast<uint16_t *>(static_cast<uint8_t *>(dest) + (size_t) y * destStride),
+                 width, firstRow + y, dither);
+    }
+}
+
+// RGB_565 bitmaps are rendered a band of rows at a time into a reused RGBX buffer, then converted into the bitmap,
+// instead of through a full-size 24-bit copy allocated per render. Each band walks the page's display list again,
+// so bands are sized in bytes rather than kept to a few rows.
+static const size_t RGB565_BAND_BYTES = 512 * 1024;
+static const int RGB565_MIN_BAND_ROWS = 16;
+// How many band buffers are kept between renders. A render holds its buffer while converting, outside the PDFium
+// lock, so renders on other threads need buffers of their own; those beyond this many are freed after the render
+// rather than pinned by every thread that ever rendered.
+static const size_t RGB565_KEPT_BAND_BUFFERS = 2;
+
+// A band buffer, taken from the kept ones for the length of a render and given back after.
+class BandBuffer {
+public:
+    explicit BandBuffer(size_t size) {
+        {
+            const std::lock_guard<std::mutex> lock(sKeptLock);
+            if (sKeptCount > 0) data = std::move(sKept[--sKeptCount]);
+        }
+        if (data.size() < size) data.resize(size);
+    }
+
+    ~BandBuffer() {
+        const std::lock_guard<std::mutex> lock(sKeptLock);
+        // A very wide bitmap's band, its minimum rows past RGB565_BAND_BYTES, isn't worth keeping.
+        if (sKeptCount < RGB565_KEPT_BAND_BUFFERS && data.size() <= RGB565_BAND_BYTES) {
+            sKept[sKeptCount++] = std::move(data);
+        }
+    }
+
+    BandBuffer(const BandBuffer &) = delete;
+    BandBuffer &operator=(const BandBuffer &) = delete;
+
+    std::vector<uint8_t> data;
+
+private:
+    static std::mutex sKeptLock;
+    static std::vector<uint8_t> sKept[RGB565_KEPT_BAND_BUFFERS];
+    static size_t sKeptCount;
+};
+
+std::mutex BandBuffer::sKeptLock;
+std::vector<uint8_t> BandBuffer::sKept[RGB565_KEPT_BAND_BUFFERS];
+size_t BandBuffer::sKeptCount = 0;
+
+// Calls [renderBand](band, top, rows) for each band of [info]'s rows; the band bitmap's row 0 is bitmap row [top].
+// Each band is rendered under the PDFium lock and converted after it's released, so other threads' PDFium calls
+// interleave with the conversion. [renderBand] returning false stops the render before that band is converted.
+template<typename RenderBand>
+static void renderTo565InBands(void *pixels, const AndroidBitmapInfo &info, RenderBand renderBand) {
+    int width = (int) info.width;
+    int height = (int) info.height;
+    if (width <= 0 || height <= 0) return;
+    size_t rowBytes = (size_t) width * 4;
+    int bandRows = std::min(height, (int) std::max((size_t) RGB565_MIN_BAND_ROWS, RGB565_BAND_BYTES / rowBytes));
+    BandBuffer buffer(rowBytes * bandRows);
+    std::vector<uint8_t> &scratch = buffer.data;
+
+    bool dither = sDitherRgb565.load(std::memory_order_relaxed);
+    for (int top = 0; top < height; top += bandRows) {
+        int rows = std::min(bandRows, height - top);
+        {
+            PdfiumLock lock(sPdfiumMutex);
+            ScopedBitmap band(FPDFBitmap_CreateEx(width, rows, FPDFBitmap_BGRx, scratch.data(), (int) rowBytes));
+            if (band == nullptr || !renderBand((FPDF_BITMAP) band, top, rows)) return;
         }
-        source = (char*) source + sourceStride;
-        dest = (char*) dest + info->stride;
+        rgbBitmapTo565(scratch.data(), (int) rowBytes, 4, static_cast<uint8_t *>(pixels) + (size_t) top * info.stride,
+                       (int) info.stride, width, rows, top, dither);
     }
 }
 
@@ -311,9 +1116,6 @@ jlong loadTextPageInternal(JNIEnv *env, DocumentFile *doc, jlong pagePtr) {
     }
 }
 
-jfieldID dataBuffer;
-jmethodID readMethod;
-
 extern "C"
 int getBlock(void* param, unsigned long position, unsigned char* outBuffer,
                     unsigned long size) {
@@ -329,35 +1131,13 @@ int getBlock(void* param, unsigned long position, unsigned char* outBuffer,
 extern "C"
 int getBlockFromCustomSource(void* param, unsigned long position, unsigned char* outBuffer,
                              unsigned long size) {
-    JNIEnv *env = nullptr;
-    bool attached;
-    if (!jniAttachCurrentThread(&env, &attached)) {
-        return 0;
-    }
-
-    auto nativeSourceBridge = reinterpret_cast<jobject>(param);
-    jint bytesRead = env->CallIntMethod(nativeSourceBridge, readMethod, (jlong) position, (jlong) size);
-
-    if (bytesRead == 0) {
-        LOGE("Cannot read from custom source");
-        if (!jniDetachCurrentThread(attached)) {
-            // ignore. we're going to return anyway on the next line
-        }
-        return 0;
-    }
-
-    auto buffer = (jbyteArray) env->GetObjectField(nativeSourceBridge, dataBuffer);
-    env->GetByteArrayRegion(buffer, 0, bytesRead, (jbyte*) outBuffer);
-    env->DeleteLocalRef(buffer); // this callback fires per block during load; refs accumulate otherwise
-
-    if (!jniDetachCurrentThread(attached)) {
-        return 0;
-    }
-    return bytesRead;
+    auto *cache = reinterpret_cast<SourceBlockCache *>(param);
+    return cache->read(position, outBuffer, size) ? 1 : 0;
 }
 
 static jlong NativeCore_nativeOpenDocument(JNIEnv *env, jobject, jint fd,
                                                            jstring password) {
+    PdfiumLock lock(sPdfiumMutex);
     auto fileLength = (size_t)getFileSize(fd);
     if(fileLength <= 0) {
         jniThrowException(env, "java/io/IOException",
@@ -406,20 +1186,53 @@ static jlong NativeCore_nativeOpenDocument(JNIEnv *env, jobject, jint fd,
     return reinterpret_cast<jlong>(docFile);
 }
 
-static jlong NativeCore_nativeOpenMemDocument(JNIEnv *env, jobject,
-                                                              jbyteArray data, jstring password) {
+// PDFium reads the trailer and cross-reference table from the end of the file before anything else, and a
+// linearized file's first page from the start; ask the kernel to fault both in up front. Everything else is left
+// to the kernel's normal readahead, which already suits the long sequential reads of image streams.
+static const size_t MAPPED_DOCUMENT_TAIL_PREFETCH = 1024 * 1024;
+static const size_t MAPPED_DOCUMENT_HEAD_PREFETCH = 64 * 1024;
+
+static void adviseMappedDocument(void *data, size_t length) {
+    auto pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t head = std::min(length, MAPPED_DOCUMENT_HEAD_PREFETCH);
+    madvise(data, head, MADV_WILLNEED);
+    if (length > head) {
+        size_t tailStart = length > MAPPED_DOCUMENT_TAIL_PREFETCH ? length - MAPPED_DOCUMENT_TAIL_PREFETCH : 0;
+        tailStart -= tailStart % pageSize; // madvise needs a page-aligned address
+        madvise(static_cast<uint8_t *>(data) + tailStart, length - tailStart, MADV_WILLNEED);
+    }
+}
+
+// Opens the document straight out of a read-only mapping of [fd] instead of a pread() per block PDFium asks
+// for. The mapping belongs to the DocumentFile, and the kernel shares its pages with every other mapping of
+// the same file. Falls back to the pread() path when the file can't be mapped.
+static jlong NativeCore_nativeOpenMappedDocument(JNIEnv *env, jobject thiz, jint fd,
+                                                 jstring password) {
+    PdfiumLock lock(sPdfiumMutex);
+    auto fileLength = (size_t)getFileSize(fd);
+    if(fileLength <= 0) {
+        jniThrowException(env, "java/io/IOException",
+                          "File is empty");
+        return -1;
+    }
+
+    void *mappedData = mmap(nullptr, fileLength, PROT_READ, MAP_SHARED, fd, 0);
+    if (mappedData == MAP_FAILED) {
+        LOGE("Cannot map file descriptor, reading it instead. Error:%d", errno);
+        return NativeCore_nativeOpenDocument(env, thiz, fd, password);
+    }
+    adviseMappedDocument(mappedData, fileLength);
+
     auto *docFile = new DocumentFile();
+    docFile->mappedData = mappedData;
+    docFile->mappedLength = fileLength;
 
     const char *cpassword = nullptr;
     if(password != nullptr) {
         cpassword = env->GetStringUTFChars(password, nullptr);
     }
 
-    int size = (int) env->GetArrayLength(data);
-    auto *cDataCopy = new jbyte[size];
-    env->GetByteArrayRegion(data, 0, size, cDataCopy);
-    FPDF_DOCUMENT document = FPDF_LoadMemDocument( reinterpret_cast<const void*>(cDataCopy),
-                                                   size, cpassword);
+    FPDF_DOCUMENT document = FPDF_LoadMemDocument64(mappedData, fileLength, cpassword);
 
     if(cpassword != nullptr) {
         env->ReleaseStringUTFChars(password, cpassword);
@@ -444,32 +1257,25 @@ static jlong NativeCore_nativeOpenMemDocument(JNIEnv *env, jobject,
     }
 
     docFile->pdfDocument = document;
-    docFile->cDataCopy = cDataCopy;
+
     return reinterpret_cast<jlong>(docFile);
 }
 
-
-static jlong NativeCore_nativeOpenCustomDocument(JNIEnv *env, jobject, jobject nativeSourceBridge, jstring password, jlong dataLength) {
-    if(dataLength <= 0) {
-        jniThrowException(env, "java/io/IOException",
-                          "File is empty");
-        return -1;
-    }
-
+static jlong NativeCore_nativeOpenMemDocument(JNIEnv *env, jobject,
+                                                              jbyteArray data, jstring password) {
+    PdfiumLock lock(sPdfiumMutex);
     auto *docFile = new DocumentFile();
-    docFile->nativeSourceBridgeGlobalRef = env->NewGlobalRef(nativeSourceBridge);
-
-    FPDF_FILEACCESS loader;
-    loader.m_FileLen = dataLength;
-    loader.m_Param = reinterpret_cast<void*>(docFile->nativeSourceBridgeGlobalRef);
-    loader.m_GetBlock = &getBlockFromCustomSource;
 
     const char *cpassword = nullptr;
     if(password != nullptr) {
         cpassword = env->GetStringUTFChars(password, nullptr);
     }
 
-    FPDF_DOCUMENT document = FPDF_LoadCustomDocument(&loader, cpassword);
+    int size = (int) env->GetArrayLength(data);
+    auto *cDataCopy = new jbyte[size];
+    env->GetByteArrayRegion(data, 0, size, cDataCopy);
+    FPDF_DOCUMENT document = FPDF_LoadMemDocument( reinterpret_cast<const void*>(cDataCopy),
+                                                   size, cpassword);
 
     if(cpassword != nullptr) {
         env->ReleaseStringUTFChars(password, cpassword);
@@ -494,20 +1300,273 @@ static jlong NativeCore_nativeOpenCustomDocument(JNIEnv *env, jobject, jobject n
     }
 
     docFile->pdfDocument = document;
-
+    docFile->cDataCopy = cDataCopy;
     return reinterpret_cast<jlong>(docFile);
 }
 
-static jlong loadPageInternal(JNIEnv *env, DocumentFile *doc, int pageIndex){
-    try{
-        if(doc == nullptr) throw std::runtime_error( "Get page document null");
+// Opens a document straight out of a direct ByteBuffer's memory, [offset, offset + length). Unlike
+// nativeOpenMemDocument nothing is copied: PDFium reads the buffer in place, and a global ref holds the buffer
+// until the document closes.
+static jlong NativeCore_nativeOpenDirectBufferDocument(JNIEnv *env, jobject, jobject buffer,
+                                                       jlong offset, jlong length, jstring password) {
+    PdfiumLock lock(sPdfiumMutex);
+    auto *address = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "Buffer is not a direct buffer");
+        return -1;
+    }
+    if (offset < 0 || length > capacity - offset) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "Document range is outside the buffer");
+        return -1;
+    }
+    if (length <= 0) {
+        jniThrowException(env, "java/io/IOException",
+                          "File is empty");
+        return -1;
+    }
 
-        FPDF_DOCUMENT pdfDoc = doc->pdfDocument;
-        if(pdfDoc != nullptr){
-            FPDF_PAGE page = FPDF_LoadPage(pdfDoc, pageIndex);
+    auto *docFile = new DocumentFile();
+    docFile->directBufferGlobalRef = env->NewGlobalRef(buffer);
+
+    const char *cpassword = nullptr;
+    if(password != nullptr) {
+        cpassword = env->GetStringUTFChars(password, nullptr);
+    }
+
+    FPDF_DOCUMENT document = FPDF_LoadMemDocument64(address + offset, (size_t) length, cpassword);
+
+    if(cpassword != nullptr) {
+        env->ReleaseStringUTFChars(password, cpassword);
+    }
+
+    if (!document) {
+        delete docFile;
+
+        const unsigned long errorNum = FPDF_GetLastError();
+        if(errorNum == FPDF_ERR_PASSWORD) {
+            jniThrowException(env, "io/legere/pdfiumandroid/api/PdfPasswordException",
+                              "Password required or incorrect password.");
+        } else {
+            char* error = getErrorDescription(errorNum);
+            jniThrowExceptionFmt(env, "java/io/IOException",
+                                 "cannot create document: %s", error);
+
+            free(error);
+        }
+
+        return -1;
+    }
+
+    docFile->pdfDocument = document;
+
+    return reinterpret_cast<jlong>(docFile);
+}
+
+static jlong NativeCore_nativeOpenCustomDocument(JNIEnv *env, jobject, jobject nativeSourceBridge, jstring password, jlong dataLength) {
+    PdfiumLock lock(sPdfiumMutex);
+    if(dataLength <= 0) {
+        jniThrowException(env, "java/io/IOException",
+                          "File is empty");
+        return -1;
+    }
+
+    auto *docFile = new DocumentFile();
+    docFile->nativeSourceBridgeGlobalRef = env->NewGlobalRef(nativeSourceBridge);
+    docFile->sourceCache = new SourceBlockCache(docFile->nativeSourceBridgeGlobalRef, (uint64_t) dataLength);
+
+    FPDF_FILEACCESS loader;
+    loader.m_FileLen = dataLength;
+    loader.m_Param = reinterpret_cast<void*>(docFile->sourceCache);
+    loader.m_GetBlock = &getBlockFromCustomSource;
+
+    const char *cpassword = nullptr;
+    if(password != nullptr) {
+        cpassword = env->GetStringUTFChars(password, nullptr);
+    }
+
+    FPDF_DOCUMENT document = FPDF_LoadCustomDocument(&loader, cpassword);
+
+    if(cpassword != nullptr) {
+        env->ReleaseStringUTFChars(password, cpassword);
+    }
+
+    if (!document) {
+        delete docFile;
+
+        const unsigned long errorNum = FPDF_GetLastError();
+        if(errorNum == FPDF_ERR_PASSWORD) {
+            jniThrowException(env, "io/legere/pdfiumandroid/api/PdfPasswordException",
+                              "Password required or incorrect password.");
+        } else {
+            char* error = getErrorDescription(errorNum);
+            jniThrowExceptionFmt(env, "java/io/IOException",
+                                 "cannot create document: %s", error);
+
+            free(error);
+        }
+
+        return -1;
+    }
+
+    docFile->pdfDocument = document;
+
+    return reinterpret_cast<jlong>(docFile);
+}
+
+static jlong NativeCore_nativeOpenAvail(JNIEnv *env, jobject, jobject nativeSourceBridge, jlong dataLength) {
+    PdfiumLock lock(sPdfiumMutex);
+    if(dataLength <= 0) {
+        jniThrowException(env, "java/io/IOException",
+                          "File is empty");
+        return -1;
+    }
+
+    auto *source = new AvailSource(env->NewGlobalRef(nativeSourceBridge), (uint64_t) dataLength);
+    source->fileAccess.m_FileLen = dataLength;
+    source->fileAccess.m_Param = reinterpret_cast<void*>(&source->cache);
+    source->fileAccess.m_GetBlock = &getBlockFromCustomSource;
+
+    source->avail = FPDFAvail_Create(source, &source->fileAccess);
+    if (source->avail == nullptr) {
+        delete source;
+        jniThrowException(env, "java/io/IOException",
+                          "cannot create availability provider");
+        return -1;
+    }
+    return reinterpret_cast<jlong>(source);
+}
+
+static jint NativeCore_nativeIsDocAvail(JNIEnv *, jobject, jlong avail_ptr) {
+    PdfiumLock lock(sPdfiumMutex);
+    auto *source = reinterpret_cast<AvailSource *>(avail_ptr);
+    return (jint) FPDFAvail_IsDocAvail(source->avail, source->hints());
+}
+
+static jint NativeCore_nativeIsLinearized(JNIEnv *, jobject, jlong avail_ptr) {
+    PdfiumLock lock(sPdfiumMutex);
+    auto *source = reinterpret_cast<AvailSource *>(avail_ptr);
+    return (jint) FPDFAvail_IsLinearized(source->avail);
+}
+
+// Opens the document once FPDFAvail_IsDocAvail reports it available. On success the DocumentFile takes over the
+// availability provider; on failure (a wrong password, say) it stays with the caller, which may try again.
+static jlong NativeCore_nativeOpenAvailDocument(JNIEnv *env, jobject, jlong avail_ptr, jstring password) {
+    PdfiumLock lock(sPdfiumMutex);
+    auto *source = reinterpret_cast<AvailSource *>(avail_ptr);
+
+    const char *cpassword = nullptr;
+    if(password != nullptr) {
+        cpassword = env->GetStringUTFChars(password, nullptr);
+    }
+
+    auto *docFile = new DocumentFile();
+    FPDF_DOCUMENT document = FPDFAvail_GetDocument(source->avail, cpassword);
+
+    if(cpassword != nullptr) {
+        env->ReleaseStringUTFChars(password, cpassword);
+    }
+
+    if (!document) {
+        delete docFile;
+
+        const unsigned long errorNum = FPDF_GetLastError();
+        if(errorNum == FPDF_ERR_PASSWORD) {
+            jniThrowException(env, "io/legere/pdfiumandroid/api/PdfPasswordException",
+                              "Password required or incorrect password.");
+        } else {
+            char* error = getErrorDescription(errorNum);
+            jniThrowExceptionFmt(env, "java/io/IOException",
+                                 "cannot create document: %s", error);
+
+            free(error);
+        }
+
+        return -1;
+    }
+
+    docFile->pdfDocument = document;
+    docFile->availSource = source;
+
+    return reinterpret_cast<jlong>(docFile);
+}
+
+static void NativeCore_nativeCloseAvail(JNIEnv *, jobject, jlong avail_ptr) {
+    PdfiumLock lock(sPdfiumMutex);
+    delete reinterpret_cast<AvailSource *>(avail_ptr);
+}
+
+static void NativeCore_nativeSetTileCacheBudget(JNIEnv *, jobject, jlong budget_bytes) {
+    const std::lock_guard<std::mutex> lock(sTileCache.lock);
+    sTileCache.setBudget(budget_bytes > 0 ? (size_t) budget_bytes : 0);
+}
+
+static jlongArray NativeCore_nativeGetTileCacheStats(JNIEnv *env, jobject) {
+    jlong stats[TileCache::STATS_LEN];
+    {
+        const std::lock_guard<std::mutex> lock(sTileCache.lock);
+        sTileCache.getStats(stats);
+    }
+    jlongArray result = env->NewLongArray(TileCache::STATS_LEN);
+    if (result == nullptr) return nullptr;
+    env->SetLongArrayRegion(result, 0, TileCache::STATS_LEN, stats);
+    return result;
+}
+
+static void NativeCore_nativeSetRgb565Dither(JNIEnv *, jobject, jboolean dither) {
+    sDitherRgb565.store(dither);
+}
+
+static void NativeCore_nativeSetLimitedImageCache(JNIEnv *, jobject, jboolean limited) {
+    sLimitedImageCache.store(limited);
+}
+
+static void NativeCore_nativeSetLibraryLifetime(JNIEnv *, jobject, jint lifetime, jlong idle_timeout_millis) {
+    const std::lock_guard<std::mutex> lock(sLibraryLock);
+    sLibraryLifetime = lifetime;
+    sLibraryIdleTimeout = std::chrono::milliseconds(idle_timeout_millis > 0 ? idle_timeout_millis : 0);
+    if (sLibraryLifetime != LIBRARY_REFERENCE_COUNTED) {
+        sLibraryIdlePending = false;
+        sLibraryIdleCondition.notify_all();
+    }
+}
+
+// Initializes the library ahead of the first document, so that opening it does not pay for it. Under a reference
+// counted lifetime the idle timeout starts now.
+static void NativeCore_nativeInitLibrary(JNIEnv *, jobject) {
+    PdfiumLock pdfiumLock(sPdfiumMutex);
+    const std::lock_guard<std::mutex> lock(sLibraryLock);
+    initLibraryLocked();
+    releaseLibraryLocked();
+}
+
+static jboolean NativeCore_nativeDestroyLibrary(JNIEnv *, jobject) {
+    PdfiumLock pdfiumLock(sPdfiumMutex);
+    const std::lock_guard<std::mutex> lock(sLibraryLock);
+    if (sLibraryReferenceCount > 0) return JNI_FALSE;
+    destroyLibraryLocked();
+    return JNI_TRUE;
+}
+
+static void NativeCore_nativeClearTileCache(JNIEnv *, jobject, jboolean reset_stats) {
+    const std::lock_guard<std::mutex> lock(sTileCache.lock);
+    sTileCache.clear();
+    if (reset_stats) sTileCache.resetStats();
+}
+
+static jlong loadPageInternal(JNIEnv *env, DocumentFile *doc, int pageIndex){
+    try{
+        if(doc == nullptr) throw std::runtime_error( "Get page document null");
+
+        FPDF_DOCUMENT pdfDoc = doc->pdfDocument;
+        if(pdfDoc != nullptr){
+            FPDF_PAGE page = FPDF_LoadPage(pdfDoc, pageIndex);
             if (page == nullptr) {
                 throw std::runtime_error("Loaded page is null");
             }
+            doc->onPageLoaded(page, pageIndex);
             return reinterpret_cast<jlong>(page);
         }else{
             throw std::runtime_error("Get page pdf document null");
@@ -524,9 +1583,54 @@ static jlong loadPageInternal(JNIEnv *env, DocumentFile *doc, int pageIndex){
 }
 
 static void closePageInternal(jlong pagePtr) {
-    FPDF_ClosePage(reinterpret_cast<FPDF_PAGE>(pagePtr));
+    auto page = reinterpret_cast<FPDF_PAGE>(pagePtr);
+    DocumentFile *doc = documentForPage(page);
+    if (doc != nullptr) doc->onPageClosing(page);
+    FPDF_ClosePage(page);
+}
+
+// Whether [page] is still open. Only meaningful under the PDFium lock, which closing a page also takes.
+static bool pageIsOpen(FPDF_PAGE page) {
+    return page != nullptr && documentForPage(page) != nullptr;
+}
+
+// Whether [page] is still the load [generation] names, from pageGeneration before the PDFium lock was let go. The
+// render natives take the lock only around their FPDF_* calls, so a page handed to them may have been closed by
+// another thread before they get it, and another page loaded at the same address; neither matches. Only
+// meaningful under the PDFium lock.
+static bool pageIsOpen(FPDF_PAGE page, uint64_t generation) {
+    return generation != 0 && pageGeneration(page) == generation;
 }
 
+// The pages, matrices and clips of a multi-page render, copied out of the Java arrays before the PDFium lock is
+// taken. [count] is clamped so mismatched-length matrices or clips can't drive reads past their ends.
+struct PageBatch {
+    std::vector<jlong> pages;
+    std::vector<jfloat> matrices;
+    std::vector<jfloat> clips;
+    std::vector<uint64_t> generations;
+    int count;
+
+    PageBatch(JNIEnv *env, jlongArray pageArray, jfloatArray matrixArray, jfloatArray clipArray)
+            : pages(env->GetArrayLength(pageArray)), matrices(env->GetArrayLength(matrixArray)),
+              clips(env->GetArrayLength(clipArray)) {
+        env->GetLongArrayRegion(pageArray, 0, (jsize) pages.size(), pages.data());
+        env->GetFloatArrayRegion(matrixArray, 0, (jsize) matrices.size(), matrices.data());
+        env->GetFloatArrayRegion(clipArray, 0, (jsize) clips.size(), clips.data());
+        count = (int) std::min({pages.size(), matrices.size() / MATRIX_VALUES_LEN, clips.size() / RECT_VALUES_LEN});
+        generations.reserve(pages.size());
+        for (jlong page : pages) generations.push_back(pageGeneration(reinterpret_cast<FPDF_PAGE>(page)));
+    }
+
+    // Zeroes the pages closed since the batch was built; every render helper skips a 0 page. Call under the
+    // PDFium lock.
+    void dropClosedPages() {
+        for (int i = 0; i < count; ++i) {
+            if (!pageIsOpen(reinterpret_cast<FPDF_PAGE>(pages[i]), generations[i])) pages[i] = 0;
+        }
+    }
+};
+
 // The coverage-aware canvas/render helpers are defined once (further down) and shared by every render path,
 // including the ones above their definition — hence these forward declarations.
 static void fillCanvasBorder(FPDF_BITMAP bitmap, int bufW, int bufH, FS_RECTF cover, int canvasColor);
@@ -535,7 +1639,10 @@ static void fillCanvasGaps(FPDF_BITMAP bitmap, int bufW, int bufH, JNIEnv *env,
                            int canvasColor);
 static void fillAndRenderPage(FPDF_BITMAP bitmap, int bufW, int bufH, FPDF_PAGE page,
                               FS_RECTF clip, const FS_MATRIX &matrix, int pageBackgroundColor,
-                              int flags);
+                              int flags, FPDF_FORMHANDLE form);
+static void fillAndRenderPageCached(FPDF_BITMAP bitmap, int bufW, int bufH, FPDF_PAGE page,
+                                    FS_RECTF clip, const FS_MATRIX &matrix, int pageBackgroundColor,
+                                    int flags, FPDF_FORMHANDLE form);
 
 static void renderPageInternal( FPDF_PAGE page,
                                 ANativeWindow_Buffer *windowBuffer,
@@ -559,7 +1666,7 @@ static void renderPageInternal( FPDF_PAGE page,
     int baseVerSize = (canvasVerSize < drawSizeVer)? canvasVerSize : drawSizeVer;
     int baseX = (startX < 0)? 0 : startX;
     int baseY = (startY < 0)? 0 : startY;
-    int flags = FPDF_REVERSE_BYTE_ORDER;
+    int flags = baseRenderFlags();
     if (startX + baseHorSize > drawSizeHor) {
         baseHorSize = drawSizeHor - startX;
     }
@@ -586,6 +1693,13 @@ static void renderPageInternal( FPDF_PAGE page,
                            startX, startY,
                            drawSizeHor, drawSizeVer,
                            0, flags );
+
+    if (renderAnnot) {
+        FPDF_FORMHANDLE form = formForPage(page);
+        if (form != nullptr) {
+            FPDF_FFLDraw(form, pdfBitmap, page, startX, startY, drawSizeHor, drawSizeVer, 0, flags);
+        }
+    }
 }
 
 jfloatArray matrixToFloatArray(JNIEnv *env, const FS_MATRIX &fsMatrix) {
@@ -722,7 +1836,7 @@ static void errorRect(float *rect) {
 }
 
 template <typename T, typename Func>
-T runSafe(JNIEnv *env, T errorValue, Func func) {
+T runSafeUnlocked(JNIEnv *env, T errorValue, Func func) {
     try {
         return func();
     } catch (std::bad_alloc &e) {
@@ -741,7 +1855,7 @@ T runSafe(JNIEnv *env, T errorValue, Func func) {
 }
 
 template <typename Func>
-void runSafe(JNIEnv *env, Func func) {
+void runSafeUnlocked(JNIEnv *env, Func func) {
     try {
         func();
     } catch (std::bad_alloc &e) {
@@ -758,6 +1872,18 @@ void runSafe(JNIEnv *env, Func func) {
     }
 }
 
+template <typename T, typename Func>
+T runSafe(JNIEnv *env, T errorValue, Func func) {
+    PdfiumLock lock(sPdfiumMutex);
+    return runSafeUnlocked(env, errorValue, func);
+}
+
+template <typename Func>
+void runSafe(JNIEnv *env, Func func) {
+    PdfiumLock lock(sPdfiumMutex);
+    runSafeUnlocked(env, func);
+}
+
 static jint NativeDocument_nativeGetPageCount(JNIEnv *env, jobject,
                                                             jlong doc_ptr) {
     return runSafe(env, -1, [&]() {
@@ -788,6 +1914,21 @@ static void NativeDocument_nativeDeletePage(JNIEnv *env, jobject, jlong doc_ptr,
         FPDF_DOCUMENT pdfDoc = doc->pdfDocument;
         if(pdfDoc != nullptr) {
             FPDFPage_Delete(pdfDoc, (int) page_index);
+            // Every later page moves down one index, so neither the cached tiles nor the registry's indexes
+            // of this document's open pages hold any more.
+            {
+                const std::lock_guard<std::mutex> lock(sTileCache.lock);
+                sTileCache.invalidate(doc);
+            }
+            const std::lock_guard<std::mutex> lock(sPageDocumentsLock);
+            for (auto &entry : sPageDocuments) {
+                if (entry.second.doc != doc) continue;
+                if (entry.second.pageIndex == page_index) {
+                    entry.second.pageIndex = -1;
+                } else if (entry.second.pageIndex > page_index) {
+                    entry.second.pageIndex--;
+                }
+            }
         }
     });
 }
@@ -802,6 +1943,23 @@ static void NativeDocument_nativeCloseDocument(JNIEnv *env, jobject,
 
 }
 
+// Whether a streaming document holds everything [page_index] needs; if not, PDFium's download hints for it go to
+// the source. Documents opened any other way are always available.
+static jint NativeDocument_nativeIsPageAvail(JNIEnv *env, jobject, jlong doc_ptr, jint page_index) {
+    return runSafe(env, (jint) PDF_DATA_ERROR, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        if (doc->availSource == nullptr) return (jint) PDF_DATA_AVAIL;
+        return (jint) FPDFAvail_IsPageAvail(doc->availSource->avail, (int) page_index, doc->availSource->hints());
+    });
+}
+
+static jint NativeDocument_nativeGetFirstAvailPage(JNIEnv *env, jobject, jlong doc_ptr) {
+    return runSafe(env, (jint) 0, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        return (jint) FPDFAvail_GetFirstPageNum(doc->pdfDocument);
+    });
+}
+
 static jlongArray NativeDocument_nativeLoadPages(JNIEnv *env, jobject, jlong doc_ptr,
                                                          jint from_index, jint to_index) {
     return runSafe(env, (jlongArray) nullptr, [&]() {
@@ -822,6 +1980,130 @@ static jlongArray NativeDocument_nativeLoadPages(JNIEnv *env, jobject, jlong doc
     });
 }
 
+// Transcodes [n] UTF-16 code units to UTF-8 into [dst], which must have room for 3 bytes per unit, and returns
+// the bytes written. Runs of ASCII, most of a typical page, are narrowed 8 units at a time; unpaired surrogates
+// become U+FFFD.
+static size_t utf16ToUtf8(const uint16_t *src, size_t n, uint8_t *dst) {
+    uint8_t *out = dst;
+    size_t i = 0;
+    while (i < n) {
+#if defined(__ARM_NEON)
+        while (i + 8 <= n) {
+            uint16x8_t units = vld1q_u16(src + i);
+            uint8x8_t nonAscii = vmovn_u16(vcgtq_u16(units, vdupq_n_u16(0x7F)));
+            if (vget_lane_u64(vreinterpret_u64_u8(nonAscii), 0) != 0) break;
+            vst1_u8(out, vmovn_u16(units));
+            out += 8;
+            i += 8;
+        }
+#elif defined(__SSE2__)
+        const __m128i highBits = _mm_set1_epi16((short) 0xFF80);
+        while (i + 8 <= n) {
+            __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, highBits), _mm_setzero_si128())) != 0xFFFF) {
+                break;
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(units, units));
+            out += 8;
+            i += 8;
+        }
+#endif
+        if (i == n) break;
+        // One unit, or a surrogate pair, at a time until the next ASCII run.
+        do {
+            uint32_t c = src[i++];
+            if (c < 0x80) {
+                *out++ = (uint8_t) c;
+                continue;
+            }
+            if (c >= 0xD800 && c <= 0xDBFF && i < n && src[i] >= 0xDC00 && src[i] <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (src[i++] - 0xDC00);
+            } else if (c >= 0xD800 && c <= 0xDFFF) {
+                c = 0xFFFD;
+            }
+            if (c < 0x800) {
+                *out++ = (uint8_t) (0xC0 | (c >> 6));
+            } else if (c < 0x10000) {
+                *out++ = (uint8_t) (0xE0 | (c >> 12));
+                *out++ = (uint8_t) (0x80 | ((c >> 6) & 0x3F));
+            } else {
+                *out++ = (uint8_t) (0xF0 | (c >> 18));
+                *out++ = (uint8_t) (0x80 | ((c >> 12) & 0x3F));
+                *out++ = (uint8_t) (0x80 | ((c >> 6) & 0x3F));
+            }
+            *out++ = (uint8_t) (0x80 | (c & 0x3F));
+        } while (i < n && src[i] >= 0x80);
+    }
+    return out - dst;
+}
+
+// The text extraction's scratch buffers, guarded by the PDFium lock it runs under. They are kept between calls,
+// but freed once a long page has grown one past EXTRACT_KEPT_SCRATCH_BYTES.
+static std::vector<uint16_t> sExtractUnits;
+static std::vector<uint8_t> sExtractTranscoded;
+static const size_t EXTRACT_KEPT_SCRATCH_BYTES = 256 * 1024;
+
+// Streams the text of pages [first_page, first_page + page_count) into a direct buffer from byte [position],
+// as UTF-8 or as little-endian UTF-16, loading and closing each page and its text page here rather than in a
+// JNI round trip per step. The end offset of each page's text is written to [page_ends] from [page_ends_offset].
+// Returns how many pages were written, fewer than asked for if the next one does not fit in the buffer, or -1
+// on error; a page that fails to load is written as empty. Callers wanting to let other threads in between
+// pages ask for a few pages at a time.
+static jint NativeDocument_nativeExtractText(JNIEnv *env, jobject, jlong doc_ptr, jint first_page, jint page_count,
+                                             jobject buffer, jint position, jboolean utf8, jintArray page_ends,
+                                             jint page_ends_offset) {
+    return runSafe(env, -1, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        auto *base = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (doc == nullptr || base == nullptr || position < 0 || position > capacity || page_count < 0 ||
+            page_ends_offset < 0 || env->GetArrayLength(page_ends) - page_ends_offset < page_count) {
+            return -1;
+        }
+
+        std::vector<uint16_t> &units = sExtractUnits;
+        std::vector<uint8_t> &transcoded = sExtractTranscoded;
+        std::vector<jint> ends;
+        ends.reserve(page_count);
+        size_t offset = position;
+        for (int i = 0; i < page_count; i++) {
+            size_t length = 0;
+            FPDF_PAGE page = FPDF_LoadPage(doc->pdfDocument, first_page + i);
+            FPDF_TEXTPAGE textPage = page == nullptr ? nullptr : FPDFText_LoadPage(page);
+            if (textPage != nullptr) {
+                int count = std::max(FPDFText_CountChars(textPage), 0);
+                if (units.size() < (size_t) count + 1) units.resize(count + 1);
+                // The count written includes the terminating NUL.
+                length = (size_t) std::max(FPDFText_GetText(textPage, 0, count, units.data()) - 1, 0);
+                FPDFText_ClosePage(textPage);
+            }
+            if (page != nullptr) FPDF_ClosePage(page);
+
+            size_t room = (size_t) capacity - offset;
+            if (!utf8) {
+                if (length * 2 > room) break;
+                memcpy(base + offset, units.data(), length * 2);
+                offset += length * 2;
+            } else if (length * 3 <= room) {
+                offset += utf16ToUtf8(units.data(), length, base + offset);
+            } else {
+                if (transcoded.size() < length * 3) transcoded.resize(length * 3);
+                size_t bytes = utf16ToUtf8(units.data(), length, transcoded.data());
+                if (bytes > room) break;
+                memcpy(base + offset, transcoded.data(), bytes);
+                offset += bytes;
+            }
+            ends.push_back((jint) offset);
+        }
+
+        if (units.size() * 2 > EXTRACT_KEPT_SCRATCH_BYTES) std::vector<uint16_t>().swap(units);
+        if (transcoded.size() > EXTRACT_KEPT_SCRATCH_BYTES) std::vector<uint8_t>().swap(transcoded);
+
+        if (!ends.empty()) env->SetIntArrayRegion(page_ends, page_ends_offset, (jsize) ends.size(), ends.data());
+        return (jint) ends.size();
+    });
+}
+
 static jstring NativeDocument_nativeGetDocumentMetaText(JNIEnv *env, jobject,
                                                                    jlong doc_ptr, jstring tag) {
     return runSafe(env, (jstring) nullptr, [&]() {
@@ -1129,7 +2411,7 @@ static jboolean NativePage_nativeRenderPage(JNIEnv *env, jclass, jlong page_ptr,
     return runSafe(env, (jboolean) false, [&]() {
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
 
-        if (page == nullptr) {
+        if (!pageIsOpen(page)) {
             LOGE("Render page pointers invalid");
             return (jboolean) false;
         }
@@ -1153,10 +2435,11 @@ static jboolean NativePage_nativeRenderPageWithMatrix(JNIEnv *env, jclass,
                                                                 jboolean render_annot,
                                                                 jboolean,
                                                                 jint canvasColor, jint pageBackgroundColor) {
-    return runSafe(env, (jboolean) false, [&]() {
+    return runSafeUnlocked(env, (jboolean) false, [&]() {
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        uint64_t generation = pageGeneration(page);
 
-        if (page == nullptr) {
+        if (generation == 0) {
             LOGE("Render page pointers invalid");
             return (jboolean) false;
         }
@@ -1164,27 +2447,31 @@ static jboolean NativePage_nativeRenderPageWithMatrix(JNIEnv *env, jclass,
         auto bufferPtr = reinterpret_cast<ANativeWindow_Buffer*>(buffer_ptr);
         auto buffer = *bufferPtr;
 
-
-        auto clipRectFloats = env->GetFloatArrayElements(clipRect, nullptr);
+        jfloat clipRectFloats[RECT_VALUES_LEN];
+        env->GetFloatArrayRegion(clipRect, 0, RECT_VALUES_LEN, clipRectFloats);
+        auto clip = floatArrayToRect(env, clipRectFloats, 0);
+        auto matrix = floatArrayToMatrix(env, matrixValues);
 
         int bufW = draw_size_hor;
         int bufH = draw_size_ver;
+        int flags = baseRenderFlags();
+        if (render_annot) {
+            flags |= FPDF_ANNOT;
+        }
+
+        PdfiumLock lock(sPdfiumMutex);
+        if (!pageIsOpen(page, generation)) {
+            LOGE("Render page closed");
+            return (jboolean) false;
+        }
         ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA,
                                                     buffer.bits, (int) (buffer.stride) * 4));
 
         // Coverage-aware fill + render (shared helpers): gray only in the gaps the page's footprint (the clip)
         // doesn't cover, then the footprint filled white and rendered on top — no pixel written twice.
         fillCanvasGaps(pdfBitmap, bufW, bufH, env, clipRectFloats, 1, &page_ptr, canvasColor);
-
-        int flags = FPDF_REVERSE_BYTE_ORDER;
-        if (render_annot) {
-            flags |= FPDF_ANNOT;
-        }
-        auto clip = floatArrayToRect(env, clipRectFloats, 0);
-        auto matrix = floatArrayToMatrix(env, matrixValues);
-        fillAndRenderPage(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags);
-
-        env->ReleaseFloatArrayElements(clipRect, (jfloat *) clipRectFloats, JNI_ABORT);
+        fillAndRenderPageCached(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags,
+                              render_annot ? formForPage(page) : nullptr);
 
         return (jboolean) true;
     });
@@ -1194,10 +2481,11 @@ static jboolean NativePage_nativeRenderPageSurface(JNIEnv *env, jclass, jlong pa
                                                       jobject surface, jint start_x,
                                                       jint start_y, jboolean render_annot,
                                                       jint canvasColor, jint pageBackgroundColor) {
-    return runSafe(env, (jboolean) false, [&]() {
+    return runSafeUnlocked(env, (jboolean) false, [&]() {
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        uint64_t generation = pageGeneration(page);
 
-        if (page == nullptr) {
+        if (generation == 0) {
             LOGE("Render page pointers invalid");
             return (jboolean) false;
         }
@@ -1225,15 +2513,27 @@ static jboolean NativePage_nativeRenderPageSurface(JNIEnv *env, jclass, jlong pa
             return (jboolean) false;
         }
 
-        renderPageInternal(page, &buffer,
-                           (int) start_x, (int) start_y,
-                           width, height,
-                           (int) width, (int) height,
-                           (bool) render_annot, canvasColor, pageBackgroundColor);
+        bool rendered;
+        {
+            PdfiumLock lock(sPdfiumMutex);
+            rendered = pageIsOpen(page, generation);
+            if (rendered) {
+                renderPageInternal(page, &buffer,
+                                   (int) start_x, (int) start_y,
+                                   width, height,
+                                   (int) width, (int) height,
+                                   (bool) render_annot, canvasColor, pageBackgroundColor);
+            } else {
+                // Closed while the window was being locked: post just the canvas, not whatever the buffer held.
+                ScopedBitmap canvas(FPDFBitmap_CreateEx(buffer.width, buffer.height, FPDFBitmap_BGRA,
+                                                        buffer.bits, (int) (buffer.stride) * 4));
+                fillCanvasBorder(canvas, buffer.width, buffer.height, FS_RECTF{0, 0, 0, 0}, canvasColor);
+            }
+        }
         ANativeWindow_unlockAndPost(nativeWindow);
         ANativeWindow_release(nativeWindow);
 
-        return (jboolean) true;
+        return (jboolean) rendered;
     });
 }
 
@@ -1244,14 +2544,24 @@ static jboolean NativePage_nativeRenderPageSurfaceWithMatrix(JNIEnv *env, jclass
                                                                 jboolean render_annot,
                                                                 jboolean,
                                                                 jint canvasColor, jint pageBackgroundColor) {
-    return runSafe(env, (jboolean) false, [&]() {
+    return runSafeUnlocked(env, (jboolean) false, [&]() {
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        uint64_t generation = pageGeneration(page);
 
-        if (page == nullptr) {
+        if (generation == 0) {
             LOGE("Render page pointers invalid");
             return (jboolean) false;
         }
 
+        jfloat clipRectFloats[RECT_VALUES_LEN];
+        env->GetFloatArrayRegion(clipRect, 0, RECT_VALUES_LEN, clipRectFloats);
+        auto clip = floatArrayToRect(env, clipRectFloats, 0);
+        auto matrix = floatArrayToMatrix(env, matrixValues);
+        int flags = baseRenderFlags();
+        if (render_annot) {
+            flags |= FPDF_ANNOT;
+        }
+
         ANativeWindow *nativeWindow = ANativeWindow_fromSurface(env, surface);
         if (nativeWindow == nullptr) {
             LOGE("native window pointer null");
@@ -1281,31 +2591,30 @@ static jboolean NativePage_nativeRenderPageSurfaceWithMatrix(JNIEnv *env, jclass
         // window yet (same reasoning as the multi-page paths).
         int bufW = buffer.width;
         int bufH = buffer.height;
-        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA,
-                                                    buffer.bits, (int) (buffer.stride) * 4));
-
-        auto clipRectFloats = env->GetFloatArrayElements(clipRect, nullptr);
-
-        // ONE page, but the SAME coverage-aware fill + render as the multi-page paths. [clipRect] is the page's
-        // device footprint: fillCanvasGaps paints canvasColor only in the GAPS the footprint doesn't cover (all
-        // four strips — so a page narrower than the surface gets gray on the sides, not just top/bottom), and
-        // fillAndRenderPage fills the footprint with pageBackgroundColor and renders on top. No pixel is written
-        // twice, and the tangled per-axis base-size math is gone.
-        fillCanvasGaps(pdfBitmap, bufW, bufH, env, clipRectFloats, 1, &page_ptr, canvasColor);
-
-        int flags = FPDF_REVERSE_BYTE_ORDER;
-        if (render_annot) {
-            flags |= FPDF_ANNOT;
+        jlong pagePtr;
+        {
+            PdfiumLock lock(sPdfiumMutex);
+            // A page closed while the window was being locked leaves just the canvas.
+            pagePtr = pageIsOpen(page, generation) ? page_ptr : 0;
+            ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA,
+                                                        buffer.bits, (int) (buffer.stride) * 4));
+
+            // ONE page, but the SAME coverage-aware fill + render as the multi-page paths. [clipRect] is the page's
+            // device footprint: fillCanvasGaps paints canvasColor only in the GAPS the footprint doesn't cover (all
+            // four strips — so a page narrower than the surface gets gray on the sides, not just top/bottom), and
+            // fillAndRenderPage fills the footprint with pageBackgroundColor and renders on top. No pixel is
+            // written twice, and the tangled per-axis base-size math is gone.
+            fillCanvasGaps(pdfBitmap, bufW, bufH, env, clipRectFloats, 1, &pagePtr, canvasColor);
+            if (pagePtr != 0) {
+                fillAndRenderPageCached(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags,
+                                        render_annot ? formForPage(page) : nullptr);
+            }
         }
-        auto clip = floatArrayToRect(env, clipRectFloats, 0);
-        auto matrix = floatArrayToMatrix(env, matrixValues);
-        fillAndRenderPage(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags);
 
-        env->ReleaseFloatArrayElements(clipRect, (jfloat *) clipRectFloats, JNI_ABORT);
         ANativeWindow_unlockAndPost(nativeWindow);
         ANativeWindow_release(nativeWindow);
 
-        return (jboolean) true;
+        return (jboolean) (pagePtr != 0);
     });
 }
 
@@ -1360,11 +2669,42 @@ static void fillCanvasGaps(FPDF_BITMAP bitmap, int bufW, int bufH, JNIEnv *env,
     fillCanvasBorder(bitmap, bufW, bufH, FS_RECTF{uL, uT, uR, uB}, canvasColor);
 }
 
+// Draw [page]'s form fields over a page already rendered with [matrix], clipped to [clip] (already clamped to
+// the bitmap). FPDF_FFLDraw only takes a device rect, so this handles the axis-aligned scale + translate
+// matrices the viewer renders with — the page rect is then (e, f, a * width, d * height) — and skips the form
+// layer for a rotating or skewing matrix. The clip is honoured by drawing into a bitmap that views just that
+// region of the target's pixels.
+static void drawFormFields(FPDF_FORMHANDLE form, FPDF_BITMAP bitmap, FPDF_PAGE page, FS_RECTF clip,
+                           const FS_MATRIX &matrix, int flags) {
+    if (matrix.b != 0 || matrix.c != 0 || matrix.a <= 0 || matrix.d <= 0) return;
+    int left = (int) floor(clip.left);
+    int top = (int) floor(clip.top);
+    int right = (int) ceil(clip.right);
+    int bottom = (int) ceil(clip.bottom);
+    if (left >= right || top >= bottom) return;
+
+    int format = FPDFBitmap_GetFormat(bitmap);
+    int bytesPerPixel = format == FPDFBitmap_BGR ? 3 : 4;
+    int stride = FPDFBitmap_GetStride(bitmap);
+    auto *origin = static_cast<uint8_t *>(FPDFBitmap_GetBuffer(bitmap)) + top * stride + left * bytesPerPixel;
+    ScopedBitmap view(FPDFBitmap_CreateEx(right - left, bottom - top, format, origin, stride));
+    if (view == nullptr) return;
+
+    // Same page box FPDF_RenderPageBitmapWithMatrix maps the matrix from.
+    auto pageWidth = (float) (int) FPDF_GetPageWidthF(page);
+    auto pageHeight = (float) (int) FPDF_GetPageHeightF(page);
+    FPDF_FFLDraw(form, view, page,
+                 (int) lround(matrix.e) - left, (int) lround(matrix.f) - top,
+                 (int) lround(matrix.a * pageWidth), (int) lround(matrix.d * pageHeight),
+                 0, flags);
+}
+
 // Clamp a page clip to the bitmap, fill its background white to the CLIP extent (not the buffer edge),
-// and render the page. Shared by the multi-page paths so the fill geometry is identical.
+// and render the page, then its form fields when [form] isn't null. Shared by the multi-page paths so the
+// fill geometry is identical.
 static void fillAndRenderPage(FPDF_BITMAP bitmap, int bufW, int bufH, FPDF_PAGE page,
                               FS_RECTF clip, const FS_MATRIX &matrix, int pageBackgroundColor,
-                              int flags) {
+                              int flags, FPDF_FORMHANDLE form) {
     if (clip.left < 0) clip.left = 0;
     if (clip.top < 0) clip.top = 0;
     if (clip.right > (float) bufW) clip.right = (float) bufW;
@@ -1378,6 +2718,117 @@ static void fillAndRenderPage(FPDF_BITMAP bitmap, int bufW, int bufH, FPDF_PAGE
         FPDFBitmap_FillRect(bitmap, baseX, baseY, baseWidth, baseHeight, pageBackgroundColor);
     }
     FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip, flags);
+    if (form != nullptr) {
+        drawFormFields(form, bitmap, page, clip, matrix, flags);
+    }
+}
+
+// Renders one tile of [page] at the (quantized) scale of [key] into [tile]'s block: the page background, the page
+// shifted so the tile's corner is at the origin, then the form fields.
+static bool renderTile(TileCache::Tile *tile, FPDF_PAGE page, const TileCache::Key &key, FPDF_FORMHANDLE form) {
+    ScopedBitmap bitmap(FPDFBitmap_CreateEx(tile->width, tile->height, FPDFBitmap_BGRA, tile->pixels,
+                                            TileCache::TILE_SIZE * 4));
+    if (bitmap == nullptr) return false;
+    FPDFBitmap_FillRect(bitmap, 0, 0, tile->width, tile->height, key.backgroundColor);
+    FS_MATRIX matrix{(float) (key.scaleX / TileCache::SCALE_STEPS), 0, 0,
+                     (float) (key.scaleY / TileCache::SCALE_STEPS),
+                     (float) -(key.tileX * TileCache::TILE_SIZE), (float) -(key.tileY * TileCache::TILE_SIZE)};
+    FS_RECTF clip{0, 0, (float) tile->width, (float) tile->height};
+    FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip, key.flags);
+    if (form != nullptr) {
+        drawFormFields(form, bitmap, page, clip, matrix, key.flags);
+    }
+    return true;
+}
+
+// fillAndRenderPage through the tile cache: the part of the page inside [clip] is assembled from cached tiles,
+// and only the tiles not in the cache are rasterized. Pages the cache can't key - a rotating or skewing matrix,
+// a page the registry doesn't know, a bitmap that isn't 32-bit, or the cache switched off - render directly, as
+// do pages with a background that isn't opaque: tiles are copied over the target rather than blended, so a
+// see-through tile would wipe out the canvas under the page.
+// The page lands on whole device pixels, so it may sit up to half a pixel from where [matrix] puts it.
+static void fillAndRenderPageCached(FPDF_BITMAP bitmap, int bufW, int bufH, FPDF_PAGE page,
+                                    FS_RECTF clip, const FS_MATRIX &matrix, int pageBackgroundColor,
+                                    int flags, FPDF_FORMHANDLE form) {
+    const std::lock_guard<std::mutex> cacheLock(sTileCache.lock);
+    PageEntry entry{};
+    int scaleX = (int) lround(matrix.a * TileCache::SCALE_STEPS);
+    int scaleY = (int) lround(matrix.d * TileCache::SCALE_STEPS);
+    int format = FPDFBitmap_GetFormat(bitmap);
+    if (!sTileCache.enabled() || ((uint32_t) pageBackgroundColor >> 24) != 0xFF ||
+        matrix.b != 0 || matrix.c != 0 || scaleX <= 0 || scaleY <= 0 ||
+        (format != FPDFBitmap_BGRA && format != FPDFBitmap_BGRx) ||
+        !pageEntryFor(page, &entry) || entry.pageIndex < 0) {
+        fillAndRenderPage(bitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags, form);
+        return;
+    }
+
+    if (clip.left < 0) clip.left = 0;
+    if (clip.top < 0) clip.top = 0;
+    if (clip.right > (float) bufW) clip.right = (float) bufW;
+    if (clip.bottom > (float) bufH) clip.bottom = (float) bufH;
+    if (clip.left >= clip.right || clip.top >= clip.bottom) return;
+    int clipLeft = (int) floor(clip.left);
+    int clipTop = (int) floor(clip.top);
+    int clipRight = (int) ceil(clip.right);
+    int clipBottom = (int) ceil(clip.bottom);
+
+    // The page as rendered at the quantized scale, placed at a whole-pixel origin; same page box as drawFormFields.
+    int originX = (int) lround(matrix.e);
+    int originY = (int) lround(matrix.f);
+    auto pageWidth = (double) (int) FPDF_GetPageWidthF(page);
+    auto pageHeight = (double) (int) FPDF_GetPageHeightF(page);
+    int imageWidth = (int) ceil(scaleX / TileCache::SCALE_STEPS * pageWidth);
+    int imageHeight = (int) ceil(scaleY / TileCache::SCALE_STEPS * pageHeight);
+
+    // The visible part of the page image, in image coordinates.
+    int visibleLeft = std::max(0, clipLeft - originX);
+    int visibleTop = std::max(0, clipTop - originY);
+    int visibleRight = std::min(imageWidth, clipRight - originX);
+    int visibleBottom = std::min(imageHeight, clipBottom - originY);
+    if (visibleLeft >= visibleRight || visibleTop >= visibleBottom) return;
+
+    auto *target = static_cast<uint8_t *>(FPDFBitmap_GetBuffer(bitmap));
+    int targetStride = FPDFBitmap_GetStride(bitmap);
+    constexpr int tileSize = TileCache::TILE_SIZE;
+    for (int tileY = visibleTop / tileSize; tileY <= (visibleBottom - 1) / tileSize; ++tileY) {
+        for (int tileX = visibleLeft / tileSize; tileX <= (visibleRight - 1) / tileSize; ++tileX) {
+            TileCache::Key key{entry.doc, entry.pageIndex, scaleX, scaleY, tileX, tileY, flags,
+                               pageBackgroundColor};
+            int tileLeft = tileX * tileSize;
+            int tileTop = tileY * tileSize;
+            TileCache::Tile *tile = sTileCache.find(key);
+            if (tile == nullptr) {
+                tile = sTileCache.insert(key, std::min(tileSize, imageWidth - tileLeft),
+                                         std::min(tileSize, imageHeight - tileTop));
+                if (tile != nullptr && !renderTile(tile, page, key, form)) {
+                    sTileCache.remove(tile);
+                    tile = nullptr;
+                }
+                if (tile == nullptr) {
+                    // No block for it: render this tile's part of the page the direct way.
+                    FS_RECTF tileClip{(float) std::max(clipLeft, originX + tileLeft),
+                                      (float) std::max(clipTop, originY + tileTop),
+                                      (float) std::min(clipRight, originX + tileLeft + tileSize),
+                                      (float) std::min(clipBottom, originY + tileTop + tileSize)};
+                    fillAndRenderPage(bitmap, bufW, bufH, page, tileClip, matrix, pageBackgroundColor, flags,
+                                      form);
+                    continue;
+                }
+            }
+
+            int left = std::max(visibleLeft, tileLeft);
+            int top = std::max(visibleTop, tileTop);
+            int right = std::min(visibleRight, tileLeft + tile->width);
+            int bottom = std::min(visibleBottom, tileTop + tile->height);
+            size_t rowBytes = (size_t) (right - left) * 4;
+            for (int y = top; y < bottom; ++y) {
+                memcpy(target + (size_t) (originY + y) * targetStride + (size_t) (originX + left) * 4,
+                       tile->pixels + (size_t) (y - tileTop) * tileSize * 4 + (size_t) (left - tileLeft) * 4,
+                       rowBytes);
+            }
+        }
+    }
 }
 
 static jboolean NativeDocument_nativeRenderPagesSurfaceWithMatrix(JNIEnv *env,
@@ -1390,7 +2841,9 @@ static jboolean NativeDocument_nativeRenderPagesSurfaceWithMatrix(JNIEnv *env,
                                                                             jboolean text_mask,
                                                                             jint canvasColor,
                                                                             jint pageBackgroundColor) {
-    return runSafe(env, (jboolean) false, [&]() {
+    return runSafeUnlocked(env, (jboolean) false, [&]() {
+        PageBatch batch(env, pages, matrices, clipRect);
+
         ANativeWindow *nativeWindow = ANativeWindow_fromSurface(env, surface);
         if (nativeWindow == nullptr) {
             LOGE("native window pointer null");
@@ -1418,60 +2871,422 @@ static jboolean NativeDocument_nativeRenderPagesSurfaceWithMatrix(JNIEnv *env,
             return (jboolean) false;
         }
 
-        auto pagePtrs = env->GetLongArrayElements(pages, nullptr);
-        auto numPages = env->GetArrayLength(pages);
-        // Clamp so a caller passing mismatched-length matrices/clipRect can't drive OOB reads of them.
-        if (numPages > env->GetArrayLength(matrices) / MATRIX_VALUES_LEN) {
-            numPages = env->GetArrayLength(matrices) / MATRIX_VALUES_LEN;
+        // 2. CRITICAL: Use the buffer's actual dimensions, not the window's.
+        // During rapid resizing, the buffer might not match the window yet.
+        int bufW = buffer.width;
+        int bufH = buffer.height;
+        int bufStride = buffer.stride;
+
+        int flags = baseRenderFlags();
+        if (render_annot) {
+            flags |= FPDF_ANNOT;
         }
-        if (numPages > env->GetArrayLength(clipRect) / RECT_VALUES_LEN) {
-            numPages = env->GetArrayLength(clipRect) / RECT_VALUES_LEN;
+        {
+            PdfiumLock lock(sPdfiumMutex);
+            batch.dropClosedPages();
+
+            // Use the buffer's stride for the bitmap pitch (pixels * 4 bytes)
+            ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH,
+                                                        FPDFBitmap_BGRA,
+                                                        buffer.bits,
+                                                        bufStride * 4));
+
+            // Coverage-aware canvas fill + per-page render, the SAME shared helpers the other paths use: gray
+            // only in the gaps the pages don't cover, then each page's background filled to its clip and
+            // rendered on top.
+            fillCanvasGaps(pdfBitmap, bufW, bufH, env, batch.clips.data(), batch.count, batch.pages.data(),
+                           canvasColor);
+            for (int pageIndex = 0; pageIndex < batch.count; ++pageIndex) {
+                auto page = reinterpret_cast<FPDF_PAGE>(batch.pages[pageIndex]);
+                if (page == nullptr) continue;
+                auto clip = floatArrayToRect(env, batch.clips.data(), pageIndex);
+                auto matrix = floatArrayToMatrix(env, batch.matrices.data(), pageIndex);
+                fillAndRenderPageCached(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags,
+                                        render_annot ? formForPage(page) : nullptr);
+            }
         }
 
-        auto clipRectFloats = env->GetFloatArrayElements(clipRect, nullptr);
+        ANativeWindow_unlockAndPost(nativeWindow);
+        ANativeWindow_release(nativeWindow);
 
-        auto matrixFloats = env->GetFloatArrayElements(matrices, nullptr);
+        return (jboolean) true;
+    });
+}
 
-        // 2. CRITICAL: Use the buffer's actual dimensions, not the window's.
-        // During rapid resizing, the buffer might not match the window yet.
+// The last frame rendered to a Surface through NativeDocument_nativeRenderPagesSurfaceScrolled, kept in native
+// memory because the window's own buffers can't be read back: the next frame, when it's the same view scrolled,
+// is this one shifted plus the strip the scroll exposed.
+struct SurfaceFrame {
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+};
+
+// Moves the [width] x [height] RGBA image at [pixels] by ([dx], [dy]) pixels, in place. The pixels it uncovers
+// keep their old values.
+static void shiftPixels(uint8_t *pixels, int width, int height, int dx, int dy) {
+    size_t stride = (size_t) width * 4;
+    size_t rowBytes = (size_t) (width - abs(dx)) * 4;
+    size_t dstOffset = (size_t) std::max(dx, 0) * 4;
+    size_t srcOffset = (size_t) std::max(-dx, 0) * 4;
+    int rows = height - abs(dy);
+    for (int i = 0; i < rows; ++i) {
+        // Walk against the shift so a row is read before it's overwritten.
+        int y = dy > 0 ? height - 1 - i : i;
+        memmove(pixels + y * stride + dstOffset, pixels + (y - dy) * stride + srcOffset, rowBytes);
+    }
+}
+
+// Renders the pages, and the canvas around them, into the [region] of [bitmap] only; pixels outside it are left
+// as they are.
+static void renderPagesRegion(FPDF_BITMAP bitmap, int bufW, int bufH, FS_RECTF region, const jlong *pagePtrs,
+                              int numPages, const jfloat *clipRectFloats, const jfloat *matrixFloats,
+                              JNIEnv *env, int flags, bool renderAnnot, int canvasColor, int pageBackgroundColor) {
+    if (region.left >= region.right || region.top >= region.bottom) return;
+    int left = (int) region.left, top = (int) region.top;
+    auto *origin = static_cast<uint8_t *>(FPDFBitmap_GetBuffer(bitmap)) + (size_t) top * FPDFBitmap_GetStride(bitmap) +
+                   (size_t) left * 4;
+    ScopedBitmap view(FPDFBitmap_CreateEx((int) region.right - left, (int) region.bottom - top, FPDFBitmap_BGRA,
+                                          origin, FPDFBitmap_GetStride(bitmap)));
+    if (view == nullptr) return;
+    int viewW = (int) region.right - left, viewH = (int) region.bottom - top;
+
+    // The canvas around the pages' union, within the region.
+    if (canvasColor != 0) {
+        std::vector<jfloat> clips(clipRectFloats, clipRectFloats + (size_t) numPages * RECT_VALUES_LEN);
+        for (int i = 0; i < numPages; ++i) {
+            clips[i * RECT_VALUES_LEN] -= (float) left;
+            clips[i * RECT_VALUES_LEN + 1] -= (float) top;
+            clips[i * RECT_VALUES_LEN + 2] -= (float) left;
+            clips[i * RECT_VALUES_LEN + 3] -= (float) top;
+        }
+        fillCanvasGaps(view, viewW, viewH, env, clips.data(), numPages, pagePtrs, canvasColor);
+    }
+    // Each page clipped to the region. The whole bitmap is the target, so the page lands where it would in a full
+    // frame - and on the same tiles.
+    for (int i = 0; i < numPages; ++i) {
+        auto page = reinterpret_cast<FPDF_PAGE>(pagePtrs[i]);
+        if (page == nullptr) continue;
+        auto clip = floatArrayToRect(env, clipRectFloats, i);
+        clip.left = fmax(clip.left, region.left);
+        clip.top = fmax(clip.top, region.top);
+        clip.right = fmin(clip.right, region.right);
+        clip.bottom = fmin(clip.bottom, region.bottom);
+        if (clip.left >= clip.right || clip.top >= clip.bottom) continue;
+        auto matrix = floatArrayToMatrix(env, matrixFloats, i);
+        fillAndRenderPageCached(bitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags,
+                                renderAnnot ? formForPage(page) : nullptr);
+    }
+}
+
+static jlong NativeDocument_nativeOpenSurfaceFrame(JNIEnv *env, jobject) {
+    return runSafe(env, (jlong) 0, [&]() {
+        return reinterpret_cast<jlong>(new SurfaceFrame());
+    });
+}
+
+static void NativeDocument_nativeCloseSurfaceFrame(JNIEnv *, jobject, jlong frame_ptr) {
+    delete reinterpret_cast<SurfaceFrame *>(frame_ptr);
+}
+
+// nativeRenderPagesSurfaceWithMatrix for a frame that is the previous one scrolled by ([scroll_x], [scroll_y])
+// pixels: when [reuse] is set and the previous frame is the same size, it is shifted in [frame_ptr]'s copy and only
+// the strips the scroll uncovered are rendered; otherwise the whole frame is. The frame is then copied to the
+// window. The matrices and clips must be exactly the previous frame's moved by the scroll for the shifted part to
+// match. Returns false if the frame couldn't be rendered, after which the frame shouldn't be reused.
+static jboolean NativeDocument_nativeRenderPagesSurfaceScrolled(JNIEnv *env, jobject, jlong frame_ptr,
+                                                                jlongArray pages, jobject surface,
+                                                                jfloatArray matrices, jfloatArray clipRect,
+                                                                jint scroll_x, jint scroll_y, jboolean reuse,
+                                                                jboolean render_annot, jboolean,
+                                                                jint canvasColor, jint pageBackgroundColor) {
+    return runSafeUnlocked(env, (jboolean) false, [&]() {
+        auto *frame = reinterpret_cast<SurfaceFrame *>(frame_ptr);
+        if (frame == nullptr) {
+            LOGE("surface frame pointer null");
+            return (jboolean) false;
+        }
+        PageBatch batch(env, pages, matrices, clipRect);
+
+        ANativeWindow *nativeWindow = ANativeWindow_fromSurface(env, surface);
+        if (nativeWindow == nullptr) {
+            LOGE("native window pointer null");
+            return (jboolean) false;
+        }
+        if (ANativeWindow_getFormat(nativeWindow) != WINDOW_FORMAT_RGBA_8888) {
+            ANativeWindow_setBuffersGeometry(nativeWindow, ANativeWindow_getWidth(nativeWindow),
+                                             ANativeWindow_getHeight(nativeWindow), WINDOW_FORMAT_RGBA_8888);
+        }
+
+        ANativeWindow_Buffer buffer{};
+        if (ANativeWindow_lock(nativeWindow, &buffer, nullptr) != 0) {
+            LOGE("Locking native window failed");
+            ANativeWindow_release(nativeWindow);
+            return (jboolean) false;
+        }
         int bufW = buffer.width;
         int bufH = buffer.height;
-        int bufStride = buffer.stride;
-
-        // Use the buffer's stride for the bitmap pitch (pixels * 4 bytes)
-        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH,
-                                                    FPDFBitmap_BGRA,
-                                                    buffer.bits,
-                                                    bufStride * 4));
 
-        // Coverage-aware canvas fill + per-page render, the SAME shared helpers the other paths use: gray only
-        // in the gaps the pages don't cover, then each page's background filled to its clip and rendered on top.
-        fillCanvasGaps(pdfBitmap, bufW, bufH, env, clipRectFloats, numPages, pagePtrs, canvasColor);
+        bool shift = reuse && frame->width == bufW && frame->height == bufH &&
+                     abs(scroll_x) < bufW && abs(scroll_y) < bufH;
+        if (shift) {
+            shiftPixels(frame->pixels.data(), bufW, bufH, scroll_x, scroll_y);
+        } else {
+            frame->pixels.resize((size_t) bufW * bufH * 4);
+            frame->width = bufW;
+            frame->height = bufH;
+        }
 
-        int flags = FPDF_REVERSE_BYTE_ORDER;
+        int flags = baseRenderFlags();
         if (render_annot) {
             flags |= FPDF_ANNOT;
         }
-        for (int pageIndex = 0; pageIndex < numPages; ++pageIndex) {
-            auto page = reinterpret_cast<FPDF_PAGE>(pagePtrs[pageIndex]);
-            if (page == nullptr) continue;
-            auto clip = floatArrayToRect(env, clipRectFloats, pageIndex);
-            auto matrix = floatArrayToMatrix(env, matrixFloats, pageIndex);
-            fillAndRenderPage(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags);
+        {
+            PdfiumLock lock(sPdfiumMutex);
+            ScopedBitmap frameBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA, frame->pixels.data(),
+                                                         bufW * 4));
+            if (frameBitmap == nullptr) {
+                frame->width = frame->height = 0;
+                ANativeWindow_unlockAndPost(nativeWindow);
+                ANativeWindow_release(nativeWindow);
+                return (jboolean) false;
+            }
+            batch.dropClosedPages();
+
+            auto render = [&](float left, float top, float right, float bottom) {
+                renderPagesRegion(frameBitmap, bufW, bufH, FS_RECTF{left, top, right, bottom}, batch.pages.data(),
+                                  batch.count, batch.clips.data(), batch.matrices.data(), env, flags, render_annot,
+                                  canvasColor, pageBackgroundColor);
+            };
+            if (shift) {
+                // The rows uncovered at the top or bottom, then the columns uncovered at the side, less those rows.
+                int rowsTop = scroll_y > 0 ? 0 : bufH + scroll_y;
+                int rowsBottom = scroll_y > 0 ? scroll_y : bufH;
+                render(0, (float) rowsTop, (float) bufW, (float) rowsBottom);
+                int columnsLeft = scroll_x > 0 ? 0 : bufW + scroll_x;
+                int columnsRight = scroll_x > 0 ? scroll_x : bufW;
+                int top = scroll_y > 0 ? scroll_y : 0;
+                int bottom = scroll_y > 0 ? bufH : bufH + scroll_y;
+                render((float) columnsLeft, (float) top, (float) columnsRight, (float) bottom);
+            } else {
+                render(0, 0, (float) bufW, (float) bufH);
+            }
+        }
+
+        auto *windowPixels = static_cast<uint8_t *>(buffer.bits);
+        for (int y = 0; y < bufH; ++y) {
+            memcpy(windowPixels + (size_t) y * buffer.stride * 4, frame->pixels.data() + (size_t) y * bufW * 4,
+                   (size_t) bufW * 4);
         }
 
         ANativeWindow_unlockAndPost(nativeWindow);
         ANativeWindow_release(nativeWindow);
 
+        return (jboolean) true;
+    });
+}
 
-        env->ReleaseFloatArrayElements(matrices, (jfloat *) matrixFloats, JNI_ABORT);
-        env->ReleaseFloatArrayElements(clipRect, (jfloat *) clipRectFloats, JNI_ABORT);
-        env->ReleaseLongArrayElements(pages, pagePtrs, JNI_ABORT);
+// A frame for a RenderLoop: the pages and where to put them, copied out of the Java arrays at submit time.
+struct FrameRequest {
+    std::vector<jlong> pages;
+    std::vector<jfloat> matrices;
+    std::vector<jfloat> clips;
+    std::vector<uint64_t> generations;
+    bool renderAnnot = false;
+    int canvasColor = 0;
+    int pageBackgroundColor = 0;
+};
 
-        return (jboolean) true;
+// A thread that presents frames to one window. Callers post the latest viewport into a single-slot mailbox,
+// replacing - and so dropping - any frame the thread hasn't started yet. The thread takes it, has the Java side
+// run RenderLoop::rasterize under the PDFium lock into its off-screen back buffer, and then, with the PDFium lock
+// released, locks the window only to copy the back buffer in and post it.
+struct RenderLoop {
+    enum Stat { SUBMITTED, RENDERED, DROPPED, STATS_LEN };
+
+    RenderLoop(ANativeWindow *window, jobject bridge) : window(window), bridge(bridge) {
+        thread = std::thread([this]() { run(); });
+    }
+
+    // Stops the thread, waiting out the frame it's on. Must not be called holding the PDFium lock, which that
+    // frame may be waiting for.
+    ~RenderLoop() {
+        {
+            const std::lock_guard<std::mutex> lock(wakeLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+        delete mailbox.exchange(nullptr);
+        ANativeWindow_release(window);
+        // Released here rather than by the thread, which never gets an env if it fails to attach.
+        JNIEnv *env;
+        bool attached;
+        if (jniAttachCurrentThread(&env, &attached)) {
+            env->DeleteGlobalRef(bridge);
+            jniDetachCurrentThread(attached);
+        }
+    }
+
+    void submit(FrameRequest *request) {
+        FrameRequest *stale = mailbox.exchange(request, std::memory_order_acq_rel);
+        if (stale != nullptr) {
+            delete stale;
+            stats[DROPPED]++;
+        }
+        stats[SUBMITTED]++;
+        // Taken only so the thread can't miss the wake-up between checking the mailbox and sleeping.
+        { const std::lock_guard<std::mutex> lock(wakeLock); }
+        wake.notify_one();
+    }
+
+    // Renders the frame the thread is on into the back buffer. Runs on the thread, called back from Java with the
+    // PDFium lock held. Pages closed since the frame was submitted, even if another page now has the same address,
+    // are left out, so a frame can't touch a freed page.
+    bool rasterize(JNIEnv *env) {
+        if (current == nullptr || width <= 0 || height <= 0) return false;
+        ScopedBitmap bitmap(FPDFBitmap_CreateEx(width, height, FPDFBitmap_BGRA, backBuffer.data(), width * 4));
+        if (bitmap == nullptr) return false;
+
+        FrameRequest &frame = *current;
+        int numPages = (int) std::min({frame.pages.size(), frame.matrices.size() / MATRIX_VALUES_LEN,
+                                       frame.clips.size() / RECT_VALUES_LEN});
+        for (int i = 0; i < numPages; ++i) {
+            if (!pageIsOpen(reinterpret_cast<FPDF_PAGE>(frame.pages[i]), frame.generations[i])) frame.pages[i] = 0;
+        }
+        int flags = baseRenderFlags();
+        if (frame.renderAnnot) {
+            flags |= FPDF_ANNOT;
+        }
+        renderPagesRegion(bitmap, width, height, FS_RECTF{0, 0, (float) width, (float) height}, frame.pages.data(),
+                          numPages, frame.clips.data(), frame.matrices.data(), env, flags, frame.renderAnnot,
+                          frame.canvasColor, frame.pageBackgroundColor);
+        return true;
+    }
+
+    std::atomic<int64_t> stats[STATS_LEN] = {};
+
+private:
+    void run() {
+        JNIEnv *env = nullptr;
+        bool attached;
+        if (!jniAttachCurrentThread(&env, &attached)) return;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(wakeLock);
+                wake.wait(lock, [this]() { return stopping || mailbox.load(std::memory_order_acquire) != nullptr; });
+                if (stopping) break;
+            }
+            current.reset(mailbox.exchange(nullptr, std::memory_order_acq_rel));
+            if (current == nullptr) continue;
+
+            width = ANativeWindow_getWidth(window);
+            height = ANativeWindow_getHeight(window);
+            if (width > 0 && height > 0) backBuffer.resize((size_t) width * height * 4);
+            jboolean rasterized = env->CallBooleanMethod(bridge, rasterizeFrameMethod);
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                rasterized = false;
+            }
+            current.reset();
+            if (rasterized && present()) stats[RENDERED]++;
+        }
+        jniDetachCurrentThread(attached);
+    }
+
+    bool present() {
+        if (ANativeWindow_getFormat(window) != WINDOW_FORMAT_RGBA_8888) {
+            ANativeWindow_setBuffersGeometry(window, width, height, WINDOW_FORMAT_RGBA_8888);
+        }
+        ANativeWindow_Buffer buffer{};
+        if (ANativeWindow_lock(window, &buffer, nullptr) != 0) {
+            LOGE("Locking native window failed");
+            return false;
+        }
+        // The window may have been resized since the frame was rasterized; copy what overlaps.
+        int rows = std::min(height, buffer.height);
+        size_t rowBytes = (size_t) std::min(width, buffer.width) * 4;
+        auto *windowPixels = static_cast<uint8_t *>(buffer.bits);
+        for (int y = 0; y < rows; ++y) {
+            memcpy(windowPixels + (size_t) y * buffer.stride * 4, backBuffer.data() + (size_t) y * width * 4, rowBytes);
+        }
+        ANativeWindow_unlockAndPost(window);
+        return true;
+    }
+
+    ANativeWindow *window;
+    jobject bridge;
+    std::thread thread;
+    std::atomic<FrameRequest *> mailbox{nullptr};
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    bool stopping = false;
+    // Owned by the thread.
+    std::unique_ptr<FrameRequest> current;
+    std::vector<uint8_t> backBuffer;
+    int width = 0;
+    int height = 0;
+};
+
+static jlong NativeDocument_nativeOpenRenderLoop(JNIEnv *env, jobject, jobject surface, jobject bridge) {
+    return runSafe(env, (jlong) 0, [&]() {
+        ANativeWindow *nativeWindow = ANativeWindow_fromSurface(env, surface);
+        if (nativeWindow == nullptr) {
+            LOGE("native window pointer null");
+            return (jlong) 0;
+        }
+        return reinterpret_cast<jlong>(new RenderLoop(nativeWindow, env->NewGlobalRef(bridge)));
     });
 }
 
+static void NativeDocument_nativeSubmitRenderLoopFrame(JNIEnv *env, jobject, jlong loop_ptr, jlongArray pages,
+                                                       jfloatArray matrices, jfloatArray clipRect,
+                                                       jboolean render_annot, jint canvasColor,
+                                                       jint pageBackgroundColor) {
+    runSafe(env, [&]() {
+        auto *loop = reinterpret_cast<RenderLoop *>(loop_ptr);
+        if (loop == nullptr) return;
+        auto *request = new FrameRequest();
+        request->pages.resize(env->GetArrayLength(pages));
+        env->GetLongArrayRegion(pages, 0, (jsize) request->pages.size(), request->pages.data());
+        for (jlong page : request->pages) {
+            request->generations.push_back(pageGeneration(reinterpret_cast<FPDF_PAGE>(page)));
+        }
+        request->matrices.resize(env->GetArrayLength(matrices));
+        env->GetFloatArrayRegion(matrices, 0, (jsize) request->matrices.size(), request->matrices.data());
+        request->clips.resize(env->GetArrayLength(clipRect));
+        env->GetFloatArrayRegion(clipRect, 0, (jsize) request->clips.size(), request->clips.data());
+        request->renderAnnot = render_annot;
+        request->canvasColor = canvasColor;
+        request->pageBackgroundColor = pageBackgroundColor;
+        loop->submit(request);
+    });
+}
+
+static jboolean NativeDocument_nativeRasterizeRenderLoopFrame(JNIEnv *env, jobject, jlong loop_ptr) {
+    return runSafe(env, (jboolean) false, [&]() {
+        auto *loop = reinterpret_cast<RenderLoop *>(loop_ptr);
+        return (jboolean) (loop != nullptr && loop->rasterize(env));
+    });
+}
+
+static jlongArray NativeDocument_nativeGetRenderLoopStats(JNIEnv *env, jobject, jlong loop_ptr) {
+    return runSafe(env, (jlongArray) nullptr, [&]() {
+        auto *loop = reinterpret_cast<RenderLoop *>(loop_ptr);
+        jlong values[RenderLoop::STATS_LEN] = {};
+        if (loop != nullptr) {
+            for (int i = 0; i < RenderLoop::STATS_LEN; ++i) values[i] = loop->stats[i].load();
+        }
+        jlongArray result = env->NewLongArray(RenderLoop::STATS_LEN);
+        if (result != nullptr) env->SetLongArrayRegion(result, 0, RenderLoop::STATS_LEN, values);
+        return result;
+    });
+}
+
+static void NativeDocument_nativeCloseRenderLoop(JNIEnv *, jobject, jlong loop_ptr) {
+    delete reinterpret_cast<RenderLoop *>(loop_ptr);
+}
+
 static void NativeDocument_nativeRenderPagesWithMatrix(JNIEnv *env, jobject thiz,
                                                                      jlongArray pages, jlong buffer_ptr,
                                                                      jint draw_size_hor, jint draw_size_ver,
@@ -1481,48 +3296,33 @@ static void NativeDocument_nativeRenderPagesWithMatrix(JNIEnv *env, jobject thiz
                                                                      jboolean text_mask,
                                                                      jint canvasColor,
                                                                      jint pageBackgroundColor) {
-    runSafe(env, [&]() {
+    runSafeUnlocked(env, [&]() {
         auto bufferPtr = reinterpret_cast<ANativeWindow_Buffer*>(buffer_ptr);
         auto buffer = *bufferPtr;
-        auto pagePtrs = env->GetLongArrayElements(pages, nullptr);
-        auto numPages = env->GetArrayLength(pages);
-        // Clamp so a caller passing mismatched-length matrices/clipRect can't drive OOB reads of them.
-        if (numPages > env->GetArrayLength(matrices) / MATRIX_VALUES_LEN) {
-            numPages = env->GetArrayLength(matrices) / MATRIX_VALUES_LEN;
-        }
-        if (numPages > env->GetArrayLength(clipRect) / RECT_VALUES_LEN) {
-            numPages = env->GetArrayLength(clipRect) / RECT_VALUES_LEN;
-        }
-        auto clipRectFloats = env->GetFloatArrayElements(clipRect, nullptr);
-        auto matrixFloats = env->GetFloatArrayElements(matrices, nullptr);
+        PageBatch batch(env, pages, matrices, clipRect);
 
         int bufW = draw_size_hor;
         int bufH = draw_size_ver;
-        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA,
-                                                    buffer.bits, (int) (buffer.stride) * 4));
-
-        fillCanvasGaps(pdfBitmap, bufW, bufH, env, clipRectFloats, numPages, pagePtrs, canvasColor);
-
-        int flags = FPDF_REVERSE_BYTE_ORDER;
+        int flags = baseRenderFlags();
         if (render_annot) {
             flags |= FPDF_ANNOT;
         }
 
-        for (int pageIndex = 0; pageIndex < numPages; ++pageIndex) {
-            auto page = reinterpret_cast<FPDF_PAGE>(pagePtrs[pageIndex]);
-            if (page == nullptr) continue; // skip a bad page; the old code `return`ed, aborting the
-                                           // whole batch AND leaking the array elements below
-            auto clip = floatArrayToRect(env, clipRectFloats, pageIndex);
-            auto matrix = floatArrayToMatrix(env, matrixFloats, pageIndex);
-            fillAndRenderPage(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags);
-        }
+        PdfiumLock lock(sPdfiumMutex);
+        batch.dropClosedPages();
+        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(bufW, bufH, FPDFBitmap_BGRA,
+                                                    buffer.bits, (int) (buffer.stride) * 4));
+
+        fillCanvasGaps(pdfBitmap, bufW, bufH, env, batch.clips.data(), batch.count, batch.pages.data(), canvasColor);
 
-        // Always release (JNI_ABORT — the arrays are never modified). The prior code guarded each
-        // Release on its isCopy flag and released `pages` under `isCopyClipRect` (a copy-paste bug),
-        // leaking the elements whenever the JVM didn't hand back a copy.
-        env->ReleaseFloatArrayElements(matrices, (jfloat *) matrixFloats, JNI_ABORT);
-        env->ReleaseFloatArrayElements(clipRect, (jfloat *) clipRectFloats, JNI_ABORT);
-        env->ReleaseLongArrayElements(pages, pagePtrs, JNI_ABORT);
+        for (int pageIndex = 0; pageIndex < batch.count; ++pageIndex) {
+            auto page = reinterpret_cast<FPDF_PAGE>(batch.pages[pageIndex]);
+            if (page == nullptr) continue; // a bad or closed page is skipped, not the whole batch
+            auto clip = floatArrayToRect(env, batch.clips.data(), pageIndex);
+            auto matrix = floatArrayToMatrix(env, batch.matrices.data(), pageIndex);
+            fillAndRenderPageCached(pdfBitmap, bufW, bufH, page, clip, matrix, pageBackgroundColor, flags,
+                              render_annot ? formForPage(page) : nullptr);
+        }
     });
 }
 static void NativePage_nativeRenderPageBitmap(JNIEnv *env, jclass,
@@ -1534,11 +3334,12 @@ static void NativePage_nativeRenderPageBitmap(JNIEnv *env, jclass,
                                                             jboolean render_annot,
                                                             jboolean,
                                                             jint canvasColor, jint pageBackgroundColor) {
-    runSafe(env, [&]() {
+    runSafeUnlocked(env, [&]() {
         auto *doc = reinterpret_cast<DocumentFile*>(doc_ptr);
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        uint64_t generation = pageGeneration(page);
 
-        if (doc == nullptr || page == nullptr || bitmap == nullptr) { // doc used below for form fill
+        if (doc == nullptr || generation == 0 || bitmap == nullptr) { // doc used below for form fill
             LOGE("Render page pointers invalid");
             return;
         }
@@ -1565,21 +3366,113 @@ static void NativePage_nativeRenderPageBitmap(JNIEnv *env, jclass,
             return;
         }
 
-        void *tmp;
-        int format;
-        int sourceStride;
+        /*LOGD("Start X: %d", startX);
+        LOGD("Start Y: %d", startY);
+        LOGD("Canvas Hor: %d", canvasHorSize);
+        LOGD("Canvas Ver: %d", canvasVerSize);
+        LOGD("Draw Hor: %d", drawSizeHor);
+        LOGD("Draw Ver: %d", drawSizeVer);*/
+
+        int baseHorSize = (canvasHorSize < draw_size_hor) ? (int) canvasHorSize
+                                                          : (int) draw_size_hor;
+        int baseVerSize = (canvasVerSize < draw_size_ver) ? (int) canvasVerSize
+                                                          : (int) draw_size_ver;
+        int baseX = (start_x < 0) ? 0 : (int) start_x;
+        int baseY = (start_y < 0) ? 0 : (int) start_y;
+        int flags = baseRenderFlags();
+
+        // The document's form environment, created once on its first form render — not per render. Looked up
+        // under the PDFium lock, with the page.
+        FPDF_FORMHANDLE form = nullptr;
+
+        if (render_annot) {
+            flags |= FPDF_ANNOT;
+        }
+
+//    if(text_mask) {
+//        flags |= FPDF_RENDER_TEXT_MASK;
+//    }
+
+        // Renders the rows of the bitmap that [target] holds, [target]'s row 0 being bitmap row [top]. Runs under
+        // the PDFium lock; false once the page has been closed.
+        auto renderRows = [&](FPDF_BITMAP target, int top, int rows) {
+            if (!pageIsOpen(page, generation)) return false;
+            if (render_annot && form == nullptr) form = doc->getFormHandle();
+            // Gray fills ONLY the gaps around the page footprint (never under the white page background below).
+            fillCanvasBorder(target, (int) canvasHorSize, rows,
+                             FS_RECTF{ (float) start_x, (float) (start_y - top),
+                                       (float) (start_x + draw_size_hor), (float) (start_y - top + draw_size_ver) },
+                             (int) canvasColor);
+
+            if (pageBackgroundColor != 0) {
+                FPDFBitmap_FillRect(target, baseX, baseY - top, baseHorSize, baseVerSize,
+                                    pageBackgroundColor); //White
+            }
+
+            FPDF_RenderPageBitmap(target, page,
+                                  start_x, start_y - top,
+                                  (int) draw_size_hor, (int) draw_size_ver,
+                                  0, flags);
+
+            if (form != nullptr) { // null when the document has no form, or its environment failed to start
+                // main's 5dfd985: pass `flags` (which already includes FPDF_ANNOT when render_annot), not FPDF_ANNOT
+                FPDF_FFLDraw(form, target, page, start_x, start_y - top, (int) draw_size_hor, (int) draw_size_ver,
+                             0, flags);
+            }
+            return true;
+        };
+
         if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
-            tmp = malloc(canvasVerSize * canvasHorSize * sizeof(rgb));
-            sourceStride = (int) (canvasHorSize * sizeof(rgb));
-            format = FPDFBitmap_BGR;
+            renderTo565InBands(addr, info, renderRows);
         } else {
-            tmp = addr;
-            sourceStride = (int) info.stride;
-            format = FPDFBitmap_BGRA;
+            PdfiumLock lock(sPdfiumMutex);
+            ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx((int) canvasHorSize, (int) canvasVerSize,
+                                                        FPDFBitmap_BGRA, addr, (int) info.stride));
+            renderRows(pdfBitmap, 0, (int) canvasVerSize);
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmap);
+    });
+}
+
+static void NativePage_nativeRenderPageBitmapWithMatrix(JNIEnv *env, jclass,
+                                                                      jlong page_ptr,
+                                                                      jobject bitmap,
+                                                                      jfloatArray matrixValues,
+                                                                      jfloatArray clipRect,
+                                                                      jboolean render_annot,
+                                                                      jboolean,
+                                                                      jint canvasColor, jint pageBackgroundColor) {
+    runSafeUnlocked(env, [&]() {
+        auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        uint64_t generation = pageGeneration(page);
+
+        if (generation == 0 || bitmap == nullptr) {
+            LOGE("Render page pointers invalid");
+            return;
+        }
+
+        AndroidBitmapInfo info;
+        int ret;
+        if ((ret = AndroidBitmap_getInfo(env, bitmap, &info)) < 0) {
+            LOGE("Fetching bitmap info failed: %s", strerror(ret * -1));
+            return;
         }
 
-        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx((int) canvasHorSize, (int) canvasVerSize,
-                                                    format, tmp, sourceStride));
+        auto canvasHorSize = info.width;
+        auto canvasVerSize = info.height;
+
+        if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
+            info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
+            LOGE("Bitmap format must be RGBA_8888 or RGB_565");
+            return;
+        }
+
+        void *addr;
+        if ((ret = AndroidBitmap_lockPixels(env, bitmap, &addr)) != 0) {
+            LOGE("Locking bitmap failed: %s", strerror(ret * -1));
+            return;
+        }
 
         /*LOGD("Start X: %d", startX);
         LOGD("Start Y: %d", startY);
@@ -1588,144 +3481,686 @@ static void NativePage_nativeRenderPageBitmap(JNIEnv *env, jclass,
         LOGD("Draw Hor: %d", drawSizeHor);
         LOGD("Draw Ver: %d", drawSizeVer);*/
 
-        // Gray fills ONLY the gaps around the page footprint (never under the white page background below).
-        fillCanvasBorder(pdfBitmap, (int) canvasHorSize, (int) canvasVerSize,
+        int flags = baseRenderFlags();
+        if (render_annot) {
+            flags |= FPDF_ANNOT;
+        }
+
+        auto clip = floatArrayToRect(env, clipRect);
+        auto matrix = floatArrayToMatrix(env, matrixValues);
+        FPDF_FORMHANDLE form = nullptr;
+
+        // Coverage-aware fill + render, the same shared helpers as the other paths: canvasColor only in the gaps
+        // around the page footprint (the clip), pageBackgroundColor to the footprint, page on top. (This path
+        // previously filled the WHOLE bitmap with pageBackgroundColor and ignored canvasColor.) [target] holds the
+        // bitmap's rows from [top], so the clip and matrix move up by [top]. Runs under the PDFium lock; false once
+        // the page has been closed.
+        auto renderRows = [&](FPDF_BITMAP target, int top, int rows) {
+            if (!pageIsOpen(page, generation)) return false;
+            if (render_annot && form == nullptr) form = formForPage(page);
+            FS_RECTF rowsClip{clip.left, clip.top - (float) top, clip.right, clip.bottom - (float) top};
+            FS_MATRIX rowsMatrix = matrix;
+            rowsMatrix.f -= (float) top;
+            fillCanvasBorder(target, (int) canvasHorSize, rows, rowsClip, canvasColor);
+            fillAndRenderPage(target, (int) canvasHorSize, rows, page, rowsClip, rowsMatrix,
+                              pageBackgroundColor, flags, form);
+            return true;
+        };
+
+        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
+            renderTo565InBands(addr, info, renderRows);
+        } else {
+            PdfiumLock lock(sPdfiumMutex);
+            ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx((int) canvasHorSize, (int) canvasVerSize,
+                                                        FPDFBitmap_BGRA, addr, (int) info.stride));
+            renderRows(pdfBitmap, 0, (int) canvasVerSize);
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmap);
+    });
+}
+// Status for a progressive render the caller cancelled. The other statuses handed back to Kotlin are
+// PDFium's own FPDF_RENDER_TOBECONTINUED / FPDF_RENDER_DONE / FPDF_RENDER_FAILED.
+const int PROGRESSIVE_RENDER_CANCELLED = 4;
+
+// One resumable bitmap render. PDFium polls NeedToPauseNow between rendering steps, so the render yields as
+// soon as the caller cancels it (from any thread) or the current slice's time budget runs out, and
+// FPDF_RenderPage_Continue picks up where it stopped on a later call. The FPDF_BITMAP wraps the target's
+// pixels for the whole render, so they must not move between calls.
+class ProgressiveRender : public IFSDK_PAUSE {
+public:
+    std::atomic<bool> cancelled{false};
+    FPDF_PAGE page = nullptr;
+    FPDF_BITMAP pdfBitmap = nullptr;
+    AndroidBitmapInfo info{};
+    void *pixels = nullptr;
+    std::vector<uint8_t> tmp; // BGR scratch when the target is RGB_565
+    int sourceStride = 0;
+    int status = FPDF_RENDER_READY;
+    // Form fields are drawn over the finished page, in the same device rect it was rendered to.
+    FPDF_FORMHANDLE form = nullptr;
+    int formX = 0, formY = 0, formWidth = 0, formHeight = 0, formFlags = 0;
+
+    ProgressiveRender() {
+        version = 1;
+        NeedToPauseNow = &needToPauseNow;
+        user = nullptr;
+    }
+
+    ~ProgressiveRender() { release(); }
+
+    void beginSlice(jlong timeBudgetMillis) {
+        hasDeadline = timeBudgetMillis > 0;
+        if (hasDeadline) {
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeBudgetMillis);
+        }
+    }
+
+    // Map PDFium's result for the slice that just ran to the status reported to Kotlin. Once the render is
+    // over, one way or another, PDFium's render state is dropped so the page can be rendered normally again.
+    int endSlice(int result) {
+        if (result == FPDF_RENDER_TOBECONTINUED && cancelled.load()) {
+            result = PROGRESSIVE_RENDER_CANCELLED;
+        }
+        if (result == FPDF_RENDER_DONE && form != nullptr) {
+            FPDF_FFLDraw(form, pdfBitmap, page, formX, formY, formWidth, formHeight, 0, formFlags);
+        }
+        if (result == FPDF_RENDER_DONE && !tmp.empty()) {
+            rgbBitmapTo565(tmp.data(), sourceStride, sizeof(rgb), pixels, (int) info.stride, (int) info.width,
+                           (int) info.height, 0, sDitherRgb565.load(std::memory_order_relaxed));
+        }
+        status = result;
+        if (status != FPDF_RENDER_TOBECONTINUED) {
+            release();
+        }
+        return status;
+    }
+
+    void release() {
+        if (page != nullptr) {
+            FPDF_RenderPage_Close(page);
+            page = nullptr;
+        }
+        if (pdfBitmap != nullptr) {
+            FPDFBitmap_Destroy(pdfBitmap);
+            pdfBitmap = nullptr;
+        }
+        std::vector<uint8_t>().swap(tmp);
+    }
+
+private:
+    std::chrono::steady_clock::time_point deadline{};
+    bool hasDeadline = false;
+
+    static FPDF_BOOL needToPauseNow(IFSDK_PAUSE *pause) {
+        auto *render = static_cast<ProgressiveRender *>(pause);
+        if (render->cancelled.load(std::memory_order_relaxed)) return true;
+        return render->hasDeadline && std::chrono::steady_clock::now() >= render->deadline;
+    }
+};
+
+static jlong NativePage_nativeOpenProgressiveRender(JNIEnv *env, jclass) {
+    return runSafe(env, (jlong) 0, [&]() {
+        return reinterpret_cast<jlong>(new ProgressiveRender());
+    });
+}
+
+static jint NativePage_nativeStartProgressiveRender(JNIEnv *env, jclass,
+                                                    jlong render_ptr,
+                                                    jlong page_ptr,
+                                                    jobject bitmap,
+                                                    jint start_x, jint start_y,
+                                                    jint draw_size_hor, jint draw_size_ver,
+                                                    jboolean render_annot,
+                                                    jboolean,
+                                                    jint canvasColor, jint pageBackgroundColor,
+                                                    jlong timeBudgetMillis) {
+    return runSafe(env, (jint) FPDF_RENDER_FAILED, [&]() {
+        auto *render = reinterpret_cast<ProgressiveRender *>(render_ptr);
+        auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+
+        if (render == nullptr || page == nullptr || bitmap == nullptr) {
+            LOGE("Render page pointers invalid");
+            return (jint) FPDF_RENDER_FAILED;
+        }
+        if (render->status != FPDF_RENDER_READY) {
+            LOGE("Progressive render already started");
+            return (jint) render->status;
+        }
+        if (render->cancelled.load()) {
+            return (jint) render->endSlice(PROGRESSIVE_RENDER_CANCELLED);
+        }
+
+        int ret;
+        if ((ret = AndroidBitmap_getInfo(env, bitmap, &render->info)) < 0) {
+            LOGE("Fetching bitmap info failed: %s", strerror(ret * -1));
+            return (jint) render->endSlice(FPDF_RENDER_FAILED);
+        }
+
+        auto canvasHorSize = (int) render->info.width;
+        auto canvasVerSize = (int) render->info.height;
+
+        if (render->info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
+            render->info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
+            LOGE("Bitmap format must be RGBA_8888 or RGB_565");
+            return (jint) render->endSlice(FPDF_RENDER_FAILED);
+        }
+
+        if ((ret = AndroidBitmap_lockPixels(env, bitmap, &render->pixels)) != 0) {
+            LOGE("Locking bitmap failed: %s", strerror(ret * -1));
+            return (jint) render->endSlice(FPDF_RENDER_FAILED);
+        }
+
+        void *target;
+        int format;
+        if (render->info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
+            render->sourceStride = (int) (canvasHorSize * sizeof(rgb));
+            try {
+                render->tmp.resize((size_t) canvasVerSize * render->sourceStride);
+            } catch (const std::bad_alloc &) {
+                // Without it PDFium would render into a buffer of its own that the RGB_565 conversion never sees.
+                LOGE("Allocating the RGB_565 scratch buffer failed");
+                AndroidBitmap_unlockPixels(env, bitmap);
+                return (jint) render->endSlice(FPDF_RENDER_FAILED);
+            }
+            target = render->tmp.data();
+            format = FPDFBitmap_BGR;
+        } else {
+            render->sourceStride = (int) render->info.stride;
+            target = render->pixels;
+            format = FPDFBitmap_BGRA;
+        }
+
+        render->pdfBitmap = FPDFBitmap_CreateEx(canvasHorSize, canvasVerSize, format, target,
+                                                render->sourceStride);
+        if (render->pdfBitmap == nullptr) {
+            AndroidBitmap_unlockPixels(env, bitmap);
+            return (jint) render->endSlice(FPDF_RENDER_FAILED);
+        }
+
+        fillCanvasBorder(render->pdfBitmap, canvasHorSize, canvasVerSize,
                          FS_RECTF{ (float) start_x, (float) start_y,
                                    (float) (start_x + draw_size_hor), (float) (start_y + draw_size_ver) },
                          (int) canvasColor);
 
-        int baseHorSize = (canvasHorSize < draw_size_hor) ? (int) canvasHorSize
-                                                          : (int) draw_size_hor;
-        int baseVerSize = (canvasVerSize < draw_size_ver) ? (int) canvasVerSize
-                                                          : (int) draw_size_ver;
         int baseX = (start_x < 0) ? 0 : (int) start_x;
         int baseY = (start_y < 0) ? 0 : (int) start_y;
-        int flags = FPDF_REVERSE_BYTE_ORDER;
-
-        FPDF_FORMFILLINFO form_callbacks = {0};
-        form_callbacks.version = 2;
-        FPDF_FORMHANDLE form = nullptr; // was uninitialized
+        int baseHorSize = std::min((int) (start_x + draw_size_hor), canvasHorSize) - baseX;
+        int baseVerSize = std::min((int) (start_y + draw_size_ver), canvasVerSize) - baseY;
+        if (pageBackgroundColor != 0 && baseHorSize > 0 && baseVerSize > 0) {
+            FPDFBitmap_FillRect(render->pdfBitmap, baseX, baseY, baseHorSize, baseVerSize,
+                                pageBackgroundColor);
+        }
 
+        int flags = baseRenderFlags();
         if (render_annot) {
-            form = FPDFDOC_InitFormFillEnvironment(doc->pdfDocument, &form_callbacks);
             flags |= FPDF_ANNOT;
         }
 
-//    if(text_mask) {
-//        flags |= FPDF_RENDER_TEXT_MASK;
-//    }
+        if (render_annot) {
+            render->form = formForPage(page);
+            render->formX = start_x;
+            render->formY = start_y;
+            render->formWidth = draw_size_hor;
+            render->formHeight = draw_size_ver;
+            render->formFlags = flags;
+        }
 
-        if (pageBackgroundColor != 0) {
-            FPDFBitmap_FillRect(pdfBitmap, baseX, baseY, baseHorSize, baseVerSize,
-                                pageBackgroundColor); //White
+        render->page = page;
+        render->beginSlice(timeBudgetMillis);
+        int result = FPDF_RenderPageBitmap_Start(render->pdfBitmap, page,
+                                                 start_x, start_y,
+                                                 (int) draw_size_hor, (int) draw_size_ver,
+                                                 0, flags, render);
+        result = render->endSlice(result);
+
+        AndroidBitmap_unlockPixels(env, bitmap);
+        return (jint) result;
+    });
+}
+
+static jint NativePage_nativeContinueProgressiveRender(JNIEnv *env, jclass,
+                                                       jlong render_ptr,
+                                                       jobject bitmap,
+                                                       jlong timeBudgetMillis) {
+    return runSafe(env, (jint) FPDF_RENDER_FAILED, [&]() {
+        auto *render = reinterpret_cast<ProgressiveRender *>(render_ptr);
+
+        if (render == nullptr || bitmap == nullptr) {
+            LOGE("Render page pointers invalid");
+            return (jint) FPDF_RENDER_FAILED;
+        }
+        if (render->status != FPDF_RENDER_TOBECONTINUED) {
+            return (jint) render->status;
         }
 
-        FPDF_RenderPageBitmap(pdfBitmap, page,
-                              start_x, start_y,
-                              (int) draw_size_hor, (int) draw_size_ver,
-                              0, flags);
+        void *addr;
+        int ret;
+        if ((ret = AndroidBitmap_lockPixels(env, bitmap, &addr)) != 0) {
+            LOGE("Locking bitmap failed: %s", strerror(ret * -1));
+            return (jint) render->endSlice(FPDF_RENDER_FAILED);
+        }
+
+        int result;
+        if (addr != render->pixels) {
+            LOGE("Bitmap pixels moved during a progressive render");
+            result = render->endSlice(FPDF_RENDER_FAILED);
+        } else {
+            render->beginSlice(timeBudgetMillis);
+            result = render->endSlice(FPDF_RenderPage_Continue(render->page, render));
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmap);
+        return (jint) result;
+    });
+}
+
+// Only flips an atomic, so unlike every other page call this one is safe without the PDFium lock; it is how
+// another thread stops a render that is running right now.
+static void NativePage_nativeCancelProgressiveRender(JNIEnv *, jclass, jlong render_ptr) {
+    auto *render = reinterpret_cast<ProgressiveRender *>(render_ptr);
+    if (render != nullptr) {
+        render->cancelled.store(true);
+    }
+}
+
+static void NativePage_nativeCloseProgressiveRender(JNIEnv *env, jclass, jlong render_ptr,
+                                                    jboolean page_open) {
+    runSafe(env, [&]() {
+        auto *render = reinterpret_cast<ProgressiveRender *>(render_ptr);
+        if (render == nullptr) return;
+        if (!page_open) {
+            // The page, and the render state PDFium hung off it, are already gone.
+            render->page = nullptr;
+        }
+        delete render;
+    });
+}
 
-        if (render_annot && form != nullptr) { // FPDFDOC_InitFormFillEnvironment can return null
-            // main's 5dfd985: pass `flags` (which already includes FPDF_ANNOT when render_annot), not FPDF_ANNOT
-            FPDF_FFLDraw(form, pdfBitmap, page, start_x, start_y, (int) draw_size_hor, (int) draw_size_ver, 0, flags);
-            FPDFDOC_ExitFormFillEnvironment(form);
+// A rectangle in whole pixels, right and bottom exclusive.
+struct PixelRect {
+    int left, top, right, bottom;
+};
+
+// Results of NativePage_nativeRenderThumbnail.
+const int THUMBNAIL_FAILED = -1;
+const int THUMBNAIL_RENDERED = 0;
+const int THUMBNAIL_EMBEDDED = 1;
+
+// Scales [thumbnail] - PDFium's decoded /Thumb image, gray or B, G, R ordered - to fill [info]'s bitmap, bilinearly,
+// pixel centres onto pixel centres. Each row is built as RGBX and then stored, or converted for RGB_565.
+static void scaleThumbnail(FPDF_BITMAP thumbnail, void *pixels, const AndroidBitmapInfo &info) {
+    int srcWidth = FPDFBitmap_GetWidth(thumbnail);
+    int srcHeight = FPDFBitmap_GetHeight(thumbnail);
+    int srcStride = FPDFBitmap_GetStride(thumbnail);
+    int format = FPDFBitmap_GetFormat(thumbnail);
+    int bytesPerPixel = format == FPDFBitmap_Gray ? 1 : format == FPDFBitmap_BGR ? 3 : 4;
+    auto *src = static_cast<const uint8_t *>(FPDFBitmap_GetBuffer(thumbnail));
+    int width = (int) info.width;
+    int height = (int) info.height;
+
+    // Source position of a destination pixel centre, in 16.16 fixed point, clamped to the image.
+    auto sourcePosition = [](int dst, int dstSize, int srcSize) {
+        double position = ((double) dst + 0.5) * srcSize / dstSize - 0.5;
+        position = std::min(std::max(position, 0.0), (double) (srcSize - 1));
+        return (uint32_t) (position * 65536.0);
+    };
+    // Channel 0, 1, 2 = red, green, blue of the pixel at [pixel].
+    auto channel = [bytesPerPixel](const uint8_t *pixel, int c) {
+        return (uint32_t) (bytesPerPixel == 1 ? pixel[0] : pixel[2 - c]);
+    };
+
+    std::vector<uint32_t> columns((size_t) width);
+    for (int x = 0; x < width; ++x) columns[x] = sourcePosition(x, width, srcWidth);
+    std::vector<uint8_t> row((size_t) width * 4);
+    bool dither = sDitherRgb565.load(std::memory_order_relaxed);
+
+    for (int y = 0; y < height; ++y) {
+        uint32_t sy = sourcePosition(y, height, srcHeight);
+        int y0 = (int) (sy >> 16);
+        int y1 = std::min(y0 + 1, srcHeight - 1);
+        uint64_t fy = sy & 0xFFFF;
+        const uint8_t *top = src + (size_t) y0 * srcStride;
+        const uint8_t *bottom = src + (size_t) y1 * srcStride;
+        for (int x = 0; x < width; ++x) {
+            int x0 = (int) (columns[x] >> 16);
+            int x1 = std::min(x0 + 1, srcWidth - 1);
+            uint64_t fx = columns[x] & 0xFFFF;
+            for (int c = 0; c < 3; ++c) {
+                uint64_t upper = channel(top + x0 * bytesPerPixel, c) * (65536 - fx) +
+                                 channel(top + x1 * bytesPerPixel, c) * fx;
+                uint64_t lower = channel(bottom + x0 * bytesPerPixel, c) * (65536 - fx) +
+                                 channel(bottom + x1 * bytesPerPixel, c) * fx;
+                row[x * 4 + c] = (uint8_t) ((upper * (65536 - fy) + lower * fy + (1ull << 31)) >> 32);
+            }
+            row[x * 4 + 3] = 0xFF;
+        }
+        auto *dst = static_cast<uint8_t *>(pixels) + (size_t) y * info.stride;
+        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
+            rowTo565(row.data(), 4, reinterpret_cast<uint16_t *>(dst), width, y, dither);
+        } else {
+            memcpy(dst, row.data(), row.size());
+        }
+    }
+}
+
+// Draws a thumbnail of [page] into the [info]-sized cell at [pixels], the page occupying the [pageRect] part of it
+// (cell coordinates) and [canvasColor] the rest. The page's embedded /Thumb image is scaled in when it has one and
+// [useEmbedded] is set; otherwise the page is rendered with smoothing and annotations off. A null [page] only fills
+// the canvas. Returns THUMBNAIL_EMBEDDED or THUMBNAIL_RENDERED.
+static int drawThumbnail(FPDF_PAGE page, void *pixels, const AndroidBitmapInfo &info, PixelRect pageRect,
+                         bool useEmbedded, int canvasColor, int pageBackgroundColor) {
+    ScopedBitmap thumbnail(page != nullptr && useEmbedded ? FPDFPage_GetThumbnailAsBitmap(page) : nullptr);
+    if (thumbnail != nullptr &&
+        (FPDFBitmap_GetWidth(thumbnail) <= 0 || FPDFBitmap_GetHeight(thumbnail) <= 0 ||
+         FPDFBitmap_GetFormat(thumbnail) == FPDFBitmap_Unknown)) {
+        thumbnail.bmp = nullptr;
+    }
+    bool embedded = thumbnail != nullptr;
+    int width = (int) info.width;
+    int pageWidth = pageRect.right - pageRect.left;
+    int pageHeight = pageRect.bottom - pageRect.top;
+    FS_RECTF cover = page != nullptr ? FS_RECTF{(float) pageRect.left, (float) pageRect.top,
+                                                (float) pageRect.right, (float) pageRect.bottom}
+                                     : FS_RECTF{0, 0, 0, 0};
+    int flags = baseRenderFlags() | FPDF_RENDER_NO_SMOOTHTEXT | FPDF_RENDER_NO_SMOOTHIMAGE |
+                FPDF_RENDER_NO_SMOOTHPATH;
+
+    // The embedded image is scaled straight into the pixels afterwards, so it only needs the canvas around it.
+    if (!embedded || canvasColor != 0) {
+        auto renderRows = [&](FPDF_BITMAP target, int top, int rows) {
+            FS_RECTF rowsCover = {cover.left, cover.top - (float) top, cover.right, cover.bottom - (float) top};
+            fillCanvasBorder(target, width, rows, rowsCover, canvasColor);
+            if (page == nullptr || embedded) return true;
+            FPDFBitmap_FillRect(target, pageRect.left, pageRect.top - top, pageWidth, pageHeight,
+                                pageBackgroundColor);
+            FPDF_RenderPageBitmap(target, page, pageRect.left, pageRect.top - top, pageWidth, pageHeight, 0, flags);
+            return true;
+        };
+        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
+            renderTo565InBands(pixels, info, renderRows);
+        } else {
+            ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx(width, (int) info.height, FPDFBitmap_BGRA, pixels,
+                                                       (int) info.stride));
+            renderRows(pdfBitmap, 0, (int) info.height);
+        }
+    }
+    if (embedded) {
+        int bytesPerPixel = info.format == ANDROID_BITMAP_FORMAT_RGB_565 ? 2 : 4;
+        AndroidBitmapInfo pageInfo = info;
+        pageInfo.width = (uint32_t) pageWidth;
+        pageInfo.height = (uint32_t) pageHeight;
+        scaleThumbnail(thumbnail, static_cast<uint8_t *>(pixels) + (size_t) pageRect.top * info.stride +
+                                  (size_t) pageRect.left * bytesPerPixel, pageInfo);
+    }
+    return embedded ? THUMBNAIL_EMBEDDED : THUMBNAIL_RENDERED;
+}
+
+// Fills [bitmap] with a thumbnail of the page: the page's embedded /Thumb image, scaled to the bitmap, when it has
+// one and [use_embedded] is set, otherwise the whole page rendered at the bitmap's size with smoothing and
+// annotations off. The bitmap should have the page's aspect ratio; the page is stretched to fill it.
+static jint NativePage_nativeRenderThumbnail(JNIEnv *env, jclass, jlong page_ptr, jobject bitmap,
+                                             jboolean use_embedded, jint pageBackgroundColor) {
+    return runSafe(env, (jint) THUMBNAIL_FAILED, [&]() {
+        auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        if (page == nullptr || bitmap == nullptr) {
+            LOGE("Render page pointers invalid");
+            return (jint) THUMBNAIL_FAILED;
+        }
+
+        AndroidBitmapInfo info;
+        int ret;
+        if ((ret = AndroidBitmap_getInfo(env, bitmap, &info)) < 0) {
+            LOGE("Fetching bitmap info failed: %s", strerror(ret * -1));
+            return (jint) THUMBNAIL_FAILED;
+        }
+        if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
+            info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
+            LOGE("Bitmap format must be RGBA_8888 or RGB_565");
+            return (jint) THUMBNAIL_FAILED;
         }
 
-        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
-            rgbBitmapTo565(tmp, sourceStride, addr, &info);
-            free(tmp);
+        void *addr;
+        if ((ret = AndroidBitmap_lockPixels(env, bitmap, &addr)) != 0) {
+            LOGE("Locking bitmap failed: %s", strerror(ret * -1));
+            return (jint) THUMBNAIL_FAILED;
         }
-
+        PixelRect pageRect = {0, 0, (int) info.width, (int) info.height};
+        jint result = drawThumbnail(page, addr, info, pageRect, use_embedded, 0, pageBackgroundColor);
         AndroidBitmap_unlockPixels(env, bitmap);
+        return result;
     });
 }
 
-static void NativePage_nativeRenderPageBitmapWithMatrix(JNIEnv *env, jclass,
-                                                                      jlong page_ptr,
-                                                                      jobject bitmap,
-                                                                      jfloatArray matrixValues,
-                                                                      jfloatArray clipRect,
-                                                                      jboolean render_annot,
-                                                                      jboolean,
-                                                                      jint canvasColor, jint pageBackgroundColor) {
-    runSafe(env, [&]() {
+static jboolean NativePage_nativeHasEmbeddedThumbnail(JNIEnv *env, jclass, jlong page_ptr) {
+    return runSafe(env, (jboolean) false, [&]() {
         auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        return (jboolean) (page != nullptr && FPDFPage_GetRawThumbnailData(page, nullptr, 0) > 0);
+    });
+}
 
-        if (page == nullptr || bitmap == nullptr) {
-            LOGE("Render page pointers invalid");
-            return;
+// Lays the pages [startIndex, startIndex + count) out in [cellWidth] x [cellHeight] cells, left to right and top to
+// bottom, across the [info]-sized atlas at [pixels], and draws each one's thumbnail centred in its cell at the
+// page's aspect ratio. [openPages] holds, per page, a handle the caller already has open, or 0 to load the page
+// just for the draw. Returns [left, top, right, bottom] of each page in atlas pixels; a page that does not fit in
+// the atlas, or fails to load, gets an empty rect.
+static std::vector<float> renderThumbnailAtlas(DocumentFile *doc, int startIndex, const jlong *openPages, int count,
+                                               void *pixels, const AndroidBitmapInfo &info, int cellWidth,
+                                               int cellHeight, bool useEmbedded, int canvasColor,
+                                               int pageBackgroundColor) {
+    std::vector<float> rects((size_t) count * 4, 0.0f);
+    if (cellWidth <= 0 || cellHeight <= 0) return rects;
+    int columns = (int) info.width / cellWidth;
+    int capacity = columns * ((int) info.height / cellHeight);
+    int bytesPerPixel = info.format == ANDROID_BITMAP_FORMAT_RGB_565 ? 2 : 4;
+    AndroidBitmapInfo cellInfo = info;
+    cellInfo.width = (uint32_t) cellWidth;
+    cellInfo.height = (uint32_t) cellHeight;
+
+    for (int i = 0; i < std::min(count, capacity); ++i) {
+        int cellX = (i % columns) * cellWidth;
+        int cellY = (i / columns) * cellHeight;
+        auto *cell = static_cast<uint8_t *>(pixels) + (size_t) cellY * info.stride + (size_t) cellX * bytesPerPixel;
+
+        auto page = reinterpret_cast<FPDF_PAGE>(openPages[i]);
+        bool loaded = false;
+        if (page == nullptr) {
+            page = FPDF_LoadPage(doc->pdfDocument, startIndex + i);
+            loaded = page != nullptr;
+        }
+        PixelRect pageRect = {0, 0, 0, 0};
+        if (page != nullptr) {
+            float pageWidth = FPDF_GetPageWidthF(page);
+            float pageHeight = FPDF_GetPageHeightF(page);
+            if (pageWidth > 0 && pageHeight > 0) {
+                float scale = std::min((float) cellWidth / pageWidth, (float) cellHeight / pageHeight);
+                int width = std::max(1, std::min(cellWidth, (int) lroundf(pageWidth * scale)));
+                int height = std::max(1, std::min(cellHeight, (int) lroundf(pageHeight * scale)));
+                pageRect.left = (cellWidth - width) / 2;
+                pageRect.top = (cellHeight - height) / 2;
+                pageRect.right = pageRect.left + width;
+                pageRect.bottom = pageRect.top + height;
+            }
+        }
+        bool drawn = pageRect.right > pageRect.left;
+        drawThumbnail(drawn ? page : nullptr, cell, cellInfo, pageRect, useEmbedded, canvasColor,
+                      pageBackgroundColor);
+        if (loaded) FPDF_ClosePage(page);
+
+        if (drawn) {
+            rects[i * 4] = (float) (cellX + pageRect.left);
+            rects[i * 4 + 1] = (float) (cellY + pageRect.top);
+            rects[i * 4 + 2] = (float) (cellX + pageRect.right);
+            rects[i * 4 + 3] = (float) (cellY + pageRect.bottom);
+        }
+    }
+    return rects;
+}
+
+static jfloatArray toFloatArray(JNIEnv *env, const std::vector<float> &values) {
+    jfloatArray result = env->NewFloatArray((jsize) values.size());
+    if (result != nullptr && !values.empty()) {
+        env->SetFloatArrayRegion(result, 0, (jsize) values.size(), values.data());
+    }
+    return result;
+}
+
+static jfloatArray NativeDocument_nativeRenderThumbnailAtlas(JNIEnv *env, jobject, jlong doc_ptr, jint start_index,
+                                                             jlongArray open_pages, jobject bitmap,
+                                                             jint cell_width, jint cell_height,
+                                                             jboolean use_embedded, jint canvasColor,
+                                                             jint pageBackgroundColor) {
+    return runSafe(env, (jfloatArray) nullptr, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        if (doc == nullptr || open_pages == nullptr || bitmap == nullptr) {
+            LOGE("Render atlas pointers invalid");
+            return (jfloatArray) nullptr;
         }
 
         AndroidBitmapInfo info;
         int ret;
         if ((ret = AndroidBitmap_getInfo(env, bitmap, &info)) < 0) {
             LOGE("Fetching bitmap info failed: %s", strerror(ret * -1));
-            return;
+            return (jfloatArray) nullptr;
         }
-
-        auto canvasHorSize = info.width;
-        auto canvasVerSize = info.height;
-
         if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
             info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
             LOGE("Bitmap format must be RGBA_8888 or RGB_565");
-            return;
+            return (jfloatArray) nullptr;
         }
 
+        int count = env->GetArrayLength(open_pages);
+        std::vector<jlong> pages((size_t) count);
+        env->GetLongArrayRegion(open_pages, 0, count, pages.data());
+
         void *addr;
         if ((ret = AndroidBitmap_lockPixels(env, bitmap, &addr)) != 0) {
             LOGE("Locking bitmap failed: %s", strerror(ret * -1));
-            return;
+            return (jfloatArray) nullptr;
         }
+        std::vector<float> rects = renderThumbnailAtlas(doc, start_index, pages.data(), count, addr, info,
+                                                        cell_width, cell_height, use_embedded, canvasColor,
+                                                        pageBackgroundColor);
+        AndroidBitmap_unlockPixels(env, bitmap);
+        return toFloatArray(env, rects);
+    });
+}
 
-        void *tmp;
-        int format;
-        int sourceStride;
-        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
-            tmp = malloc(canvasVerSize * canvasHorSize * sizeof(rgb));
-            sourceStride = (int) (canvasHorSize * sizeof(rgb));
-            format = FPDFBitmap_BGR;
-        } else {
-            tmp = addr;
-            sourceStride = (int) info.stride;
-            format = FPDFBitmap_BGRA;
+static jfloatArray NativeDocument_nativeRenderThumbnailAtlasToBuffer(JNIEnv *env, jobject, jlong doc_ptr,
+                                                                     jint start_index, jlongArray open_pages,
+                                                                     jobject buffer, jint width, jint height,
+                                                                     jint cell_width, jint cell_height,
+                                                                     jboolean use_embedded, jint canvasColor,
+                                                                     jint pageBackgroundColor) {
+    return runSafe(env, (jfloatArray) nullptr, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        if (doc == nullptr || open_pages == nullptr || buffer == nullptr || width <= 0 || height <= 0) {
+            LOGE("Render atlas pointers invalid");
+            return (jfloatArray) nullptr;
+        }
+        void *addr = env->GetDirectBufferAddress(buffer);
+        if (addr == nullptr || env->GetDirectBufferCapacity(buffer) < (jlong) width * height * 4) {
+            LOGE("Atlas buffer must be a direct ByteBuffer of at least width * height * 4 bytes");
+            return (jfloatArray) nullptr;
         }
 
-        ScopedBitmap pdfBitmap(FPDFBitmap_CreateEx((int) canvasHorSize, (int) canvasVerSize,
-                                                    format, tmp, sourceStride));
+        AndroidBitmapInfo info = {};
+        info.width = (uint32_t) width;
+        info.height = (uint32_t) height;
+        info.stride = (uint32_t) width * 4;
+        info.format = ANDROID_BITMAP_FORMAT_RGBA_8888;
 
-        /*LOGD("Start X: %d", startX);
-        LOGD("Start Y: %d", startY);
-        LOGD("Canvas Hor: %d", canvasHorSize);
-        LOGD("Canvas Ver: %d", canvasVerSize);
-        LOGD("Draw Hor: %d", drawSizeHor);
-        LOGD("Draw Ver: %d", drawSizeVer);*/
+        int count = env->GetArrayLength(open_pages);
+        std::vector<jlong> pages((size_t) count);
+        env->GetLongArrayRegion(open_pages, 0, count, pages.data());
 
-        int flags = FPDF_REVERSE_BYTE_ORDER;
-        if (render_annot) {
-            flags |= FPDF_ANNOT;
-        }
+        std::vector<float> rects = renderThumbnailAtlas(doc, start_index, pages.data(), count, addr, info,
+                                                        cell_width, cell_height, use_embedded, canvasColor,
+                                                        pageBackgroundColor);
+        return toFloatArray(env, rects);
+    });
+}
 
-        // Coverage-aware fill + render, the same shared helpers as the other paths: canvasColor only in the gaps
-        // around the page footprint (the clip), pageBackgroundColor to the footprint, page on top. (This path
-        // previously filled the WHOLE bitmap with pageBackgroundColor and ignored canvasColor.)
-        auto clipRectFloats = env->GetFloatArrayElements(clipRect, nullptr);
-        fillCanvasGaps(pdfBitmap, (int) canvasHorSize, (int) canvasVerSize, env, clipRectFloats, 1, &page_ptr,
-                       canvasColor);
-        auto clip = floatArrayToRect(env, clipRectFloats, 0);
-        auto matrix = floatArrayToMatrix(env, matrixValues);
-        fillAndRenderPage(pdfBitmap, (int) canvasHorSize, (int) canvasVerSize, page, clip, matrix,
-                          pageBackgroundColor, flags);
-        env->ReleaseFloatArrayElements(clipRect, (jfloat *) clipRectFloats, JNI_ABORT);
+// Adds a hit's rect to the rects after `first`, extending the last one instead when the two sit on
+// the same line and touch, so a hit spanning several text objects highlights as one box per line.
+static void appendMergedRect(std::vector<float> &out, size_t first, float left, float top, float right,
+                             float bottom) {
+    if (out.size() >= first + 4) {
+        float *last = &out[out.size() - 4];
+        float overlap = std::min(top, last[1]) - std::max(bottom, last[3]);
+        float height = std::min(top - bottom, last[1] - last[3]);
+        if (height > 0 && overlap >= height / 2 && left <= last[2] + height && right >= last[0] - height) {
+            last[0] = std::min(last[0], left);
+            last[1] = std::max(last[1], top);
+            last[2] = std::max(last[2], right);
+            last[3] = std::min(last[3], bottom);
+            return;
+        }
+    }
+    out.insert(out.end(), {left, top, right, bottom});
+}
 
-        if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
-            rgbBitmapTo565(tmp, sourceStride, addr, &info);
-            free(tmp);
+// Appends every match of `query` on one text page to `out` as its page index, first char, char count and
+// rect count, followed by left, top, right, bottom for each rect.
+static void searchTextPage(FPDF_TEXTPAGE textPage, int pageIndex, FPDF_WIDESTRING query, int flags,
+                           std::vector<float> &out) {
+    FPDF_SCHHANDLE find = FPDFText_FindStart(textPage, query, flags, 0);
+    if (find == nullptr) return;
+    while (FPDFText_FindNext(find)) {
+        int start = FPDFText_GetSchResultIndex(find);
+        int count = FPDFText_GetSchCount(find);
+        size_t header = out.size();
+        out.insert(out.end(), {(float) pageIndex, (float) start, (float) count, 0});
+        size_t first = out.size();
+        int rectCount = FPDFText_CountRects(textPage, start, count);
+        for (int i = 0; i < rectCount; i++) {
+            double left, top, right, bottom;
+            if (!FPDFText_GetRect(textPage, i, &left, &top, &right, &bottom)) continue;
+            appendMergedRect(out, first, (float) left, (float) top, (float) right, (float) bottom);
         }
+        out[header + 3] = (float) ((out.size() - first) / 4);
+    }
+    FPDFText_FindClose(find);
+}
 
-        AndroidBitmap_unlockPixels(env, bitmap);
+static jfloatArray NativeDocument_nativeSearchPages(JNIEnv *env, jobject, jlong doc_ptr, jint first_page,
+                                                    jlongArray text_pages, jstring query, jint flags) {
+    return runSafe(env, (jfloatArray) nullptr, [&]() {
+        auto *doc = reinterpret_cast<DocumentFile *>(doc_ptr);
+        if (doc == nullptr || text_pages == nullptr || query == nullptr) {
+            LOGE("Search pointers invalid");
+            return (jfloatArray) nullptr;
+        }
+        const jchar *raw = env->GetStringChars(query, nullptr);
+        if (raw == nullptr) return (jfloatArray) nullptr;
+        std::u16string what(raw, raw + env->GetStringLength(query));
+        env->ReleaseStringChars(query, raw);
+
+        int count = env->GetArrayLength(text_pages);
+        std::vector<jlong> open((size_t) count);
+        env->GetLongArrayRegion(text_pages, 0, count, open.data());
+
+        std::vector<float> hits;
+        for (int i = 0; i < count; i++) {
+            // Search the text page the caller already has open, or load one just for this.
+            auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(open[i]);
+            FPDF_PAGE page = nullptr;
+            if (textPage == nullptr) {
+                page = FPDF_LoadPage(doc->pdfDocument, first_page + i);
+                textPage = page == nullptr ? nullptr : FPDFText_LoadPage(page);
+            }
+            if (textPage != nullptr) {
+                searchTextPage(textPage, first_page + i, (FPDF_WIDESTRING) what.c_str(), flags, hits);
+            }
+            if (page != nullptr) {
+                if (textPage != nullptr) FPDFText_ClosePage(textPage);
+                FPDF_ClosePage(page);
+            }
+        }
+        return toFloatArray(env, hits);
     });
 }
+
 static jintArray NativePage_nativeGetPageSizeByIndex(JNIEnv *env, jclass,
                                                               jlong doc_ptr, jint page_index,
                                                               jint dpi) {
@@ -1831,7 +4266,183 @@ static jfloatArray NativePage_nativeDeviceCoordsToPage(JNIEnv *env, jclass,
     });
 }
 
-static void closeTextPageInternal(jlong textPagePtr) { FPDFText_ClosePage(reinterpret_cast<FPDF_TEXTPAGE>(textPagePtr)); }
+// Hit testing against a text page without scanning it. FPDFText_GetCharIndexAtPos and the link
+// lookups walk every character or link on each call, which stutters on dense pages when every
+// drag event of a selection asks again. A uniform grid over the boxes is built the first time a
+// text page is hit-tested, kept until the text page is closed, and answers each query from the
+// few cells around the point. Boxes are in page coordinates, top above bottom.
+class RectGrid {
+public:
+    void build(const std::vector<FS_RECTF> &rects) {
+        this->rects = &rects;
+        stamps.assign(rects.size(), 0);
+        stamp = 0;
+        bool any = false;
+        for (const FS_RECTF &r: rects) {
+            if (isEmpty(r)) continue;
+            if (!any) {
+                bounds = r;
+                any = true;
+            } else {
+                bounds.left = std::min(bounds.left, r.left);
+                bounds.right = std::max(bounds.right, r.right);
+                bounds.top = std::max(bounds.top, r.top);
+                bounds.bottom = std::min(bounds.bottom, r.bottom);
+            }
+        }
+        if (!any) {
+            cols = rows = 0;
+            return;
+        }
+        float width = std::max(bounds.right - bounds.left, 1.0f);
+        float height = std::max(bounds.top - bounds.bottom, 1.0f);
+        // About TARGET_PER_CELL boxes a cell, with cells as square as the page allows.
+        double cells = std::max(1.0, (double) rects.size() / TARGET_PER_CELL);
+        cols = std::clamp((int) std::ceil(std::sqrt(cells * width / height)), 1, MAX_CELLS_PER_SIDE);
+        rows = std::clamp((int) std::ceil(cells / cols), 1, MAX_CELLS_PER_SIDE);
+        cellWidth = width / (float) cols;
+        cellHeight = height / (float) rows;
+
+        // Compressed rows: cellStart[c]..cellStart[c + 1] indexes the boxes overlapping cell c.
+        cellStart.assign(cols * rows + 1, 0);
+        forEachCell(rects, [&](int, int cell) { cellStart[cell + 1]++; });
+        for (int c = 0; c < cols * rows; c++) cellStart[c + 1] += cellStart[c];
+        cellItems.assign(cellStart.back(), 0);
+        std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        forEachCell(rects, [&](int item, int cell) { cellItems[fill[cell]++] = item; });
+    }
+
+    // Calls [visit] once with the index of each box overlapping [area], in no particular order.
+    template<typename Visit>
+    void query(const FS_RECTF &area, Visit visit) {
+        if (cols == 0) return;
+        int c0, c1, r0, r1;
+        if (!cellRange(area, c0, c1, r0, r1)) return;
+        if (++stamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+        for (int row = r0; row <= r1; row++) {
+            for (int col = c0; col <= c1; col++) {
+                int cell = row * cols + col;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                    int item = cellItems[k];
+                    // Boxes spanning several cells are seen once per query.
+                    if (stamps[item] == stamp) continue;
+                    stamps[item] = stamp;
+                    const FS_RECTF &r = (*rects)[item];
+                    if (r.left <= area.right && r.right >= area.left && r.bottom <= area.top && r.top >= area.bottom) {
+                        visit(item);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t bytes() const {
+        return (cellStart.size() + cellItems.size()) * sizeof(int) + stamps.size() * sizeof(unsigned int);
+    }
+
+private:
+    static constexpr double TARGET_PER_CELL = 4.0;
+    static constexpr int MAX_CELLS_PER_SIDE = 256;
+
+    const std::vector<FS_RECTF> *rects = nullptr;
+    FS_RECTF bounds = {0, 0, 0, 0};
+    int cols = 0;
+    int rows = 0;
+    float cellWidth = 1;
+    float cellHeight = 1;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<unsigned int> stamps;
+    unsigned int stamp = 0;
+
+    static bool isEmpty(const FS_RECTF &r) { return r.right < r.left || r.top < r.bottom; }
+
+    bool cellRange(const FS_RECTF &area, int &c0, int &c1, int &r0, int &r1) const {
+        if (area.right < bounds.left || area.left > bounds.right || area.top < bounds.bottom || area.bottom > bounds.top) {
+            return false;
+        }
+        c0 = std::clamp((int) ((area.left - bounds.left) / cellWidth), 0, cols - 1);
+        c1 = std::clamp((int) ((area.right - bounds.left) / cellWidth), 0, cols - 1);
+        r0 = std::clamp((int) ((area.bottom - bounds.bottom) / cellHeight), 0, rows - 1);
+        r1 = std::clamp((int) ((area.top - bounds.bottom) / cellHeight), 0, rows - 1);
+        return true;
+    }
+
+    template<typename Each>
+    void forEachCell(const std::vector<FS_RECTF> &all, Each each) const {
+        for (int item = 0; item < (int) all.size(); item++) {
+            int c0, c1, r0, r1;
+            if (isEmpty(all[item]) || !cellRange(all[item], c0, c1, r0, r1)) continue;
+            for (int row = r0; row <= r1; row++) {
+                for (int col = c0; col <= c1; col++) each(item, row * cols + col);
+            }
+        }
+    }
+};
+
+static const FS_RECTF EMPTY_HIT_BOX = {1, 0, 0, 1};
+
+struct TextHitIndex {
+    // Characters, by page index, with the boxes FPDFText_GetCharBox gives them, zero-sized ones included as
+    // FPDFText_GetCharIndexAtPos sees them; a character without a box gets an empty one the grid leaves out.
+    std::vector<FS_RECTF> charBoxes;
+    RectGrid chars;
+
+    // Link annotations of the page the links were last indexed for.
+    FPDF_PAGE linkPage = nullptr;
+    std::vector<FPDF_LINK> links;
+    std::vector<FS_RECTF> linkBoxes;
+    RectGrid linkGrid;
+
+    // Web links found in the text, one box per rectangle with the link it belongs to.
+    FPDF_PAGELINK webLinks = nullptr;
+    bool webLinksLoaded = false;
+    std::vector<int> webLinkOwners;
+    std::vector<FS_RECTF> webLinkBoxes;
+    RectGrid webLinkGrid;
+
+    ~TextHitIndex() {
+        if (webLinks != nullptr) FPDFLink_CloseWebLinks(webLinks);
+    }
+
+    size_t bytes() const {
+        return sizeof(TextHitIndex) + (charBoxes.size() + linkBoxes.size() + webLinkBoxes.size()) * sizeof(FS_RECTF) +
+               links.size() * sizeof(FPDF_LINK) + webLinkOwners.size() * sizeof(int) +
+               chars.bytes() + linkGrid.bytes() + webLinkGrid.bytes();
+    }
+};
+
+// Guarded by the PDFium lock, like the text pages they index.
+static std::unordered_map<FPDF_TEXTPAGE, std::unique_ptr<TextHitIndex>> sTextHitIndexes;
+
+static TextHitIndex &textHitIndex(FPDF_TEXTPAGE textPage) {
+    auto &slot = sTextHitIndexes[textPage];
+    if (slot == nullptr) {
+        slot = std::make_unique<TextHitIndex>();
+        int n = std::max(FPDFText_CountChars(textPage), 0);
+        slot->charBoxes.resize(n);
+        for (int i = 0; i < n; i++) {
+            double left = 0, right = 0, bottom = 0, top = 0;
+            if (!FPDFText_GetCharBox(textPage, i, &left, &right, &bottom, &top)) {
+                slot->charBoxes[i] = EMPTY_HIT_BOX;
+                continue;
+            }
+            slot->charBoxes[i] = {(float) std::min(left, right), (float) std::max(top, bottom),
+                                  (float) std::max(left, right), (float) std::min(top, bottom)};
+        }
+        slot->chars.build(slot->charBoxes);
+    }
+    return *slot;
+}
+
+static void closeTextPageInternal(jlong textPagePtr) {
+    auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(textPagePtr);
+    sTextHitIndexes.erase(textPage);
+    FPDFText_ClosePage(textPage);
+}
 
 static void NativeTextPage_nativeCloseTextPage(JNIEnv *env, jclass,
                                                              jlong page_ptr) {
@@ -1848,6 +4459,23 @@ static jint NativeTextPage_nativeTextCountChars(JNIEnv *env, jclass,
     });
 }
 
+// A text page keeps a record per character (its code, font, origin and box) plus the page text,
+// so it grows with the character count and stays small next to a parsed page.
+static const jlong kTextPageBaseBytes = 4 * 1024;
+static const jlong kTextCharBytes = 128;
+
+static jlong NativeTextPage_nativeGetTextPageMemoryEstimate(JNIEnv *env, jclass,
+                                                            jlong text_page_ptr) {
+    return runSafe(env, (jlong) -1, [&]() {
+        auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr);
+        int count = FPDFText_CountChars(textPage);
+        jlong bytes = kTextPageBaseBytes + (jlong) std::max(count, 0) * kTextCharBytes;
+        auto it = sTextHitIndexes.find(textPage);
+        if (it != sTextHitIndexes.end()) bytes += (jlong) it->second->bytes();
+        return bytes;
+    });
+}
+
 static jint NativeTextPage_nativeTextGetText(JNIEnv *env, jclass,
                                                            jlong text_page_ptr, jint start_index,
                                                            jint count, jshortArray result) {
@@ -1936,6 +4564,88 @@ static jdoubleArray NativeTextPage_nativeTextGetCharBox(JNIEnv *env, jclass,
     });
 }
 
+// Layout of the arrays nativeTextGetCharGeometry fills, see io.legere.pdfiumandroid.api.CharGeometry.
+static const int CHAR_BOX_VALUES = 4;
+static const int CHAR_ORIGIN_VALUES = 2;
+static const jint CHAR_FLAG_GENERATED = 1;
+static const jint CHAR_FLAG_HYPHEN = 2;
+static const jint CHAR_FLAG_UNICODE_MAP_ERROR = 4;
+
+// Fills one array per attribute for up to [count] characters from [start_index], in a single crossing instead of
+// several per character. Returns how many characters were written, fewer than asked for at the end of the page, or
+// -1 if the range is out of bounds or an array is too small for it.
+static jint NativeTextPage_nativeTextGetCharGeometry(JNIEnv *env, jclass, jlong text_page_ptr,
+                                                     jint start_index, jint count,
+                                                     jintArray unicodes, jfloatArray loose_boxes,
+                                                     jfloatArray tight_boxes, jfloatArray origins,
+                                                     jfloatArray angles, jfloatArray font_sizes,
+                                                     jintArray flags) {
+    return runSafe(env, -1, [&]() {
+        auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr);
+        int total = FPDFText_CountChars(textPage);
+        if (start_index < 0 || count < 0 || start_index > total) return -1;
+        int n = std::min(count, total - start_index);
+        if (env->GetArrayLength(unicodes) < n || env->GetArrayLength(angles) < n ||
+            env->GetArrayLength(font_sizes) < n || env->GetArrayLength(flags) < n ||
+            env->GetArrayLength(loose_boxes) < n * CHAR_BOX_VALUES ||
+            env->GetArrayLength(tight_boxes) < n * CHAR_BOX_VALUES ||
+            env->GetArrayLength(origins) < n * CHAR_ORIGIN_VALUES) {
+            return -1;
+        }
+        if (n == 0) return 0;
+
+        std::vector<jint> unicodeData(n);
+        std::vector<jfloat> looseData(n * CHAR_BOX_VALUES);
+        std::vector<jfloat> tightData(n * CHAR_BOX_VALUES);
+        std::vector<jfloat> originData(n * CHAR_ORIGIN_VALUES);
+        std::vector<jfloat> angleData(n);
+        std::vector<jfloat> fontSizeData(n);
+        std::vector<jint> flagData(n);
+
+        for (int i = 0; i < n; i++) {
+            int index = start_index + i;
+            unicodeData[i] = (jint) FPDFText_GetUnicode(textPage, index);
+
+            FS_RECTF loose = {0, 0, 0, 0};
+            FPDFText_GetLooseCharBox(textPage, index, &loose);
+            looseData[i * CHAR_BOX_VALUES] = loose.left;
+            looseData[i * CHAR_BOX_VALUES + 1] = loose.top;
+            looseData[i * CHAR_BOX_VALUES + 2] = loose.right;
+            looseData[i * CHAR_BOX_VALUES + 3] = loose.bottom;
+
+            double left = 0, right = 0, bottom = 0, top = 0;
+            FPDFText_GetCharBox(textPage, index, &left, &right, &bottom, &top);
+            tightData[i * CHAR_BOX_VALUES] = (jfloat) left;
+            tightData[i * CHAR_BOX_VALUES + 1] = (jfloat) top;
+            tightData[i * CHAR_BOX_VALUES + 2] = (jfloat) right;
+            tightData[i * CHAR_BOX_VALUES + 3] = (jfloat) bottom;
+
+            double x = 0, y = 0;
+            FPDFText_GetCharOrigin(textPage, index, &x, &y);
+            originData[i * CHAR_ORIGIN_VALUES] = (jfloat) x;
+            originData[i * CHAR_ORIGIN_VALUES + 1] = (jfloat) y;
+
+            angleData[i] = FPDFText_GetCharAngle(textPage, index);
+            fontSizeData[i] = (jfloat) FPDFText_GetFontSize(textPage, index);
+
+            jint charFlags = 0;
+            if (FPDFText_IsGenerated(textPage, index) == 1) charFlags |= CHAR_FLAG_GENERATED;
+            if (FPDFText_IsHyphen(textPage, index) == 1) charFlags |= CHAR_FLAG_HYPHEN;
+            if (FPDFText_HasUnicodeMapError(textPage, index) == 1) charFlags |= CHAR_FLAG_UNICODE_MAP_ERROR;
+            flagData[i] = charFlags;
+        }
+
+        env->SetIntArrayRegion(unicodes, 0, n, unicodeData.data());
+        env->SetFloatArrayRegion(loose_boxes, 0, n * CHAR_BOX_VALUES, looseData.data());
+        env->SetFloatArrayRegion(tight_boxes, 0, n * CHAR_BOX_VALUES, tightData.data());
+        env->SetFloatArrayRegion(origins, 0, n * CHAR_ORIGIN_VALUES, originData.data());
+        env->SetFloatArrayRegion(angles, 0, n, angleData.data());
+        env->SetFloatArrayRegion(font_sizes, 0, n, fontSizeData.data());
+        env->SetIntArrayRegion(flags, 0, n, flagData.data());
+        return n;
+    });
+}
+
 static jint NativeTextPage_nativeTextGetCharIndexAtPos(JNIEnv *env, jclass,
                                                                      jlong text_page_ptr, jdouble x,
                                                                      jdouble y, jdouble x_tolerance,
@@ -1947,6 +4657,161 @@ static jint NativeTextPage_nativeTextGetCharIndexAtPos(JNIEnv *env, jclass,
     });
 }
 
+// Same answer as FPDFText_GetCharIndexAtPos from the text page's hit index, following CPDF_TextPage::GetIndexAtPos:
+// the first character whose box holds the point; or else, when a tolerance is positive, of the characters whose box
+// widened by half the tolerance on each side holds it, the first with the smallest sum of the distances from the
+// point to the box's nearest vertical and nearest horizontal edge; or -1.
+static jint NativeTextPage_nativeTextHitTestChar(JNIEnv *env, jclass, jlong text_page_ptr, jdouble x, jdouble y,
+                                                 jdouble x_tolerance, jdouble y_tolerance) {
+    return runSafe(env, -1, [&]() {
+        TextHitIndex &index = textHitIndex(reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr));
+        // PDFium takes the point and tolerances as floats.
+        auto px = (float) x;
+        auto py = (float) y;
+        auto halfWidth = (float) x_tolerance / 2;
+        auto halfHeight = (float) y_tolerance / 2;
+        bool useTolerance = x_tolerance > 0 || y_tolerance > 0;
+        FS_RECTF area = {px - std::abs(halfWidth), py + std::abs(halfHeight),
+                         px + std::abs(halfWidth), py - std::abs(halfHeight)};
+        int inside = -1;
+        int nearest = -1;
+        double nearestDistance = 10000;
+        index.chars.query(area, [&](int i) {
+            const FS_RECTF &box = index.charBoxes[i];
+            if (px >= box.left && px <= box.right && py >= box.bottom && py <= box.top) {
+                if (inside < 0 || i < inside) inside = i;
+                return;
+            }
+            if (!useTolerance) return;
+            // The widened box, normalized as CFX_FloatRect::Contains does should a negative tolerance flip it.
+            float left = box.left - halfWidth;
+            float right = box.right + halfWidth;
+            float bottom = box.bottom - halfHeight;
+            float top = box.top + halfHeight;
+            if (px < std::min(left, right) || px > std::max(left, right) ||
+                py < std::min(bottom, top) || py > std::max(bottom, top)) {
+                return;
+            }
+            double distance = std::min(std::fabs((double) px - box.left), std::fabs((double) px - box.right)) +
+                              std::min(std::fabs((double) py - box.bottom), std::fabs((double) py - box.top));
+            if (distance < nearestDistance || (distance == nearestDistance && nearest >= 0 && i < nearest)) {
+                nearest = i;
+                nearestDistance = distance;
+            }
+        });
+        return (jint) (inside >= 0 ? inside : nearest);
+    });
+}
+
+// The characters whose boxes overlap a rectangle, as the range {start, count} from the first of
+// them to the last, or {-1, 0} if there are none.
+static jintArray NativeTextPage_nativeTextHitTestCharRange(JNIEnv *env, jclass, jlong text_page_ptr,
+                                                           jfloat left, jfloat top, jfloat right, jfloat bottom) {
+    return runSafe(env, (jintArray) nullptr, [&]() {
+        TextHitIndex &index = textHitIndex(reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr));
+        FS_RECTF area = {std::min(left, right), std::max(top, bottom), std::max(left, right), std::min(top, bottom)};
+        int first = -1;
+        int last = -1;
+        index.chars.query(area, [&](int i) {
+            if (first < 0 || i < first) first = i;
+            if (i > last) last = i;
+        });
+        jint buffer[] = {first, first < 0 ? 0 : last - first + 1};
+        jintArray retVal = env->NewIntArray(2);
+        if (retVal == nullptr) {
+            return (jintArray) nullptr;
+        }
+        env->SetIntArrayRegion(retVal, 0, 2, buffer);
+        return retVal;
+    });
+}
+
+// The link annotation of [page_ptr] under a point, or 0. The text page must belong to the page;
+// its links are indexed the first time they are asked for.
+static jlong NativeTextPage_nativeTextHitTestLink(JNIEnv *env, jclass, jlong text_page_ptr, jlong page_ptr,
+                                                  jdouble x, jdouble y) {
+    return runSafe(env, (jlong) 0, [&]() {
+        TextHitIndex &index = textHitIndex(reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr));
+        auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        if (index.linkPage != page) {
+            index.linkPage = page;
+            index.links.clear();
+            index.linkBoxes.clear();
+            int pos = 0;
+            FPDF_LINK link;
+            while (FPDFLink_Enumerate(page, &pos, &link)) {
+                FS_RECTF box = EMPTY_HIT_BOX;
+                if (!FPDFLink_GetAnnotRect(link, &box)) box = EMPTY_HIT_BOX;
+                index.links.push_back(link);
+                index.linkBoxes.push_back(box);
+            }
+            index.linkGrid.build(index.linkBoxes);
+        }
+        FS_RECTF point = {(float) x, (float) y, (float) x, (float) y};
+        int hit = -1;
+        // Annotation rects may list their corners either way round; FPDFLink_GetAnnotRect
+        // normalizes them, so the first in page order wins, as FPDFLink_GetLinkAtPoint's would.
+        index.linkGrid.query(point, [&](int i) {
+            if (hit < 0 || i < hit) hit = i;
+        });
+        return hit < 0 ? (jlong) 0 : reinterpret_cast<jlong>(index.links[hit]);
+    });
+}
+
+// The web link in the page text under a point, as {link index, left, top, right, bottom} of the
+// rectangle hit, or null. The index is that of FPDFLink_LoadWebLinks on the same text page.
+static jfloatArray NativeTextPage_nativeTextHitTestWebLink(JNIEnv *env, jclass, jlong text_page_ptr,
+                                                           jdouble x, jdouble y) {
+    return runSafe(env, (jfloatArray) nullptr, [&]() {
+        auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr);
+        TextHitIndex &index = textHitIndex(textPage);
+        if (!index.webLinksLoaded) {
+            index.webLinksLoaded = true;
+            index.webLinks = FPDFLink_LoadWebLinks(textPage);
+            int count = index.webLinks == nullptr ? 0 : FPDFLink_CountWebLinks(index.webLinks);
+            for (int link = 0; link < count; link++) {
+                int rects = FPDFLink_CountRects(index.webLinks, link);
+                for (int r = 0; r < rects; r++) {
+                    double left, top, right, bottom;
+                    if (!FPDFLink_GetRect(index.webLinks, link, r, &left, &top, &right, &bottom)) continue;
+                    index.webLinkOwners.push_back(link);
+                    index.webLinkBoxes.push_back({(float) left, (float) top, (float) right, (float) bottom});
+                }
+            }
+            index.webLinkGrid.build(index.webLinkBoxes);
+        }
+        FS_RECTF point = {(float) x, (float) y, (float) x, (float) y};
+        int hit = -1;
+        index.webLinkGrid.query(point, [&](int i) {
+            if (hit < 0 || i < hit) hit = i;
+        });
+        if (hit < 0) return (jfloatArray) nullptr;
+        const FS_RECTF &box = index.webLinkBoxes[hit];
+        jfloat buffer[] = {(jfloat) index.webLinkOwners[hit], box.left, box.top, box.right, box.bottom};
+        jfloatArray retVal = env->NewFloatArray(5);
+        if (retVal == nullptr) {
+            return (jfloatArray) nullptr;
+        }
+        env->SetFloatArrayRegion(retVal, 0, 5, buffer);
+        return retVal;
+    });
+}
+
+// The URL of web link [link_index] of the text page's hit index, or null.
+static jstring NativeTextPage_nativeTextGetWebLinkURL(JNIEnv *env, jclass, jlong text_page_ptr, jint link_index) {
+    return runSafe(env, (jstring) nullptr, [&]() {
+        auto it = sTextHitIndexes.find(reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr));
+        if (it == sTextHitIndexes.end() || it->second->webLinks == nullptr) return (jstring) nullptr;
+        FPDF_PAGELINK webLinks = it->second->webLinks;
+        int length = FPDFLink_GetURL(webLinks, link_index, nullptr, 0);
+        if (length <= 0) return (jstring) nullptr;
+        std::vector<unsigned short> buffer(length);
+        FPDFLink_GetURL(webLinks, link_index, buffer.data(), length);
+        // length counts the terminating NUL.
+        return env->NewString(reinterpret_cast<const jchar *>(buffer.data()), length - 1);
+    });
+}
+
 static jint NativeTextPage_nativeTextCountRects(JNIEnv *env, jclass,
                                                               jlong text_page_ptr, jint start_index,
                                                               jint count) {
@@ -2394,10 +5259,12 @@ static jfloatArray NativeTextPage_nativeTextGetRectsFloat(JNIEnv *env, jclass cl
         // Get the number of rectangles in the range
         int rectCount = FPDFText_CountRects(textPage, start, length);
 
-        // Get the rectangles
+        // Get the rectangles. FPDFText_GetRect indexes the rects the last FPDFText_CountRects
+        // computed, so j restarts at 0 for every range; the lock keeps another call from
+        // replacing them in between.
         for (int j = 0; j < rectCount; ++j) {
             double left, top, right, bottom;
-            FPDFText_GetRect(textPage, j, &left, &top, &right, &bottom);
+            if (!FPDFText_GetRect(textPage, j, &left, &top, &right, &bottom)) continue;
 
             // Add the rectangle to the data vector (left, top, right, bottom)
             data.push_back((float)left);
@@ -2426,6 +5293,195 @@ static jfloatArray NativeTextPage_nativeTextGetRectsFloat(JNIEnv *env, jclass cl
 
 }
 
+// Word and line segmentation of a text page, walking its characters once. Words follow a subset of
+// the Unicode word-break rules (UAX #29): runs of letters and digits, joined across an apostrophe,
+// full stop or colon between letters and a comma or full stop between digits, with each ideograph
+// its own word and spaces and punctuation belonging to no word. Lines break at the line breaks
+// PDFium generates and wherever a character leaves the vertical extent of the one before it or
+// jumps back to the left of it, so a word never spans two lines and has a single rectangle. Each
+// word is WORD_VALUES floats, in the layout io.legere.pdfiumandroid.api.PageWords reads.
+static const int WORD_VALUES = 8;
+static const int WORD_FLAG_HYPHENATED = 1;
+
+enum class WordCharClass { SPACE, PUNCTUATION, IDEOGRAPH, LETTER, DIGIT };
+
+static WordCharClass classifyWordChar(unsigned int u) {
+    if (u <= 0x20 || (u >= 0x7F && u <= 0xA0) || u == 0x1680 || (u >= 0x2000 && u <= 0x200B) ||
+        u == 0x2028 || u == 0x2029 || u == 0x202F || u == 0x205F || u == 0x3000 || u == 0xFEFF ||
+        (u >= 0xFFFE && u <= 0xFFFF)) {
+        return WordCharClass::SPACE;
+    }
+    if ((u >= '0' && u <= '9') || (u >= 0x0660 && u <= 0x0669) || (u >= 0x06F0 && u <= 0x06F9) ||
+        (u >= 0x0966 && u <= 0x096F) || (u >= 0xFF10 && u <= 0xFF19)) {
+        return WordCharClass::DIGIT;
+    }
+    if ((u >= 0x3040 && u <= 0x309F) || (u >= 0x3400 && u <= 0x4DBF) || (u >= 0x4E00 && u <= 0x9FFF) ||
+        (u >= 0xF900 && u <= 0xFAFF) || (u >= 0x20000 && u <= 0x2FFFF) || (u >= 0x3005 && u <= 0x3007)) {
+        return WordCharClass::IDEOGRAPH;
+    }
+    if ((u >= 0x21 && u <= 0x2F) || (u >= 0x3A && u <= 0x40) || (u >= 0x5B && u <= 0x60) ||
+        (u >= 0x7B && u <= 0x7E) || (u >= 0xA1 && u <= 0xBF && u != 0xAA && u != 0xB5 && u != 0xBA) ||
+        u == 0xD7 || u == 0xF7 || (u >= 0x2010 && u <= 0x2027) || (u >= 0x2030 && u <= 0x205E) ||
+        (u >= 0x20A0 && u <= 0x20CF) || (u >= 0x2190 && u <= 0x23FF) || (u >= 0x2500 && u <= 0x27BF) ||
+        (u >= 0x3001 && u <= 0x3003) || (u >= 0x3008 && u <= 0x3020) || u == 0x30FB ||
+        (u >= 0xFE30 && u <= 0xFE6F) || (u >= 0xFF01 && u <= 0xFF0F) || (u >= 0xFF1A && u <= 0xFF20) ||
+        (u >= 0xFF3B && u <= 0xFF40) || (u >= 0xFF5B && u <= 0xFF65)) {
+        return WordCharClass::PUNCTUATION;
+    }
+    return WordCharClass::LETTER;
+}
+
+// Whether [u] keeps a word going when it sits between two letters (MidLetter and MidNumLet).
+static bool isMidLetter(unsigned int u) {
+    return u == '\'' || u == '.' || u == ':' || u == 0xB7 || u == 0x2018 || u == 0x2019 ||
+           u == 0x2024 || u == 0x2027 || u == 0xFE13 || u == 0xFE52 || u == 0xFE55 || u == 0xFF07 ||
+           u == 0xFF0E || u == 0xFF1A;
+}
+
+// Whether [u] keeps a word going when it sits between two digits (MidNum and MidNumLet).
+static bool isMidNum(unsigned int u) {
+    return u == '\'' || u == '.' || u == ',' || u == ';' || u == 0x066C || u == 0x2019 ||
+           u == 0xFE50 || u == 0xFE52 || u == 0xFE54 || u == 0xFF07 || u == 0xFF0C || u == 0xFF0E ||
+           u == 0xFF1B;
+}
+
+struct SegChar {
+    unsigned int unicode;
+    WordCharClass charClass;
+    bool generated;
+    bool hyphen;
+    FS_RECTF box;
+    bool hasBox;
+};
+
+static jfloatArray NativeTextPage_nativeTextGetWords(JNIEnv *env, jclass, jlong text_page_ptr) {
+    return runSafe(env, (jfloatArray) nullptr, [&]() {
+        auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr);
+        int n = FPDFText_CountChars(textPage);
+        if (n < 0) return (jfloatArray) nullptr;
+
+        std::vector<SegChar> chars(n);
+        for (int i = 0; i < n; i++) {
+            SegChar &c = chars[i];
+            c.unicode = FPDFText_GetUnicode(textPage, i);
+            c.charClass = classifyWordChar(c.unicode);
+            c.generated = FPDFText_IsGenerated(textPage, i) == 1;
+            c.hyphen = FPDFText_IsHyphen(textPage, i) == 1;
+            c.box = {0, 0, 0, 0};
+            c.hasBox = FPDFText_GetLooseCharBox(textPage, i, &c.box) &&
+                       c.box.right > c.box.left && c.box.top > c.box.bottom;
+        }
+
+        std::vector<float> data;
+        int line = 0;
+        bool lineHasWords = false;
+        bool lineBreakPending = false;
+        const SegChar *previous = nullptr;
+
+        int wordStart = -1;
+        WordCharClass wordClass = WordCharClass::SPACE;
+        FS_RECTF wordBox = {0, 0, 0, 0};
+        bool wordHasBox = false;
+        bool wordHyphenated = false;
+
+        auto endWord = [&](int end) {
+            if (wordStart < 0) return;
+            data.push_back(wordHasBox ? wordBox.left : 0);
+            data.push_back(wordHasBox ? wordBox.top : 0);
+            data.push_back(wordHasBox ? wordBox.right : 0);
+            data.push_back(wordHasBox ? wordBox.bottom : 0);
+            data.push_back(static_cast<float>(wordStart));
+            data.push_back(static_cast<float>(end - wordStart));
+            data.push_back(static_cast<float>(line));
+            data.push_back(static_cast<float>(wordHyphenated ? WORD_FLAG_HYPHENATED : 0));
+            lineHasWords = true;
+            wordStart = -1;
+        };
+        auto addToWord = [&](const SegChar &c) {
+            if (!c.hasBox) return;
+            if (!wordHasBox) {
+                wordBox = c.box;
+                wordHasBox = true;
+            } else {
+                wordBox.left = std::min(wordBox.left, c.box.left);
+                wordBox.top = std::max(wordBox.top, c.box.top);
+                wordBox.right = std::max(wordBox.right, c.box.right);
+                wordBox.bottom = std::min(wordBox.bottom, c.box.bottom);
+            }
+        };
+
+        for (int i = 0; i < n; i++) {
+            const SegChar &c = chars[i];
+            if (c.unicode == '\r' || c.unicode == '\n') {
+                endWord(i);
+                lineBreakPending = true;
+                continue;
+            }
+            if (c.hasBox) {
+                if (previous != nullptr) {
+                    float middle = (c.box.top + c.box.bottom) / 2;
+                    float height = previous->box.top - previous->box.bottom;
+                    if (middle > previous->box.top || middle < previous->box.bottom ||
+                        c.box.right < previous->box.left - height) {
+                        endWord(i);
+                        lineBreakPending = true;
+                    }
+                }
+                previous = &c;
+            }
+
+            if (c.hyphen && wordStart >= 0) {
+                // A hyphen PDFium found breaking a word across lines ends the word it belongs to.
+                addToWord(c);
+                wordHyphenated = true;
+                endWord(i + 1);
+                continue;
+            }
+
+            bool joins = false;
+            if (wordStart >= 0) {
+                if (c.charClass == WordCharClass::LETTER || c.charClass == WordCharClass::DIGIT) {
+                    joins = wordClass == WordCharClass::LETTER || wordClass == WordCharClass::DIGIT;
+                } else if (c.charClass == WordCharClass::PUNCTUATION && i + 1 < n && !chars[i + 1].generated) {
+                    WordCharClass next = chars[i + 1].charClass;
+                    joins = (wordClass == WordCharClass::LETTER && next == WordCharClass::LETTER &&
+                             isMidLetter(c.unicode)) ||
+                            (wordClass == WordCharClass::DIGIT && next == WordCharClass::DIGIT &&
+                             isMidNum(c.unicode));
+                }
+            }
+            if (joins) {
+                addToWord(c);
+                if (c.charClass != WordCharClass::PUNCTUATION) wordClass = c.charClass;
+                continue;
+            }
+
+            endWord(i);
+            if (c.charClass == WordCharClass::SPACE || c.charClass == WordCharClass::PUNCTUATION) continue;
+
+            if (lineBreakPending && lineHasWords) {
+                line++;
+                lineHasWords = false;
+            }
+            lineBreakPending = false;
+            wordStart = i;
+            wordClass = c.charClass;
+            wordHasBox = false;
+            wordHyphenated = false;
+            addToWord(c);
+            if (c.charClass == WordCharClass::IDEOGRAPH) endWord(i + 1);
+        }
+        endWord(n);
+
+        jfloatArray result = env->NewFloatArray(static_cast<jsize>(data.size()));
+        if (result == nullptr) {
+            return (jfloatArray) nullptr; // Out of memory error
+        }
+        env->SetFloatArrayRegion(result, 0, static_cast<jsize>(data.size()), data.data());
+        return result;
+    });
+}
+
 static jfloatArray NativeTextPage_nativeTextPageGetRects(JNIEnv *env, jclass clazz, jlong text_page_ptr, jint offset, jint limit) {
     return runSafe(env, (jfloatArray) nullptr, [&]() {
         auto textPage = reinterpret_cast<FPDF_TEXTPAGE>(text_page_ptr);
@@ -2472,9 +5528,74 @@ static jint NativePage_nativeGetPageRotation(JNIEnv *env, jclass,
     });
 }
 
+// Rough native footprint of loaded pages, used to retain and cache pages by bytes rather than by
+// count. PDFium has no way to ask what a page holds, so these are order-of-magnitude costs: the
+// page itself with its resource dictionaries, each parsed object with its clip path, colour and
+// graphics state, and each image decoded at 32 bits per pixel, which is how the page's image cache
+// keeps it once the page has been rendered. An image drawn more than once is counted each time.
+static const jlong kPageBaseBytes = 16 * 1024;
+static const jlong kPageObjectBytes = 512;
+static const jlong kImageBytesPerPixel = 4;
+// Form XObjects may nest; past this depth their contents are not counted.
+static const int kMaxFormDepth = 16;
+
+static jlong estimateObjectBytes(FPDF_PAGEOBJECT object, int depth) {
+    jlong bytes = kPageObjectBytes;
+    switch (FPDFPageObj_GetType(object)) {
+        case FPDF_PAGEOBJ_IMAGE: {
+            unsigned int width = 0;
+            unsigned int height = 0;
+            if (FPDFImageObj_GetImagePixelSize(object, &width, &height)) {
+                bytes += (jlong) width * (jlong) height * kImageBytesPerPixel;
+            }
+            break;
+        }
+        case FPDF_PAGEOBJ_FORM: {
+            if (depth >= kMaxFormDepth) break;
+            int count = FPDFFormObj_CountObjects(object);
+            for (int i = 0; i < count; i++) {
+                FPDF_PAGEOBJECT child = FPDFFormObj_GetObject(object, (unsigned long) i);
+                if (child != nullptr) bytes += estimateObjectBytes(child, depth + 1);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return bytes;
+}
+
+static jlong NativePage_nativeGetPageMemoryEstimate(JNIEnv *env, jclass, jlong page_ptr) {
+    return runSafe(env, (jlong) -1, [&]() {
+        auto page = reinterpret_cast<FPDF_PAGE>(page_ptr);
+        jlong bytes = kPageBaseBytes;
+        int count = FPDFPage_CountObjects(page);
+        for (int i = 0; i < count; i++) {
+            FPDF_PAGEOBJECT object = FPDFPage_GetObject(page, i);
+            if (object != nullptr) bytes += estimateObjectBytes(object, 0);
+        }
+        return bytes;
+    });
+}
+
 static const JNINativeMethod coreMethods[] = {
         {"nativeOpenDocument",       "(ILjava/lang/String;)J",                                                        (void *) NativeCore_nativeOpenDocument},
+        {"nativeOpenMappedDocument", "(ILjava/lang/String;)J",                                                        (void *) NativeCore_nativeOpenMappedDocument},
         {"nativeOpenMemDocument",    "([BLjava/lang/String;)J",                                                       (void *) NativeCore_nativeOpenMemDocument},
+        {"nativeOpenDirectBufferDocument", "(Ljava/nio/ByteBuffer;JJLjava/lang/String;)J",                            (void *) NativeCore_nativeOpenDirectBufferDocument},
+        {"nativeOpenAvail",          "(Lio/legere/pdfiumandroid/core/util/PdfiumNativeSourceBridge;J)J",                (void *) NativeCore_nativeOpenAvail},
+        {"nativeIsDocAvail",         "(J)I",                                                                          (void *) NativeCore_nativeIsDocAvail},
+        {"nativeIsLinearized",       "(J)I",                                                                          (void *) NativeCore_nativeIsLinearized},
+        {"nativeOpenAvailDocument",  "(JLjava/lang/String;)J",                                                        (void *) NativeCore_nativeOpenAvailDocument},
+        {"nativeCloseAvail",         "(J)V",                                                                          (void *) NativeCore_nativeCloseAvail},
+        {"nativeSetTileCacheBudget", "(J)V",                                                                          (void *) NativeCore_nativeSetTileCacheBudget},
+        {"nativeGetTileCacheStats",  "()[J",                                                                          (void *) NativeCore_nativeGetTileCacheStats},
+        {"nativeClearTileCache",     "(Z)V",                                                                          (void *) NativeCore_nativeClearTileCache},
+        {"nativeSetRgb565Dither",    "(Z)V",                                                                          (void *) NativeCore_nativeSetRgb565Dither},
+        {"nativeSetLimitedImageCache", "(Z)V",                                                                        (void *) NativeCore_nativeSetLimitedImageCache},
+        {"nativeSetLibraryLifetime", "(IJ)V",                                                                         (void *) NativeCore_nativeSetLibraryLifetime},
+        {"nativeInitLibrary",        "()V",                                                                           (void *) NativeCore_nativeInitLibrary},
+        {"nativeDestroyLibrary",     "()Z",                                                                           (void *) NativeCore_nativeDestroyLibrary},
         {"nativeOpenCustomDocument", "(Lio/legere/pdfiumandroid/core/util/PdfiumNativeSourceBridge;Ljava/lang/String;J)J", (void *) NativeCore_nativeOpenCustomDocument},
 };
 
@@ -2493,6 +5614,13 @@ static const JNINativeMethod pageMethods[] = {
         {"nativeRenderPageSurfaceWithMatrix",       "(JLandroid/view/Surface;[F[FZZII)Z",   (void *) NativePage_nativeRenderPageSurfaceWithMatrix},
         {"nativeRenderPageBitmap",           "(JJLandroid/graphics/Bitmap;IIIIZZII)V", (void *) NativePage_nativeRenderPageBitmap},
         {"nativeRenderPageBitmapWithMatrix", "(JLandroid/graphics/Bitmap;[F[FZZII)V",  (void *) NativePage_nativeRenderPageBitmapWithMatrix},
+        {"nativeOpenProgressiveRender",      "()J",                                    (void *) NativePage_nativeOpenProgressiveRender},
+        {"nativeStartProgressiveRender",     "(JJLandroid/graphics/Bitmap;IIIIZZIIJ)I", (void *) NativePage_nativeStartProgressiveRender},
+        {"nativeContinueProgressiveRender",  "(JLandroid/graphics/Bitmap;J)I",         (void *) NativePage_nativeContinueProgressiveRender},
+        {"nativeCancelProgressiveRender",    "(J)V",                                   (void *) NativePage_nativeCancelProgressiveRender},
+        {"nativeCloseProgressiveRender",     "(JZ)V",                                  (void *) NativePage_nativeCloseProgressiveRender},
+        {"nativeRenderThumbnail",            "(JLandroid/graphics/Bitmap;ZI)I",        (void *) NativePage_nativeRenderThumbnail},
+        {"nativeHasEmbeddedThumbnail",       "(J)Z",                                   (void *) NativePage_nativeHasEmbeddedThumbnail},
         {"nativeGetPageSizeByIndex",         "(JII)[I",                                (void *) NativePage_nativeGetPageSizeByIndex},
         {"nativeGetPageLinks",               "(J)[J",                                  (void *) NativePage_nativeGetPageLinks},
         {"nativePageCoordsToDevice",         "(JIIIIIDD)[I",                           (void *) NativePage_nativePageCoordsToDevice},
@@ -2502,6 +5630,7 @@ static const JNINativeMethod pageMethods[] = {
         {"nativeGetPageWidthPoint",          "(J)I",                                   (void *) NativePage_nativeGetPageWidthPoint},
         {"nativeGetPageHeightPoint",         "(J)I",                                   (void *) NativePage_nativeGetPageHeightPoint},
         {"nativeGetPageRotation",            "(J)I",                                   (void *) NativePage_nativeGetPageRotation},
+        {"nativeGetPageMemoryEstimate",      "(J)J",                                   (void *) NativePage_nativeGetPageMemoryEstimate},
         {"nativeGetPageMediaBox",            "(J)[F",                                  (void *) NativePage_nativeGetPageMediaBox},
         {"nativeGetPageCropBox",             "(J)[F",                                  (void *) NativePage_nativeGetPageCropBox},
         {"nativeGetPageBleedBox",            "(J)[F",                                  (void *) NativePage_nativeGetPageBleedBox},
@@ -2517,13 +5646,20 @@ static const JNINativeMethod textPageMethods[] = {
 
         {"nativeCloseTextPage",         "(J)V",                     (void *) NativeTextPage_nativeCloseTextPage},
         {"nativeTextCountChars",        "(J)I",                     (void *) NativeTextPage_nativeTextCountChars},
+        {"nativeGetTextPageMemoryEstimate", "(J)J",                 (void *) NativeTextPage_nativeGetTextPageMemoryEstimate},
         {"nativeTextGetCharBox",        "(JI)[D",                   (void *) NativeTextPage_nativeTextGetCharBox},
+        {"nativeTextGetCharGeometry",   "(JII[I[F[F[F[F[F[I)I",     (void *) NativeTextPage_nativeTextGetCharGeometry},
         {"nativeTextGetRect",           "(JI)[F",                   (void *) NativeTextPage_nativeTextGetRect},
         {"nativeTextGetRects",           "(J[I)[F",                   (void *) NativeTextPage_nativeTextGetRectsFloat},
         {"nativeTextGetBoundedText",    "(JDDDD[S)I",               (void *) NativeTextPage_nativeTextGetBoundedText},
         {"nativeFindStart",             "(JLjava/lang/String;II)J", (void *) NativeTextPage_nativeFindStart},
         {"nativeLoadWebLink",           "(J)J",                     (void *) NativeTextPage_nativeLoadWebLink},
         {"nativeTextGetCharIndexAtPos", "(JDDDD)I",                 (void *) NativeTextPage_nativeTextGetCharIndexAtPos},
+        {"nativeTextHitTestChar",       "(JDDDD)I",                 (void *) NativeTextPage_nativeTextHitTestChar},
+        {"nativeTextHitTestCharRange",  "(JFFFF)[I",                (void *) NativeTextPage_nativeTextHitTestCharRange},
+        {"nativeTextHitTestLink",       "(JJDD)J",                  (void *) NativeTextPage_nativeTextHitTestLink},
+        {"nativeTextHitTestWebLink",    "(JDD)[F",                  (void *) NativeTextPage_nativeTextHitTestWebLink},
+        {"nativeTextGetWebLinkURL",     "(JI)Ljava/lang/String;",   (void *) NativeTextPage_nativeTextGetWebLinkURL},
         {"nativeTextGetText",           "(JII[S)I",                 (void *) NativeTextPage_nativeTextGetText},
         {"nativeTextGetTextString",     "(JII)Ljava/lang/String;",  (void *) NativeTextPage_nativeTextGetTextString},
         {"nativeTextGetTextByteArray",  "(JII[B)I",                 (void *) NativeTextPage_nativeTextGetTextByteArray},
@@ -2531,6 +5667,7 @@ static const JNINativeMethod textPageMethods[] = {
         {"nativeTextCountRects",        "(JII)I",                   (void *) NativeTextPage_nativeTextCountRects},
         {"nativeGetFontSize",           "(JI)D",                    (void *) NativeTextPage_nativeGetFontSize},
         {"nativeTextPageGetRects",      "(JII)[F",                   (void *) NativeTextPage_nativeTextPageGetRects},
+        {"nativeTextGetWords",          "(J)[F",                     (void *) NativeTextPage_nativeTextGetWords},
 
 };
 
@@ -2540,6 +5677,10 @@ static const JNINativeMethod documentMethods[] = {
         {"nativeDeletePage",            "(JI)V",                                           (void *) NativeDocument_nativeDeletePage},
         {"nativeCloseDocument",         "(J)V",                                            (void *) NativeDocument_nativeCloseDocument},
         {"nativeLoadPages",             "(JII)[J",                                         (void *) NativeDocument_nativeLoadPages},
+        {"nativeExtractText",           "(JIILjava/nio/ByteBuffer;IZ[II)I",                (void *) NativeDocument_nativeExtractText},
+        {"nativeSearchPages",           "(JI[JLjava/lang/String;I)[F",                     (void *) NativeDocument_nativeSearchPages},
+        {"nativeIsPageAvail",           "(JI)I",                                           (void *) NativeDocument_nativeIsPageAvail},
+        {"nativeGetFirstAvailPage",     "(J)I",                                            (void *) NativeDocument_nativeGetFirstAvailPage},
         {"nativeGetDocumentMetaText",   "(JLjava/lang/String;)Ljava/lang/String;",         (void *) NativeDocument_nativeGetDocumentMetaText},
         {"nativeGetFirstChildBookmark", "(JJ)J",                                           (void *) NativeDocument_nativeGetFirstChildBookmark},
         {"nativeGetSiblingBookmark",    "(JJ)J",                                           (void *) NativeDocument_nativeGetSiblingBookmark},
@@ -2550,6 +5691,16 @@ static const JNINativeMethod documentMethods[] = {
         {"nativeGetPageCharCounts",     "(J)[I",                                           (void *) NativeDocument_nativeGetPageCharCounts},
         {"nativeRenderPagesWithMatrix", "([JJII[F[FZZII)V",                                (void *) NativeDocument_nativeRenderPagesWithMatrix},
         {"nativeRenderPagesSurfaceWithMatrix", "([JLandroid/view/Surface;[F[FZZII)Z",           (void *) NativeDocument_nativeRenderPagesSurfaceWithMatrix},
+        {"nativeOpenSurfaceFrame",      "()J",                                             (void *) NativeDocument_nativeOpenSurfaceFrame},
+        {"nativeCloseSurfaceFrame",     "(J)V",                                            (void *) NativeDocument_nativeCloseSurfaceFrame},
+        {"nativeRenderPagesSurfaceScrolled", "(J[JLandroid/view/Surface;[F[FIIZZZII)Z",      (void *) NativeDocument_nativeRenderPagesSurfaceScrolled},
+        {"nativeRenderThumbnailAtlas",  "(JI[JLandroid/graphics/Bitmap;IIZII)[F",           (void *) NativeDocument_nativeRenderThumbnailAtlas},
+        {"nativeRenderThumbnailAtlasToBuffer", "(JI[JLjava/nio/ByteBuffer;IIIIZII)[F",      (void *) NativeDocument_nativeRenderThumbnailAtlasToBuffer},
+        {"nativeOpenRenderLoop",        "(Landroid/view/Surface;Lio/legere/pdfiumandroid/core/util/RenderLoopBridge;)J", (void *) NativeDocument_nativeOpenRenderLoop},
+        {"nativeSubmitRenderLoopFrame", "(J[J[F[FZII)V",                                   (void *) NativeDocument_nativeSubmitRenderLoopFrame},
+        {"nativeRasterizeRenderLoopFrame", "(J)Z",                                         (void *) NativeDocument_nativeRasterizeRenderLoopFrame},
+        {"nativeGetRenderLoopStats",    "(J)[J",                                           (void *) NativeDocument_nativeGetRenderLoopStats},
+        {"nativeCloseRenderLoop",       "(J)V",                                            (void *) NativeDocument_nativeCloseRenderLoop},
 };
 
 static const JNINativeMethod findResultMethods[] = {
@@ -2591,6 +5742,21 @@ JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void*) {
         return JNI_ERR;
     }
 
+    if ((isDataAvailableMethod = env->GetMethodID(nativeSourceBridge, "isDataAvailable", "(JJ)Z")) == nullptr) {
+        return JNI_ERR;
+    }
+
+    if ((requestDataMethod = env->GetMethodID(nativeSourceBridge, "requestData", "(JJ)V")) == nullptr) {
+        return JNI_ERR;
+    }
+
+    jclass renderLoopBridge = env->FindClass("io/legere/pdfiumandroid/core/util/RenderLoopBridge");
+    if (renderLoopBridge == nullptr) return JNI_ERR;
+
+    if ((rasterizeFrameMethod = env->GetMethodID(renderLoopBridge, "rasterize", "()Z")) == nullptr) {
+        return JNI_ERR;
+    }
+
     jclass clazz = env->FindClass("io/legere/pdfiumandroid/core/jni/NativeCore"); // Replace with your class name
     if (clazz == nullptr) {
         return -1;
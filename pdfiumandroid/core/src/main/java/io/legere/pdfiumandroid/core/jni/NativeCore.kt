@@ -20,6 +20,7 @@
 package io.legere.pdfiumandroid.core.jni
 
 import io.legere.pdfiumandroid.core.util.PdfiumNativeSourceBridge
+import java.nio.ByteBuffer
 
 /**
  * Contract for the native core PDFium functions.
@@ -41,6 +42,21 @@ interface NativeCoreContract {
         password: String?,
     ): Long
 
+    /**
+     * Opens a PDF document from a read-only memory mapping of a file descriptor, so PDFium reads the
+     * file straight from the page cache instead of through a read per block. Falls back to
+     * [openDocument]'s behaviour if the file can't be mapped.
+     * This is a JNI method.
+     *
+     * @param fd The file descriptor of the PDF file.
+     * @param password The password for the PDF document, or `null` if no password is required.
+     * @return A native pointer (long) to the opened PDF document.
+     */
+    fun openMappedDocument(
+        fd: Int,
+        password: String?,
+    ): Long
+
     /**
      * Opens a PDF document from a byte array in memory.
      * This is a JNI method.
@@ -54,6 +70,24 @@ interface NativeCoreContract {
         password: String?,
     ): Long
 
+    /**
+     * Opens a PDF document from a direct [ByteBuffer] without copying it. PDFium reads the buffer's
+     * memory in place, and the native document holds a reference to the buffer until it is closed.
+     * This is a JNI method.
+     *
+     * @param buffer The direct buffer containing the PDF document data.
+     * @param offset The offset in [buffer] the PDF document starts at.
+     * @param length The length of the PDF document in bytes.
+     * @param password The password for the PDF document, or `null` if no password is required.
+     * @return A native pointer (long) to the opened PDF document.
+     */
+    fun openDirectBufferDocument(
+        buffer: ByteBuffer,
+        offset: Long,
+        length: Long,
+        password: String?,
+    ): Long
+
     /**
      * Opens a PDF document from a custom data source, bridged via
      * [PdfiumNativeSourceBridge].
@@ -69,6 +103,128 @@ interface NativeCoreContract {
         password: String?,
         size: Long,
     ): Long
+
+    /**
+     * Creates a PDFium availability provider for a custom data source whose data is still
+     * arriving. PDFium only reads ranges the source reports as available.
+     * This is a JNI method.
+     *
+     * @param data The [PdfiumNativeSourceBridge] instance to read PDF data.
+     * @param size The total length of the PDF data, including data that hasn't arrived yet.
+     * @return A native pointer (long) to the availability provider.
+     */
+    fun openAvail(
+        data: PdfiumNativeSourceBridge,
+        size: Long,
+    ): Long
+
+    /**
+     * Checks whether enough of the data has arrived to open the document. If not, PDFium's hints
+     * for the data it needs are passed to the source.
+     * This is a JNI method.
+     *
+     * @param availPtr The native pointer (long) to the availability provider.
+     * @return 1 if the document can be opened, 0 if not yet, or -1 on error.
+     */
+    fun isDocAvail(availPtr: Long): Int
+
+    /**
+     * Checks whether the document is linearized, which lets its first page load before the rest.
+     * This is a JNI method.
+     *
+     * @param availPtr The native pointer (long) to the availability provider.
+     * @return 1 if linearized, 0 if not, or -1 if not enough data has arrived to tell.
+     */
+    fun isLinearized(availPtr: Long): Int
+
+    /**
+     * Opens the document once [isDocAvail] reports it available. On success the document owns the
+     * availability provider, which must not be closed; on failure the caller still owns it.
+     * This is a JNI method.
+     *
+     * @param availPtr The native pointer (long) to the availability provider.
+     * @param password The password for the PDF document, or `null` if no password is required.
+     * @return A native pointer (long) to the opened PDF document.
+     */
+    fun openAvailDocument(
+        availPtr: Long,
+        password: String?,
+    ): Long
+
+    /**
+     * Releases an availability provider no document was opened from.
+     * This is a JNI method.
+     *
+     * @param availPtr The native pointer (long) to the availability provider.
+     */
+    fun closeAvail(availPtr: Long)
+
+    /**
+     * Sets the byte budget of the native tile cache, evicting tiles until it fits. A budget too
+     * small for one tile switches the cache off.
+     * This is a JNI method.
+     *
+     * @param budgetBytes The budget in bytes.
+     */
+    fun setTileCacheBudget(budgetBytes: Long)
+
+    /**
+     * Gets the counters of the native tile cache.
+     * This is a JNI method.
+     *
+     * @return hits, misses, evictions, cached tiles, bytes allocated and the budget, in that order.
+     */
+    fun getTileCacheStats(): LongArray
+
+    /**
+     * Drops every cached tile and frees the cache's memory.
+     * This is a JNI method.
+     *
+     * @param resetStats Whether the hit, miss and eviction counters start again from zero.
+     */
+    fun clearTileCache(resetStats: Boolean)
+
+    /**
+     * Sets whether pages rendered to RGB_565 bitmaps are ordered-dithered.
+     * This is a JNI method.
+     *
+     * @param dither `true` to dither.
+     */
+    fun setRgb565Dither(dither: Boolean)
+
+    /**
+     * Sets whether renders ask PDFium to limit the decoded images it keeps cached on each page.
+     * This is a JNI method.
+     *
+     * @param limited `true` to limit the image cache.
+     */
+    fun setLimitedImageCache(limited: Boolean)
+
+    /**
+     * Sets when the PDFium library is torn down once no document needs it.
+     * This is a JNI method.
+     *
+     * @param lifetime The ordinal of an [io.legere.pdfiumandroid.api.LibraryLifetime].
+     * @param idleTimeoutMillis How long a reference counted library outlives the last document.
+     */
+    fun setLibraryLifetime(
+        lifetime: Int,
+        idleTimeoutMillis: Long,
+    )
+
+    /**
+     * Sets up the PDFium library ahead of the first document.
+     * This is a JNI method.
+     */
+    fun initLibrary()
+
+    /**
+     * Tears down the PDFium library.
+     * This is a JNI method.
+     *
+     * @return `false`, leaving the library as it is, if a document is still open.
+     */
+    fun destroyLibrary(): Boolean
 }
 
 class NativeCore : NativeCoreContract {
@@ -77,11 +233,58 @@ class NativeCore : NativeCoreContract {
         password: String?,
     ): Long
 
+    private external fun nativeOpenMappedDocument(
+        fd: Int,
+        password: String?,
+    ): Long
+
     private external fun nativeOpenMemDocument(
         data: ByteArray?,
         password: String?,
     ): Long
 
+    private external fun nativeOpenDirectBufferDocument(
+        buffer: ByteBuffer,
+        offset: Long,
+        length: Long,
+        password: String?,
+    ): Long
+
+    private external fun nativeOpenAvail(
+        data: PdfiumNativeSourceBridge,
+        size: Long,
+    ): Long
+
+    private external fun nativeIsDocAvail(availPtr: Long): Int
+
+    private external fun nativeIsLinearized(availPtr: Long): Int
+
+    private external fun nativeOpenAvailDocument(
+        availPtr: Long,
+        password: String?,
+    ): Long
+
+    private external fun nativeCloseAvail(availPtr: Long)
+
+    private external fun nativeSetTileCacheBudget(budgetBytes: Long)
+
+    private external fun nativeGetTileCacheStats(): LongArray
+
+    private external fun nativeClearTileCache(resetStats: Boolean)
+
+    private external fun nativeSetRgb565Dither(dither: Boolean)
+
+    private external fun nativeSetLimitedImageCache(limited: Boolean)
+
+    private external fun nativeSetLibraryLifetime(
+        lifetime: Int,
+        idleTimeoutMillis: Long,
+    )
+
+    private external fun nativeInitLibrary()
+
+    private external fun nativeDestroyLibrary(): Boolean
+
     private external fun nativeOpenCustomDocument(
         data: PdfiumNativeSourceBridge,
         password: String?,
@@ -97,6 +300,15 @@ class NativeCore : NativeCoreContract {
             password,
         )
 
+    override fun openMappedDocument(
+        fd: Int,
+        password: String?,
+    ): Long =
+        nativeOpenMappedDocument(
+            fd,
+            password,
+        )
+
     override fun openMemDocument(
         data: ByteArray?,
         password: String?,
@@ -106,6 +318,54 @@ class NativeCore : NativeCoreContract {
             password,
         )
 
+    override fun openDirectBufferDocument(
+        buffer: ByteBuffer,
+        offset: Long,
+        length: Long,
+        password: String?,
+    ): Long =
+        nativeOpenDirectBufferDocument(
+            buffer,
+            offset,
+            length,
+            password,
+        )
+
+    override fun openAvail(
+        data: PdfiumNativeSourceBridge,
+        size: Long,
+    ): Long = nativeOpenAvail(data, size)
+
+    override fun isDocAvail(availPtr: Long): Int = nativeIsDocAvail(availPtr)
+
+    override fun isLinearized(availPtr: Long): Int = nativeIsLinearized(availPtr)
+
+    override fun openAvailDocument(
+        availPtr: Long,
+        password: String?,
+    ): Long = nativeOpenAvailDocument(availPtr, password)
+
+    override fun closeAvail(availPtr: Long) = nativeCloseAvail(availPtr)
+
+    override fun setTileCacheBudget(budgetBytes: Long) = nativeSetTileCacheBudget(budgetBytes)
+
+    override fun getTileCacheStats(): LongArray = nativeGetTileCacheStats()
+
+    override fun clearTileCache(resetStats: Boolean) = nativeClearTileCache(resetStats)
+
+    override fun setRgb565Dither(dither: Boolean) = nativeSetRgb565Dither(dither)
+
+    override fun setLimitedImageCache(limited: Boolean) = nativeSetLimitedImageCache(limited)
+
+    override fun setLibraryLifetime(
+        lifetime: Int,
+        idleTimeoutMillis: Long,
+    ) = nativeSetLibraryLifetime(lifetime, idleTimeoutMillis)
+
+    override fun initLibrary() = nativeInitLibrary()
+
+    override fun destroyLibrary(): Boolean = nativeDestroyLibrary()
+
     override fun openCustomDocument(
         data: PdfiumNativeSourceBridge,
         password: String?,
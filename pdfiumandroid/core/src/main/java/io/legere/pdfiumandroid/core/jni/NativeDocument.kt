@@ -19,8 +19,11 @@
 
 package io.legere.pdfiumandroid.core.jni
 
+import android.graphics.Bitmap
 import android.view.Surface
 import io.legere.pdfiumandroid.api.PdfWriteCallback
+import io.legere.pdfiumandroid.core.util.RenderLoopBridge
+import java.nio.ByteBuffer
 
 /**
  * Contract for native PDFium document operations.
@@ -72,6 +75,31 @@ interface NativeDocumentContract {
      */
     fun closeDocument(docPtr: Long)
 
+    /**
+     * Checks whether a page of a streaming document can be loaded. If it can't, PDFium's hints for
+     * the data the page still needs are passed to the document's
+     * [io.legere.pdfiumandroid.api.StreamingPdfiumSource]. Pages of documents that weren't opened
+     * by streaming are always available.
+     * This is a JNI method.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @param pageIndex The 0-based index of the page.
+     * @return 1 if the page is available, 0 if it isn't yet, or -1 on error.
+     */
+    fun isPageAvail(
+        docPtr: Long,
+        pageIndex: Int,
+    ): Int
+
+    /**
+     * Gets the first page a linearized document makes available, usually the first page.
+     * This is a JNI method.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @return The 0-based index of the first available page; 0 for a document that isn't linearized.
+     */
+    fun getFirstAvailPage(docPtr: Long): Int
+
     /**
      * Loads a range of pages from the PDF document.
      * This is a JNI method.
@@ -87,6 +115,53 @@ interface NativeDocumentContract {
         toIndex: Int,
     ): LongArray
 
+    /**
+     * Extracts the text of a run of pages into a direct [ByteBuffer], one page after another with nothing
+     * between them, loading and closing each page natively. Stops at the first page whose text does not fit.
+     * This is a JNI method.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @param firstPage The 0-based index of the first page to extract.
+     * @param pageCount How many pages to extract at most.
+     * @param buffer A direct [ByteBuffer] to write the text into.
+     * @param position The offset in `buffer` to start writing at.
+     * @param utf8 `true` to write UTF-8, `false` for little-endian UTF-16.
+     * @param pageEnds Receives the end offset in `buffer` of each page written.
+     * @param pageEndsOffset The index in `pageEnds` for the first page's end.
+     * @return How many pages were written, or -1 on failure.
+     */
+    @Suppress("LongParameterList")
+    fun extractText(
+        docPtr: Long,
+        firstPage: Int,
+        pageCount: Int,
+        buffer: ByteBuffer,
+        position: Int,
+        utf8: Boolean,
+        pageEnds: IntArray,
+        pageEndsOffset: Int,
+    ): Int
+
+    /**
+     * Finds every match of a string on a run of pages, with the rectangles that highlight each one.
+     * This is a JNI method.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @param firstPage The 0-based index of the first page to search.
+     * @param textPagePtrs One entry per page: the native pointer to the page's text page if it is already
+     * open, or 0 to load the page just for the search.
+     * @param query The string to find.
+     * @param flags The [io.legere.pdfiumandroid.api.FindFlags] values or-ed together.
+     * @return The packed hits, as [io.legere.pdfiumandroid.api.SearchHits] reads them, or `null` on failure.
+     */
+    fun searchPages(
+        docPtr: Long,
+        firstPage: Int,
+        textPagePtrs: LongArray,
+        query: String,
+        flags: Int,
+    ): FloatArray?
+
     /**
      * Retrieves metadata text from the PDF document.
      * This is a JNI method.
@@ -241,6 +316,192 @@ interface NativeDocumentContract {
         canvasColor: Int,
         pageBackgroundColor: Int,
     ): Boolean
+
+    /**
+     * Allocates the native copy of a Surface's last frame used by [renderPagesSurfaceScrolled].
+     * This is a JNI method.
+     *
+     * @return A native pointer (long) to the frame, to be released with [closeSurfaceFrame].
+     */
+    fun openSurfaceFrame(): Long
+
+    /**
+     * Releases a frame from [openSurfaceFrame].
+     * This is a JNI method.
+     *
+     * @param framePtr The native pointer (long) to the frame.
+     */
+    fun closeSurfaceFrame(framePtr: Long)
+
+    /**
+     * Renders multiple PDF pages onto an Android [Surface] like [renderPagesSurfaceWithMatrix], reusing the
+     * previous frame when this one is it scrolled: the frame kept in `framePtr` is shifted by
+     * (`scrollX`, `scrollY`) and only the strips the scroll uncovered are rendered.
+     * This is a JNI method.
+     *
+     * @param framePtr The native pointer (long) from [openSurfaceFrame].
+     * @param pages An array of native pointers (long) to the PDF pages to render.
+     * @param surface The [Surface] to render onto.
+     * @param matrixFloats A `FloatArray` containing concatenated 2x3 transformation matrices for each page.
+     * @param clipFloats A `FloatArray` containing concatenated 4-element clipping rectangles
+     * [left, top, right, bottom] for each page.
+     * @param scrollX How far the content moved right since the previous frame, in pixels.
+     * @param scrollY How far the content moved down since the previous frame, in pixels.
+     * @param reuse `false` to render the whole frame regardless.
+     * @param renderAnnot `true` to render annotations, `false` otherwise.
+     * @param textMask `true` to render text as an image mask, `false` otherwise. (Currently ignored by Pdfium)
+     * @param canvasColor The ARGB color to fill the canvas background. Use 0 for no fill.
+     * @param pageBackgroundColor The ARGB color to fill the page background. Use 0 for no fill.
+     * @return `true` if rendering was successful, `false` otherwise.
+     */
+    @Suppress("LongParameterList")
+    fun renderPagesSurfaceScrolled(
+        framePtr: Long,
+        pages: LongArray,
+        surface: Surface,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        scrollX: Int,
+        scrollY: Int,
+        reuse: Boolean,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): Boolean
+
+    /**
+     * Renders thumbnails of a run of pages into one atlas [Bitmap], loading and closing the pages internally.
+     * This is a JNI method.
+     *
+     * The pages are laid out left to right, top to bottom, in `cellWidth` x `cellHeight` cells, each centred in
+     * its cell at its own aspect ratio. Each page's embedded thumbnail is used when it has one and
+     * `useEmbedded` is set; otherwise the page is rendered without anti-aliasing or annotations.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @param startIndex The 0-based index of the first page.
+     * @param openPagePtrs One entry per page: the native pointer of the page if it is already open, else 0.
+     * @param bitmap The `RGBA_8888` or `RGB_565` atlas [Bitmap].
+     * @param cellWidth The width of a cell in pixels.
+     * @param cellHeight The height of a cell in pixels.
+     * @param useEmbedded `false` to skip embedded thumbnails and always render.
+     * @param canvasColor The ARGB color to fill each cell around its page. Use 0 for no fill.
+     * @param pageBackgroundColor The ARGB color to fill the page background. Use 0 for no fill.
+     * @return A `FloatArray` of concatenated [left, top, right, bottom] page rects in atlas pixels, one per
+     * page, empty for a page that did not fit or failed to load; or `null` on failure.
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlas(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        bitmap: Bitmap,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray?
+
+    /**
+     * Renders thumbnails of a run of pages into one RGBA atlas held in a direct [ByteBuffer], loading and closing
+     * the pages internally. Like [renderThumbnailAtlas], but for a `width` x `height` buffer with rows of
+     * `width * 4` bytes.
+     * This is a JNI method.
+     *
+     * @param docPtr The native pointer (long) to the PDF document.
+     * @param startIndex The 0-based index of the first page.
+     * @param openPagePtrs One entry per page: the native pointer of the page if it is already open, else 0.
+     * @param buffer The direct [ByteBuffer] to render into.
+     * @param width The width of the atlas in pixels.
+     * @param height The height of the atlas in pixels.
+     * @param cellWidth The width of a cell in pixels.
+     * @param cellHeight The height of a cell in pixels.
+     * @param useEmbedded `false` to skip embedded thumbnails and always render.
+     * @param canvasColor The ARGB color to fill each cell around its page. Use 0 for no fill.
+     * @param pageBackgroundColor The ARGB color to fill the page background. Use 0 for no fill.
+     * @return The page rects, as for [renderThumbnailAtlas], or `null` on failure.
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlasToBuffer(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray?
+
+    /**
+     * Starts a render loop: a native thread that presents frames submitted with [submitRenderLoopFrame] to
+     * an Android [Surface], asking `bridge` to rasterize each one.
+     * This is a JNI method.
+     *
+     * @param surface The [Surface] to present to.
+     * @param bridge The [RenderLoopBridge] the thread calls to rasterize a frame under the PDFium lock.
+     * @return A native pointer (long) to the loop, to be released with [closeRenderLoop], or 0 on failure.
+     */
+    fun openRenderLoop(
+        surface: Surface,
+        bridge: RenderLoopBridge,
+    ): Long
+
+    /**
+     * Posts a frame to a render loop, replacing any frame it has not started yet. Does not block.
+     * This is a JNI method.
+     *
+     * @param loopPtr The native pointer (long) from [openRenderLoop].
+     * @param pages An array of native pointers (long) to the PDF pages to render.
+     * @param matrixFloats A `FloatArray` containing concatenated 2x3 transformation matrices for each page.
+     * @param clipFloats A `FloatArray` containing concatenated 4-element clipping rectangles
+     * [left, top, right, bottom] for each page.
+     * @param renderAnnot `true` to render annotations, `false` otherwise.
+     * @param canvasColor The ARGB color to fill the canvas background. Use 0 for no fill.
+     * @param pageBackgroundColor The ARGB color to fill the page background. Use 0 for no fill.
+     */
+    @Suppress("LongParameterList")
+    fun submitRenderLoopFrame(
+        loopPtr: Long,
+        pages: LongArray,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        renderAnnot: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    )
+
+    /**
+     * Rasterizes the frame a render loop's thread is on into its back buffer. Only to be called from
+     * [RenderLoopBridge.rasterize], holding the PDFium lock.
+     * This is a JNI method.
+     *
+     * @param loopPtr The native pointer (long) from [openRenderLoop].
+     * @return `true` if the frame was rasterized and should be presented.
+     */
+    fun rasterizeRenderLoopFrame(loopPtr: Long): Boolean
+
+    /**
+     * Reads a render loop's counters.
+     * This is a JNI method.
+     *
+     * @param loopPtr The native pointer (long) from [openRenderLoop].
+     * @return The frames submitted, presented and dropped, in that order, or `null` on failure.
+     */
+    fun getRenderLoopStats(loopPtr: Long): LongArray?
+
+    /**
+     * Stops a render loop, waiting for the frame it is on, and releases it. Must not be called holding the
+     * PDFium lock.
+     * This is a JNI method.
+     *
+     * @param loopPtr The native pointer (long) from [openRenderLoop].
+     */
+    fun closeRenderLoop(loopPtr: Long)
 }
 
 @Suppress("TooManyFunctions")
@@ -265,6 +526,33 @@ class NativeDocument : NativeDocumentContract {
         toIndex: Int,
     ): LongArray
 
+    private external fun nativeIsPageAvail(
+        docPtr: Long,
+        pageIndex: Int,
+    ): Int
+
+    private external fun nativeGetFirstAvailPage(docPtr: Long): Int
+
+    @Suppress("LongParameterList")
+    private external fun nativeExtractText(
+        docPtr: Long,
+        firstPage: Int,
+        pageCount: Int,
+        buffer: ByteBuffer,
+        position: Int,
+        utf8: Boolean,
+        pageEnds: IntArray,
+        pageEndsOffset: Int,
+    ): Int
+
+    private external fun nativeSearchPages(
+        docPtr: Long,
+        firstPage: Int,
+        textPagePtrs: LongArray,
+        query: String,
+        flags: Int,
+    ): FloatArray?
+
     private external fun nativeGetDocumentMetaText(
         docPtr: Long,
         tag: String,
@@ -326,6 +614,76 @@ class NativeDocument : NativeDocumentContract {
         pageBackgroundColor: Int,
     ): Boolean
 
+    private external fun nativeOpenSurfaceFrame(): Long
+
+    private external fun nativeCloseSurfaceFrame(framePtr: Long)
+
+    @Suppress("LongParameterList")
+    private external fun nativeRenderPagesSurfaceScrolled(
+        framePtr: Long,
+        pages: LongArray,
+        surface: Surface,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        scrollX: Int,
+        scrollY: Int,
+        reuse: Boolean,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): Boolean
+
+    @Suppress("LongParameterList")
+    private external fun nativeRenderThumbnailAtlas(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        bitmap: Bitmap,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray?
+
+    @Suppress("LongParameterList")
+    private external fun nativeRenderThumbnailAtlasToBuffer(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray?
+
+    private external fun nativeOpenRenderLoop(
+        surface: Surface,
+        bridge: RenderLoopBridge,
+    ): Long
+
+    @Suppress("LongParameterList")
+    private external fun nativeSubmitRenderLoopFrame(
+        loopPtr: Long,
+        pages: LongArray,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        renderAnnot: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    )
+
+    private external fun nativeRasterizeRenderLoopFrame(loopPtr: Long): Boolean
+
+    private external fun nativeGetRenderLoopStats(loopPtr: Long): LongArray?
+
+    private external fun nativeCloseRenderLoop(loopPtr: Long)
+
     override fun getPageCount(docPtr: Long): Int = nativeGetPageCount(docPtr)
 
     override fun loadPage(
@@ -346,6 +704,33 @@ class NativeDocument : NativeDocumentContract {
         toIndex: Int,
     ): LongArray = nativeLoadPages(docPtr, fromIndex, toIndex)
 
+    override fun isPageAvail(
+        docPtr: Long,
+        pageIndex: Int,
+    ): Int = nativeIsPageAvail(docPtr, pageIndex)
+
+    override fun getFirstAvailPage(docPtr: Long): Int = nativeGetFirstAvailPage(docPtr)
+
+    @Suppress("LongParameterList")
+    override fun extractText(
+        docPtr: Long,
+        firstPage: Int,
+        pageCount: Int,
+        buffer: ByteBuffer,
+        position: Int,
+        utf8: Boolean,
+        pageEnds: IntArray,
+        pageEndsOffset: Int,
+    ): Int = nativeExtractText(docPtr, firstPage, pageCount, buffer, position, utf8, pageEnds, pageEndsOffset)
+
+    override fun searchPages(
+        docPtr: Long,
+        firstPage: Int,
+        textPagePtrs: LongArray,
+        query: String,
+        flags: Int,
+    ): FloatArray? = nativeSearchPages(docPtr, firstPage, textPagePtrs, query, flags)
+
     override fun getDocumentMetaText(
         docPtr: Long,
         tag: String,
@@ -427,4 +812,120 @@ class NativeDocument : NativeDocumentContract {
             canvasColor,
             pageBackgroundColor,
         )
+
+    override fun openSurfaceFrame(): Long = nativeOpenSurfaceFrame()
+
+    override fun closeSurfaceFrame(framePtr: Long) = nativeCloseSurfaceFrame(framePtr)
+
+    @Suppress("LongParameterList")
+    override fun renderPagesSurfaceScrolled(
+        framePtr: Long,
+        pages: LongArray,
+        surface: Surface,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        scrollX: Int,
+        scrollY: Int,
+        reuse: Boolean,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): Boolean =
+        nativeRenderPagesSurfaceScrolled(
+            framePtr,
+            pages,
+            surface,
+            matrixFloats,
+            clipFloats,
+            scrollX,
+            scrollY,
+            reuse,
+            renderAnnot,
+            textMask,
+            canvasColor,
+            pageBackgroundColor,
+        )
+
+    @Suppress("LongParameterList")
+    override fun renderThumbnailAtlas(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        bitmap: Bitmap,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray? =
+        nativeRenderThumbnailAtlas(
+            docPtr,
+            startIndex,
+            openPagePtrs,
+            bitmap,
+            cellWidth,
+            cellHeight,
+            useEmbedded,
+            canvasColor,
+            pageBackgroundColor,
+        )
+
+    @Suppress("LongParameterList")
+    override fun renderThumbnailAtlasToBuffer(
+        docPtr: Long,
+        startIndex: Int,
+        openPagePtrs: LongArray,
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        useEmbedded: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ): FloatArray? =
+        nativeRenderThumbnailAtlasToBuffer(
+            docPtr,
+            startIndex,
+            openPagePtrs,
+            buffer,
+            width,
+            height,
+            cellWidth,
+            cellHeight,
+            useEmbedded,
+            canvasColor,
+            pageBackgroundColor,
+        )
+
+    override fun openRenderLoop(
+        surface: Surface,
+        bridge: RenderLoopBridge,
+    ): Long = nativeOpenRenderLoop(surface, bridge)
+
+    @Suppress("LongParameterList")
+    override fun submitRenderLoopFrame(
+        loopPtr: Long,
+        pages: LongArray,
+        matrixFloats: FloatArray,
+        clipFloats: FloatArray,
+        renderAnnot: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+    ) = nativeSubmitRenderLoopFrame(
+        loopPtr,
+        pages,
+        matrixFloats,
+        clipFloats,
+        renderAnnot,
+        canvasColor,
+        pageBackgroundColor,
+    )
+
+    override fun rasterizeRenderLoopFrame(loopPtr: Long): Boolean = nativeRasterizeRenderLoopFrame(loopPtr)
+
+    override fun getRenderLoopStats(loopPtr: Long): LongArray? = nativeGetRenderLoopStats(loopPtr)
+
+    override fun closeRenderLoop(loopPtr: Long) = nativeCloseRenderLoop(loopPtr)
 }
@@ -21,7 +21,6 @@ package io.legere.pdfiumandroid.core.jni
 
 import android.graphics.Bitmap
 import android.view.Surface
-import dalvik.annotation.optimization.FastNative
 
 /**
  * Contract for native PDFium page operations.
@@ -273,6 +272,115 @@ interface NativePageContract {
         pageBackgroundColor: Int,
     )
 
+    /**
+     * Allocates the native state for a progressive render.
+     * This is a JNI method.
+     *
+     * @return A native pointer (long) to the progressive render, to pass to the other progressive render methods.
+     */
+    fun openProgressiveRender(): Long
+
+    /**
+     * Starts rendering a fragment of a PDF page onto an Android [Bitmap], progressively.
+     * This is a JNI method.
+     *
+     * The render runs until it finishes, is cancelled or uses up [timeBudgetMillis]; an incomplete render
+     * is resumed with [continueProgressiveRender]. The bitmap must stay alive, and must not be rendered
+     * into any other way, until the render is finished or closed.
+     *
+     * @param renderPtr The native pointer (long) from [openProgressiveRender].
+     * @param pagePtr The native pointer (long) to the PDF page to render.
+     * @param bitmap The [Bitmap] to render onto. Supported formats: `ARGB_8888`, `RGB_565`.
+     * @param startX The X-coordinate of the top-left corner of the page in the bitmap.
+     * @param startY The Y-coordinate of the top-left corner of the page in the bitmap.
+     * @param drawSizeHor The horizontal size of the page on the bitmap.
+     * @param drawSizeVer The vertical size of the page on the bitmap.
+     * @param renderAnnot `true` to render annotations, `false` otherwise.
+     * @param textMask `true` to render text as an image mask, `false` otherwise. (Currently ignored by Pdfium)
+     * @param canvasColor The ARGB color to fill the canvas background. Use 0 for no fill.
+     * @param pageBackgroundColor The ARGB color to fill the page background. Use 0 for no fill.
+     * @param timeBudgetMillis How long to render before pausing. Use 0 to render until done or cancelled.
+     * @return The native render status, see [io.legere.pdfiumandroid.api.RenderStatus].
+     */
+    @Suppress("LongParameterList")
+    fun startProgressiveRender(
+        renderPtr: Long,
+        pagePtr: Long,
+        bitmap: Bitmap?,
+        startX: Int,
+        startY: Int,
+        drawSizeHor: Int,
+        drawSizeVer: Int,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+        timeBudgetMillis: Long,
+    ): Int
+
+    /**
+     * Resumes an incomplete progressive render.
+     * This is a JNI method.
+     *
+     * @param renderPtr The native pointer (long) from [openProgressiveRender].
+     * @param bitmap The same [Bitmap] the render was started with.
+     * @param timeBudgetMillis How long to render before pausing. Use 0 to render until done or cancelled.
+     * @return The native render status, see [io.legere.pdfiumandroid.api.RenderStatus].
+     */
+    fun continueProgressiveRender(
+        renderPtr: Long,
+        bitmap: Bitmap?,
+        timeBudgetMillis: Long,
+    ): Int
+
+    /**
+     * Cancels a progressive render. Unlike the other methods this one may be called from any thread, while
+     * the render is running.
+     * This is a JNI method.
+     *
+     * @param renderPtr The native pointer (long) from [openProgressiveRender].
+     */
+    fun cancelProgressiveRender(renderPtr: Long)
+
+    /**
+     * Releases a progressive render, abandoning it if it is incomplete.
+     * This is a JNI method.
+     *
+     * @param renderPtr The native pointer (long) from [openProgressiveRender].
+     * @param pageOpen `false` if the page was closed (or its document was) while the render was incomplete.
+     */
+    fun closeProgressiveRender(
+        renderPtr: Long,
+        pageOpen: Boolean,
+    )
+
+    /**
+     * Fills a bitmap with a thumbnail of a PDF page: the page's embedded thumbnail scaled to the bitmap when
+     * there is one, otherwise a fast, unsmoothed render of the page without annotations.
+     * This is a JNI method.
+     *
+     * @param pagePtr The native pointer (long) to the PDF page.
+     * @param bitmap The `RGBA_8888` or `RGB_565` [Bitmap] to fill. The page is stretched to its size.
+     * @param useEmbedded `false` to skip the embedded thumbnail and always render.
+     * @param pageBackgroundColor The ARGB color the page is filled with before a render.
+     * @return 1 if the embedded thumbnail was used, 0 if the page was rendered, -1 on failure.
+     */
+    fun renderThumbnail(
+        pagePtr: Long,
+        bitmap: Bitmap,
+        useEmbedded: Boolean,
+        pageBackgroundColor: Int,
+    ): Int
+
+    /**
+     * Checks whether a PDF page carries an embedded thumbnail image.
+     * This is a JNI method.
+     *
+     * @param pagePtr The native pointer (long) to the PDF page.
+     * @return `true` if the page has a non-empty `/Thumb` stream.
+     */
+    fun hasEmbeddedThumbnail(pagePtr: Long): Boolean
+
     /**
      * Gets the width and height of a PDF page by its index in pixels.
      * This is a JNI method.
@@ -475,6 +583,18 @@ interface NativePageContract {
      * @return A `FloatArray` containing various page attributes (width, height, rotation, bounding boxes, etc.).
      */
     fun getPageAttributes(pagePtr: Long): FloatArray
+
+    /**
+     * Estimates how much native memory a loaded PDF page holds.
+     * This is a JNI method.
+     *
+     * The estimate counts the page's parsed objects, including those inside form XObjects, and the
+     * decoded size of every image it draws, which PDFium caches on the page once it is rendered.
+     *
+     * @param pagePtr The native pointer (long) to the PDF page.
+     * @return The approximate size of the page in bytes, or -1 on error.
+     */
+    fun getPageMemoryEstimate(pagePtr: Long): Long
 }
 
 @Suppress("TooManyFunctions")
@@ -634,6 +754,59 @@ class NativePage : NativePageContract {
         pageBackgroundColor,
     )
 
+    override fun openProgressiveRender() = nativeOpenProgressiveRender()
+
+    @Suppress("LongParameterList")
+    override fun startProgressiveRender(
+        renderPtr: Long,
+        pagePtr: Long,
+        bitmap: Bitmap?,
+        startX: Int,
+        startY: Int,
+        drawSizeHor: Int,
+        drawSizeVer: Int,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+        timeBudgetMillis: Long,
+    ) = nativeStartProgressiveRender(
+        renderPtr,
+        pagePtr,
+        bitmap,
+        startX,
+        startY,
+        drawSizeHor,
+        drawSizeVer,
+        renderAnnot,
+        textMask,
+        canvasColor,
+        pageBackgroundColor,
+        timeBudgetMillis,
+    )
+
+    override fun continueProgressiveRender(
+        renderPtr: Long,
+        bitmap: Bitmap?,
+        timeBudgetMillis: Long,
+    ) = nativeContinueProgressiveRender(renderPtr, bitmap, timeBudgetMillis)
+
+    override fun cancelProgressiveRender(renderPtr: Long) = nativeCancelProgressiveRender(renderPtr)
+
+    override fun closeProgressiveRender(
+        renderPtr: Long,
+        pageOpen: Boolean,
+    ) = nativeCloseProgressiveRender(renderPtr, pageOpen)
+
+    override fun renderThumbnail(
+        pagePtr: Long,
+        bitmap: Bitmap,
+        useEmbedded: Boolean,
+        pageBackgroundColor: Int,
+    ) = nativeRenderThumbnail(pagePtr, bitmap, useEmbedded, pageBackgroundColor)
+
+    override fun hasEmbeddedThumbnail(pagePtr: Long) = nativeHasEmbeddedThumbnail(pagePtr)
+
     override fun getPageSizeByIndex(
         docPtr: Long,
         pageIndex: Int,
@@ -698,6 +871,8 @@ class NativePage : NativePageContract {
 
     override fun getPageAttributes(pagePtr: Long) = nativeGetPageAttributes(pagePtr)
 
+    override fun getPageMemoryEstimate(pagePtr: Long) = nativeGetPageMemoryEstimate(pagePtr)
+
     /**
      * @suppress
      */
@@ -819,6 +994,53 @@ class NativePage : NativePageContract {
             pageBackgroundColor: Int,
         )
 
+        @JvmStatic
+        private external fun nativeOpenProgressiveRender(): Long
+
+        @Suppress("LongParameterList")
+        @JvmStatic
+        private external fun nativeStartProgressiveRender(
+            renderPtr: Long,
+            pagePtr: Long,
+            bitmap: Bitmap?,
+            startX: Int,
+            startY: Int,
+            drawSizeHor: Int,
+            drawSizeVer: Int,
+            renderAnnot: Boolean,
+            textMask: Boolean,
+            canvasColor: Int,
+            pageBackgroundColor: Int,
+            timeBudgetMillis: Long,
+        ): Int
+
+        @JvmStatic
+        private external fun nativeContinueProgressiveRender(
+            renderPtr: Long,
+            bitmap: Bitmap?,
+            timeBudgetMillis: Long,
+        ): Int
+
+        @JvmStatic
+        private external fun nativeCancelProgressiveRender(renderPtr: Long)
+
+        @JvmStatic
+        private external fun nativeCloseProgressiveRender(
+            renderPtr: Long,
+            pageOpen: Boolean,
+        )
+
+        @JvmStatic
+        private external fun nativeRenderThumbnail(
+            pagePtr: Long,
+            bitmap: Bitmap,
+            useEmbedded: Boolean,
+            pageBackgroundColor: Int,
+        ): Int
+
+        @JvmStatic
+        private external fun nativeHasEmbeddedThumbnail(pagePtr: Long): Boolean
+
         @JvmStatic
         private external fun nativeGetPageSizeByIndex(
             docPtr: Long,
@@ -831,7 +1053,6 @@ class NativePage : NativePageContract {
 
         @Suppress("LongParameterList")
         @JvmStatic
-        @FastNative
         private external fun nativePageCoordsToDevice(
             pagePtr: Long,
             startX: Int,
@@ -845,7 +1066,6 @@ class NativePage : NativePageContract {
 
         @Suppress("LongParameterList")
         @JvmStatic
-        @FastNative
         private external fun nativeDeviceCoordsToPage(
             pagePtr: Long,
             startX: Int,
@@ -858,61 +1078,51 @@ class NativePage : NativePageContract {
         ): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageWidthPixel(
             pagePtr: Long,
             dpi: Int,
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageHeightPixel(
             pagePtr: Long,
             dpi: Int,
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageWidthPoint(pagePtr: Long): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageHeightPoint(pagePtr: Long): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageRotation(pagePtr: Long): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageMediaBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageCropBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageBleedBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageTrimBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageArtBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageBoundingBox(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageMatrix(pagePtr: Long): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetPageAttributes(pagePtr: Long): FloatArray
+
+        @JvmStatic
+        private external fun nativeGetPageMemoryEstimate(pagePtr: Long): Long
     }
 }
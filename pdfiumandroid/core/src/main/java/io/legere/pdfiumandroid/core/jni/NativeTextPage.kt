@@ -19,7 +19,6 @@
 
 package io.legere.pdfiumandroid.core.jni
 
-import dalvik.annotation.optimization.FastNative
 
 /**
  * Contract for native PDFium text page operations.
@@ -60,6 +59,36 @@ interface NativeTextPageContract {
         index: Int,
     ): DoubleArray
 
+    /**
+     * Fills one array per attribute with the geometry of a run of characters on a PDF text page.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param startIndex The 0-based index of the first character.
+     * @param count The maximum number of characters to fill.
+     * @param unicodes Receives each character's code point.
+     * @param looseBoxes Receives each character's loose box, 4 values [left, top, right, bottom] per character.
+     * @param tightBoxes Receives each character's tight box, 4 values [left, top, right, bottom] per character.
+     * @param origins Receives each character's origin, 2 values [x, y] per character.
+     * @param angles Receives each character's angle in radians.
+     * @param fontSizes Receives each character's font size in points.
+     * @param flags Receives each character's generated, hyphen and Unicode map error bits.
+     * @return The number of characters filled, or -1 if the range is out of bounds or an array is too small.
+     */
+    @Suppress("LongParameterList")
+    fun textGetCharGeometry(
+        textPagePtr: Long,
+        startIndex: Int,
+        count: Int,
+        unicodes: IntArray,
+        looseBoxes: FloatArray,
+        tightBoxes: FloatArray,
+        origins: FloatArray,
+        angles: FloatArray,
+        fontSizes: FloatArray,
+        flags: IntArray,
+    ): Int
+
     /**
      * Gets the bounding rectangle of a specific text segment on a PDF text page.
      * This is a JNI method.
@@ -250,6 +279,110 @@ interface NativeTextPageContract {
         offset: Int,
         limit: Int,
     ): FloatArray?
+
+    /**
+     * Segments a PDF text page into words and lines in one pass over its characters.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @return The words, 8 floats each [left, top, right, bottom, start, length, line, flags], or `null` on error.
+     */
+    fun textGetWords(textPagePtr: Long): FloatArray?
+
+    /**
+     * Finds the character at or near a position on a PDF text page using the page's spatial index,
+     * built on first use and kept until the text page is closed.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param x The x-coordinate in page coordinates.
+     * @param y The y-coordinate in page coordinates.
+     * @param xTolerance The x-axis tolerance.
+     * @param yTolerance The y-axis tolerance.
+     * @return The 0-based index of the character, or -1 if none is within tolerance.
+     */
+    fun textHitTestChar(
+        textPagePtr: Long,
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ): Int
+
+    /**
+     * Finds the characters whose boxes overlap a rectangle using the page's spatial index.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param left The left edge of the rectangle in page coordinates.
+     * @param top The top edge of the rectangle in page coordinates.
+     * @param right The right edge of the rectangle in page coordinates.
+     * @param bottom The bottom edge of the rectangle in page coordinates.
+     * @return An `IntArray` [start, count] from the first overlapping character to the last, [-1, 0] if none,
+     * or `null` on error.
+     */
+    @Suppress("LongParameterList")
+    fun textHitTestCharRange(
+        textPagePtr: Long,
+        left: Float,
+        top: Float,
+        right: Float,
+        bottom: Float,
+    ): IntArray?
+
+    /**
+     * Finds the link annotation under a position using the page's spatial index.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param pagePtr The native pointer (long) to the PDF page the text page was loaded from.
+     * @param x The x-coordinate in page coordinates.
+     * @param y The y-coordinate in page coordinates.
+     * @return The native pointer (long) to the link, or 0 if there is none.
+     */
+    fun textHitTestLink(
+        textPagePtr: Long,
+        pagePtr: Long,
+        x: Double,
+        y: Double,
+    ): Long
+
+    /**
+     * Finds the web link in the page text under a position using the page's spatial index.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param x The x-coordinate in page coordinates.
+     * @param y The y-coordinate in page coordinates.
+     * @return A `FloatArray` [linkIndex, left, top, right, bottom] of the rectangle hit, or `null` if there is none.
+     */
+    fun textHitTestWebLink(
+        textPagePtr: Long,
+        x: Double,
+        y: Double,
+    ): FloatArray?
+
+    /**
+     * Gets the URL of a web link found by [textHitTestWebLink].
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @param linkIndex The link index [textHitTestWebLink] returned.
+     * @return The URL, or `null` if there is none.
+     */
+    fun textGetWebLinkURL(
+        textPagePtr: Long,
+        linkIndex: Int,
+    ): String?
+
+    /**
+     * Estimates how much native memory a loaded PDF text page holds.
+     * This is a JNI method.
+     *
+     * @param textPagePtr The native pointer (long) to the PDF text page.
+     * @return The approximate size of the text page in bytes, or -1 on error.
+     */
+    fun getTextPageMemoryEstimate(textPagePtr: Long): Long
 }
 
 @Suppress("TooManyFunctions")
@@ -263,6 +396,20 @@ class NativeTextPage : NativeTextPageContract {
         index: Int,
     ) = nativeTextGetCharBox(textPagePtr, index)
 
+    @Suppress("LongParameterList")
+    override fun textGetCharGeometry(
+        textPagePtr: Long,
+        startIndex: Int,
+        count: Int,
+        unicodes: IntArray,
+        looseBoxes: FloatArray,
+        tightBoxes: FloatArray,
+        origins: FloatArray,
+        angles: FloatArray,
+        fontSizes: FloatArray,
+        flags: IntArray,
+    ) = nativeTextGetCharGeometry(textPagePtr, startIndex, count, unicodes, looseBoxes, tightBoxes, origins, angles, fontSizes, flags)
+
     override fun textGetRect(
         textPagePtr: Long,
         rectIndex: Int,
@@ -342,6 +489,45 @@ class NativeTextPage : NativeTextPageContract {
         limit: Int,
     ): FloatArray? = nativeTextPageGetRects(textPagePtr, offset, limit)
 
+    override fun textGetWords(textPagePtr: Long) = nativeTextGetWords(textPagePtr)
+
+    override fun textHitTestChar(
+        textPagePtr: Long,
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ) = nativeTextHitTestChar(textPagePtr, x, y, xTolerance, yTolerance)
+
+    @Suppress("LongParameterList")
+    override fun textHitTestCharRange(
+        textPagePtr: Long,
+        left: Float,
+        top: Float,
+        right: Float,
+        bottom: Float,
+    ) = nativeTextHitTestCharRange(textPagePtr, left, top, right, bottom)
+
+    override fun textHitTestLink(
+        textPagePtr: Long,
+        pagePtr: Long,
+        x: Double,
+        y: Double,
+    ) = nativeTextHitTestLink(textPagePtr, pagePtr, x, y)
+
+    override fun textHitTestWebLink(
+        textPagePtr: Long,
+        x: Double,
+        y: Double,
+    ) = nativeTextHitTestWebLink(textPagePtr, x, y)
+
+    override fun textGetWebLinkURL(
+        textPagePtr: Long,
+        linkIndex: Int,
+    ) = nativeTextGetWebLinkURL(textPagePtr, linkIndex)
+
+    override fun getTextPageMemoryEstimate(textPagePtr: Long) = nativeGetTextPageMemoryEstimate(textPagePtr)
+
     /**
      * @suppress
      */
@@ -350,18 +536,30 @@ class NativeTextPage : NativeTextPageContract {
         private external fun nativeCloseTextPage(textPagePtr: Long)
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextCountChars(textPagePtr: Long): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetCharBox(
             textPagePtr: Long,
             index: Int,
         ): DoubleArray
 
         @JvmStatic
-        @FastNative
+        @Suppress("LongParameterList")
+        private external fun nativeTextGetCharGeometry(
+            textPagePtr: Long,
+            startIndex: Int,
+            count: Int,
+            unicodes: IntArray,
+            looseBoxes: FloatArray,
+            tightBoxes: FloatArray,
+            origins: FloatArray,
+            angles: FloatArray,
+            fontSizes: FloatArray,
+            flags: IntArray,
+        ): Int
+
+        @JvmStatic
         private external fun nativeTextGetTextString(
             textPagePtr: Long,
             startIndex: Int,
@@ -369,21 +567,18 @@ class NativeTextPage : NativeTextPageContract {
         ): String
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetRect(
             textPagePtr: Long,
             rectIndex: Int,
         ): FloatArray
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetRects(
             textPagePtr: Long,
             wordRanges: IntArray,
         ): FloatArray?
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextPageGetRects(
             textPagePtr: Long,
             offset: Int,
@@ -392,7 +587,6 @@ class NativeTextPage : NativeTextPageContract {
 
         @Suppress("LongParameterList")
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetBoundedText(
             textPagePtr: Long,
             left: Double,
@@ -414,7 +608,6 @@ class NativeTextPage : NativeTextPageContract {
         private external fun nativeLoadWebLink(textPagePtr: Long): Long
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetCharIndexAtPos(
             textPagePtr: Long,
             x: Double,
@@ -424,7 +617,6 @@ class NativeTextPage : NativeTextPageContract {
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetText(
             textPagePtr: Long,
             startIndex: Int,
@@ -433,7 +625,6 @@ class NativeTextPage : NativeTextPageContract {
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetTextByteArray(
             textPagePtr: Long,
             startIndex: Int,
@@ -442,14 +633,12 @@ class NativeTextPage : NativeTextPageContract {
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextGetUnicode(
             textPagePtr: Long,
             index: Int,
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeTextCountRects(
             textPagePtr: Long,
             startIndex: Int,
@@ -457,10 +646,55 @@ class NativeTextPage : NativeTextPageContract {
         ): Int
 
         @JvmStatic
-        @FastNative
         private external fun nativeGetFontSize(
             textPagePtr: Long,
             charIndex: Int,
         ): Double
+
+        @JvmStatic
+        private external fun nativeGetTextPageMemoryEstimate(textPagePtr: Long): Long
+
+        @JvmStatic
+        private external fun nativeTextGetWords(textPagePtr: Long): FloatArray?
+
+        @JvmStatic
+        private external fun nativeTextHitTestChar(
+            textPagePtr: Long,
+            x: Double,
+            y: Double,
+            xTolerance: Double,
+            yTolerance: Double,
+        ): Int
+
+        @JvmStatic
+        @Suppress("LongParameterList")
+        private external fun nativeTextHitTestCharRange(
+            textPagePtr: Long,
+            left: Float,
+            top: Float,
+            right: Float,
+            bottom: Float,
+        ): IntArray?
+
+        @JvmStatic
+        private external fun nativeTextHitTestLink(
+            textPagePtr: Long,
+            pagePtr: Long,
+            x: Double,
+            y: Double,
+        ): Long
+
+        @JvmStatic
+        private external fun nativeTextHitTestWebLink(
+            textPagePtr: Long,
+            x: Double,
+            y: Double,
+        ): FloatArray?
+
+        @JvmStatic
+        private external fun nativeTextGetWebLinkURL(
+            textPagePtr: Long,
+            linkIndex: Int,
+        ): String?
     }
 }
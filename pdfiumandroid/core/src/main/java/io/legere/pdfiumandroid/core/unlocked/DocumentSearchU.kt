@@ -0,0 +1,108 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.SearchHits
+import io.legere.pdfiumandroid.api.handleAlreadyClosed
+import io.legere.pdfiumandroid.core.jni.NativeDocumentContract
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+
+/**
+ * An **unlocked** search for a string across a run of pages, done a few pages at a time so a caller
+ * can hand each run's hits on and let go of the PDFium lock in between.
+ * Started with [PdfDocumentU.startSearch].
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * Pages whose text page is open, or retained after its last holder closed it, are searched through
+ * it; the rest are loaded and closed natively for the search without being opened here.
+ *
+ * @property doc The [PdfDocumentU] the pages belong to.
+ * @property query The string to find.
+ * @property firstPage The index of the first page to search.
+ * @property pageCount How many pages to search.
+ */
+@Suppress("LongParameterList")
+class DocumentSearchU internal constructor(
+    val doc: PdfDocumentU,
+    val query: String,
+    private val flags: Int,
+    val firstPage: Int,
+    val pageCount: Int,
+    private val cancellationToken: RenderCancellationToken?,
+    nativeFactory: NativeFactory = defaultNativeFactory,
+) {
+    private val nativeDocument: NativeDocumentContract = nativeFactory.getNativeDocument()
+
+    private val found = mutableListOf<FloatArray>()
+
+    /** How many pages have been searched so far. */
+    var pagesDone = 0
+        private set
+
+    /** Whether the search was cancelled through its token before every page was searched. */
+    val isCancelled: Boolean
+        get() = cancellationToken?.isCancelled == true && pagesDone < pageCount
+
+    /** Whether there is nothing left to search, because every page is done or the search was cancelled. */
+    val isFinished: Boolean
+        get() = pagesDone == pageCount || isCancelled
+
+    /**
+     * Search up to [maxPages] more pages.
+     * For internal use only.
+     *
+     * @param maxPages the most pages to search in this call
+     * @return the hits on the pages searched, or `null` if the document is closed
+     * @throws IllegalStateException if the pages cannot be searched
+     */
+    fun searchNext(maxPages: Int = pageCount): SearchHits? {
+        if (handleAlreadyClosed(doc.isClosed)) return null
+        if (isFinished) return SearchHits.EMPTY
+        val from = firstPage + pagesDone
+        val count = minOf(maxPages, pageCount - pagesDone)
+        val textPagePtrs = LongArray(count) { doc.openTextPagePtr(from + it) }
+        val data = nativeDocument.searchPages(doc.mNativeDocPtr, from, textPagePtrs, query, flags)
+        checkNotNull(data) { "Could not search pages $from until ${from + count}" }
+        pagesDone += count
+        if (data.isNotEmpty()) found.add(data)
+        return SearchHits(data)
+    }
+
+    /**
+     * Every hit found so far.
+     * For internal use only.
+     */
+    fun result(): SearchHits {
+        val data = FloatArray(found.sumOf { it.size })
+        var at = 0
+        found.forEach {
+            it.copyInto(data, at)
+            at += it.size
+        }
+        return SearchHits(data)
+    }
+
+    companion object {
+        /** How many pages the locked wrappers search before letting go of the lock. */
+        const val DEFAULT_PAGES_PER_LOCK = 8
+    }
+}
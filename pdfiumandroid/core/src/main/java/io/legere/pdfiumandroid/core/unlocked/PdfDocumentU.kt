@@ -21,18 +21,27 @@
 
 package io.legere.pdfiumandroid.core.unlocked
 
+import android.content.ComponentCallbacks2
+import android.graphics.Bitmap
 import android.graphics.Matrix
 import android.graphics.RectF
 import android.os.ParcelFileDescriptor
 import android.view.Surface
+import androidx.annotation.ColorInt
 import androidx.annotation.OpenForTesting
 import io.legere.pdfiumandroid.api.Bookmark
+import io.legere.pdfiumandroid.api.DocumentText
+import io.legere.pdfiumandroid.api.FindFlags
 import io.legere.pdfiumandroid.api.ImmutableMatrix
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.Meta
 import io.legere.pdfiumandroid.api.PdfWriteCallback
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.SearchHits
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.api.handleAlreadyClosed
 import io.legere.pdfiumandroid.api.pdfiumConfig
 import io.legere.pdfiumandroid.core.jni.NativeFactory
@@ -41,9 +50,11 @@ import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU.Companion.FPDF_INCREME
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU.Companion.FPDF_NO_INCREMENTAL
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU.Companion.FPDF_REMOVE_SECURITY
 import io.legere.pdfiumandroid.core.util.PageCount
+import io.legere.pdfiumandroid.core.util.floatArrayToRects
 import io.legere.pdfiumandroid.core.util.matricesToFloatArray
 import io.legere.pdfiumandroid.core.util.rectsToFloatArray
 import java.io.Closeable
+import java.nio.ByteBuffer
 
 private const val MAX_RECURSION = 16
 
@@ -65,10 +76,15 @@ class PdfDocumentU(
 
     /**
      * Indexes of pages that every holder has closed but which are still open natively, in the order
-     * they were released. Their [PageCount.count] is 0, so reopening one costs nothing and the next
-     * release past [io.legere.pdfiumandroid.api.Config.pageRetentionCount] evicts the oldest.
+     * they were released, with the estimated bytes the page and its text page hold. Their
+     * [PageCount.count] is 0, so reopening one costs nothing, and a release that takes them past
+     * [io.legere.pdfiumandroid.api.Config.pageRetentionCount] or
+     * [io.legere.pdfiumandroid.api.Config.pageRetentionBudgetBytes] evicts the oldest.
      */
-    private val retainedPages = LinkedHashSet<Int>()
+    private val retainedPages = LinkedHashMap<Int, Long>()
+
+    /** The sum of the estimates in [retainedPages]. */
+    private var retainedBytes = 0L
 
     /**
      * Represents a key for caching transformation matrices.
@@ -120,6 +136,10 @@ class PdfDocumentU(
     var parcelFileDescriptor: ParcelFileDescriptor? = null
     var source: PdfiumSource? = null
 
+    // Pages known to be available, for documents opened with a PdfStreamingLoaderU; sized on first use.
+    private var availablePages: BooleanArray? = null
+    private var onPageAvailableListener: ((Int) -> Unit)? = null
+
     /**
      * Get the page count of the PDF document.
      * For internal use only.
@@ -132,6 +152,70 @@ class PdfDocumentU(
         return nativeDocument.getPageCount(mNativeDocPtr)
     }
 
+    /**
+     * Whether a page's data has arrived, so the page can be opened. Always `true` unless the
+     * document was opened with a [PdfStreamingLoaderU]; for such a document, don't open a page
+     * before this returns `true`. If the page isn't available, the ranges it needs are passed to
+     * the source's [io.legere.pdfiumandroid.api.StreamingPdfiumSource.requestData].
+     * For internal use only.
+     *
+     * @param pageIndex the page index
+     * @return `true` if the page can be opened
+     * @throws IllegalStateException if document is closed
+     */
+    fun isPageAvailable(pageIndex: Int): Boolean {
+        if (handleAlreadyClosed(isClosed)) return false
+        availablePages?.let { if (pageIndex in it.indices && it[pageIndex]) return true }
+        val available = nativeDocument.isPageAvail(mNativeDocPtr, pageIndex) == PDF_DATA_AVAIL
+        if (available) availablePages().let { if (pageIndex in it.indices) it[pageIndex] = true }
+        return available
+    }
+
+    /**
+     * The page a linearized document makes available first, usually the first page.
+     * For internal use only.
+     *
+     * @return the page index; 0 for a document that isn't linearized
+     * @throws IllegalStateException if document is closed
+     */
+    fun getFirstAvailablePage(): Int {
+        if (handleAlreadyClosed(isClosed)) return 0
+        return nativeDocument.getFirstAvailPage(mNativeDocPtr)
+    }
+
+    /**
+     * Sets the listener [notifyDataAvailable] reports newly available pages to, or clears it.
+     * For internal use only.
+     *
+     * @param listener called with the index of each page that has become available
+     */
+    fun setOnPageAvailableListener(listener: ((pageIndex: Int) -> Unit)?) {
+        onPageAvailableListener = listener
+    }
+
+    /**
+     * Tells the document more of its data has arrived. Every page that wasn't available before is
+     * checked again; those that now are go to the listener set with [setOnPageAvailableListener].
+     * For internal use only.
+     *
+     * @return the indexes of the pages that became available, in page order
+     * @throws IllegalStateException if document is closed
+     */
+    fun notifyDataAvailable(): List<Int> {
+        if (handleAlreadyClosed(isClosed)) return emptyList()
+        val known = availablePages()
+        val newlyAvailable =
+            known.indices.filter { pageIndex ->
+                !known[pageIndex] && nativeDocument.isPageAvail(mNativeDocPtr, pageIndex) == PDF_DATA_AVAIL
+            }
+        newlyAvailable.forEach { known[it] = true }
+        onPageAvailableListener?.let { listener -> newlyAvailable.forEach(listener) }
+        return newlyAvailable
+    }
+
+    private fun availablePages(): BooleanArray =
+        availablePages ?: BooleanArray(nativeDocument.getPageCount(mNativeDocPtr)).also { availablePages = it }
+
     /**
      * Get the page character counts for every page of the PDF document.
      * For internal use only.
@@ -144,6 +228,121 @@ class PdfDocumentU(
         return nativeDocument.getPageCharCounts(mNativeDocPtr)
     }
 
+    /**
+     * Start extracting the text of a run of pages into one direct buffer. The pages are loaded and
+     * closed natively one at a time, without opening them here, so pages already open are unaffected.
+     * For internal use only.
+     *
+     * @param firstPage the index of the first page
+     * @param pageCount how many pages, or -1 for every page from [firstPage] on
+     * @param encoding the encoding to extract the text in
+     * @param initialCapacity the bytes to start the buffer with, or 0 to estimate them from the page count
+     * @return the extraction, to be run with [TextExtractionU.extractNext], or `null` if the document is closed
+     * @throws IllegalArgumentException if the pages are not in the document
+     */
+    fun startTextExtraction(
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        encoding: TextEncoding = TextEncoding.UTF_16LE,
+        initialCapacity: Int = 0,
+    ): TextExtractionU? {
+        if (handleAlreadyClosed(isClosed)) return null
+        val count = checkPageRange(firstPage, pageCount)
+        val capacity =
+            if (initialCapacity > 0) {
+                initialCapacity
+            } else {
+                val unitBytes = if (encoding == TextEncoding.UTF_8) 1 else 2
+                minOf(count.toLong() * TextExtractionU.BYTES_PER_PAGE_ESTIMATE * unitBytes, Int.MAX_VALUE.toLong()).toInt()
+            }
+        return TextExtractionU(this, firstPage, count, encoding, capacity, nativeFactory)
+    }
+
+    /**
+     * Extract the text of a run of pages into one direct buffer, in one go. See [startTextExtraction].
+     * For internal use only.
+     *
+     * @return the text, or `null` if the document is closed
+     * @throws IllegalArgumentException if the pages are not in the document
+     * @throws IllegalStateException if a page's text cannot be extracted
+     */
+    fun extractText(
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        encoding: TextEncoding = TextEncoding.UTF_16LE,
+        initialCapacity: Int = 0,
+    ): DocumentText? {
+        val extraction = startTextExtraction(firstPage, pageCount, encoding, initialCapacity) ?: return null
+        extraction.extractNext()
+        return extraction.result()
+    }
+
+    /**
+     * Start searching a run of pages for a string. Text pages already open, or retained, are searched
+     * through; the other pages are loaded and closed natively for the search, without opening them here.
+     * For internal use only.
+     *
+     * @param query the string to find
+     * @param flags a set of [FindFlags] to control the search
+     * @param firstPage the index of the first page
+     * @param pageCount how many pages, or -1 for every page from [firstPage] on
+     * @param cancellationToken stops the search between runs of pages once cancelled
+     * @return the search, to be run with [DocumentSearchU.searchNext], or `null` if the document is closed
+     * @throws IllegalArgumentException if the query is empty or the pages are not in the document
+     */
+    fun startSearch(
+        query: String,
+        flags: Set<FindFlags> = emptySet(),
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        cancellationToken: RenderCancellationToken? = null,
+    ): DocumentSearchU? {
+        if (handleAlreadyClosed(isClosed)) return null
+        require(query.isNotEmpty()) { "The query must not be empty" }
+        val count = checkPageRange(firstPage, pageCount)
+        val apiFlags = flags.fold(0) { acc, flag -> acc or flag.value }
+        return DocumentSearchU(this, query, apiFlags, firstPage, count, cancellationToken, nativeFactory)
+    }
+
+    /**
+     * Search a run of pages for a string, in one go. See [startSearch].
+     * For internal use only.
+     *
+     * @return every hit, or `null` if the document is closed
+     * @throws IllegalArgumentException if the query is empty or the pages are not in the document
+     * @throws IllegalStateException if the pages cannot be searched
+     */
+    fun search(
+        query: String,
+        flags: Set<FindFlags> = emptySet(),
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+    ): SearchHits? {
+        val search = startSearch(query, flags, firstPage, pageCount) ?: return null
+        search.searchNext()
+        return search.result()
+    }
+
+    /** The native pointer to page [pageIndex]'s text page if it is open or retained, or 0. */
+    internal fun openTextPagePtr(pageIndex: Int): Long = textPageMap[pageIndex]?.pagePtr ?: 0L
+
+    /**
+     * Check that [pageCount] pages from [firstPage] are in the document, -1 meaning the rest of it.
+     *
+     * @return the number of pages
+     */
+    private fun checkPageRange(
+        firstPage: Int,
+        pageCount: Int,
+    ): Int {
+        val documentPages = nativeDocument.getPageCount(mNativeDocPtr)
+        val count = if (pageCount < 0) documentPages - firstPage else pageCount
+        require(firstPage >= 0 && count >= 0 && firstPage + count <= documentPages) {
+            "Pages $firstPage until ${firstPage + count} are not in a document of $documentPages pages"
+        }
+        return count
+    }
+
     /**
      * Open page and store native pointer in [PdfDocumentU].
      * For internal use only.
@@ -161,7 +360,7 @@ class PdfDocumentU(
                 pageMap[pageIndex]?.let {
                     it.count++
                     // The page has a holder again, so it is no longer a candidate for eviction
-                    retainedPages.remove(pageIndex)
+                    releaseRetained(pageIndex)
                     return PdfPageU(this, pageIndex, it.pagePtr, pageMap, nativeFactory)
                 }
             }
@@ -252,7 +451,7 @@ class PdfDocumentU(
                 // page is already open, drop the duplicate and hand back the one being tracked.
                 nativePage.closePage(loadedPtr)
                 open.count++
-                retainedPages.remove(pageIndex)
+                releaseRetained(pageIndex)
                 PdfPageU(this, pageIndex, open.pagePtr, pageMap, nativeFactory)
             }
         }
@@ -261,7 +460,9 @@ class PdfDocumentU(
     /**
      * Offer a page, or a text page, whose last holder has just closed it to the retention pool, so
      * that reopening it does not have to load it again. Evicts, and closes, whatever has been
-     * released for longest beyond [io.legere.pdfiumandroid.api.Config.pageRetentionCount].
+     * released for longest beyond [io.legere.pdfiumandroid.api.Config.pageRetentionCount] or
+     * [io.legere.pdfiumandroid.api.Config.pageRetentionBudgetBytes]; that may be the page being
+     * released, if it alone is over the budget.
      *
      * For internal use only.
      *
@@ -276,12 +477,16 @@ class PdfDocumentU(
         // A text page is loaded from its page, so the two are evicted together and the index only
         // becomes a candidate once nothing holds either of them.
         if (isFullyReleased(pageIndex)) {
-            retainedPages.remove(pageIndex)
-            retainedPages.add(pageIndex)
+            val budget = pdfiumConfig.pageRetentionBudgetBytes
+            // Measured once per load, on its first release, and only when there is a budget to keep
+            val bytes = if (budget > 0) estimateBytes(pageIndex) else 0L
+            releaseRetained(pageIndex)
+            retainedPages[pageIndex] = bytes
+            retainedBytes += bytes
 
-            while (retainedPages.size > retentionCount) {
-                val oldest = retainedPages.first()
-                retainedPages.remove(oldest)
+            while (retainedPages.size > retentionCount || (budget > 0 && retainedBytes > budget)) {
+                val oldest = retainedPages.keys.first()
+                releaseRetained(oldest)
                 evict(oldest)
             }
         }
@@ -291,12 +496,67 @@ class PdfDocumentU(
     private fun isFullyReleased(pageIndex: Int): Boolean =
         (pageMap[pageIndex]?.count ?: 0) == 0 && (textPageMap[pageIndex]?.count ?: 0) == 0
 
+    /** Take [pageIndex] out of the retention pool, if it is in it. */
+    private fun releaseRetained(pageIndex: Int) {
+        retainedPages.remove(pageIndex)?.let { retainedBytes -= it }
+    }
+
+    /** The estimated native memory held by the page at [pageIndex] and its text page, if they are open. */
+    private fun estimateBytes(pageIndex: Int): Long {
+        val pageBytes = pageMap[pageIndex]?.let { measure(it, nativePage::getPageMemoryEstimate) } ?: 0L
+        val textPageBytes = textPageMap[pageIndex]?.let { measure(it, nativeTextPage::getTextPageMemoryEstimate) } ?: 0L
+        return pageBytes + textPageBytes
+    }
+
+    /** [page]'s estimated size, from [estimate] the first time and from [PageCount.memoryEstimate] after. */
+    private fun measure(
+        page: PageCount,
+        estimate: (Long) -> Long,
+    ): Long {
+        if (page.memoryEstimate < 0) page.memoryEstimate = estimate(page.pagePtr).coerceAtLeast(0L)
+        return page.memoryEstimate
+    }
+
     /** Close and forget the page at [pageIndex], text page first so it never outlives its page. */
     private fun evict(pageIndex: Int) {
         textPageMap.remove(pageIndex)?.let { nativeTextPage.closeTextPage(it.pagePtr) }
         pageMap.remove(pageIndex)?.let { nativePage.closePage(it.pagePtr) }
     }
 
+    /**
+     * Close the pages this document keeps open that no caller holds, in response to
+     * [ComponentCallbacks2.onTrimMemory]. Nothing a caller holds is touched; pages closed here are
+     * loaded again when they are next opened.
+     * For internal use only.
+     *
+     * From [ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE] every retained page is closed with its
+     * text page. From [ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW] text pages no caller holds are
+     * closed too, even while their page is open.
+     *
+     * @param level the level passed to [ComponentCallbacks2.onTrimMemory]
+     * @return the estimated number of bytes released
+     */
+    @Suppress("DEPRECATION")
+    fun trimMemory(level: Int): Long {
+        if (handleAlreadyClosed(isClosed)) return 0
+        if (level < ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE) return 0
+
+        var released = 0L
+        retainedPages.keys.toList().forEach { pageIndex ->
+            released += estimateBytes(pageIndex)
+            releaseRetained(pageIndex)
+            evict(pageIndex)
+        }
+        if (level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW) {
+            textPageMap.filterValues { it.count == 0 }.forEach { (pageIndex, textPage) ->
+                released += nativeTextPage.getTextPageMemoryEstimate(textPage.pagePtr).coerceAtLeast(0L)
+                textPageMap.remove(pageIndex)
+                nativeTextPage.closeTextPage(textPage.pagePtr)
+            }
+        }
+        return released
+    }
+
     /**
      * Render multiple page fragments on a [Surface]'s buffer.
      * For internal use only.
@@ -384,6 +644,221 @@ class PdfDocumentU(
         )
     }
 
+    /**
+     * Open the native frame copy that lets [renderPages] render a scrolled frame by shifting the previous one.
+     * For internal use only.
+     *
+     * @return a new [SurfaceFrameU], to be closed when the Surface goes away
+     */
+    fun openSurfaceFrame(): SurfaceFrameU = SurfaceFrameU(nativeFactory)
+
+    /**
+     * Render multiple page fragments directly on a [Surface], reusing the previous frame when this one is it
+     * scrolled.
+     * For internal use only.
+     *
+     * When [frame] holds the previous frame rendered to [surface], and the Surface has not changed size, that
+     * frame is shifted by ([scrollX], [scrollY]) and only the strips the scroll uncovered are rendered. Otherwise
+     * the whole frame is rendered, as [renderPages] does without a frame. The [matrices] and [clipRects] must be
+     * exactly the previous frame's moved by the scroll; call [SurfaceFrameU.invalidate] after any other change.
+     *
+     * @param surface The [Surface] on which to render the pages.
+     * @param frame The frame copy kept for [surface].
+     * @param pages The list of [PdfPageU] to render.
+     * @param matrices The list of transformation [Matrix] for each page, mapping page coordinates
+     * to surface coordinates.
+     * @param clipRects The list of [RectF] for each page, defining the clipping area in surface coordinates.
+     * @param scrollX how far the content moved right since the previous frame, in pixels.
+     * @param scrollY how far the content moved down since the previous frame, in pixels.
+     * @param renderAnnot whether to render annotations.
+     * @param textMask whether to render text as an image mask - currently ignored.
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     *                            You almost always want this to be white (the default).
+     * @return `true` if rendering was successful, `false` otherwise.
+     * @throws IllegalStateException If a page, the document or the frame is closed.
+     */
+    @Suppress("LongParameterList")
+    fun renderPages(
+        surface: Surface,
+        frame: SurfaceFrameU,
+        pages: List<PdfPageU>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        scrollX: Int,
+        scrollY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ): Boolean {
+        if (handleAlreadyClosed(isClosed || frame.isClosed || pages.any { it.isClosed })) return false
+        val rendered =
+            nativeDocument.renderPagesSurfaceScrolled(
+                frame.framePtr,
+                pages.map { it.pagePtr }.toLongArray(),
+                surface,
+                matricesToFloatArray(matrices),
+                rectsToFloatArray(clipRects),
+                scrollX,
+                scrollY,
+                frame.hasFrame,
+                renderAnnot,
+                textMask,
+                canvasColor,
+                pageBackgroundColor,
+            )
+        frame.hasFrame = rendered
+        return rendered
+    }
+
+    /**
+     * Start a render loop that presents frames to [surface] from its own thread.
+     * For internal use only.
+     *
+     * @param surface The [Surface] to present to.
+     * @return a new [SurfaceRenderLoopU], to be closed when the Surface goes away, or `null` if the document is closed
+     * @throws IllegalStateException If the document is closed.
+     */
+    fun openRenderLoop(surface: Surface): SurfaceRenderLoopU? {
+        if (handleAlreadyClosed(isClosed)) return null
+        return SurfaceRenderLoopU(surface, nativeFactory)
+    }
+
+    /**
+     * Fill a [Bitmap] with a thumbnail of a page, opening the page only for the call.
+     * For internal use only.
+     *
+     * See [PdfPageU.renderThumbnail]. A page that is already open, or retained, is reused rather than reloaded.
+     *
+     * @param pageIndex the page index
+     * @param bitmap The `ARGB_8888` or `RGB_565` bitmap to fill
+     * @param pageBackgroundColor The color for the page background when the page is rendered
+     * @param useEmbedded `false` to ignore any embedded thumbnail and always render
+     * @return where the thumbnail came from, or `null` if it could not be made or the document is closed
+     * @throws IllegalStateException If the document is closed
+     */
+    fun renderThumbnail(
+        pageIndex: Int,
+        bitmap: Bitmap,
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? {
+        if (handleAlreadyClosed(isClosed)) return null
+        return openPage(pageIndex)?.use { it.renderThumbnail(bitmap, pageBackgroundColor, useEmbedded) }
+    }
+
+    /**
+     * Render thumbnails of the pages [fromIndex]..[toIndex] into a single atlas [Bitmap], in one native call.
+     * For internal use only.
+     *
+     * The pages are laid out left to right, then top to bottom, in [cellWidth] x [cellHeight] cells, and each
+     * is drawn centred in its cell at its own aspect ratio, the rest of the cell filled with [canvasColor].
+     * Pages are drawn as [PdfPageU.renderThumbnail] draws them. Pages that are already open, or retained,
+     * are drawn from their open handle; the rest are loaded and closed inside the call, without being opened
+     * through this document. Cells the range does not reach are left untouched.
+     *
+     * @param bitmap The `ARGB_8888` or `RGB_565` atlas bitmap
+     * @param fromIndex the index of the first page
+     * @param toIndex the index of the last page, inclusive
+     * @param cellWidth the width of a cell in pixels
+     * @param cellHeight the height of a cell in pixels
+     * @param canvasColor The color to fill each cell around its page with. Use 0 to not fill it.
+     * @param pageBackgroundColor The color for the page background when a page is rendered
+     * @param useEmbedded `false` to ignore embedded thumbnails and always render
+     * @return one rect per page, where it was drawn in the atlas, in pixels. A page that did not fit in the
+     * atlas, or could not be loaded, gets an empty rect. Empty if the document is closed.
+     * @throws IllegalStateException If the document is closed
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlas(
+        bitmap: Bitmap,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        @ColorInt canvasColor: Int = 0xFF848484.toInt(),
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> {
+        require(cellWidth > 0 && cellHeight > 0) { "Cell size must be positive: $cellWidth x $cellHeight" }
+        if (handleAlreadyClosed(isClosed) || toIndex < fromIndex) return emptyList()
+        val rects =
+            nativeDocument.renderThumbnailAtlas(
+                mNativeDocPtr,
+                fromIndex,
+                openPagePtrs(fromIndex, toIndex),
+                bitmap,
+                cellWidth,
+                cellHeight,
+                useEmbedded,
+                canvasColor,
+                pageBackgroundColor,
+            ) ?: return emptyList()
+        return floatArrayToRects(rects)
+    }
+
+    /**
+     * Render thumbnails of the pages [fromIndex]..[toIndex] into a single RGBA atlas held in a direct
+     * [ByteBuffer], in one native call. Like the [Bitmap] version, for a [width] x [height] atlas whose rows
+     * are `width * 4` bytes, with no stride padding.
+     * For internal use only.
+     *
+     * @param buffer a direct [ByteBuffer] of at least `width * height * 4` bytes
+     * @param width the width of the atlas in pixels
+     * @param height the height of the atlas in pixels
+     * @param fromIndex the index of the first page
+     * @param toIndex the index of the last page, inclusive
+     * @param cellWidth the width of a cell in pixels
+     * @param cellHeight the height of a cell in pixels
+     * @param canvasColor The color to fill each cell around its page with. Use 0 to not fill it.
+     * @param pageBackgroundColor The color for the page background when a page is rendered
+     * @param useEmbedded `false` to ignore embedded thumbnails and always render
+     * @return one rect per page, as for the [Bitmap] version
+     * @throws IllegalStateException If the document is closed
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlas(
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        @ColorInt canvasColor: Int = 0xFF848484.toInt(),
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> {
+        require(buffer.isDirect) { "The atlas buffer must be a direct ByteBuffer" }
+        require(buffer.capacity().toLong() >= width.toLong() * height * BYTES_PER_PIXEL) {
+            "The atlas buffer holds ${buffer.capacity()} bytes, too few for $width x $height pixels"
+        }
+        require(cellWidth > 0 && cellHeight > 0) { "Cell size must be positive: $cellWidth x $cellHeight" }
+        if (handleAlreadyClosed(isClosed) || toIndex < fromIndex) return emptyList()
+        val rects =
+            nativeDocument.renderThumbnailAtlasToBuffer(
+                mNativeDocPtr,
+                fromIndex,
+                openPagePtrs(fromIndex, toIndex),
+                buffer,
+                width,
+                height,
+                cellWidth,
+                cellHeight,
+                useEmbedded,
+                canvasColor,
+                pageBackgroundColor,
+            ) ?: return emptyList()
+        return floatArrayToRects(rects)
+    }
+
+    /** The native handle of each page in the range that is open or retained, 0 for the others. */
+    private fun openPagePtrs(
+        fromIndex: Int,
+        toIndex: Int,
+    ): LongArray = LongArray(toIndex - fromIndex + 1) { offset -> pageMap[fromIndex + offset]?.pagePtr ?: 0L }
+
     /**
      * Get metadata for given document.
      * For internal use only.
@@ -468,7 +943,7 @@ class PdfDocumentU(
             textPageMap[page.pageIndex]?.let {
                 it.count++
                 // The text page has a holder again, so its index is no longer evictable
-                retainedPages.remove(page.pageIndex)
+                releaseRetained(page.pageIndex)
 //                    Timber.d("from cache openTextPage: pageIndex: ${page.pageIndex}, count: ${it.count}")
                 return PdfTextPageU(this, page.pageIndex, it.pagePtr, textPageMap, nativeFactory)
             }
@@ -537,6 +1012,7 @@ class PdfDocumentU(
         parcelFileDescriptor = null
         source?.close()
         source = null
+        onPageAvailableListener = null
         matrixCache.clear()
     }
 
@@ -555,6 +1031,7 @@ class PdfDocumentU(
             pageMap.clear()
         }
         retainedPages.clear()
+        retainedBytes = 0L
     }
 
     /**
@@ -563,6 +1040,9 @@ class PdfDocumentU(
     companion object {
         private val TAG = PdfDocumentU::class.java.name
 
+        // An RGBA atlas pixel
+        private const val BYTES_PER_PIXEL = 4
+
         /** Flag for incremental save. */
         const val FPDF_INCREMENTAL = 1
 
@@ -571,5 +1051,8 @@ class PdfDocumentU(
 
         /** Flag to remove security from the document during save. */
         const val FPDF_REMOVE_SECURITY = 3
+
+        // fpdf_dataavail.h's value for an available page
+        private const val PDF_DATA_AVAIL = 1
     }
 }
@@ -32,7 +32,9 @@ import androidx.annotation.ColorInt
 import io.legere.pdfiumandroid.api.Link
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.PageAttributes
+import io.legere.pdfiumandroid.api.RenderCancellationToken
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.api.handleAlreadyClosed
 import io.legere.pdfiumandroid.core.jni.NativeFactory
 import io.legere.pdfiumandroid.core.jni.NativePageContract
@@ -64,13 +66,16 @@ class PdfPageU(
     val pageIndex: Int,
     val pagePtr: Long,
     private val pageMap: MutableMap<Int, PageCount>,
-    nativeFactory: NativeFactory = defaultNativeFactory,
+    private val nativeFactory: NativeFactory = defaultNativeFactory,
 ) : Closeable {
     @Volatile
     var isClosed = false
 
     private val nativePage: NativePageContract = nativeFactory.getNativePage()
 
+    // PDFium keeps a single progressive render per page, so a page has at most one in flight.
+    private var progressiveRender: ProgressiveRenderU? = null
+
     /**
      * Open a text page.
      * For internal use only.
@@ -162,6 +167,19 @@ class PdfPageU(
         return nativePage.getPageRotation(pagePtr)
     }
 
+    /**
+     * Get an estimate of the native memory the page holds: its parsed objects, and its images at
+     * the size they are cached once the page has been rendered.
+     * For internal use only.
+     *
+     * @return the approximate size of the page in bytes, or -1 on error
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun getMemoryEstimate(): Long {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return -1
+        return nativePage.getPageMemoryEstimate(pagePtr)
+    }
+
     /**
      * Get the page's crop box in PostScript points (1/72th of an inch).
      * For internal use only.
@@ -476,6 +494,104 @@ class PdfPageU(
         )
     }
 
+    /**
+     * Start rendering page fragment on a [Bitmap] in a way that can be paused and cancelled.
+     * For internal use only.
+     *
+     * Renders like [renderPageBitmap], except that the render stops early when [cancellationToken] is
+     * cancelled — from any thread, while the render is running — and pauses once [timeBudgetMillis] have
+     * passed, so the caller can let go of the lock and resume the render later with
+     * [ProgressiveRenderU.resume]. Starting another progressive render on this page, or closing the page,
+     * abandons one that is still incomplete; rendering the page any other way in between fails it.
+     *
+     * @param bitmap Bitmap on which to render page. It must stay alive until the render is finished.
+     * @param startX left position of the page in the bitmap
+     * @param startY top position of the page in the bitmap
+     * @param drawSizeX horizontal size of the page on the bitmap
+     * @param drawSizeY vertical size of the page on the bitmap
+     * @param renderAnnot whether render annotation
+     * @param textMask whether to render text as image mask. Currently ignored
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     * You almost always want this to be white (the default)
+     * @param cancellationToken token to stop the render with, or `null` if it will not be cancelled
+     * @param timeBudgetMillis how long to render before pausing. Use 0 to render until done or cancelled.
+     * @return the render, whose [ProgressiveRenderU.status] says whether it finished, or `null` if the
+     * page or document is closed
+     * @throws IllegalStateException If the page or document is closed
+     */
+    @Suppress("LongParameterList")
+    fun startRenderPageBitmap(
+        bitmap: Bitmap,
+        startX: Int,
+        startY: Int,
+        drawSizeX: Int,
+        drawSizeY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        cancellationToken: RenderCancellationToken? = null,
+        timeBudgetMillis: Long = 0,
+    ): ProgressiveRenderU? {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return null
+        progressiveRender?.close()
+        val render = ProgressiveRenderU(this, bitmap, cancellationToken, nativeFactory)
+        progressiveRender = render
+        render.start(
+            startX,
+            startY,
+            drawSizeX,
+            drawSizeY,
+            renderAnnot,
+            textMask,
+            canvasColor,
+            pageBackgroundColor,
+            timeBudgetMillis,
+        )
+        return render
+    }
+
+    /**
+     * Fill a [Bitmap] with a thumbnail of the page, as cheaply as possible.
+     * For internal use only.
+     *
+     * If the PDF stores a thumbnail image for the page and [useEmbedded] is set, that image is scaled to
+     * the bitmap and the page itself is never rendered. Otherwise the page is rendered at the bitmap's size
+     * with anti-aliasing and annotations turned off, which is noticeably faster than [renderPageBitmap] at
+     * thumbnail sizes. The page is stretched to fill the bitmap, so give it the page's aspect ratio.
+     *
+     * @param bitmap The `ARGB_8888` or `RGB_565` bitmap to fill
+     * @param pageBackgroundColor The color for the page background when the page is rendered
+     * @param useEmbedded `false` to ignore any embedded thumbnail and always render
+     * @return where the thumbnail came from, or `null` if it could not be made or the page is closed
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun renderThumbnail(
+        bitmap: Bitmap,
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return null
+        return when (nativePage.renderThumbnail(pagePtr, bitmap, useEmbedded, pageBackgroundColor)) {
+            THUMBNAIL_EMBEDDED -> ThumbnailSource.EMBEDDED
+            THUMBNAIL_RENDERED -> ThumbnailSource.RENDERED
+            else -> null
+        }
+    }
+
+    /**
+     * Whether the PDF stores a thumbnail image for this page.
+     * For internal use only.
+     *
+     * @return `true` if [renderThumbnail] can use an embedded thumbnail
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun hasEmbeddedThumbnail(): Boolean {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return false
+        return nativePage.hasEmbeddedThumbnail(pagePtr)
+    }
+
     /**
      * Get all links from given page.
      * For internal use only.
@@ -486,21 +602,24 @@ class PdfPageU(
     fun getPageLinks(): List<Link> {
         if (handleAlreadyClosed(isClosed || doc.isClosed)) return emptyList()
         val linkPtrs = nativePage.getPageLinks(pagePtr)
-        val links =
-            Array(linkPtrs.size) { i ->
-                val linkPtr = linkPtrs[i]
-                val index = nativePage.getDestPageIndex(doc.mNativeDocPtr, linkPtr)
-                val uri = nativePage.getLinkURI(doc.mNativeDocPtr, linkPtr)
-                val rect = nativePage.getLinkRect(doc.mNativeDocPtr, linkPtr)
-                Link(
-                    floatArrayToRect(rect),
-                    index,
-                    uri,
-                )
-            }
+        val links = Array(linkPtrs.size) { i -> getLink(linkPtrs[i]) }
         return links.toList()
     }
 
+    /**
+     * Describe the link annotation [linkPtr] of this page.
+     */
+    internal fun getLink(linkPtr: Long): Link {
+        val index = nativePage.getDestPageIndex(doc.mNativeDocPtr, linkPtr)
+        val uri = nativePage.getLinkURI(doc.mNativeDocPtr, linkPtr)
+        val rect = nativePage.getLinkRect(doc.mNativeDocPtr, linkPtr)
+        return Link(
+            floatArrayToRect(rect),
+            index,
+            uri,
+        )
+    }
+
     /**
      * Map page coordinates to device screen coordinates.
      * For internal use only.
@@ -754,6 +873,7 @@ class PdfPageU(
 
             it.count = 0
             isClosed = true
+            closeProgressiveRender()
 
             // The page has no holders left. The document may keep it open so that reopening it is
             // free; if it does not want it, close it now.
@@ -763,10 +883,16 @@ class PdfPageU(
             }
         } ?: run {
             isClosed = true
+            closeProgressiveRender()
             nativePage.closePage(pagePtr)
         }
     }
 
+    private fun closeProgressiveRender() {
+        progressiveRender?.close()
+        progressiveRender = null
+    }
+
     /**
      * Locks the surface and retrieves its dimensions and buffer pointers.
      * For internal use only.
@@ -801,6 +927,8 @@ class PdfPageU(
      */
     companion object {
         private const val TAG = "PdfPage"
+        private const val THUMBNAIL_RENDERED = 0
+        private const val THUMBNAIL_EMBEDDED = 1
 
         /**
          * Calculates a transformation matrix to map a source rectangle to a destination rectangle.
@@ -0,0 +1,135 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.api.handleAlreadyClosed
+import io.legere.pdfiumandroid.core.jni.NativeCoreContract
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+import io.legere.pdfiumandroid.core.util.PdfiumNativeSourceBridge
+import java.io.Closeable
+import java.io.IOException
+
+/**
+ * An **unlocked** loader for a document whose data is still arriving through a
+ * [StreamingPdfiumSource]. Created with [PdfiumCoreU.newStreamingLoader].
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * Each time more data arrives, call [isDocumentAvailable]; once it returns `true`, [openDocument]
+ * opens the document. Pages of the opened document become available as their data arrives, see
+ * [PdfDocumentU.isPageAvailable] and [PdfDocumentU.notifyDataAvailable]. For a linearized file the
+ * first page is usually available as soon as the document is.
+ *
+ * The opened document takes over the source and closes it when it is closed. Close the loader
+ * only to give up before a document has been opened.
+ *
+ * @property source The source the document is read from.
+ */
+class PdfStreamingLoaderU internal constructor(
+    val source: StreamingPdfiumSource,
+    private val nativeFactory: NativeFactory = defaultNativeFactory,
+) : Closeable {
+    private val nativeCore: NativeCoreContract = nativeFactory.getNativeCore()
+
+    private val availPtr: Long = nativeCore.openAvail(PdfiumNativeSourceBridge(source), source.length)
+
+    /**
+     * `true` once the loader has been closed or has handed its source over to an opened document.
+     */
+    var isClosed = false
+        private set
+
+    /**
+     * Whether the document is linearized, so its first page can load before the rest of the file.
+     * For internal use only.
+     *
+     * @return `true` or `false`, or `null` while too little of the file has arrived to tell
+     * @throws IllegalStateException if the loader is closed
+     */
+    fun isLinearized(): Boolean? {
+        if (handleAlreadyClosed(isClosed)) return null
+        return when (nativeCore.isLinearized(availPtr)) {
+            PDF_LINEARIZED -> true
+            PDF_NOT_LINEARIZED -> false
+            else -> null
+        }
+    }
+
+    /**
+     * Whether enough of the file has arrived to open the document. If not, the ranges PDFium needs
+     * are passed to [StreamingPdfiumSource.requestData].
+     * For internal use only.
+     *
+     * @return `true` if [openDocument] can be called
+     * @throws IOException if the data that has arrived is not a valid PDF
+     * @throws IllegalStateException if the loader is closed
+     */
+    @Throws(IOException::class)
+    fun isDocumentAvailable(): Boolean {
+        if (handleAlreadyClosed(isClosed)) return false
+        return when (nativeCore.isDocAvail(availPtr)) {
+            PDF_DATA_AVAIL -> true
+            PDF_DATA_NOTAVAIL -> false
+            else -> throw IOException("cannot check document availability")
+        }
+    }
+
+    /**
+     * Opens the document once [isDocumentAvailable] has returned `true`. The document takes over
+     * the source, and this loader is closed. If opening fails, for example with a wrong password,
+     * the loader stays open and opening can be tried again.
+     * For internal use only.
+     *
+     * @param password password for decryption
+     * @return [PdfDocumentU]
+     * @throws IOException if the document cannot be opened
+     * @throws IllegalStateException if the loader is closed
+     */
+    @Throws(IOException::class)
+    fun openDocument(password: String? = null): PdfDocumentU {
+        check(!isClosed) { "Already closed" }
+        val document = PdfDocumentU(nativeCore.openAvailDocument(availPtr, password), nativeFactory)
+        isClosed = true
+        return document.also {
+            it.parcelFileDescriptor = null
+            it.source = source
+        }
+    }
+
+    /**
+     * Gives up on a document that hasn't been opened, closing the source. Does nothing once a
+     * document has been opened.
+     */
+    override fun close() {
+        if (isClosed) return
+        isClosed = true
+        nativeCore.closeAvail(availPtr)
+        source.close()
+    }
+
+    private companion object {
+        // Values from PDFium's fpdf_dataavail.h
+        const val PDF_LINEARIZED = 1
+        const val PDF_NOT_LINEARIZED = 0
+        const val PDF_DATA_AVAIL = 1
+        const val PDF_DATA_NOTAVAIL = 0
+    }
+}
@@ -22,8 +22,11 @@
 package io.legere.pdfiumandroid.core.unlocked
 
 import android.graphics.RectF
+import io.legere.pdfiumandroid.api.CharGeometry
 import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.Link
 import io.legere.pdfiumandroid.api.Logger
+import io.legere.pdfiumandroid.api.PageWords
 import io.legere.pdfiumandroid.api.WordRangeRect
 import io.legere.pdfiumandroid.api.handleAlreadyClosed
 import io.legere.pdfiumandroid.core.jni.NativeFactory
@@ -46,6 +49,9 @@ private const val RANGE_LENGTH_OFFSET = 5
 
 private const val RANGE_RECT_DATA_SIZE = 6
 
+// A web link hit is its link index followed by the rectangle hit.
+private const val WEB_LINK_RECT_OFFSET = 1
+
 /**
  * Represents an **unlocked** text layer of a single page in a [PdfDocumentU].
  * This class is for **internal use only** within the PdfiumAndroid library.
@@ -82,6 +88,18 @@ class PdfTextPageU(
         return nativeTextPage.textCountChars(pagePtr)
     }
 
+    /**
+     * Get an estimate of the native memory the text page holds, which grows with its character count.
+     * For internal use only.
+     *
+     * @return the approximate size of the text page in bytes, or -1 on error
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun getMemoryEstimate(): Long {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return -1
+        return nativeTextPage.getTextPageMemoryEstimate(pagePtr)
+    }
+
     /**
      * Get the text on the page using a legacy method.
      * For internal use only. Prefer `textPageGetText`.
@@ -209,6 +227,50 @@ class PdfTextPageU(
         return null
     }
 
+    /**
+     * Get the geometry of a run of characters on the page in one native call, filling the arrays
+     * of [geometry] instead of allocating per character.
+     * For internal use only.
+     *
+     * @param geometry the [CharGeometry] to fill, reused across calls so its arrays are only allocated when they grow
+     * @param startIndex the index of the first character
+     * @param count the number of characters, or -1 for every character from [startIndex] to the end of the page
+     * @return [geometry], holding the characters filled; none if the page is closed or the range is out of bounds
+     * @throws IllegalStateException if the page or document is closed
+     */
+    @Suppress("ReturnCount")
+    fun textPageGetCharGeometry(
+        geometry: CharGeometry = CharGeometry(),
+        startIndex: Int = 0,
+        count: Int = -1,
+    ): CharGeometry {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) {
+            geometry.prepare(startIndex, 0)
+            return geometry
+        }
+        val wanted = if (count < 0) nativeTextPage.textCountChars(pagePtr) - startIndex else count
+        if (wanted <= 0) {
+            geometry.prepare(startIndex, 0)
+            return geometry
+        }
+        geometry.prepare(startIndex, wanted)
+        val written =
+            nativeTextPage.textGetCharGeometry(
+                pagePtr,
+                startIndex,
+                wanted,
+                geometry.unicodes,
+                geometry.looseBoxes,
+                geometry.tightBoxes,
+                geometry.origins,
+                geometry.angles,
+                geometry.fontSizes,
+                geometry.flags,
+            )
+        geometry.prepare(startIndex, written.coerceAtLeast(0))
+        return geometry
+    }
+
     /**
      * Get the index of the character at a given position on the page.
      * For internal use only.
@@ -242,6 +304,86 @@ class PdfTextPageU(
         return -1
     }
 
+    /**
+     * Get the index of the character at or nearest a position on the page, like
+     * [textPageGetCharIndexAtPos], from a spatial index of the page's characters instead of a scan
+     * over all of them. The index is built on the first hit test and kept until the text page is
+     * closed, so repeated queries such as the drag events of a selection stay cheap on dense pages.
+     * For internal use only.
+     *
+     * @param x the x position in page coordinates
+     * @param y the y position in page coordinates
+     * @param xTolerance the x tolerance
+     * @param yTolerance the y tolerance
+     * @return the 0-based index of the character, or -1 if no character is within tolerance
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageHitTestChar(
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ): Int {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return -1
+        return nativeTextPage.textHitTestChar(pagePtr, x, y, xTolerance, yTolerance)
+    }
+
+    /**
+     * Get the range of characters, from first to last, whose boxes overlap a rectangle, using the
+     * spatial index of [textPageHitTestChar].
+     * For internal use only.
+     *
+     * @param rect the rectangle in page coordinates
+     * @return the range of character indexes, empty if no character overlaps [rect]
+     * @throws IllegalStateException if the page or document is closed
+     */
+    @Suppress("ReturnCount")
+    fun textPageHitTestCharRange(rect: RectF): IntRange {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return IntRange.EMPTY
+        val range =
+            nativeTextPage.textHitTestCharRange(pagePtr, rect.left, rect.top, rect.right, rect.bottom)
+                ?: return IntRange.EMPTY
+        if (range[0] < 0) return IntRange.EMPTY
+        return range[0] until range[0] + range[1]
+    }
+
+    /**
+     * Get the link under a position on the page, either a link annotation of [page] or a web link
+     * found in the page text, using the spatial index of [textPageHitTestChar]. Link annotations
+     * take precedence.
+     * For internal use only.
+     *
+     * @param page the page this text page was opened from
+     * @param x the x position in page coordinates
+     * @param y the y position in page coordinates
+     * @return the [Link] under the position, or `null` if there is none; a web link's bounds are
+     * the rectangle of it that was hit
+     * @throws IllegalArgumentException if [page] is not the page this text page was opened from
+     * @throws IllegalStateException if the page or document is closed
+     */
+    @Suppress("ReturnCount")
+    fun textPageHitTestLink(
+        page: PdfPageU,
+        x: Double,
+        y: Double,
+    ): Link? {
+        require(page.doc === doc && page.pageIndex == pageIndex) { "page is not the page of this text page" }
+        if (handleAlreadyClosed(isClosed || doc.isClosed || page.isClosed)) return null
+        val linkPtr = nativeTextPage.textHitTestLink(pagePtr, page.pagePtr, x, y)
+        if (linkPtr != 0L) return page.getLink(linkPtr)
+        val hit = nativeTextPage.textHitTestWebLink(pagePtr, x, y) ?: return null
+        return Link(
+            RectF(
+                hit[WEB_LINK_RECT_OFFSET + LEFT_OFFSET],
+                hit[WEB_LINK_RECT_OFFSET + TOP_OFFSET],
+                hit[WEB_LINK_RECT_OFFSET + RIGHT_OFFSET],
+                hit[WEB_LINK_RECT_OFFSET + BOTTOM_OFFSET],
+            ),
+            null,
+            nativeTextPage.textGetWebLinkURL(pagePtr, hit[0].toInt()),
+        )
+    }
+
     /**
      * Get the count of rectangles that bound the text on the page in a given range.
      * For internal use only.
@@ -336,6 +478,20 @@ class PdfTextPageU(
         return null
     }
 
+    /**
+     * Segment the page into words and lines natively, with each word's offset, length and
+     * rectangle, in place of splitting its text into words here and asking for the
+     * rectangles of each with [textPageGetRectsForRanges].
+     * For internal use only.
+     *
+     * @return the page's [PageWords], or `null` if an error occurs
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageGetWords(): PageWords? {
+        if (handleAlreadyClosed(isClosed || doc.isClosed)) return null
+        return nativeTextPage.textGetWords(pagePtr)?.let { PageWords(it) }
+    }
+
     /**
      * Get the text bounded by the given rectangle.
      * For internal use only.
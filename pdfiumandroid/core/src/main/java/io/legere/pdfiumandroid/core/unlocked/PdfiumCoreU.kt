@@ -21,15 +21,19 @@
 
 package io.legere.pdfiumandroid.core.unlocked
 
+import android.content.ComponentCallbacks2
 import android.content.Context
 import android.os.ParcelFileDescriptor
 import android.util.Log
 import androidx.annotation.VisibleForTesting
 import io.legere.pdfiumandroid.api.Config
+import io.legere.pdfiumandroid.api.FileOpenMode
 import io.legere.pdfiumandroid.api.LockManager
 import io.legere.pdfiumandroid.api.LockManagerReentrantLock
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.api.pdfiumConfig
 import io.legere.pdfiumandroid.core.jni.NativeCoreContract
 import io.legere.pdfiumandroid.core.jni.NativeFactory
@@ -37,6 +41,7 @@ import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
 import io.legere.pdfiumandroid.core.util.InitLock
 import io.legere.pdfiumandroid.core.util.PdfiumNativeSourceBridge
 import java.io.IOException
+import java.nio.ByteBuffer
 
 /**
  * PdfiumCoreU is the **unlocked** main entry-point for raw access to the PDFium API.
@@ -73,6 +78,11 @@ class PdfiumCoreU(
                         libraryLoader.load("pdfium")
                         libraryLoader.load("pdfiumandroid")
                         // Load success
+                        if (config.initLibraryOnLoad) {
+                            // Off the caller's thread, so the first document opened does not pay for it
+                            setLibraryLifetime(config)
+                            nativeCore.initLibrary()
+                        }
                     } catch (e: Throwable) {
                         // Capture the error to throw on the main thread
                         libraryLoadError = e
@@ -98,6 +108,14 @@ class PdfiumCoreU(
         libraryLoadError?.let {
             throw RuntimeException("Failed to initialize PdfiumCore native libraries", it)
         }
+
+        setLibraryLifetime(config)
+        if (config.tileCacheBudgetBytes > 0) {
+            nativeCore.setTileCacheBudget(config.tileCacheBudgetBytes)
+        }
+        if (config.ditherRgb565) {
+            nativeCore.setRgb565Dither(true)
+        }
     }
 
     /**
@@ -113,6 +131,7 @@ class PdfiumCoreU(
 
     /**
      * Create new document from file descriptor with password.
+     * The file is read as [io.legere.pdfiumandroid.api.Config.fileOpenMode] says.
      * For internal use only.
      *
      * @param parcelFileDescriptor opened file descriptor of file
@@ -126,10 +145,10 @@ class PdfiumCoreU(
         password: String?,
     ): PdfDocumentU =
         PdfDocumentU(
-            nativeCore.openDocument(
-                parcelFileDescriptor.fd,
-                password,
-            ),
+            when (config.fileOpenMode) {
+                FileOpenMode.READ -> nativeCore.openDocument(parcelFileDescriptor.fd, password)
+                FileOpenMode.MEMORY_MAP -> nativeCore.openMappedDocument(parcelFileDescriptor.fd, password)
+            },
             nativeFactory,
         ).also { document ->
             document.parcelFileDescriptor = parcelFileDescriptor
@@ -166,6 +185,50 @@ class PdfiumCoreU(
             document.source = null
         }
 
+    /**
+     * Create new document from a direct [ByteBuffer] without copying it.
+     * For internal use only.
+     *
+     * @param data direct buffer holding the pdf file between its position and limit
+     * @return [PdfDocumentU]
+     * @throws IOException if the document cannot be opened
+     * @throws IllegalArgumentException if [data] is not a direct buffer
+     */
+    @Throws(IOException::class)
+    fun newDocument(data: ByteBuffer): PdfDocumentU = newDocument(data, null)
+
+    /**
+     * Create new document from a direct [ByteBuffer] with password, without copying it.
+     * PDFium reads the bytes between the buffer's position and limit in place, so they must not
+     * change while the document is open. The document keeps the buffer alive until it is closed.
+     * For internal use only.
+     *
+     * @param data direct buffer holding the pdf file between its position and limit
+     * @param password password for decryption
+     * @return [PdfDocumentU]
+     * @throws IOException if the document cannot be opened
+     * @throws IllegalArgumentException if [data] is not a direct buffer
+     */
+    @Throws(IOException::class)
+    fun newDocument(
+        data: ByteBuffer,
+        password: String?,
+    ): PdfDocumentU {
+        require(data.isDirect) { "Only direct buffers can be opened without a copy" }
+        return PdfDocumentU(
+            nativeCore.openDirectBufferDocument(
+                data,
+                data.position().toLong(),
+                data.remaining().toLong(),
+                password,
+            ),
+            nativeFactory,
+        ).also { document ->
+            document.parcelFileDescriptor = null
+            document.source = null
+        }
+    }
+
     /**
      * Create new document from custom data source.
      * For internal use only.
@@ -205,6 +268,97 @@ class PdfiumCoreU(
         }
     }
 
+    /**
+     * Create a loader for a document whose data is still arriving, which opens the document as soon
+     * as enough of it is available.
+     * For internal use only.
+     *
+     * @param source custom data source that reports which of its data has arrived
+     * @return [PdfStreamingLoaderU]
+     * @throws IOException if the data source is empty
+     */
+    @Throws(IOException::class)
+    fun newStreamingLoader(source: StreamingPdfiumSource): PdfStreamingLoaderU = PdfStreamingLoaderU(source, nativeFactory)
+
+    /**
+     * Sets how much native memory the tile cache may use, evicting the least recently drawn tiles
+     * until it fits. See [Config.tileCacheBudgetBytes].
+     * For internal use only.
+     *
+     * @param budgetBytes the budget in bytes; 0 switches the cache off and frees its memory
+     */
+    fun setTileCacheBudget(budgetBytes: Long) {
+        require(budgetBytes >= 0) { "budgetBytes must not be negative" }
+        nativeCore.setTileCacheBudget(budgetBytes)
+    }
+
+    /**
+     * Get the tile cache's counters.
+     * For internal use only.
+     *
+     * @return [TileCacheStats]
+     */
+    fun getTileCacheStats(): TileCacheStats {
+        val stats = nativeCore.getTileCacheStats()
+        return TileCacheStats(
+            hits = stats[STATS_HITS],
+            misses = stats[STATS_MISSES],
+            evictions = stats[STATS_EVICTIONS],
+            tileCount = stats[STATS_TILE_COUNT],
+            bytesAllocated = stats[STATS_BYTES_ALLOCATED],
+            budgetBytes = stats[STATS_BUDGET],
+        )
+    }
+
+    /**
+     * Drops every cached tile and frees the tile cache's memory; the budget stays as it is.
+     * For internal use only.
+     *
+     * @param resetStats whether the hit, miss and eviction counters start again from zero
+     */
+    fun clearTileCache(resetStats: Boolean = false) {
+        nativeCore.clearTileCache(resetStats)
+    }
+
+    /**
+     * Releases the native memory shared by all documents in response to
+     * [ComponentCallbacks2.onTrimMemory]. Pages each document keeps open are released by
+     * [PdfDocumentU.trimMemory].
+     * For internal use only.
+     *
+     * From [ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW] the tile cache is cleared. At
+     * [ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL], and from
+     * [ComponentCallbacks2.TRIM_MEMORY_BACKGROUND], later renders also stop PDFium keeping every
+     * decoded image cached on its page, until a call with a lower level, such as 0, restores it.
+     *
+     * @param level the level passed to [ComponentCallbacks2.onTrimMemory]
+     * @return the number of bytes released
+     */
+    @Suppress("DEPRECATION")
+    fun trimMemory(level: Int): Long {
+        nativeCore.setLimitedImageCache(
+            level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL || level >= ComponentCallbacks2.TRIM_MEMORY_BACKGROUND,
+        )
+        if (level < ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW) return 0
+
+        val released = nativeCore.getTileCacheStats()[STATS_BYTES_ALLOCATED]
+        nativeCore.clearTileCache(false)
+        return released
+    }
+
+    /**
+     * Tears down the PDFium library now, whatever [Config.libraryLifetime] says. It is set up again
+     * when the next document is opened.
+     * For internal use only.
+     *
+     * @return `false`, leaving the library as it is, if a document is still open
+     */
+    fun destroyLibrary(): Boolean = nativeCore.destroyLibrary()
+
+    private fun setLibraryLifetime(config: Config) {
+        nativeCore.setLibraryLifetime(config.libraryLifetime.ordinal, config.libraryIdleTimeoutMillis)
+    }
+
     /**
      * Sets the global [io.legere.pdfiumandroid.api.LockManager] for PdfiumAndroidKt.
      * For internal use only.
@@ -222,6 +376,14 @@ class PdfiumCoreU(
     companion object {
         private val TAG = PdfiumCoreU::class.java.name
 
+        // Layout of NativeCoreContract.getTileCacheStats
+        private const val STATS_HITS = 0
+        private const val STATS_MISSES = 1
+        private const val STATS_EVICTIONS = 2
+        private const val STATS_TILE_COUNT = 3
+        private const val STATS_BYTES_ALLOCATED = 4
+        private const val STATS_BUDGET = 5
+
         /** The global [io.legere.pdfiumandroid.api.LockManager] instance used for thread synchronization. */
         var lock: LockManager = LockManagerReentrantLock()
 
@@ -0,0 +1,136 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import android.graphics.Bitmap
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.RenderStatus
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.NativePageContract
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+import java.io.Closeable
+
+/**
+ * An **unlocked** render of a page into a [Bitmap] that can be paused, resumed and cancelled.
+ * Started with [PdfPageU.startRenderPageBitmap].
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * Once the render reaches a final [status] its native state is released on its own; [close] is only
+ * needed to abandon a render that is still [RenderStatus.INCOMPLETE].
+ *
+ * @property page The [PdfPageU] being rendered.
+ * @property bitmap The [Bitmap] being rendered into.
+ */
+class ProgressiveRenderU internal constructor(
+    val page: PdfPageU,
+    val bitmap: Bitmap,
+    private val cancellationToken: RenderCancellationToken?,
+    nativeFactory: NativeFactory = defaultNativeFactory,
+) : Closeable {
+    private val nativePage: NativePageContract = nativeFactory.getNativePage()
+
+    private val renderPtr: Long = nativePage.openProgressiveRender()
+
+    private var isClosed = false
+
+    private val cancelListener: () -> Unit = { cancel() }
+
+    /**
+     * Where the render stands. [RenderStatus.INCOMPLETE] until it has run to an end.
+     */
+    @Volatile
+    var status: RenderStatus = RenderStatus.INCOMPLETE
+        private set
+
+    init {
+        cancellationToken?.invokeOnCancel(cancelListener)
+    }
+
+    @Suppress("LongParameterList")
+    internal fun start(
+        startX: Int,
+        startY: Int,
+        drawSizeX: Int,
+        drawSizeY: Int,
+        renderAnnot: Boolean,
+        textMask: Boolean,
+        canvasColor: Int,
+        pageBackgroundColor: Int,
+        timeBudgetMillis: Long,
+    ): RenderStatus =
+        update(
+            nativePage.startProgressiveRender(
+                renderPtr,
+                page.pagePtr,
+                bitmap,
+                startX,
+                startY,
+                drawSizeX,
+                drawSizeY,
+                renderAnnot,
+                textMask,
+                canvasColor,
+                pageBackgroundColor,
+                timeBudgetMillis,
+            ),
+        )
+
+    /**
+     * Carry on with an incomplete render.
+     * For internal use only.
+     *
+     * @param timeBudgetMillis how long to render before pausing again. Use 0 to render until done or cancelled.
+     * @return the render's [status] afterwards
+     */
+    fun resume(timeBudgetMillis: Long = 0): RenderStatus {
+        if (status.isFinished) return status
+        return update(nativePage.continueProgressiveRender(renderPtr, bitmap, timeBudgetMillis))
+    }
+
+    /**
+     * Stop the render. Safe to call from any thread, including while another thread is running the
+     * render, which then returns [RenderStatus.CANCELLED] within a few milliseconds.
+     */
+    fun cancel() {
+        synchronized(this) {
+            if (!isClosed) nativePage.cancelProgressiveRender(renderPtr)
+        }
+    }
+
+    /**
+     * Release the render, abandoning it if it is still incomplete.
+     * For internal use only.
+     */
+    override fun close() {
+        synchronized(this) {
+            if (isClosed) return
+            isClosed = true
+        }
+        if (!status.isFinished) status = RenderStatus.CANCELLED
+        cancellationToken?.removeOnCancel(cancelListener)
+        nativePage.closeProgressiveRender(renderPtr, !page.doc.isClosed)
+    }
+
+    private fun update(nativeStatus: Int): RenderStatus {
+        status = RenderStatus.fromValue(nativeStatus)
+        if (status.isFinished) close()
+        return status
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import io.legere.pdfiumandroid.core.jni.NativeDocumentContract
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+import java.io.Closeable
+
+/**
+ * An **unlocked** native copy of the last frame rendered to a Surface by [PdfDocumentU.renderPages] with a
+ * scroll, so that the next frame, when it is the same view scrolled, only has to render the strip the scroll
+ * uncovered. Opened with [PdfDocumentU.openSurfaceFrame]; use one per Surface.
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * It holds a full RGBA copy of the Surface's buffer until it is closed.
+ */
+class SurfaceFrameU internal constructor(
+    nativeFactory: NativeFactory = defaultNativeFactory,
+) : Closeable {
+    private val nativeDocument: NativeDocumentContract = nativeFactory.getNativeDocument()
+
+    internal val framePtr: Long = nativeDocument.openSurfaceFrame()
+
+    /** `true` while the native copy holds the frame last shown on the Surface. */
+    internal var hasFrame = false
+
+    /** `true` once [close] has been called. */
+    var isClosed = false
+        private set
+
+    /**
+     * Make the next render draw the whole frame, for a change that is not a scroll: a zoom, a resize,
+     * a different page set, or anything drawn to the Surface by other means.
+     * For internal use only.
+     */
+    fun invalidate() {
+        hasFrame = false
+    }
+
+    /**
+     * Release the native copy of the frame.
+     * For internal use only.
+     */
+    override fun close() {
+        if (isClosed) return
+        isClosed = true
+        hasFrame = false
+        nativeDocument.closeSurfaceFrame(framePtr)
+    }
+}
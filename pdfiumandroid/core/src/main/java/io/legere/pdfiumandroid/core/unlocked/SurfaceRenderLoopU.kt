@@ -0,0 +1,128 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import android.graphics.Matrix
+import android.graphics.RectF
+import android.view.Surface
+import io.legere.pdfiumandroid.api.RenderLoopStats
+import io.legere.pdfiumandroid.api.handleAlreadyClosed
+import io.legere.pdfiumandroid.core.jni.NativeDocumentContract
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+import io.legere.pdfiumandroid.core.util.RenderLoopBridge
+import io.legere.pdfiumandroid.core.util.matricesToFloatArray
+import io.legere.pdfiumandroid.core.util.rectsToFloatArray
+import java.io.Closeable
+
+/**
+ * An **unlocked** render loop: a native thread that presents frames to one [Surface]. Opened with
+ * [PdfDocumentU.openRenderLoop]; use one per Surface.
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * [submit] only posts the frame and returns, so it can be called on every scroll or fling step from the UI
+ * thread. The loop renders the latest frame posted; one that is replaced before the loop gets to it is dropped.
+ * The loop takes [PdfiumCoreU.lock] only while rasterizing into its own back buffer, and copies that to the
+ * Surface after releasing it, so the Surface is never held waiting on PDFium. [PdfiumCoreU.lock] must therefore
+ * support [io.legere.pdfiumandroid.api.LockManager.withLockBlocking].
+ *
+ * Pages closed after a frame is submitted are left out of it, so pages can be closed while the loop runs.
+ */
+class SurfaceRenderLoopU internal constructor(
+    surface: Surface,
+    nativeFactory: NativeFactory = defaultNativeFactory,
+) : Closeable {
+    private val nativeDocument: NativeDocumentContract = nativeFactory.getNativeDocument()
+
+    private val bridge =
+        RenderLoopBridge {
+            PdfiumCoreU.lock.withLockBlocking { nativeDocument.rasterizeRenderLoopFrame(loopPtr) }
+        }
+
+    internal val loopPtr: Long = nativeDocument.openRenderLoop(surface, bridge)
+
+    /** `true` once [close] has been called. */
+    var isClosed = false
+        private set
+
+    /**
+     * Post a frame to the loop, replacing any frame it has not started yet. Does not wait for the frame.
+     * For internal use only.
+     *
+     * @param pages The list of [PdfPageU] to render.
+     * @param matrices The list of transformation [Matrix] for each page, mapping page coordinates
+     * to surface coordinates.
+     * @param clipRects The list of [RectF] for each page, defining the clipping area in surface coordinates.
+     * @param renderAnnot whether to render annotations.
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     * @throws IllegalStateException If the loop or a page is closed.
+     */
+    @Suppress("LongParameterList")
+    fun submit(
+        pages: List<PdfPageU>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        renderAnnot: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ) {
+        if (handleAlreadyClosed(isClosed || pages.any { it.isClosed }) || loopPtr == 0L) return
+        nativeDocument.submitRenderLoopFrame(
+            loopPtr,
+            pages.map { it.pagePtr }.toLongArray(),
+            matricesToFloatArray(matrices),
+            rectsToFloatArray(clipRects),
+            renderAnnot,
+            canvasColor,
+            pageBackgroundColor,
+        )
+    }
+
+    /**
+     * Get the loop's counters.
+     * For internal use only.
+     *
+     * @return the counters, all 0 once the loop is closed
+     */
+    fun getStats(): RenderLoopStats {
+        val stats = if (isClosed || loopPtr == 0L) null else nativeDocument.getRenderLoopStats(loopPtr)
+        return if (stats == null || stats.size < STATS_LEN) {
+            RenderLoopStats(0, 0, 0)
+        } else {
+            RenderLoopStats(stats[0], stats[1], stats[2])
+        }
+    }
+
+    /**
+     * Stop the loop, waiting for the frame it is on, and release the Surface. Must not be called holding
+     * [PdfiumCoreU.lock], which that frame may be waiting for.
+     * For internal use only.
+     */
+    override fun close() {
+        if (isClosed) return
+        isClosed = true
+        if (loopPtr != 0L) nativeDocument.closeRenderLoop(loopPtr)
+    }
+
+    companion object {
+        private const val STATS_LEN = 3
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import io.legere.pdfiumandroid.api.DocumentText
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.handleAlreadyClosed
+import io.legere.pdfiumandroid.core.jni.NativeDocumentContract
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.legere.pdfiumandroid.core.jni.defaultNativeFactory
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * An **unlocked** extraction of the text of a run of pages into one direct [ByteBuffer], done a
+ * few pages at a time so a caller can let go of the PDFium lock in between.
+ * Started with [PdfDocumentU.startTextExtraction].
+ * This class is for **internal use only** within the PdfiumAndroid library.
+ *
+ * The buffer doubles whenever the next page's text does not fit, so size `initialCapacity` for the
+ * whole run to avoid copying.
+ *
+ * @property doc The [PdfDocumentU] the pages belong to.
+ * @property firstPage The index of the first page to extract.
+ * @property pageCount How many pages to extract.
+ * @property encoding The encoding to extract the text in.
+ */
+class TextExtractionU internal constructor(
+    val doc: PdfDocumentU,
+    val firstPage: Int,
+    val pageCount: Int,
+    val encoding: TextEncoding,
+    initialCapacity: Int,
+    nativeFactory: NativeFactory = defaultNativeFactory,
+) {
+    private val nativeDocument: NativeDocumentContract = nativeFactory.getNativeDocument()
+
+    private var buffer = allocate(initialCapacity)
+
+    private val pageEnds = IntArray(pageCount)
+
+    /** How many pages have been extracted so far. */
+    var pagesDone = 0
+        private set
+
+    /** Whether every page has been extracted. */
+    val isFinished: Boolean
+        get() = pagesDone == pageCount
+
+    /**
+     * Extract up to [maxPages] more pages.
+     * For internal use only.
+     *
+     * @param maxPages the most pages to extract in this call
+     * @return `true` if there is nothing left to do, because every page is done or the document was closed
+     * @throws IllegalStateException if a page's text cannot be extracted or the buffer cannot grow to fit it
+     */
+    fun extractNext(maxPages: Int = pageCount): Boolean {
+        if (handleAlreadyClosed(doc.isClosed)) return true
+        var budget = maxPages
+        while (!isFinished && budget > 0) {
+            val position = bytesDone()
+            val written =
+                nativeDocument.extractText(
+                    doc.mNativeDocPtr,
+                    firstPage + pagesDone,
+                    minOf(budget, pageCount - pagesDone),
+                    buffer,
+                    position,
+                    encoding == TextEncoding.UTF_8,
+                    pageEnds,
+                    pagesDone,
+                )
+            check(written >= 0) { "Could not extract the text of page ${firstPage + pagesDone}" }
+            if (written == 0) grow(position)
+            pagesDone += written
+            budget -= written
+        }
+        return isFinished
+    }
+
+    /**
+     * The text of the pages extracted so far, sharing this extraction's buffer.
+     * For internal use only.
+     */
+    fun result(): DocumentText {
+        val text = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+        text.position(0)
+        text.limit(bytesDone())
+        return DocumentText(text, encoding, firstPage, pageEnds.copyOf(pagesDone))
+    }
+
+    private fun bytesDone(): Int = if (pagesDone == 0) 0 else pageEnds[pagesDone - 1]
+
+    private fun grow(used: Int) {
+        check(buffer.capacity() < MAX_CAPACITY) { "The text of page ${firstPage + pagesDone} does not fit in a buffer" }
+        val grown = allocate(minOf(buffer.capacity().toLong() * 2, MAX_CAPACITY.toLong()).toInt())
+        val src = buffer.duplicate()
+        src.position(0)
+        src.limit(used)
+        grown.put(src)
+        grown.clear()
+        buffer = grown
+    }
+
+    private fun allocate(capacity: Int): ByteBuffer =
+        ByteBuffer.allocateDirect(maxOf(capacity, MIN_CAPACITY)).order(ByteOrder.LITTLE_ENDIAN)
+
+    companion object {
+        private const val MIN_CAPACITY = 4096
+
+        // The largest array the VM reliably allocates.
+        private const val MAX_CAPACITY = Int.MAX_VALUE - 8
+
+        /** How many pages the locked wrappers extract before letting go of the lock. */
+        const val DEFAULT_PAGES_PER_LOCK = 8
+
+        /** The bytes a page's text is assumed to take when no initial capacity is given. */
+        internal const val BYTES_PER_PAGE_ESTIMATE = 4096
+    }
+}
@@ -93,3 +93,8 @@ fun rectsToFloatArray(rects: Collection<RectF>): FloatArray =
         .flatMap { rect ->
             rectToFloatArray(rect).asIterable()
         }.toFloatArray()
+
+fun floatArrayToRects(rectValues: FloatArray): List<RectF> =
+    List(rectValues.size / 4) { i ->
+        floatArrayToRect(rectValues.copyOfRange(i * 4, i * 4 + 4))
+    }
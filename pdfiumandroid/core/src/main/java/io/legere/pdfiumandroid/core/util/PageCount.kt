@@ -28,4 +28,7 @@ package io.legere.pdfiumandroid.core.util
 data class PageCount(
     val pagePtr: Long,
     var count: Int,
-)
+) {
+    /** The estimated native memory the loaded page holds, measured when first needed; -1 until then. */
+    var memoryEstimate: Long = -1
+}
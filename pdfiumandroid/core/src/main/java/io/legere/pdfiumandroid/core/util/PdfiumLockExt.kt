@@ -19,6 +19,7 @@
 
 package io.legere.pdfiumandroid.core.util
 
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
 
 /**
@@ -30,11 +31,15 @@ import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
  * consider using [io.legere.pdfiumandroid.suspend.wrapSuspend].
  *
  * @param T The return type of the [block].
+ * @param tag The operation's name, for an [io.legere.pdfiumandroid.api.InstrumentedLockManager]; see [LockTag].
  * @param block The block of code to execute. This block will be run inside a
  *              `withLockBlocking` block on a shared mutex to ensure thread safety with native calls.
  * @return The result of the [block] execution.
  */
-inline fun <reified T> wrapLock(crossinline block: () -> T): T =
-    PdfiumCoreU.lock.withLockBlocking {
+inline fun <reified T> wrapLock(
+    tag: String = LockTag.UNTAGGED,
+    crossinline block: () -> T,
+): T =
+    PdfiumCoreU.lock.withLockBlocking(tag) {
         block()
     }
@@ -21,6 +21,7 @@ package io.legere.pdfiumandroid.core.util
 
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
 
 /**
  * A bridge class used internally to provide a custom [io.legere.pdfiumandroid.api.PdfiumSource] to
@@ -67,4 +68,44 @@ class PdfiumNativeSourceBridge(
             Logger.e("PdfiumNativeSourceBridge", t, "read failed")
             0
         }
+
+    /**
+     * Whether a range of the source can be read now. Sources that aren't a [StreamingPdfiumSource]
+     * are always fully available.
+     * This method is called by the native PDFium library.
+     *
+     * @param position The starting offset of the range.
+     * @param size The number of bytes in the range.
+     * @return `true` if the whole range is available, `false` if not or if the check failed.
+     */
+    @Suppress("TooGenericExceptionCaught")
+    fun isDataAvailable(
+        position: Long,
+        size: Long,
+    ): Boolean =
+        try {
+            (source as? StreamingPdfiumSource)?.isDataAvailable(position, size) ?: true
+        } catch (t: Throwable) {
+            Logger.e("PdfiumNativeSourceBridge", t, "isDataAvailable failed")
+            false
+        }
+
+    /**
+     * Passes on PDFium's hint that it is waiting for a range of the source.
+     * This method is called by the native PDFium library.
+     *
+     * @param position The starting offset of the range.
+     * @param size The number of bytes in the range.
+     */
+    @Suppress("TooGenericExceptionCaught")
+    fun requestData(
+        position: Long,
+        size: Long,
+    ) {
+        try {
+            (source as? StreamingPdfiumSource)?.requestData(position, size)
+        } catch (t: Throwable) {
+            Logger.e("PdfiumNativeSourceBridge", t, "requestData failed")
+        }
+    }
 }
@@ -0,0 +1,50 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.util
+
+import io.legere.pdfiumandroid.api.Logger
+
+/**
+ * A bridge class used internally to let a native render loop's thread rasterize a frame from Kotlin, where it
+ * can take the PDFium lock. The loop itself lives in native code; see
+ * [io.legere.pdfiumandroid.core.unlocked.SurfaceRenderLoopU].
+ *
+ * @property renderFrame Rasterizes the frame the loop's thread is on, returning `true` if it should be presented.
+ */
+
+class RenderLoopBridge(
+    private val renderFrame: () -> Boolean,
+) {
+    /**
+     * Rasterizes the current frame.
+     * This method is called by the native render loop's thread.
+     *
+     * @return `true` if the frame was rasterized, `false` if not or if rasterizing failed.
+     */
+    @Suppress("TooGenericExceptionCaught")
+    fun rasterize(): Boolean =
+        try {
+            renderFrame()
+        } catch (t: Throwable) {
+            // This is to prevent the exception to go to the native code level
+            Logger.e("RenderLoopBridge", t, "rasterize failed")
+            false
+        }
+}
@@ -20,17 +20,29 @@
 
 package io.legere.pdfiumandroid
 
+import android.graphics.Bitmap
 import android.graphics.Matrix
 import android.graphics.RectF
 import android.view.Surface
+import androidx.annotation.ColorInt
 import io.legere.pdfiumandroid.PdfDocument.Companion.FPDF_INCREMENTAL
 import io.legere.pdfiumandroid.PdfDocument.Companion.FPDF_NO_INCREMENTAL
 import io.legere.pdfiumandroid.PdfDocument.Companion.FPDF_REMOVE_SECURITY
+import io.legere.pdfiumandroid.api.DocumentText
+import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.PdfWriteCallback
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.SearchHits
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.ThumbnailSource
+import io.legere.pdfiumandroid.core.unlocked.DocumentSearchU
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU
+import io.legere.pdfiumandroid.core.unlocked.TextExtractionU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import java.io.Closeable
+import java.nio.ByteBuffer
 
 private const val MAX_RECURSION = 16
 private const val THREE_BY_THREE = 9
@@ -69,6 +81,52 @@ class PdfDocument internal constructor(
             document.getPageCount()
         }
 
+    /**
+     * Whether a page's data has arrived, so the page can be opened. Always `true` unless the
+     * document was opened with a [PdfStreamingLoader]; for such a document, don't open a page
+     * before this returns `true`.
+     * @param pageIndex the page index
+     * @return `true` if the page can be opened
+     * @throws IllegalStateException if document is closed
+     */
+    fun isPageAvailable(pageIndex: Int): Boolean =
+        wrapLock {
+            document.isPageAvailable(pageIndex)
+        }
+
+    /**
+     * The page a linearized document makes available first, usually the first page.
+     * @return the page index; 0 for a document that isn't linearized
+     * @throws IllegalStateException if document is closed
+     */
+    fun getFirstAvailablePage(): Int =
+        wrapLock {
+            document.getFirstAvailablePage()
+        }
+
+    /**
+     * Sets the listener [notifyDataAvailable] reports newly available pages to, or clears it.
+     * The listener is called with the lock held.
+     * @param listener called with the index of each page that has become available
+     */
+    fun setOnPageAvailableListener(listener: ((pageIndex: Int) -> Unit)?) {
+        wrapLock {
+            document.setOnPageAvailableListener(listener)
+        }
+    }
+
+    /**
+     * Tells a document opened with a [PdfStreamingLoader] that more of its data has arrived.
+     * Pages that have become available are reported to the listener set with
+     * [setOnPageAvailableListener].
+     * @return the indexes of the pages that became available, in page order
+     * @throws IllegalStateException if document is closed
+     */
+    fun notifyDataAvailable(): List<Int> =
+        wrapLock {
+            document.notifyDataAvailable()
+        }
+
     /**
      *  Get the page character counts for every page of the PDF document
      *  @return an array of character counts
@@ -78,6 +136,76 @@ class PdfDocument internal constructor(
             document.getPageCharCounts()
         }
 
+    /**
+     * Extract the text of a run of pages into one direct [ByteBuffer], with a table of where each page's
+     * text starts and ends, for indexing a document without a string per page. Pages are loaded and
+     * closed natively one after another, so pages already open are unaffected, and the lock is let go
+     * every [pagesPerLock] pages so rendering can go on while a large document is extracted.
+     *
+     * @param firstPage the index of the first page
+     * @param pageCount how many pages, or -1 for every page from [firstPage] on
+     * @param encoding the encoding to extract the text in
+     * @param pagesPerLock how many pages to extract each time the lock is taken
+     * @return the text, or `null` if the document is closed
+     * @throws IllegalArgumentException if the pages are not in the document
+     * @throws IllegalStateException if a page's text cannot be extracted
+     */
+    fun extractText(
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        encoding: TextEncoding = TextEncoding.UTF_16LE,
+        pagesPerLock: Int = TextExtractionU.DEFAULT_PAGES_PER_LOCK,
+    ): DocumentText? {
+        val extraction =
+            wrapLock(LockTag.EXTRACT_TEXT) {
+                document.startTextExtraction(firstPage, pageCount, encoding)
+            } ?: return null
+        var done = false
+        while (!done) {
+            done = wrapLock(LockTag.EXTRACT_TEXT) { extraction.extractNext(pagesPerLock) }
+        }
+        return extraction.result()
+    }
+
+    /**
+     * Search a run of pages for a string, collecting every hit with its page, character range and the
+     * rectangles that highlight it. Each run of [pagesPerLock] pages is searched in one native call, so a
+     * long document is one background job rather than a native call per hit, and the lock is let go
+     * between runs. Text pages already open, or retained, are searched without loading them again.
+     *
+     * @param query the string to find
+     * @param flags a set of [FindFlags] to control the search
+     * @param firstPage the index of the first page
+     * @param pageCount how many pages, or -1 for every page from [firstPage] on
+     * @param pagesPerLock how many pages to search each time the lock is taken
+     * @param cancellationToken stops the search between runs of pages once cancelled
+     * @param onPagesSearched called after each run of pages, outside the lock, with that run's hits and
+     * how many pages have been searched so far
+     * @return every hit found, up to the cancellation if there was one, or `null` if the document is closed
+     * @throws IllegalArgumentException if the query is empty or the pages are not in the document
+     * @throws IllegalStateException if the pages cannot be searched
+     */
+    @Suppress("LongParameterList")
+    fun search(
+        query: String,
+        flags: Set<FindFlags> = emptySet(),
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        pagesPerLock: Int = DocumentSearchU.DEFAULT_PAGES_PER_LOCK,
+        cancellationToken: RenderCancellationToken? = null,
+        onPagesSearched: ((hits: SearchHits, pagesSearched: Int) -> Unit)? = null,
+    ): SearchHits? {
+        val search =
+            wrapLock(LockTag.SEARCH) {
+                document.startSearch(query, flags, firstPage, pageCount, cancellationToken)
+            } ?: return null
+        while (!search.isFinished) {
+            val hits = wrapLock(LockTag.SEARCH) { search.searchNext(pagesPerLock) } ?: return null
+            onPagesSearched?.invoke(hits, search.pagesDone)
+        }
+        return search.result()
+    }
+
     /**
      * Get a page's size in pixels without opening it.
      *
@@ -120,7 +248,7 @@ class PdfDocument internal constructor(
      * RuntimeException if the page cannot be loaded
      */
     fun openPage(pageIndex: Int): PdfPage? =
-        wrapLock {
+        wrapLock(LockTag.OPEN_PAGE) {
             document.openPage(pageIndex)?.let { PdfPage(it) }
         }
 
@@ -146,7 +274,7 @@ class PdfDocument internal constructor(
         fromIndex: Int,
         toIndex: Int,
     ): List<PdfPage> =
-        wrapLock {
+        wrapLock(LockTag.OPEN_PAGE) {
             document.openPages(fromIndex, toIndex).map { PdfPage(it) }
         }
 
@@ -176,20 +304,19 @@ class PdfDocument internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ) {
-        wrapLock {
-            document.renderPages(
-                bufferPtr,
-                drawSizeX,
-                drawSizeY,
-                pages.map { it.page },
-                matrices,
-                clipRects,
-                renderAnnot,
-                textMask,
-                canvasColor,
-                pageBackgroundColor,
-            )
-        }
+        // The PDFium lock is taken natively around the rendering alone, and pages closed meanwhile are skipped.
+        document.renderPages(
+            bufferPtr,
+            drawSizeX,
+            drawSizeY,
+            pages.map { it.page },
+            matrices,
+            clipRects,
+            renderAnnot,
+            textMask,
+            canvasColor,
+            pageBackgroundColor,
+        )
     }
 
     @Suppress("LongParameterList")
@@ -203,12 +330,68 @@ class PdfDocument internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Boolean =
-        wrapLock {
+        // The PDFium lock is taken natively around the rendering alone, not while the Surface is locked or posted.
+        document.renderPages(
+            surface,
+            pages.map { it.page },
+            matrices,
+            clipRects,
+            renderAnnot,
+            textMask,
+            canvasColor,
+            pageBackgroundColor,
+        )
+
+    /**
+     * Open a [SurfaceFrame] for a Surface, so that [renderPages] can render a scrolled frame by shifting
+     * the previous one.
+     * @return a new [SurfaceFrame], to be closed when the Surface is destroyed
+     */
+    fun openSurfaceFrame(): SurfaceFrame = SurfaceFrame(document.openSurfaceFrame())
+
+    /**
+     * Render multiple page fragments directly on a [Surface], reusing the previous frame when this one is it
+     * scrolled.<br></br>
+     * When [frame] holds the previous frame rendered to [surface], that frame is shifted by
+     * ([scrollX], [scrollY]) and only the strips the scroll uncovered are rendered, so continuous scrolling
+     * rasterizes a small fraction of the pixels a full render does. The [matrices] and [clipRects] must be
+     * exactly the previous frame's moved by the scroll; call [SurfaceFrame.invalidate] after any other change.
+     * @param surface The [Surface] on which to render the pages
+     * @param frame The [SurfaceFrame] kept for [surface]
+     * @param pages The pages to render
+     * @param matrices The transformation [Matrix] for each page, mapping page coordinates to surface coordinates
+     * @param clipRects The [RectF] for each page, defining the clipping area in surface coordinates
+     * @param scrollX how far the content moved right since the previous frame, in pixels
+     * @param scrollY how far the content moved down since the previous frame, in pixels
+     * @param renderAnnot whether render annotation
+     * @param textMask whether to render text as image mask. Currently ignored
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     * @return `true` if rendering was successful
+     */
+    @Suppress("LongParameterList")
+    fun renderPages(
+        surface: Surface,
+        frame: SurfaceFrame,
+        pages: List<PdfPage>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        scrollX: Int,
+        scrollY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ): Boolean =
+        wrapLock(LockTag.RENDER_PAGES) {
             document.renderPages(
                 surface,
+                frame.frame,
                 pages.map { it.page },
                 matrices,
                 clipRects,
+                scrollX,
+                scrollY,
                 renderAnnot,
                 textMask,
                 canvasColor,
@@ -216,6 +399,124 @@ class PdfDocument internal constructor(
             )
         }
 
+    /**
+     * Open a [SurfaceRenderLoop] that presents frames to [surface] from its own thread, so that scrolling can
+     * post each viewport without waiting for it to render.
+     * @param surface The [Surface] to present to
+     * @return a new [SurfaceRenderLoop], to be closed when the Surface is destroyed, or `null` if the document
+     * is closed
+     */
+    fun openRenderLoop(surface: Surface): SurfaceRenderLoop? =
+        wrapLock {
+            document.openRenderLoop(surface)?.let { SurfaceRenderLoop(it) }
+        }
+
+    /**
+     * Fill [bitmap] with a thumbnail of a page, opening the page only for the call.
+     * See [PdfPage.renderThumbnail].
+     * @param pageIndex the page index
+     * @param bitmap The `ARGB_8888` or `RGB_565` bitmap to fill
+     * @param pageBackgroundColor The color for the page background when the page is rendered
+     * @param useEmbedded `false` to ignore any embedded thumbnail and always render
+     * @return where the thumbnail came from, or `null` if it could not be made
+     * @throws IllegalStateException if document is closed
+     */
+    fun renderThumbnail(
+        pageIndex: Int,
+        bitmap: Bitmap,
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? =
+        wrapLock {
+            document.renderThumbnail(pageIndex, bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * Render thumbnails of the pages [fromIndex]..[toIndex] into a single atlas [Bitmap], taking the lock and
+     * crossing into native code once for the whole batch.<br></br>
+     * Pages are laid out left to right, then top to bottom, in [cellWidth] x [cellHeight] cells, each centred
+     * in its cell at its own aspect ratio and drawn as [PdfPage.renderThumbnail] draws it. Pages need not be
+     * open; those that are, are reused.
+     * @param bitmap The `ARGB_8888` or `RGB_565` atlas bitmap
+     * @param fromIndex the index of the first page
+     * @param toIndex the index of the last page, inclusive
+     * @param cellWidth the width of a cell in pixels
+     * @param cellHeight the height of a cell in pixels
+     * @param canvasColor The color to fill each cell around its page with. Use 0 to not fill it.
+     * @param pageBackgroundColor The color for the page background when a page is rendered
+     * @param useEmbedded `false` to ignore embedded thumbnails and always render
+     * @return one rect per page, where it was drawn in the atlas. A page that did not fit, or could not be
+     * loaded, gets an empty rect.
+     * @throws IllegalStateException if document is closed
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlas(
+        bitmap: Bitmap,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        @ColorInt canvasColor: Int = 0xFF848484.toInt(),
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> =
+        wrapLock {
+            document.renderThumbnailAtlas(
+                bitmap,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
+    /**
+     * Render thumbnails of the pages [fromIndex]..[toIndex] into a single RGBA atlas held in a direct
+     * [ByteBuffer] of [width] x [height] pixels, rows `width * 4` bytes apart. Otherwise as the [Bitmap] version.
+     * @param buffer a direct [ByteBuffer] of at least `width * height * 4` bytes
+     * @param width the width of the atlas in pixels
+     * @param height the height of the atlas in pixels
+     * @param fromIndex the index of the first page
+     * @param toIndex the index of the last page, inclusive
+     * @param cellWidth the width of a cell in pixels
+     * @param cellHeight the height of a cell in pixels
+     * @param canvasColor The color to fill each cell around its page with. Use 0 to not fill it.
+     * @param pageBackgroundColor The color for the page background when a page is rendered
+     * @param useEmbedded `false` to ignore embedded thumbnails and always render
+     * @return one rect per page, as for the [Bitmap] version
+     * @throws IllegalStateException if document is closed
+     */
+    @Suppress("LongParameterList")
+    fun renderThumbnailAtlas(
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        @ColorInt canvasColor: Int = 0xFF848484.toInt(),
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> =
+        wrapLock {
+            document.renderThumbnailAtlas(
+                buffer,
+                width,
+                height,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
     /**
      * Get metadata for given document
      * @return the [Meta] data
@@ -251,6 +552,25 @@ class PdfDocument internal constructor(
             document.saveAsCopy(callback, flags)
         }
 
+    /**
+     * Close the pages this document keeps open that no caller holds, so that their native memory
+     * can be reclaimed. Call it, with [PdfiumCore.trimMemory], from
+     * [android.content.ComponentCallbacks2.onTrimMemory].
+     *
+     * From `TRIM_MEMORY_RUNNING_MODERATE` the pages retained after their last holder closed them
+     * are closed, see [io.legere.pdfiumandroid.api.Config.pageRetentionCount]. From
+     * `TRIM_MEMORY_RUNNING_LOW` text pages no caller holds are closed too. Pages and text pages
+     * that are still held stay open.
+     *
+     * @param level the level passed to [android.content.ComponentCallbacks2.onTrimMemory]
+     * @return the estimated number of bytes released
+     * @throws IllegalStateException if document is closed
+     */
+    fun trimMemory(level: Int): Long =
+        wrapLock {
+            document.trimMemory(level)
+        }
+
     /**
      * Close the document
      * @throws IllegalArgumentException if document is closed
@@ -30,8 +30,11 @@ import android.graphics.RectF
 import android.view.Surface
 import androidx.annotation.ColorInt
 import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.PageAttributes
+import io.legere.pdfiumandroid.api.RenderCancellationToken
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.core.unlocked.PdfPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import java.io.Closeable
@@ -127,6 +130,17 @@ class PdfPage internal constructor(
             page.getPageRotation()
         }
 
+    /**
+     * Get an estimate of the native memory the page holds: its parsed objects, and its images at
+     * the size they are cached once the page has been rendered.
+     * @return the approximate size of the page in bytes, or -1 on error
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun getMemoryEstimate(): Long =
+        wrapLock {
+            page.getMemoryEstimate()
+        }
+
     /**
      *  Get the page's crop box in PostScript points (1/72th of an inch)
      *  @return page crop box in points or RectF(-1, -1, -1, -1) if not present
@@ -223,7 +237,7 @@ class PdfPage internal constructor(
         @ColorInt
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Boolean =
-        wrapLock {
+        wrapLock(LockTag.RENDER_PAGE) {
             page.renderPage(
                 bufferPtr,
                 startX,
@@ -260,7 +274,7 @@ class PdfPage internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Boolean =
-        wrapLock {
+        wrapLock(LockTag.RENDER_PAGE) {
             page.renderPage(
                 bufferPtr,
                 drawSizeX,
@@ -284,7 +298,7 @@ class PdfPage internal constructor(
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
     ): Boolean =
-        wrapLock {
+        wrapLock(LockTag.RENDER_PAGE) {
             page.renderPage(
                 surface,
                 matrix,
@@ -315,6 +329,7 @@ class PdfPage internal constructor(
      *  * ARGB_8888 - best quality, high memory usage, higher possibility of OutOfMemoryError
      *  * RGB_565 - little worse quality, 1/2 the memory usage.  Much more expensive to render
      *
+     * The PDFium lock is taken natively around the rendering alone, not while the bitmap is locked or converted.
      */
     @Suppress("LongParameterList")
     fun renderPageBitmap(
@@ -327,19 +342,17 @@ class PdfPage internal constructor(
         textMask: Boolean = false,
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
-    ) = wrapLock {
-        page.renderPageBitmap(
-            bitmap,
-            startX,
-            startY,
-            drawSizeX,
-            drawSizeY,
-            renderAnnot,
-            textMask,
-            canvasColor,
-            pageBackgroundColor,
-        )
-    }
+    ) = page.renderPageBitmap(
+        bitmap,
+        startX,
+        startY,
+        drawSizeX,
+        drawSizeY,
+        renderAnnot,
+        textMask,
+        canvasColor,
+        pageBackgroundColor,
+    )
 
     /**
      * Render page fragment on [Bitmap].<br></br>
@@ -358,6 +371,7 @@ class PdfPage internal constructor(
      *  * ARGB_8888 - best quality, high memory usage, higher possibility of OutOfMemoryError
      *  * RGB_565 - little worse quality, 1/2 the memory usage.  Much more expensive to render
      *
+     * The PDFium lock is taken natively around the rendering alone, not while the bitmap is locked or converted.
      */
     @Suppress("LongParameterList")
     fun renderPageBitmap(
@@ -368,17 +382,95 @@ class PdfPage internal constructor(
         textMask: Boolean = false,
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
-    ) = wrapLock {
-        page.renderPageBitmap(
-            bitmap,
-            matrix,
-            clipRect,
-            renderAnnot,
-            textMask,
-            canvasColor,
-            pageBackgroundColor,
-        )
-    }
+    ) = page.renderPageBitmap(
+        bitmap,
+        matrix,
+        clipRect,
+        renderAnnot,
+        textMask,
+        canvasColor,
+        pageBackgroundColor,
+    )
+
+    /**
+     * Start rendering page fragment on [Bitmap] in a way that can be paused and cancelled.<br></br>
+     * The render stops early when [cancellationToken] is cancelled, from any thread, and pauses once
+     * [timeBudgetMillis] have passed so the lock is free until [ProgressiveRender.resume] is called.
+     * @param bitmap Bitmap on which to render page. It must stay alive until the render is finished.
+     * @param startX left position of the page in the bitmap
+     * @param startY top position of the page in the bitmap
+     * @param drawSizeX horizontal size of the page on the bitmap
+     * @param drawSizeY vertical size of the page on the bitmap
+     * @param renderAnnot whether render annotation
+     * @param textMask whether to render text as image mask. Currently ignored
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     * You almost always want this to be white (the default)
+     * @param cancellationToken token to stop the render with, or `null` if it will not be cancelled
+     * @param timeBudgetMillis how long to render before pausing. Use 0 to render until done or cancelled.
+     * @return the [ProgressiveRender], or `null` if the page or document is closed
+     * @throws IllegalStateException If the page or document is closed
+     */
+    @Suppress("LongParameterList")
+    fun startRenderPageBitmap(
+        bitmap: Bitmap,
+        startX: Int,
+        startY: Int,
+        drawSizeX: Int,
+        drawSizeY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        cancellationToken: RenderCancellationToken? = null,
+        timeBudgetMillis: Long = 0,
+    ): ProgressiveRender? =
+        wrapLock {
+            page
+                .startRenderPageBitmap(
+                    bitmap,
+                    startX,
+                    startY,
+                    drawSizeX,
+                    drawSizeY,
+                    renderAnnot,
+                    textMask,
+                    canvasColor,
+                    pageBackgroundColor,
+                    cancellationToken,
+                    timeBudgetMillis,
+                )?.let { ProgressiveRender(it) }
+        }
+
+    /**
+     * Fill [bitmap] with a thumbnail of the page, as cheaply as possible.<br></br>
+     * The page's embedded thumbnail image is scaled to the bitmap when there is one and [useEmbedded] is set;
+     * otherwise the page is rendered without anti-aliasing or annotations. The page is stretched to fill the
+     * bitmap, so give it the page's aspect ratio.
+     * @param bitmap The `ARGB_8888` or `RGB_565` bitmap to fill
+     * @param pageBackgroundColor The color for the page background when the page is rendered
+     * @param useEmbedded `false` to ignore any embedded thumbnail and always render
+     * @return where the thumbnail came from, or `null` if it could not be made
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun renderThumbnail(
+        bitmap: Bitmap,
+        @ColorInt pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? =
+        wrapLock {
+            page.renderThumbnail(bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * Whether the PDF stores a thumbnail image for this page
+     * @return `true` if [renderThumbnail] can use an embedded thumbnail
+     * @throws IllegalStateException If the page or document is closed
+     */
+    fun hasEmbeddedThumbnail(): Boolean =
+        wrapLock {
+            page.hasEmbeddedThumbnail()
+        }
 
     /** Get all links from given page  */
     fun getPageLinks(): List<Link> =
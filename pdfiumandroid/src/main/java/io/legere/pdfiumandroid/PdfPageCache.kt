@@ -22,6 +22,7 @@
 package io.legere.pdfiumandroid
 
 import io.legere.pdfiumandroid.api.PdfPageCacheBase
+import java.util.concurrent.ConcurrentHashMap
 
 internal const val CACHE_SIZE = 64L
 
@@ -59,6 +60,12 @@ internal const val CACHE_SIZE = 64L
  * }
  * ```
  *
+ * To bound the cache by memory rather than by page count, pass `maxBytes`; each page is then
+ * weighed by [PdfPage.getMemoryEstimate] and [PdfTextPage.getMemoryEstimate] when it is loaded:
+ * ```
+ * val pageCache = PdfPageCache(pdfDocument, pageHolderFactory = { page, textPage -> PageHolder(page, textPage) }, maxBytes = budget)
+ * ```
+ *
  * @param H The type of the holder for the page and text page. Must be [AutoCloseable].
  * @property pdfDocument The [PdfDocument] to cache pages from.
  * @property pageHolderFactory A factory for creating a holder for a page and text page.
@@ -67,14 +74,34 @@ class PdfPageCache<H : AutoCloseable>(
     private val pdfDocument: PdfDocument,
     maxSize: Long = CACHE_SIZE,
     private val pageHolderFactory: (PdfPage, PdfTextPage) -> H,
+    maxBytes: Long,
 ) : PdfPageCacheBase<H>(
         maxSize = maxSize,
+        maxBytes = maxBytes,
     ) {
+    constructor(
+        pdfDocument: PdfDocument,
+        maxSize: Long = CACHE_SIZE,
+        pageHolderFactory: (PdfPage, PdfTextPage) -> H,
+    ) : this(pdfDocument, maxSize, pageHolderFactory, 0)
+
+    // The holder type is the caller's, so pages are measured while they are still in hand, and
+    // their weight is taken out again as the cache weighs them
+    private val pageBytes = ConcurrentHashMap<Int, Long>()
+
     override fun openPageAndText(pageIndex: Int): H? {
         val page = pdfDocument.openPage(pageIndex) ?: return null
         val textPage = page.openTextPage()
+        if (maxBytes > 0) {
+            pageBytes[pageIndex] = page.getMemoryEstimate() + textPage.getMemoryEstimate()
+        }
         return pageHolderFactory(page, textPage)
     }
+
+    override fun weigh(
+        pageIndex: Int,
+        holder: H,
+    ): Long = pageBytes.remove(pageIndex) ?: 1
 }
 
 /**
@@ -0,0 +1,91 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+@file:Suppress("unused")
+
+package io.legere.pdfiumandroid
+
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.core.unlocked.PdfStreamingLoaderU
+import io.legere.pdfiumandroid.core.util.wrapLock
+import java.io.Closeable
+import java.io.IOException
+
+/**
+ * `PdfStreamingLoader` opens a document whose data is still arriving through a
+ * [StreamingPdfiumSource]. Create one with [PdfiumCore.newStreamingLoader].
+ *
+ * Each time more data arrives, call [isDocumentAvailable]; once it returns `true`, [openDocument]
+ * opens the document. Pages of the opened document become available as their data arrives, see
+ * [PdfDocument.isPageAvailable] and [PdfDocument.notifyDataAvailable].
+ *
+ * @property loader The internal [PdfStreamingLoaderU] instance that performs the unlocked operations.
+ */
+class PdfStreamingLoader internal constructor(
+    internal val loader: PdfStreamingLoaderU,
+) : Closeable {
+    /**
+     * Whether the document is linearized, so its first page can load before the rest of the file.
+     *
+     * @return `true` or `false`, or `null` while too little of the file has arrived to tell
+     * @throws IllegalStateException if the loader is closed
+     */
+    fun isLinearized(): Boolean? =
+        wrapLock {
+            loader.isLinearized()
+        }
+
+    /**
+     * Whether enough of the file has arrived to open the document. If not, the ranges PDFium needs
+     * are passed to [StreamingPdfiumSource.requestData].
+     *
+     * @return `true` if [openDocument] can be called
+     * @throws IOException if the data that has arrived is not a valid PDF
+     * @throws IllegalStateException if the loader is closed
+     */
+    @Throws(IOException::class)
+    fun isDocumentAvailable(): Boolean =
+        wrapLock {
+            loader.isDocumentAvailable()
+        }
+
+    /**
+     * Opens the document once [isDocumentAvailable] has returned `true`. The document takes over
+     * the source, and this loader is closed.
+     *
+     * @param password password for decryption
+     * @return [PdfDocument]
+     * @throws IOException if the document cannot be opened
+     * @throws IllegalStateException if the loader is closed
+     */
+    @Throws(IOException::class)
+    fun openDocument(password: String? = null): PdfDocument =
+        wrapLock {
+            PdfDocument(loader.openDocument(password))
+        }
+
+    /**
+     * Gives up on a document that hasn't been opened, closing the source.
+     */
+    override fun close() {
+        wrapLock {
+            loader.close()
+        }
+    }
+}
@@ -21,6 +21,10 @@
 package io.legere.pdfiumandroid
 
 import android.graphics.RectF
+import io.legere.pdfiumandroid.api.CharGeometry
+import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
+import io.legere.pdfiumandroid.api.PageWords
 import io.legere.pdfiumandroid.core.unlocked.PdfTextPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import java.io.Closeable
@@ -76,6 +80,16 @@ class PdfTextPage internal constructor(
             page.textPageCountChars()
         }
 
+    /**
+     * Get an estimate of the native memory the text page holds, which grows with its character count
+     * @return the approximate size of the text page in bytes, or -1 on error
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun getMemoryEstimate(): Long =
+        wrapLock {
+            page.getMemoryEstimate()
+        }
+
     /**
      * Get the text on the page
      * @param startIndex the index of the first character to get
@@ -121,6 +135,24 @@ class PdfTextPage internal constructor(
     @Suppress("ReturnCount", "MagicNumber")
     fun textPageGetCharBox(index: Int): RectF? = page.textPageGetCharBox(index)
 
+    /**
+     * Get the geometry of a run of characters on the page in one call, instead of one
+     * [textPageGetCharBox] or [textPageGetUnicode] call per character
+     * @param geometry the [CharGeometry] to fill; reuse one across calls to avoid reallocating its arrays
+     * @param startIndex the index of the first character
+     * @param count the number of characters, or -1 for the rest of the page
+     * @return [geometry], holding the characters filled
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageGetCharGeometry(
+        geometry: CharGeometry = CharGeometry(),
+        startIndex: Int = 0,
+        count: Int = -1,
+    ): CharGeometry =
+        wrapLock {
+            page.textPageGetCharGeometry(geometry, startIndex, count)
+        }
+
     /**
      * Get the index of the character at a given position on the page
      * @param x the x position
@@ -141,6 +173,55 @@ class PdfTextPage internal constructor(
             page.textPageGetCharIndexAtPos(x, y, xTolerance, yTolerance)
         }
 
+    /**
+     * Get the index of the character at or nearest a position on the page, like
+     * [textPageGetCharIndexAtPos] but from a spatial index built on the first hit test and kept
+     * until the text page is closed, so it stays cheap when called for every drag event
+     * @param x the x position
+     * @param y the y position
+     * @param xTolerance the x tolerance
+     * @param yTolerance the y tolerance
+     * @return the index of the character, or -1 if none is within tolerance
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageHitTestChar(
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ): Int =
+        wrapLock {
+            page.textPageHitTestChar(x, y, xTolerance, yTolerance)
+        }
+
+    /**
+     * Get the range of characters, from first to last, whose boxes overlap a rectangle
+     * @param rect the rectangle in page coordinates
+     * @return the range of character indexes, empty if none overlaps
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageHitTestCharRange(rect: RectF): IntRange =
+        wrapLock {
+            page.textPageHitTestCharRange(rect)
+        }
+
+    /**
+     * Get the link annotation or web link under a position on the page
+     * @param page the page this text page was opened from
+     * @param x the x position
+     * @param y the y position
+     * @return the link, or null if there is none
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageHitTestLink(
+        page: PdfPage,
+        x: Double,
+        y: Double,
+    ): Link? =
+        wrapLock {
+            this.page.textPageHitTestLink(page.page, x, y)
+        }
+
     /**
      * Get the count of rectangles that bound the text on the page in a given range
      * @param startIndex the index of the first character to get
@@ -181,6 +262,17 @@ class PdfTextPage internal constructor(
             page.textPageGetRectsForRanges(wordRanges)
         }
 
+    /**
+     * Get the words on the page, with the line each is on and its rectangle, segmented natively
+     * in one call instead of splitting the text and calling [textPageGetRectsForRanges]
+     * @return the words, or null if an error occurs
+     * @throws IllegalStateException if the page or document is closed
+     */
+    fun textPageGetWords(): PageWords? =
+        wrapLock {
+            page.textPageGetWords()
+        }
+
     /**
      * Get the text bounded by the given rectangle
      * @param rect the rectangle to bound the text
@@ -212,7 +304,7 @@ class PdfTextPage internal constructor(
         flags: Set<io.legere.pdfiumandroid.api.FindFlags>,
         startIndex: Int,
     ): FindResult? =
-        wrapLock {
+        wrapLock(LockTag.FIND_START) {
             page.findStart(findWhat, flags, startIndex)?.let { FindResult(it) }
         }
 
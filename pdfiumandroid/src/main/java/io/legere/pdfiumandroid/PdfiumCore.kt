@@ -31,13 +31,17 @@ import io.legere.pdfiumandroid.api.Bookmark
 import io.legere.pdfiumandroid.api.Config
 import io.legere.pdfiumandroid.api.Link
 import io.legere.pdfiumandroid.api.LockManager
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Meta
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU.Companion.lock
 import io.legere.pdfiumandroid.core.util.wrapLock
 import kotlinx.coroutines.sync.Mutex
 import java.io.IOException
+import java.nio.ByteBuffer
 
 /**
  * `PdfiumCore` is the main entry-point for accessing the PDFium API in a thread-safe manner.
@@ -87,7 +91,7 @@ class PdfiumCore(
         parcelFileDescriptor: ParcelFileDescriptor,
         password: String?,
     ): PdfDocument =
-        wrapLock {
+        wrapLock(LockTag.OPEN_DOCUMENT) {
             PdfDocument(coreInternal.newDocument(parcelFileDescriptor, password))
         }
 
@@ -115,7 +119,39 @@ class PdfiumCore(
         data: ByteArray?,
         password: String?,
     ): PdfDocument =
-        wrapLock {
+        wrapLock(LockTag.OPEN_DOCUMENT) {
+            PdfDocument(coreInternal.newDocument(data, password))
+        }
+
+    /**
+     * Creates a new [PdfDocument] from a direct [ByteBuffer], such as a memory-mapped file, without
+     * copying it. The document is opened without a password.
+     *
+     * @param data The direct buffer holding the PDF file content between its position and limit.
+     * @return A [PdfDocument] instance representing the opened PDF file.
+     * @throws IOException if the PDF document cannot be opened (e.g., corrupted or password protected).
+     * @throws IllegalArgumentException if [data] is not a direct buffer.
+     */
+    @Throws(IOException::class)
+    fun newDocument(data: ByteBuffer): PdfDocument = newDocument(data, null)
+
+    /**
+     * Creates a new [PdfDocument] from a direct [ByteBuffer] with a password, without copying it.
+     * PDFium reads the buffer in place, so its content must not change while the document is open;
+     * the document keeps the buffer alive until it is closed.
+     *
+     * @param data The direct buffer holding the PDF file content between its position and limit.
+     * @param password The password for decrypting the PDF document, or `null` if no password is required.
+     * @return A [PdfDocument] instance representing the opened PDF file.
+     * @throws IOException if the PDF document cannot be opened (e.g., corrupted or incorrect password).
+     * @throws IllegalArgumentException if [data] is not a direct buffer.
+     */
+    @Throws(IOException::class)
+    fun newDocument(
+        data: ByteBuffer,
+        password: String?,
+    ): PdfDocument =
+        wrapLock(LockTag.OPEN_DOCUMENT) {
             PdfDocument(coreInternal.newDocument(data, password))
         }
 
@@ -143,10 +179,25 @@ class PdfiumCore(
         data: PdfiumSource,
         password: String?,
     ): PdfDocument =
-        wrapLock {
+        wrapLock(LockTag.OPEN_DOCUMENT) {
             PdfDocument(coreInternal.newDocument(data, password))
         }
 
+    /**
+     * Creates a [PdfStreamingLoader] for a document whose data is still arriving, for example over
+     * the network. The loader opens the document as soon as enough of it is available, which for a
+     * linearized file is well before the whole file has arrived.
+     *
+     * @param source The custom data source, which reports which of its data has arrived.
+     * @return A [PdfStreamingLoader] for the document.
+     * @throws IOException if the data source is empty.
+     */
+    @Throws(IOException::class)
+    fun newStreamingLoader(source: StreamingPdfiumSource): PdfStreamingLoader =
+        wrapLock {
+            PdfStreamingLoader(coreInternal.newStreamingLoader(source))
+        }
+
     /**
      * @deprecated Use [PdfDocument.getPageCount] instead.
      */
@@ -356,11 +407,10 @@ class PdfiumCore(
         renderAnnot: Boolean = false,
         textMask: Boolean = false,
     ) {
-        // Lock across open+render+close so another thread can't close the document mid-render (crashes in pdfium).
-        wrapLock {
-            pdfDocument.openPage(pageIndex).use { page ->
-                page?.renderPageBitmap(bitmap, startX, startY, drawSizeX, drawSizeY, renderAnnot, textMask)
-            }
+        // Not locked across open+render+close: the render takes the PDFium lock natively, and skips the page if
+        // another thread closes it or its document in the meantime.
+        pdfDocument.openPage(pageIndex).use { page ->
+            page?.renderPageBitmap(bitmap, startX, startY, drawSizeX, drawSizeY, renderAnnot, textMask)
         }
     }
 
@@ -505,11 +555,10 @@ class PdfiumCore(
         drawSizeY: Int,
         renderAnnot: Boolean = false,
     ) {
-        // Lock across open+render+close so another thread can't close the document mid-render (crashes in pdfium).
-        wrapLock {
-            pdfDocument.openPage(pageIndex).use { page ->
-                page?.renderPageBitmap(bitmap, startX, startY, drawSizeX, drawSizeY, renderAnnot)
-            }
+        // Not locked across open+render+close: the render takes the PDFium lock natively, and skips the page if
+        // another thread closes it or its document in the meantime.
+        pdfDocument.openPage(pageIndex).use { page ->
+            page?.renderPageBitmap(bitmap, startX, startY, drawSizeX, drawSizeY, renderAnnot)
         }
     }
 
@@ -593,6 +642,70 @@ class PdfiumCore(
             }
         }
 
+    /**
+     * Sets how much native memory the tile cache may use, evicting the least recently drawn tiles
+     * until it fits. See [Config.tileCacheBudgetBytes].
+     *
+     * @param budgetBytes The budget in bytes; 0 switches the cache off and frees its memory.
+     * @throws IllegalArgumentException if [budgetBytes] is negative.
+     */
+    fun setTileCacheBudget(budgetBytes: Long) {
+        wrapLock {
+            coreInternal.setTileCacheBudget(budgetBytes)
+        }
+    }
+
+    /**
+     * Gets the tile cache's hit, miss and eviction counters and its memory use, for tuning
+     * [Config.tileCacheBudgetBytes] to a device.
+     *
+     * @return The current [TileCacheStats].
+     */
+    fun getTileCacheStats(): TileCacheStats =
+        wrapLock {
+            coreInternal.getTileCacheStats()
+        }
+
+    /**
+     * Drops every cached tile and frees the tile cache's memory; the budget stays as it is.
+     *
+     * @param resetStats Whether the hit, miss and eviction counters start again from zero.
+     */
+    fun clearTileCache(resetStats: Boolean = false) {
+        wrapLock {
+            coreInternal.clearTileCache(resetStats)
+        }
+    }
+
+    /**
+     * Releases the native memory shared by all documents; call it, with [PdfDocument.trimMemory]
+     * for each open document, from [android.content.ComponentCallbacks2.onTrimMemory].
+     *
+     * From `TRIM_MEMORY_RUNNING_LOW` the tile cache is cleared. At `TRIM_MEMORY_RUNNING_CRITICAL`,
+     * and from `TRIM_MEMORY_BACKGROUND`, later renders also stop PDFium keeping every decoded image
+     * cached on its page, which makes re-rendering pages with large images slower. That lasts until
+     * a call with a lower level; pass 0 once the app is back in the foreground to restore it.
+     *
+     * @param level the level passed to [android.content.ComponentCallbacks2.onTrimMemory]
+     * @return the number of bytes released
+     */
+    fun trimMemory(level: Int): Long =
+        wrapLock {
+            coreInternal.trimMemory(level)
+        }
+
+    /**
+     * Tears down PDFium's global state now, whatever [Config.libraryLifetime] says; with
+     * [io.legere.pdfiumandroid.api.LibraryLifetime.EXPLICIT] this is the only thing that does. It is
+     * set up again when the next document is opened.
+     *
+     * @return `false`, leaving the library as it is, if a document is still open.
+     */
+    fun destroyLibrary(): Boolean =
+        wrapLock {
+            coreInternal.destroyLibrary()
+        }
+
     /**
      * Sets the global [io.legere.pdfiumandroid.api.LockManager] for PdfiumAndroidKt.
      * This method allows custom synchronization strategies to be injected into the library.
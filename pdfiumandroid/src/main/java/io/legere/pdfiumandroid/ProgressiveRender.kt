@@ -0,0 +1,70 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid
+
+import io.legere.pdfiumandroid.api.RenderStatus
+import io.legere.pdfiumandroid.core.unlocked.ProgressiveRenderU
+import io.legere.pdfiumandroid.core.util.wrapLock
+import java.io.Closeable
+
+/**
+ * A page render that can be paused, resumed and cancelled, started with [PdfPage.startRenderPageBitmap].
+ *
+ * Each call takes the lock for itself only, so other PDFium work can run between the slices of a long
+ * render. Rendering the same page any other way between slices fails this render.
+ *
+ * @property render The underlying unlocked render.
+ */
+class ProgressiveRender internal constructor(
+    internal val render: ProgressiveRenderU,
+) : Closeable {
+    /**
+     * Where the render stands. [RenderStatus.INCOMPLETE] until it has run to an end.
+     */
+    val status: RenderStatus
+        get() = render.status
+
+    /**
+     * Carry on with an incomplete render.
+     * @param timeBudgetMillis how long to render before pausing again. Use 0 to render until done or cancelled.
+     * @return the render's [status] afterwards
+     */
+    fun resume(timeBudgetMillis: Long = 0): RenderStatus =
+        wrapLock {
+            render.resume(timeBudgetMillis)
+        }
+
+    /**
+     * Stop the render. Does not take the lock, so it can be called while another thread is inside
+     * [resume], which then returns [RenderStatus.CANCELLED] within a few milliseconds.
+     */
+    fun cancel() {
+        render.cancel()
+    }
+
+    /**
+     * Abandon the render if it is still incomplete. Not needed once it has finished.
+     */
+    override fun close() {
+        wrapLock {
+            render.close()
+        }
+    }
+}
@@ -0,0 +1,340 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid
+
+import io.legere.pdfiumandroid.api.LockTag
+import io.legere.pdfiumandroid.api.Logger
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.RenderPriority
+import io.legere.pdfiumandroid.api.RenderPriorityStats
+import io.legere.pdfiumandroid.api.RenderSchedulerStats
+import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.runBlocking
+import java.io.Closeable
+import java.util.PriorityQueue
+import java.util.concurrent.CancellationException
+import java.util.concurrent.locks.ReentrantLock
+import kotlin.concurrent.withLock
+
+/**
+ * Runs PDFium work on one dedicated thread, most urgent first.
+ *
+ * Without a scheduler every caller contends for the PDFium lock in arrival order, so prefetching page 40 can
+ * hold up the page on screen. Here each job carries a [RenderPriority] and waits in a queue; the scheduler's
+ * thread takes the highest-priority job, oldest first, and runs it holding the PDFium lock. Jobs can use the
+ * locked API ([PdfDocument], [PdfPage], ...) freely, as the lock is reentrant.
+ *
+ * A job scheduled with a key is coalesced: scheduling another job for an equal key while the first is queued
+ * or running hands back the first one, raising its priority if the new request is more urgent. Use keys
+ * that identify the result, e.g. a data class of page index and scale, and give equal keys jobs of the same
+ * result type.
+ *
+ * Jobs whose viewport has moved on can be dropped with [cancelIf]. A queued job that is cancelled never runs;
+ * one already running has its [RenderCancellationToken] cancelled, which a progressive render passed that
+ * token stops at.
+ *
+ * [getStats] reports the queue depth and how long jobs waited at each priority, to show starvation.
+ *
+ * The thread takes the lock with [io.legere.pdfiumandroid.api.LockManager.withLockBlocking], so the scheduler
+ * can't be used with a lock manager that only supports suspending.
+ *
+ * @param threadName The name of the scheduler's thread.
+ */
+class RenderScheduler(
+    threadName: String = "PdfiumRenderScheduler",
+) : Closeable {
+    private val lock = ReentrantLock()
+    private val jobAvailable = lock.newCondition()
+    private val queue = PriorityQueue(compareBy<RenderJob<*>>({ it.priority.ordinal }, { it.sequence }))
+    private val jobsByKey = HashMap<Any, RenderJob<*>>()
+
+    /** The job the thread is running, keyed or not. */
+    private var running: RenderJob<*>? = null
+    private val counters = Array(RenderPriority.entries.size) { Counters() }
+    private var nextSequence = 0L
+    private var isClosed = false
+
+    private class Counters {
+        var submitted = 0L
+        var coalesced = 0L
+        var started = 0L
+        var completed = 0L
+        var cancelled = 0L
+        var totalWaitNanos = 0L
+        var maxWaitNanos = 0L
+    }
+
+    private val thread =
+        Thread(::runJobs, threadName).apply {
+            isDaemon = true
+            start()
+        }
+
+    /**
+     * Queue [block] to run on the scheduler's thread, holding the PDFium lock.
+     *
+     * @param priority How urgent the job is.
+     * @param key Identifies the job's result for coalescing, or `null` to never coalesce.
+     * @param block The work. Pass the token it is given to any progressive render it starts, so that
+     * cancelling the job stops the render.
+     * @return the job, or the job already scheduled for [key]
+     * @throws IllegalStateException If the scheduler is closed.
+     */
+    fun <T> schedule(
+        priority: RenderPriority,
+        key: Any? = null,
+        block: (RenderCancellationToken) -> T,
+    ): RenderJob<T> {
+        lock.withLock {
+            check(!isClosed) { "RenderScheduler is closed" }
+            val existing = key?.let { jobsByKey[it] }
+            if (existing != null) {
+                counters[priority.ordinal].coalesced++
+                existing.holders++
+                if (priority < existing.priority && queue.remove(existing)) {
+                    // Move the submission too, so every event for the job is counted under one priority.
+                    counters[existing.priority.ordinal].submitted--
+                    counters[priority.ordinal].submitted++
+                    existing.priority = priority
+                    queue.add(existing)
+                }
+                @Suppress("UNCHECKED_CAST")
+                return existing as RenderJob<T>
+            }
+            val job = RenderJob(this, priority, key, nextSequence++, System.nanoTime(), block)
+            counters[priority.ordinal].submitted++
+            queue.add(job)
+            key?.let { jobsByKey[it] = job }
+            jobAvailable.signal()
+            return job
+        }
+    }
+
+    /**
+     * Schedule [block] and wait for its result. Cancelling the calling coroutine cancels the job, unless
+     * other callers are waiting on it too.
+     *
+     * @see schedule
+     * @throws CancellationException If the job is cancelled.
+     */
+    suspend fun <T> run(
+        priority: RenderPriority,
+        key: Any? = null,
+        block: (RenderCancellationToken) -> T,
+    ): T {
+        val job = schedule(priority, key, block)
+        try {
+            return job.await()
+        } catch (e: CancellationException) {
+            job.cancel()
+            throw e
+        }
+    }
+
+    /**
+     * Cancel every queued or running job [predicate] accepts, whoever else is waiting on it. Typically called
+     * when the viewport moves, for the jobs of pages that are no longer near it.
+     *
+     * @return how many jobs were cancelled
+     */
+    fun cancelIf(predicate: (RenderJob<*>) -> Boolean): Int {
+        val jobs =
+            lock.withLock {
+                (queue + jobsByKey.values + listOfNotNull(running)).distinct()
+            }
+        return jobs.filter(predicate).count { cancel(it) }
+    }
+
+    /**
+     * Get the queue depth and job counters at each priority.
+     */
+    fun getStats(): RenderSchedulerStats =
+        lock.withLock {
+            val queued = IntArray(counters.size)
+            queue.forEach { queued[it.priority.ordinal]++ }
+            RenderSchedulerStats(
+                RenderPriority.entries.map { priority ->
+                    val c = counters[priority.ordinal]
+                    RenderPriorityStats(
+                        priority = priority,
+                        queued = queued[priority.ordinal],
+                        submitted = c.submitted,
+                        coalesced = c.coalesced,
+                        started = c.started,
+                        completed = c.completed,
+                        cancelled = c.cancelled,
+                        totalWaitNanos = c.totalWaitNanos,
+                        maxWaitNanos = c.maxWaitNanos,
+                    )
+                },
+            )
+        }
+
+    /**
+     * Cancel every queued job and stop the thread once the job it is running, if any, has finished.
+     * Does not wait for that job.
+     */
+    override fun close() {
+        val pending =
+            lock.withLock {
+                if (isClosed) return
+                isClosed = true
+                jobAvailable.signal()
+                queue.toList()
+            }
+        pending.forEach { cancel(it) }
+    }
+
+    /** Drop one caller's interest in [job], cancelling it once no caller is left. */
+    internal fun release(job: RenderJob<*>) {
+        val cancel =
+            lock.withLock {
+                job.holders--
+                job.holders <= 0
+            }
+        if (cancel) cancel(job)
+    }
+
+    private fun cancel(job: RenderJob<*>): Boolean {
+        val queued =
+            lock.withLock {
+                if (job.isFinished || job.token.isCancelled) return false
+                forget(job)
+                job.token.cancel()
+                // A running job is counted, and its result cancelled, when it finishes.
+                queue.remove(job).also { if (it) counters[job.priority.ordinal].cancelled++ }
+            }
+        if (queued) job.result.cancel()
+        return true
+    }
+
+    /** Stop coalescing requests into [job]. Called holding [lock]. */
+    private fun forget(job: RenderJob<*>) {
+        val key = job.key ?: return
+        if (jobsByKey[key] === job) jobsByKey.remove(key)
+    }
+
+    private fun runJobs() {
+        while (true) {
+            val job =
+                lock.withLock {
+                    while (queue.isEmpty() && !isClosed) jobAvailable.await()
+                    if (isClosed) return
+                    queue.remove().also { job ->
+                        running = job
+                        val waited = System.nanoTime() - job.enqueuedAt
+                        counters[job.priority.ordinal].apply {
+                            started++
+                            totalWaitNanos += waited
+                            maxWaitNanos = maxOf(maxWaitNanos, waited)
+                        }
+                    }
+                }
+            val result = job.execute()
+            val cancelled =
+                lock.withLock {
+                    forget(job)
+                    running = null
+                    job.isFinished = true
+                    job.token.isCancelled.also {
+                        if (it) counters[job.priority.ordinal].cancelled++ else counters[job.priority.ordinal].completed++
+                    }
+                }
+            job.complete(result, cancelled)
+        }
+    }
+}
+
+/**
+ * A job given to a [RenderScheduler].
+ *
+ * @property key The key the job was scheduled with, if any.
+ */
+class RenderJob<T> internal constructor(
+    private val scheduler: RenderScheduler,
+    priority: RenderPriority,
+    val key: Any?,
+    internal val sequence: Long,
+    internal val enqueuedAt: Long,
+    private val block: (RenderCancellationToken) -> T,
+) {
+    /** How urgent the job is; raised when a more urgent request is coalesced into it. */
+    @Volatile
+    var priority: RenderPriority = priority
+        internal set
+
+    internal val token = RenderCancellationToken()
+    internal val result = CompletableDeferred<T>()
+
+    /** The callers sharing the job. Guarded by the scheduler's lock. */
+    internal var holders = 1
+
+    /** `true` once the job has run. Guarded by the scheduler's lock. */
+    internal var isFinished = false
+
+    /** `true` once the job has finished, failed or been cancelled. */
+    val isCompleted: Boolean
+        get() = result.isCompleted
+
+    /** `true` if the job was cancelled. */
+    val isCancelled: Boolean
+        get() = result.isCancelled
+
+    /**
+     * Wait for the job's result.
+     * @throws CancellationException If the job was cancelled.
+     */
+    suspend fun await(): T = result.await()
+
+    /**
+     * Block the calling thread until the job's result is ready. Never call it from a job.
+     * @throws CancellationException If the job was cancelled.
+     */
+    fun get(): T = runBlocking { result.await() }
+
+    /**
+     * Withdraw this caller's request. The job is cancelled once every caller it was handed to has withdrawn;
+     * if it is already running, its token is cancelled.
+     */
+    fun cancel() {
+        scheduler.release(this)
+    }
+
+    @Suppress("TooGenericExceptionCaught")
+    internal fun execute(): Result<T> =
+        try {
+            Result.success(PdfiumCoreU.lock.withLockBlocking(LockTag.RENDER_JOB) { block(token) })
+        } catch (t: Throwable) {
+            Logger.e("RenderScheduler", t, "job failed")
+            Result.failure(t)
+        }
+
+    internal fun complete(
+        outcome: Result<T>,
+        cancelled: Boolean,
+    ) {
+        when {
+            cancelled -> result.cancel()
+            outcome.isSuccess -> result.complete(outcome.getOrThrow())
+            else -> result.completeExceptionally(outcome.exceptionOrNull()!!)
+        }
+    }
+}
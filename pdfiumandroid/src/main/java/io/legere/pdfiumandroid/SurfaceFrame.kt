@@ -0,0 +1,54 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid
+
+import io.legere.pdfiumandroid.core.unlocked.SurfaceFrameU
+import io.legere.pdfiumandroid.core.util.wrapLock
+import java.io.Closeable
+
+/**
+ * A native copy of the last frame rendered to a Surface, opened with [PdfDocument.openSurfaceFrame].
+ *
+ * Passing it to [PdfDocument.renderPages] along with the scroll since the previous frame lets the render
+ * shift that frame and draw only the strip the scroll uncovered. Use one per Surface, and close it when the
+ * Surface is destroyed; it holds a full copy of the Surface's pixels.
+ *
+ * @property frame The underlying unlocked frame.
+ */
+class SurfaceFrame internal constructor(
+    internal val frame: SurfaceFrameU,
+) : Closeable {
+    /**
+     * Make the next render draw the whole frame. Call it after any change that is not a scroll: a zoom,
+     * a resize, different pages, or anything drawn to the Surface by other means.
+     */
+    fun invalidate() {
+        frame.invalidate()
+    }
+
+    /**
+     * Release the native copy of the frame.
+     */
+    override fun close() {
+        wrapLock {
+            frame.close()
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid
+
+import android.graphics.Matrix
+import android.graphics.RectF
+import io.legere.pdfiumandroid.api.RenderLoopStats
+import io.legere.pdfiumandroid.core.unlocked.SurfaceRenderLoopU
+import io.legere.pdfiumandroid.suspend.PdfPageKt
+import java.io.Closeable
+
+/**
+ * A render loop presenting frames to one Surface from its own native thread, opened with
+ * [PdfDocument.openRenderLoop].
+ *
+ * [submit] posts the latest viewport and returns at once, so it can be called on every scroll or fling step
+ * from the UI thread; frames posted faster than they can be rendered are dropped in favour of the newest one.
+ * The loop holds the PDFium lock only while rasterizing off-screen, and copies the frame to the Surface after
+ * releasing it. Use one per Surface, and close it when the Surface is destroyed.
+ *
+ * The loop takes the lock with [io.legere.pdfiumandroid.api.LockManager.withLockBlocking], so it can't be used
+ * with a lock manager that only supports suspending.
+ *
+ * @property loop The underlying unlocked render loop.
+ */
+class SurfaceRenderLoop internal constructor(
+    internal val loop: SurfaceRenderLoopU,
+) : Closeable {
+    /**
+     * Post a frame to the loop, replacing any frame it has not started yet. Does not wait for the frame.
+     * Pages closed before the frame is rendered are left out of it.
+     * @param pages The pages to render
+     * @param matrices The transformation [Matrix] for each page, mapping page coordinates to surface coordinates
+     * @param clipRects The [RectF] for each page, defining the clipping area in surface coordinates
+     * @param renderAnnot whether render annotation
+     * @param canvasColor The color to fill the canvas with. Use 0 to not fill the canvas.
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     */
+    @Suppress("LongParameterList")
+    fun submit(
+        pages: List<PdfPage>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        renderAnnot: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ) {
+        loop.submit(pages.map { it.page }, matrices, clipRects, renderAnnot, canvasColor, pageBackgroundColor)
+    }
+
+    /**
+     * [submit] for pages opened through [io.legere.pdfiumandroid.suspend.PdfDocumentKt]
+     */
+    @JvmName("submitKt")
+    @Suppress("LongParameterList")
+    fun submit(
+        pages: List<PdfPageKt>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        renderAnnot: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ) {
+        loop.submit(pages.map { it.page }, matrices, clipRects, renderAnnot, canvasColor, pageBackgroundColor)
+    }
+
+    /**
+     * Get how many frames were submitted, rendered and dropped.
+     * @return the loop's counters
+     */
+    fun getStats(): RenderLoopStats = loop.getStats()
+
+    /**
+     * Stop the loop, waiting for the frame it is on. This takes no lock, and must not be called while holding
+     * the PDFium lock, which that frame may be waiting for.
+     */
+    override fun close() {
+        loop.close()
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.suspend
+
+import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU
+import io.legere.pdfiumandroid.core.unlocked.PdfPageU
+import io.legere.pdfiumandroid.core.unlocked.PdfTextPageU
+
+/**
+ * The receiver of a [PdfDocumentKt.batch] block: the document's **unlocked** operations, and those of its pages,
+ * for use while the batch holds the lock.
+ *
+ * Nothing reached through it may be used once the block returns, when the lock is no longer held. Pages and text
+ * pages opened from [document] inside the block must be closed inside it too.
+ *
+ * @property document The unlocked document.
+ */
+class PdfBatchKt internal constructor(
+    val document: PdfDocumentU,
+) {
+    /** The unlocked operations of this page. */
+    val PdfPageKt.unlocked: PdfPageU
+        get() = page
+
+    /** The unlocked operations of this text page. */
+    val PdfTextPageKt.unlocked: PdfTextPageU
+        get() = page
+}
@@ -21,24 +21,36 @@
 
 package io.legere.pdfiumandroid.suspend
 
+import android.graphics.Bitmap
 import android.graphics.Matrix
 import android.graphics.RectF
 import android.view.Surface
 import androidx.annotation.Keep
 import io.legere.pdfiumandroid.PdfDocument
 import io.legere.pdfiumandroid.PdfiumCore
+import io.legere.pdfiumandroid.SurfaceFrame
+import io.legere.pdfiumandroid.SurfaceRenderLoop
 import io.legere.pdfiumandroid.api.Bookmark
+import io.legere.pdfiumandroid.api.DocumentText
+import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.Meta
 import io.legere.pdfiumandroid.api.PdfWriteCallback
+import io.legere.pdfiumandroid.api.SearchHits
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.ThumbnailSource
+import io.legere.pdfiumandroid.core.unlocked.DocumentSearchU
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU
+import io.legere.pdfiumandroid.core.unlocked.TextExtractionU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.sync.withLock
 import kotlinx.coroutines.withContext
 import java.io.Closeable
+import java.nio.ByteBuffer
 
 /**
  * PdfDocumentKt represents a PDF file and allows you to load pages from it.
@@ -62,6 +74,38 @@ class PdfDocumentKt internal constructor(
             document.getPageCount()
         }
 
+    /**
+     *  suspend version of [PdfDocument.isPageAvailable]
+     */
+    suspend fun isPageAvailable(pageIndex: Int): Boolean =
+        wrapSuspend(dispatcher) {
+            document.isPageAvailable(pageIndex)
+        }
+
+    /**
+     *  suspend version of [PdfDocument.getFirstAvailablePage]
+     */
+    suspend fun getFirstAvailablePage(): Int =
+        wrapSuspend(dispatcher) {
+            document.getFirstAvailablePage()
+        }
+
+    /**
+     *  suspend version of [PdfDocument.setOnPageAvailableListener]
+     */
+    suspend fun setOnPageAvailableListener(listener: ((pageIndex: Int) -> Unit)?): Unit =
+        wrapSuspend(dispatcher) {
+            document.setOnPageAvailableListener(listener)
+        }
+
+    /**
+     *  suspend version of [PdfDocument.notifyDataAvailable]
+     */
+    suspend fun notifyDataAvailable(): List<Int> =
+        wrapSuspend(dispatcher) {
+            document.notifyDataAvailable()
+        }
+
     /**
      *  suspend version of [PdfDocument.getPageCharCounts]
      */
@@ -70,6 +114,50 @@ class PdfDocumentKt internal constructor(
             document.getPageCharCounts()
         }
 
+    /**
+     * suspend version of [PdfDocument.extractText], suspending rather than blocking between chunks of pages
+     */
+    suspend fun extractText(
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        encoding: TextEncoding = TextEncoding.UTF_16LE,
+        pagesPerLock: Int = TextExtractionU.DEFAULT_PAGES_PER_LOCK,
+    ): DocumentText? {
+        val extraction =
+            wrapSuspend(dispatcher, LockTag.EXTRACT_TEXT) {
+                document.startTextExtraction(firstPage, pageCount, encoding)
+            } ?: return null
+        var done = false
+        while (!done) {
+            done = wrapSuspend(dispatcher, LockTag.EXTRACT_TEXT) { extraction.extractNext(pagesPerLock) }
+        }
+        return extraction.result()
+    }
+
+    /**
+     * suspend version of [PdfDocument.search], suspending rather than blocking between runs of pages and
+     * stopping there when the coroutine is cancelled
+     */
+    @Suppress("LongParameterList")
+    suspend fun search(
+        query: String,
+        flags: Set<FindFlags> = emptySet(),
+        firstPage: Int = 0,
+        pageCount: Int = -1,
+        pagesPerLock: Int = DocumentSearchU.DEFAULT_PAGES_PER_LOCK,
+        onPagesSearched: (suspend (hits: SearchHits, pagesSearched: Int) -> Unit)? = null,
+    ): SearchHits? {
+        val search =
+            wrapSuspend(dispatcher, LockTag.SEARCH) {
+                document.startSearch(query, flags, firstPage, pageCount)
+            } ?: return null
+        while (!search.isFinished) {
+            val hits = wrapSuspend(dispatcher, LockTag.SEARCH) { search.searchNext(pagesPerLock) } ?: return null
+            onPagesSearched?.invoke(hits, search.pagesDone)
+        }
+        return search.result()
+    }
+
     /**
      * suspend version of [PdfDocument.getPageSize]
      */
@@ -89,11 +177,23 @@ class PdfDocumentKt internal constructor(
             document.getPageSizes(screenDpi)
         }
 
+    /**
+     * Run [block] with the lock taken once, rather than once per call, for a run of operations such as rendering a
+     * page and reading its links and text geometry. The block runs on the dispatcher with the document's unlocked
+     * operations; see [PdfBatchKt] for what it may do. It should not block on anything but PDFium, since every other
+     * caller waits for it.
+     * @return the result of [block]
+     */
+    suspend fun <T> batch(block: PdfBatchKt.() -> T): T =
+        wrapSuspend(dispatcher, LockTag.BATCH) {
+            PdfBatchKt(document).block()
+        }
+
     /**
      * suspend version of [PdfDocument.openPage]
      */
     suspend fun openPage(pageIndex: Int): PdfPageKt? =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_PAGE) {
             document.openPage(pageIndex)?.let { PdfPageKt(it, dispatcher) }
         }
 
@@ -112,7 +212,7 @@ class PdfDocumentKt internal constructor(
         fromIndex: Int,
         toIndex: Int,
     ): List<PdfPageKt> =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_PAGE) {
             document.openPages(fromIndex, toIndex).map { PdfPageKt(it, dispatcher) }
         }
 
@@ -147,6 +247,127 @@ class PdfDocumentKt internal constructor(
             }
         }
 
+    /**
+     * Open a [SurfaceFrame] for a Surface, see [PdfDocument.openSurfaceFrame]
+     */
+    fun openSurfaceFrame(): SurfaceFrame = SurfaceFrame(document.openSurfaceFrame())
+
+    /**
+     * suspend version of [PdfDocument.renderPages] that reuses the previous frame when this one is it scrolled
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderPages(
+        surface: Surface,
+        frame: SurfaceFrame,
+        pages: List<PdfPageKt>,
+        matrices: List<Matrix>,
+        clipRects: List<RectF>,
+        scrollX: Int,
+        scrollY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        renderCoroutinesDispatcher: CoroutineDispatcher,
+    ): Boolean =
+        withContext(renderCoroutinesDispatcher) {
+            PdfiumCore.surfaceMutex.withLock {
+                if (!coroutineContext.isActive) return@withContext false
+                document.renderPages(
+                    surface,
+                    frame.frame,
+                    pages.map { it.page },
+                    matrices,
+                    clipRects,
+                    scrollX,
+                    scrollY,
+                    renderAnnot,
+                    textMask,
+                    canvasColor,
+                    pageBackgroundColor,
+                )
+            }
+        }
+
+    /**
+     * Open a [SurfaceRenderLoop] for a Surface, see [PdfDocument.openRenderLoop]
+     */
+    suspend fun openRenderLoop(surface: Surface): SurfaceRenderLoop? =
+        wrapSuspend(dispatcher) {
+            document.openRenderLoop(surface)?.let { SurfaceRenderLoop(it) }
+        }
+
+    /**
+     * suspend version of [PdfDocument.renderThumbnail]
+     */
+    suspend fun renderThumbnail(
+        pageIndex: Int,
+        bitmap: Bitmap,
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? =
+        wrapSuspend(dispatcher) {
+            document.renderThumbnail(pageIndex, bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * suspend version of [PdfDocument.renderThumbnailAtlas]
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderThumbnailAtlas(
+        bitmap: Bitmap,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> =
+        wrapSuspend(dispatcher) {
+            document.renderThumbnailAtlas(
+                bitmap,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
+    /**
+     * suspend version of [PdfDocument.renderThumbnailAtlas]
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderThumbnailAtlas(
+        buffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        fromIndex: Int,
+        toIndex: Int,
+        cellWidth: Int,
+        cellHeight: Int,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): List<RectF> =
+        wrapSuspend(dispatcher) {
+            document.renderThumbnailAtlas(
+                buffer,
+                width,
+                height,
+                fromIndex,
+                toIndex,
+                cellWidth,
+                cellHeight,
+                canvasColor,
+                pageBackgroundColor,
+                useEmbedded,
+            )
+        }
+
     /**
      * suspend version of [PdfDocument.getDocumentMeta]
      */
@@ -170,7 +391,7 @@ class PdfDocumentKt internal constructor(
     @Deprecated("use PdfPageKt.openTextPage", ReplaceWith("page.openTextPage()"))
     @Suppress("DEPRECATION")
     suspend fun openTextPage(page: PdfPageKt): PdfTextPageKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_TEXT_PAGE) {
             PdfTextPageKt(document.openTextPage(page.page), dispatcher)
         }
 
@@ -181,7 +402,7 @@ class PdfDocumentKt internal constructor(
         fromIndex: Int,
         toIndex: Int,
     ): List<PdfTextPageKt> =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_TEXT_PAGE) {
             document.openTextPages(fromIndex, toIndex).map { PdfTextPageKt(it, dispatcher) }
         }
 
@@ -193,6 +414,14 @@ class PdfDocumentKt internal constructor(
             document.saveAsCopy(callback)
         }
 
+    /**
+     * suspend version of [PdfDocument.trimMemory]
+     */
+    suspend fun trimMemory(level: Int): Long =
+        wrapSuspend(dispatcher) {
+            document.trimMemory(level)
+        }
+
     /**
      * Close the document
      * @throws IllegalArgumentException if document is closed
@@ -32,16 +32,29 @@ import androidx.annotation.Keep
 import io.legere.pdfiumandroid.PdfPage
 import io.legere.pdfiumandroid.PdfiumCore
 import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Logger
 import io.legere.pdfiumandroid.api.PageAttributes
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.RenderStatus
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.core.unlocked.PdfPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
 import kotlinx.coroutines.CoroutineDispatcher
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.ensureActive
 import kotlinx.coroutines.sync.withLock
 import kotlinx.coroutines.withContext
 import java.io.Closeable
 
+/**
+ * How long [PdfPageKt.renderPageBitmapProgressive] renders before letting go of the lock: about a frame,
+ * so a render never holds up other work for longer than that.
+ */
+const val DEFAULT_RENDER_SLICE_MILLIS = 16L
+
 /**
  * PdfPageKt represents a single page of a PDF file.
  * @property page the [PdfPage] to wrap
@@ -66,7 +79,7 @@ class PdfPageKt internal constructor(
      * @throws IllegalArgumentException if document is closed or the page cannot be loaded
      */
     suspend fun openTextPage(): PdfTextPageKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_TEXT_PAGE) {
             PdfTextPageKt(page.openTextPage(), dispatcher)
         }
 
@@ -299,7 +312,8 @@ class PdfPageKt internal constructor(
         textMask: Boolean = false,
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
-    ) = wrapSuspend(dispatcher) {
+    ) = withContext(dispatcher) {
+        // Not under the lock: the render takes it natively, for the rendering alone.
         page.renderPageBitmap(
             bitmap,
             startX,
@@ -325,7 +339,8 @@ class PdfPageKt internal constructor(
         textMask: Boolean = false,
         canvasColor: Int = 0xFF848484.toInt(),
         pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
-    ) = wrapSuspend(dispatcher) {
+    ) = withContext(dispatcher) {
+        // Not under the lock: the render takes it natively, for the rendering alone.
         page.renderPageBitmap(
             bitmap,
             matrix,
@@ -337,6 +352,85 @@ class PdfPageKt internal constructor(
         )
     }
 
+    /**
+     * Render page fragment on [Bitmap] in slices of [sliceMillis], taking the lock for one slice at a
+     * time so other work can get at PDFium in between.
+     *
+     * Cancelling the calling coroutine stops the render at the end of the current slice; cancelling
+     * [cancellationToken] stops it within the slice. Either way the bitmap is left partly rendered.
+     * See [PdfPage.startRenderPageBitmap].
+     *
+     * @return [RenderStatus.DONE] once the page is fully rendered, or how the render ended otherwise
+     */
+    @Suppress("LongParameterList")
+    suspend fun renderPageBitmapProgressive(
+        bitmap: Bitmap,
+        startX: Int,
+        startY: Int,
+        drawSizeX: Int,
+        drawSizeY: Int,
+        renderAnnot: Boolean = false,
+        textMask: Boolean = false,
+        canvasColor: Int = 0xFF848484.toInt(),
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        cancellationToken: RenderCancellationToken? = null,
+        sliceMillis: Long = DEFAULT_RENDER_SLICE_MILLIS,
+    ): RenderStatus {
+        val render =
+            wrapSuspend(dispatcher) {
+                page.startRenderPageBitmap(
+                    bitmap,
+                    startX,
+                    startY,
+                    drawSizeX,
+                    drawSizeY,
+                    renderAnnot,
+                    textMask,
+                    canvasColor,
+                    pageBackgroundColor,
+                    cancellationToken,
+                    sliceMillis,
+                )
+            } ?: return RenderStatus.FAILED
+        try {
+            while (!render.status.isFinished) {
+                currentCoroutineContext().ensureActive()
+                wrapSuspend(dispatcher) {
+                    render.resume(sliceMillis)
+                }
+            }
+        } finally {
+            if (!render.status.isFinished) {
+                withContext(NonCancellable) {
+                    wrapSuspend(dispatcher) {
+                        render.close()
+                    }
+                }
+            }
+        }
+        return render.status
+    }
+
+    /**
+     * suspend version of [PdfPage.renderThumbnail]
+     */
+    suspend fun renderThumbnail(
+        bitmap: Bitmap,
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+        useEmbedded: Boolean = true,
+    ): ThumbnailSource? =
+        wrapSuspend(dispatcher) {
+            page.renderThumbnail(bitmap, pageBackgroundColor, useEmbedded)
+        }
+
+    /**
+     * suspend version of [PdfPage.hasEmbeddedThumbnail]
+     */
+    suspend fun hasEmbeddedThumbnail(): Boolean =
+        wrapSuspend(dispatcher) {
+            page.hasEmbeddedThumbnail()
+        }
+
     /**
      * suspend version of [PdfPage.getPageLinks]
      */
@@ -24,8 +24,12 @@ package io.legere.pdfiumandroid.suspend
 import android.graphics.RectF
 import androidx.annotation.Keep
 import io.legere.pdfiumandroid.PdfTextPage
+import io.legere.pdfiumandroid.api.CharGeometry
 import io.legere.pdfiumandroid.api.FindFlags
+import io.legere.pdfiumandroid.api.Link
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.Logger
+import io.legere.pdfiumandroid.api.PageWords
 import io.legere.pdfiumandroid.api.WordRangeRect
 import io.legere.pdfiumandroid.core.unlocked.PdfTextPageU
 import io.legere.pdfiumandroid.core.util.wrapLock
@@ -86,6 +90,18 @@ class PdfTextPageKt internal constructor(
             page.textPageGetCharBox(index)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageGetCharGeometry]
+     */
+    suspend fun textPageGetCharGeometry(
+        geometry: CharGeometry = CharGeometry(),
+        startIndex: Int = 0,
+        count: Int = -1,
+    ): CharGeometry =
+        wrapSuspend(dispatcher) {
+            page.textPageGetCharGeometry(geometry, startIndex, count)
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageGetCharIndexAtPos]
      */
@@ -99,6 +115,39 @@ class PdfTextPageKt internal constructor(
             page.textPageGetCharIndexAtPos(x, y, xTolerance, yTolerance)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestChar]
+     */
+    suspend fun textPageHitTestChar(
+        x: Double,
+        y: Double,
+        xTolerance: Double,
+        yTolerance: Double,
+    ): Int =
+        wrapSuspend(dispatcher) {
+            page.textPageHitTestChar(x, y, xTolerance, yTolerance)
+        }
+
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestCharRange]
+     */
+    suspend fun textPageHitTestCharRange(rect: RectF): IntRange =
+        wrapSuspend(dispatcher) {
+            page.textPageHitTestCharRange(rect)
+        }
+
+    /**
+     * suspend version of [PdfTextPage.textPageHitTestLink]
+     */
+    suspend fun textPageHitTestLink(
+        page: PdfPageKt,
+        x: Double,
+        y: Double,
+    ): Link? =
+        wrapSuspend(dispatcher) {
+            this.page.textPageHitTestLink(page.page, x, y)
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageCountRects]
      */
@@ -126,6 +175,14 @@ class PdfTextPageKt internal constructor(
             page.textPageGetRectsForRanges(wordRanges)
         }
 
+    /**
+     * suspend version of [PdfTextPage.textPageGetWords]
+     */
+    suspend fun textPageGetWords(): PageWords? =
+        wrapSuspend(dispatcher) {
+            page.textPageGetWords()
+        }
+
     /**
      * suspend version of [PdfTextPage.textPageGetBoundedText]
      */
@@ -150,7 +207,7 @@ class PdfTextPageKt internal constructor(
         flags: Set<FindFlags>,
         startIndex: Int,
     ): FindResultKt? =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.FIND_START) {
             val findResult = page.findStart(findWhat, flags, startIndex)
             if (findResult == null) {
                 null
@@ -26,10 +26,14 @@ import androidx.annotation.Keep
 import io.legere.pdfiumandroid.PdfiumCore
 import io.legere.pdfiumandroid.api.Config
 import io.legere.pdfiumandroid.api.LockManager
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU.Companion.lock
 import kotlinx.coroutines.CoroutineDispatcher
+import java.nio.ByteBuffer
 
 /**
  * PdfiumCoreKt is the main entry-point for access to the PDFium API.
@@ -46,7 +50,7 @@ class PdfiumCoreKt(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(parcelFileDescriptor: ParcelFileDescriptor): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(parcelFileDescriptor), dispatcher)
         }
 
@@ -57,7 +61,7 @@ class PdfiumCoreKt(
         parcelFileDescriptor: ParcelFileDescriptor,
         password: String?,
     ): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(parcelFileDescriptor, password), dispatcher)
         }
 
@@ -65,7 +69,7 @@ class PdfiumCoreKt(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(data: ByteArray?): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(data), dispatcher)
         }
 
@@ -76,7 +80,26 @@ class PdfiumCoreKt(
         data: ByteArray?,
         password: String?,
     ): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
+            PdfDocumentKt(coreInternal.newDocument(data, password), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.newDocument]
+     */
+    suspend fun newDocument(data: ByteBuffer): PdfDocumentKt =
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
+            PdfDocumentKt(coreInternal.newDocument(data), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.newDocument]
+     */
+    suspend fun newDocument(
+        data: ByteBuffer,
+        password: String?,
+    ): PdfDocumentKt =
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(data, password), dispatcher)
         }
 
@@ -84,7 +107,7 @@ class PdfiumCoreKt(
      * suspend version of [PdfiumCore.newDocument]
      */
     suspend fun newDocument(data: PdfiumSource): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(data), dispatcher)
         }
 
@@ -95,10 +118,58 @@ class PdfiumCoreKt(
         data: PdfiumSource,
         password: String?,
     ): PdfDocumentKt =
-        wrapSuspend(dispatcher) {
+        wrapSuspend(dispatcher, LockTag.OPEN_DOCUMENT) {
             PdfDocumentKt(coreInternal.newDocument(data, password), dispatcher)
         }
 
+    /**
+     * suspend version of [PdfiumCore.newStreamingLoader]
+     */
+    suspend fun newStreamingLoader(source: StreamingPdfiumSource): PdfStreamingLoaderKt =
+        wrapSuspend(dispatcher) {
+            PdfStreamingLoaderKt(coreInternal.newStreamingLoader(source), dispatcher)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.setTileCacheBudget]
+     */
+    suspend fun setTileCacheBudget(budgetBytes: Long): Unit =
+        wrapSuspend(dispatcher) {
+            coreInternal.setTileCacheBudget(budgetBytes)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.getTileCacheStats]
+     */
+    suspend fun getTileCacheStats(): TileCacheStats =
+        wrapSuspend(dispatcher) {
+            coreInternal.getTileCacheStats()
+        }
+
+    /**
+     * suspend version of [PdfiumCore.clearTileCache]
+     */
+    suspend fun clearTileCache(resetStats: Boolean = false): Unit =
+        wrapSuspend(dispatcher) {
+            coreInternal.clearTileCache(resetStats)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.trimMemory]
+     */
+    suspend fun trimMemory(level: Int): Long =
+        wrapSuspend(dispatcher) {
+            coreInternal.trimMemory(level)
+        }
+
+    /**
+     * suspend version of [PdfiumCore.destroyLibrary]
+     */
+    suspend fun destroyLibrary(): Boolean =
+        wrapSuspend(dispatcher) {
+            coreInternal.destroyLibrary()
+        }
+
     fun setLockManager(lockManager: LockManager) {
         lock = lockManager
     }
@@ -19,6 +19,7 @@
 
 package io.legere.pdfiumandroid.suspend
 
+import io.legere.pdfiumandroid.api.LockTag
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU.Companion.lock
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.withContext
@@ -33,16 +34,18 @@ import kotlinx.coroutines.withContext
  * @param T The return type of the [block].
  * @param dispatcher The [CoroutineDispatcher] on which the [block] will be executed.
  *                   This should typically be an IO dispatcher for native calls.
+ * @param tag The operation's name, for an [io.legere.pdfiumandroid.api.InstrumentedLockManager]; see [LockTag].
  * @param block The suspendable block of code to execute. This block will be run inside
  *              a `withLock` block on a shared mutex to ensure thread safety with native calls.
  * @return The result of the [block] execution.
  */
 suspend inline fun <reified T> wrapSuspend(
     dispatcher: CoroutineDispatcher,
+    tag: String = LockTag.UNTAGGED,
     crossinline block: () -> T,
 ): T =
     withContext(dispatcher) {
-        lock.withLock {
+        lock.withLock(tag) {
             block()
         }
     }
@@ -0,0 +1,430 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+import android.content.ComponentName
+import android.content.Context
+import android.content.Intent
+import android.content.ServiceConnection
+import android.graphics.Bitmap
+import android.os.Build
+import android.os.Bundle
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.IBinder
+import android.os.Looper
+import android.os.Message
+import android.os.Messenger
+import android.os.ParcelFileDescriptor
+import android.os.RemoteException
+import android.os.SharedMemory
+import androidx.annotation.RequiresApi
+import io.legere.pdfiumandroid.api.Logger
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_ERROR
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_FD
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_HEIGHT
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_MEMORY
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_PAGE_BACKGROUND
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_PASSWORD
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_RENDER_ANNOT
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_REQUEST_ID
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_WIDTH
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_CLOSE
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_OPEN
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_RENDER
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
+import java.io.Closeable
+import java.io.IOException
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * How a [PdfiumWorkerPool] picks the worker for a page.
+ */
+enum class WorkerRouting {
+    /** Each render goes to the next worker in turn, for the most even load. */
+    ROUND_ROBIN,
+
+    /** A page always goes to the same worker, which keeps that worker's copy of the page warm. */
+    PAGE_AFFINITY,
+}
+
+/**
+ * Picks the worker for a render of [pageIndex] among [workerCount] workers. [roundRobin] is the pool's turn
+ * counter.
+ */
+internal fun routeToWorker(
+    routing: WorkerRouting,
+    pageIndex: Int,
+    workerCount: Int,
+    roundRobin: AtomicInteger,
+): Int =
+    when (routing) {
+        WorkerRouting.ROUND_ROBIN -> Math.floorMod(roundRobin.getAndIncrement(), workerCount)
+        WorkerRouting.PAGE_AFFINITY -> Math.floorMod(pageIndex, workerCount)
+    }
+
+/**
+ * The documents a worker has been sent an open request for, which are the ones to reopen when the worker
+ * restarts. A document whose open is still waiting for the worker's first connection isn't among them, as it
+ * sends its own open once connected.
+ */
+internal class SentOpens {
+    private val documentIds: MutableSet<Int> = ConcurrentHashMap.newKeySet()
+
+    /** Record that the open request for [documentId] has been sent. */
+    fun sent(documentId: Int) {
+        documentIds.add(documentId)
+    }
+
+    /** Forget [documentId], which has been closed. */
+    fun closed(documentId: Int) {
+        documentIds.remove(documentId)
+    }
+
+    /** The documents to reopen in a restarted worker. */
+    fun toReopen(): List<Int> = documentIds.sorted()
+}
+
+/**
+ * Renders pages in several processes at once, to scale past the one PDFium lock a process has.
+ *
+ * PDFium is not thread-safe, so within a process every call goes through one lock and rendering uses one
+ * core. The pool binds up to [MAX_WORKERS] [PdfiumWorkerService]s, each in a process of its own with its own
+ * PDFium. A document opened with [openDocument] is opened in every worker from the same file descriptor, and
+ * [WorkerDocument.renderPage] sends each page to a worker picked by [routing], which renders it into shared
+ * memory that is then copied into the caller's bitmap. Batch export and thumbnail generation can then run one
+ * render per worker in parallel.
+ *
+ * A worker that crashes, for instance on a malformed PDF, takes only its process down: the renders it was
+ * running fail with an [IOException], and the system restarts it, after which the pool reopens the documents
+ * in it.
+ *
+ * The pool is meant for throughput; a single render pays for the IPC and the copy, so on-screen rendering is
+ * better done in process with [io.legere.pdfiumandroid.PdfiumCore].
+ *
+ * @param context Any context; the pool keeps the application context.
+ * @param workerCount How many workers to run, from 1 to [MAX_WORKERS].
+ * @property routing How pages are assigned to workers.
+ */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class PdfiumWorkerPool(
+    context: Context,
+    workerCount: Int = minOf(MAX_WORKERS, Runtime.getRuntime().availableProcessors()),
+    private val routing: WorkerRouting = WorkerRouting.PAGE_AFFINITY,
+) : Closeable {
+    private val appContext = context.applicationContext
+    private val replyThread = HandlerThread("PdfiumWorkerPool").apply { start() }
+    private val replyMessenger = Messenger(ReplyHandler(replyThread.looper))
+    private val pending = ConcurrentHashMap<Long, CompletableDeferred<Bundle>>()
+    private val documents = ConcurrentHashMap<Int, OpenDocument>()
+    private val nextRequestId = AtomicLong()
+    private val nextDocumentId = AtomicInteger()
+    private val roundRobin = AtomicInteger()
+
+    @Volatile
+    private var isClosed = false
+
+    private class OpenDocument(
+        val fd: ParcelFileDescriptor,
+        val password: String?,
+    )
+
+    init {
+        require(workerCount in 1..MAX_WORKERS) { "workerCount must be between 1 and $MAX_WORKERS" }
+    }
+
+    private val workers = List(workerCount) { Worker(SERVICES[it]) }
+
+    /** The number of workers in the pool. */
+    val size: Int
+        get() = workers.size
+
+    /**
+     * Open a document in every worker.
+     *
+     * @param fd The PDF file. The pool keeps its own duplicate, so the caller may close it.
+     * @param password The password for the document, or `null` if no password is required.
+     * @return the document, to be closed when done
+     * @throws IOException If a worker could not open the document.
+     */
+    suspend fun openDocument(
+        fd: ParcelFileDescriptor,
+        password: String? = null,
+    ): WorkerDocument {
+        check(!isClosed) { "PdfiumWorkerPool is closed" }
+        val documentId = nextDocumentId.incrementAndGet()
+        val document = OpenDocument(fd.dup(), password)
+        documents[documentId] = document
+        try {
+            coroutineScope {
+                workers.map { worker -> async { request(worker, MSG_OPEN, documentId, 0, openData(document)) } }
+                    .awaitAll()
+            }
+        } catch (e: IOException) {
+            closeDocument(documentId)
+            throw e
+        }
+        return WorkerDocument(this, documentId)
+    }
+
+    /**
+     * Close the pool: close its documents, fail the renders in flight and unbind the workers, which ends
+     * their processes.
+     */
+    override fun close() {
+        if (isClosed) return
+        isClosed = true
+        documents.keys.toList().forEach { closeDocument(it) }
+        workers.forEach { it.unbind() }
+        pending.values.forEach { it.completeExceptionally(IOException("PdfiumWorkerPool closed")) }
+        pending.clear()
+        replyThread.quitSafely()
+    }
+
+    @Suppress("LongParameterList")
+    internal suspend fun renderPage(
+        documentId: Int,
+        pageIndex: Int,
+        bitmap: Bitmap,
+        renderAnnot: Boolean,
+        pageBackgroundColor: Int,
+    ) {
+        require(bitmap.config == Bitmap.Config.ARGB_8888) { "Only ARGB_8888 bitmaps are supported" }
+        check(documents.containsKey(documentId)) { "Document is closed" }
+        val worker = workers[routeToWorker(routing, pageIndex, workers.size, roundRobin)]
+        SharedMemory.create("pdfium_page_$pageIndex", bitmap.byteCount).use { memory ->
+            val data =
+                Bundle().apply {
+                    putParcelable(KEY_MEMORY, memory)
+                    putInt(KEY_WIDTH, bitmap.width)
+                    putInt(KEY_HEIGHT, bitmap.height)
+                    putBoolean(KEY_RENDER_ANNOT, renderAnnot)
+                    putInt(KEY_PAGE_BACKGROUND, pageBackgroundColor)
+                }
+            request(worker, MSG_RENDER, documentId, pageIndex, data)
+            val pixels = memory.mapReadOnly()
+            try {
+                bitmap.copyPixelsFromBuffer(pixels)
+            } finally {
+                SharedMemory.unmap(pixels)
+            }
+        }
+    }
+
+    internal fun closeDocument(documentId: Int) {
+        val document = documents.remove(documentId) ?: return
+        workers.forEach {
+            it.sentOpens.closed(documentId)
+            it.send(MSG_CLOSE, documentId, 0, Bundle(), null)
+        }
+        document.fd.close()
+    }
+
+    private fun openData(document: OpenDocument) =
+        Bundle().apply {
+            putParcelable(KEY_FD, document.fd)
+            putString(KEY_PASSWORD, document.password)
+        }
+
+    private suspend fun request(
+        worker: Worker,
+        what: Int,
+        arg1: Int,
+        arg2: Int,
+        data: Bundle,
+    ): Bundle {
+        val messenger = worker.connection.await()
+        val requestId = nextRequestId.incrementAndGet()
+        val reply = CompletableDeferred<Bundle>()
+        pending[requestId] = reply
+        worker.inFlight.add(requestId)
+        try {
+            data.putLong(KEY_REQUEST_ID, requestId)
+            try {
+                messenger.send(message(what, arg1, arg2, data, replyMessenger))
+                if (what == MSG_OPEN) worker.sentOpens.sent(arg1)
+            } catch (e: RemoteException) {
+                throw IOException("Pdfium worker is gone", e)
+            }
+            val result = reply.await()
+            result.getString(KEY_ERROR)?.let { throw IOException(it) }
+            return result
+        } finally {
+            pending.remove(requestId)
+            worker.inFlight.remove(requestId)
+        }
+    }
+
+    private fun message(
+        what: Int,
+        arg1: Int,
+        arg2: Int,
+        data: Bundle,
+        replyTo: Messenger?,
+    ) = Message.obtain(null, what, arg1, arg2).apply {
+        this.data = data
+        this.replyTo = replyTo
+    }
+
+    private inner class ReplyHandler(
+        looper: Looper,
+    ) : Handler(looper) {
+        override fun handleMessage(msg: Message) {
+            pending.remove(msg.data.getLong(KEY_REQUEST_ID))?.complete(msg.data)
+        }
+    }
+
+    /** One worker process: its binding, and the requests it has not answered yet. */
+    private inner class Worker(
+        service: Class<out PdfiumWorkerService>,
+    ) : ServiceConnection {
+        @Volatile
+        var connection = CompletableDeferred<Messenger>()
+        val inFlight: MutableSet<Long> = ConcurrentHashMap.newKeySet()
+        val sentOpens = SentOpens()
+        private val intent = Intent(appContext, service)
+
+        init {
+            bind()
+        }
+
+        private fun bind() {
+            if (!appContext.bindService(intent, this, Context.BIND_AUTO_CREATE)) {
+                connection.completeExceptionally(IOException("Could not bind ${intent.component}"))
+            }
+        }
+
+        fun unbind() {
+            appContext.unbindService(this)
+            connection.completeExceptionally(IOException("PdfiumWorkerPool closed"))
+        }
+
+        /** Send a request whose answer nobody waits for, if the worker is connected. */
+        @OptIn(ExperimentalCoroutinesApi::class)
+        fun send(
+            what: Int,
+            arg1: Int,
+            arg2: Int,
+            data: Bundle,
+            replyTo: Messenger?,
+        ) {
+            val current = connection
+            if (!current.isCompleted) return
+            try {
+                current.getCompleted().send(message(what, arg1, arg2, data, replyTo))
+            } catch (e: RemoteException) {
+                Logger.e(TAG, e, "worker is gone")
+            } catch (e: IOException) {
+                Logger.e(TAG, e, "worker is not connected")
+            }
+        }
+
+        override fun onServiceConnected(
+            name: ComponentName?,
+            binder: IBinder?,
+        ) {
+            val messenger = Messenger(binder)
+            // A restarted worker has none of the documents it was sent; it handles requests in order, so reopening
+            // them before anything else is sent keeps later renders valid. On the first connection nothing has
+            // been sent yet, and the opens waiting for it send their own.
+            sentOpens.toReopen().forEach { documentId ->
+                val document = documents[documentId] ?: return@forEach
+                try {
+                    messenger.send(message(MSG_OPEN, documentId, 0, openData(document), null))
+                } catch (e: RemoteException) {
+                    Logger.e(TAG, e, "reopening a document failed")
+                }
+            }
+            if (!connection.complete(messenger)) {
+                connection = CompletableDeferred(messenger)
+            }
+        }
+
+        override fun onServiceDisconnected(name: ComponentName?) {
+            // The process died; the system restarts it and calls onServiceConnected again.
+            connection = CompletableDeferred()
+            val failure = IOException("Pdfium worker ${name?.className} died")
+            inFlight.toList().forEach { pending.remove(it)?.completeExceptionally(failure) }
+        }
+
+        override fun onBindingDied(name: ComponentName?) {
+            if (isClosed) return
+            appContext.unbindService(this)
+            connection = CompletableDeferred()
+            bind()
+        }
+    }
+
+    companion object {
+        private const val TAG = "PdfiumWorkerPool"
+
+        /** The most workers a pool can have: the number of [PdfiumWorkerService]s the library declares. */
+        const val MAX_WORKERS = 4
+
+        private val SERVICES =
+            listOf(
+                PdfiumWorkerService0::class.java,
+                PdfiumWorkerService1::class.java,
+                PdfiumWorkerService2::class.java,
+                PdfiumWorkerService3::class.java,
+            )
+    }
+}
+
+/**
+ * A document opened in every worker of a [PdfiumWorkerPool].
+ */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class WorkerDocument internal constructor(
+    private val pool: PdfiumWorkerPool,
+    private val documentId: Int,
+) : Closeable {
+    /**
+     * Render a whole page to fill [bitmap], in one of the pool's workers. Renders of different pages can run
+     * concurrently, one per worker.
+     *
+     * @param pageIndex the page index
+     * @param bitmap The `ARGB_8888` bitmap to fill
+     * @param renderAnnot whether to render annotations
+     * @param pageBackgroundColor The color for the page background. Use 0 to not fill the background.
+     * @throws IOException If the worker failed to render the page or died.
+     */
+    suspend fun renderPage(
+        pageIndex: Int,
+        bitmap: Bitmap,
+        renderAnnot: Boolean = false,
+        pageBackgroundColor: Int = 0xFFFFFFFF.toInt(),
+    ) {
+        pool.renderPage(documentId, pageIndex, bitmap, renderAnnot, pageBackgroundColor)
+    }
+
+    /**
+     * Close the document in every worker.
+     */
+    override fun close() {
+        pool.closeDocument(documentId)
+    }
+}
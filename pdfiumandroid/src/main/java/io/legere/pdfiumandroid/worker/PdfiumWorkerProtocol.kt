@@ -0,0 +1,52 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+/**
+ * The messages a [PdfiumWorkerPool] and its [PdfiumWorkerService]s exchange over a [android.os.Messenger].
+ * Every request carries [KEY_REQUEST_ID] in its data and is answered with a [MSG_REPLY] carrying the same id
+ * and [KEY_ERROR] if it failed.
+ */
+internal object PdfiumWorkerProtocol {
+    /** Open a document: [KEY_FD], [KEY_PASSWORD]; `arg1` is the document id. */
+    const val MSG_OPEN = 1
+
+    /**
+     * Render a page into [KEY_MEMORY], as `width * height` RGBA pixels: [KEY_WIDTH], [KEY_HEIGHT],
+     * [KEY_RENDER_ANNOT], [KEY_PAGE_BACKGROUND]; `arg1` is the document id and `arg2` the page index.
+     */
+    const val MSG_RENDER = 2
+
+    /** Close a document; `arg1` is the document id. */
+    const val MSG_CLOSE = 3
+
+    /** The answer to a request. */
+    const val MSG_REPLY = 4
+
+    const val KEY_REQUEST_ID = "requestId"
+    const val KEY_ERROR = "error"
+    const val KEY_FD = "fd"
+    const val KEY_PASSWORD = "password"
+    const val KEY_MEMORY = "memory"
+    const val KEY_WIDTH = "width"
+    const val KEY_HEIGHT = "height"
+    const val KEY_RENDER_ANNOT = "renderAnnot"
+    const val KEY_PAGE_BACKGROUND = "pageBackground"
+}
@@ -0,0 +1,182 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+import android.app.Service
+import android.content.Intent
+import android.graphics.Bitmap
+import android.os.Build
+import android.os.Bundle
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.IBinder
+import android.os.Looper
+import android.os.Message
+import android.os.Messenger
+import android.os.ParcelFileDescriptor
+import android.os.RemoteException
+import android.os.SharedMemory
+import androidx.annotation.RequiresApi
+import io.legere.pdfiumandroid.PdfDocument
+import io.legere.pdfiumandroid.PdfiumCore
+import io.legere.pdfiumandroid.api.Logger
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_ERROR
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_FD
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_HEIGHT
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_MEMORY
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_PAGE_BACKGROUND
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_PASSWORD
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_RENDER_ANNOT
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_REQUEST_ID
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.KEY_WIDTH
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_CLOSE
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_OPEN
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_RENDER
+import io.legere.pdfiumandroid.worker.PdfiumWorkerProtocol.MSG_REPLY
+
+/**
+ * A render worker for [PdfiumWorkerPool]: a bound service that runs in a process of its own, with its own copy
+ * of PDFium, and renders pages for the pool into shared memory.
+ *
+ * The library declares [PdfiumWorkerPool.MAX_WORKERS] of them, [PdfiumWorkerService0] to [PdfiumWorkerService3],
+ * each in its own `:pdfium_worker` process. A worker handles one request at a time, on its own thread.
+ */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+open class PdfiumWorkerService : Service() {
+    private lateinit var thread: HandlerThread
+    private lateinit var messenger: Messenger
+    private val pdfiumCore by lazy { PdfiumCore(this) }
+    private val documents = HashMap<Int, PdfDocument>()
+
+    override fun onCreate() {
+        super.onCreate()
+        thread = HandlerThread("PdfiumWorker").apply { start() }
+        messenger = Messenger(RequestHandler(thread.looper))
+    }
+
+    override fun onBind(intent: Intent?): IBinder? = messenger.binder
+
+    override fun onDestroy() {
+        thread.quitSafely()
+        documents.values.forEach { it.close() }
+        documents.clear()
+        super.onDestroy()
+    }
+
+    private inner class RequestHandler(
+        looper: Looper,
+    ) : Handler(looper) {
+        @Suppress("TooGenericExceptionCaught")
+        override fun handleMessage(msg: Message) {
+            val reply = Bundle()
+            reply.putLong(KEY_REQUEST_ID, msg.data.getLong(KEY_REQUEST_ID))
+            try {
+                when (msg.what) {
+                    MSG_OPEN -> open(msg.arg1, msg.data)
+                    MSG_RENDER -> render(msg.arg1, msg.arg2, msg.data)
+                    MSG_CLOSE -> documents.remove(msg.arg1)?.close()
+                    else -> error("Unknown request ${msg.what}")
+                }
+            } catch (t: Throwable) {
+                Logger.e(TAG, t, "request ${msg.what} failed")
+                reply.putString(KEY_ERROR, t.message ?: t.javaClass.name)
+            }
+            try {
+                msg.replyTo?.send(Message.obtain(null, MSG_REPLY).apply { data = reply })
+            } catch (e: RemoteException) {
+                Logger.e(TAG, e, "client went away")
+            }
+        }
+    }
+
+    private fun open(
+        documentId: Int,
+        data: Bundle,
+    ) {
+        @Suppress("DEPRECATION")
+        val fd = requireNotNull(data.getParcelable<ParcelFileDescriptor>(KEY_FD)) { "No file descriptor" }
+        documents.remove(documentId)?.close()
+        documents[documentId] = openOwning(fd) { pdfiumCore.newDocument(it, data.getString(KEY_PASSWORD)) }
+    }
+
+    private fun render(
+        documentId: Int,
+        pageIndex: Int,
+        data: Bundle,
+    ) {
+        val document = checkNotNull(documents[documentId]) { "Document $documentId is not open" }
+        @Suppress("DEPRECATION")
+        val memory = requireNotNull(data.getParcelable<SharedMemory>(KEY_MEMORY)) { "No shared memory" }
+        val width = data.getInt(KEY_WIDTH)
+        val height = data.getInt(KEY_HEIGHT)
+        val bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
+        try {
+            checkNotNull(document.openPage(pageIndex)) { "Page $pageIndex could not be opened" }.use { page ->
+                page.renderPageBitmap(
+                    bitmap,
+                    0,
+                    0,
+                    width,
+                    height,
+                    renderAnnot = data.getBoolean(KEY_RENDER_ANNOT),
+                    pageBackgroundColor = data.getInt(KEY_PAGE_BACKGROUND),
+                )
+            }
+            val pixels = memory.mapReadWrite()
+            try {
+                bitmap.copyPixelsToBuffer(pixels)
+            } finally {
+                SharedMemory.unmap(pixels)
+            }
+        } finally {
+            bitmap.recycle()
+            memory.close()
+        }
+    }
+
+    companion object {
+        private const val TAG = "PdfiumWorkerService"
+    }
+}
+
+/**
+ * Open a document from [fd] with [open]. On success the document owns [fd] and closes it with itself; if
+ * opening fails, [fd] is closed here rather than leaked.
+ */
+internal fun <T> openOwning(
+    fd: ParcelFileDescriptor,
+    open: (ParcelFileDescriptor) -> T,
+): T = runCatching { open(fd) }.onFailure { fd.close() }.getOrThrow()
+
+/** Worker process 0 of [PdfiumWorkerPool]. */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class PdfiumWorkerService0 : PdfiumWorkerService()
+
+/** Worker process 1 of [PdfiumWorkerPool]. */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class PdfiumWorkerService1 : PdfiumWorkerService()
+
+/** Worker process 2 of [PdfiumWorkerPool]. */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class PdfiumWorkerService2 : PdfiumWorkerService()
+
+/** Worker process 3 of [PdfiumWorkerPool]. */
+@RequiresApi(Build.VERSION_CODES.O_MR1)
+class PdfiumWorkerService3 : PdfiumWorkerService()
@@ -161,6 +161,41 @@ class PdfPageCacheTest {
         verify(exactly = 2) { pdfDocument.openPage(0) }
     }
 
+    @Test
+    fun `cache bounded by bytes evicts the oldest pages once they outweigh the budget`() {
+        every { pdgPage.getMemoryEstimate() } returns 60
+        every { pdfTextPage.getMemoryEstimate() } returns 40
+        cache =
+            PdfPageCache(pdfDocument, pageHolderFactory = { page, textPage -> PageHolder(page, textPage) }, maxBytes = 250)
+
+        cache.get(0)
+        cache.get(1)
+        // 300 bytes with page 2 loaded, so page 0 has to go
+        cache.get(2)
+
+        cache.get(1)
+        cache.get(2)
+        verify(exactly = 1) { pdfDocument.openPage(1) }
+        verify(exactly = 1) { pdfDocument.openPage(2) }
+
+        cache.get(0)
+        verify(exactly = 2) { pdfDocument.openPage(0) }
+    }
+
+    @Test
+    fun `cache bounded by bytes keeps more light pages than its page count`() {
+        every { pdgPage.getMemoryEstimate() } returns 6
+        every { pdfTextPage.getMemoryEstimate() } returns 4
+        cache =
+            PdfPageCache(pdfDocument, 2, { page, textPage -> PageHolder(page, textPage) }, 250)
+
+        (0 until 10).forEach { cache.get(it) }
+        (0 until 10).forEach { cache.get(it) }
+
+        verify(exactly = 10) { pdfDocument.openPage(any()) }
+        verify(exactly = 0) { pdgPage.close() }
+    }
+
     @Test
     fun `cache with default size`() {
         cache =
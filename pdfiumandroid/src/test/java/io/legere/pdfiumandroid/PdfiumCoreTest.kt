@@ -45,6 +45,7 @@ import org.junit.jupiter.api.AfterEach
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
 import org.junit.jupiter.api.extension.ExtendWith
+import java.nio.ByteBuffer
 import java.util.concurrent.locks.ReentrantLock
 
 @Suppress("DEPRECATION")
@@ -87,6 +88,16 @@ class PdfiumCoreBasicTest {
         verify { pdfiumCoreU.newDocument(any() as ByteArray, any()) }
     }
 
+    @Test
+    fun testNewDocumentByteBuffer() {
+        val document = mockk<PdfDocumentU>()
+        val data = ByteBuffer.allocateDirect(10)
+        every { pdfiumCoreU.newDocument(any() as ByteBuffer, any()) } returns document
+        val result = pdfiumCore.newDocument(data)
+        assertThat(result.document).isEqualTo(document)
+        verify { pdfiumCoreU.newDocument(data, null) }
+    }
+
     @Test
     fun testNewDocument3() {
         val document = mockk<PdfDocumentU>()
@@ -0,0 +1,192 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid
+
+import com.google.common.truth.Truth.assertThat
+import io.legere.pdfiumandroid.api.RenderPriority
+import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
+import org.junit.jupiter.api.AfterEach
+import org.junit.jupiter.api.BeforeEach
+import org.junit.jupiter.api.Test
+import org.junit.jupiter.api.assertThrows
+import java.util.Collections
+import java.util.concurrent.CancellationException
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+
+class RenderSchedulerTest {
+    private lateinit var scheduler: RenderScheduler
+    private val ran: MutableList<String> = Collections.synchronizedList(mutableListOf())
+
+    @BeforeEach
+    fun setUp() {
+        scheduler = RenderScheduler()
+    }
+
+    @AfterEach
+    fun tearDown() {
+        scheduler.close()
+    }
+
+    /** Occupy the scheduler's thread until the returned latch is released, so jobs queue up behind it. */
+    private fun holdThread(): CountDownLatch {
+        val started = CountDownLatch(1)
+        val release = CountDownLatch(1)
+        scheduler.schedule(RenderPriority.BACKGROUND) {
+            started.countDown()
+            release.await(5, TimeUnit.SECONDS)
+        }
+        assertThat(started.await(5, TimeUnit.SECONDS)).isTrue()
+        return release
+    }
+
+    private fun record(
+        priority: RenderPriority,
+        name: String,
+        key: Any? = null,
+    ) = scheduler.schedule(priority, key) { ran.add(name) }
+
+    @Test
+    fun `queued jobs run most urgent first, oldest first within a priority`() {
+        val release = holdThread()
+        record(RenderPriority.BACKGROUND, "text")
+        record(RenderPriority.THUMBNAIL, "thumb")
+        record(RenderPriority.NEAR_PREFETCH, "next")
+        record(RenderPriority.VISIBLE, "visible 1")
+        val last = record(RenderPriority.VISIBLE, "visible 2")
+        val stats = scheduler.getStats()
+        release.countDown()
+        scheduler.schedule(RenderPriority.BACKGROUND) { }.get()
+
+        assertThat(ran).containsExactly("visible 1", "visible 2", "next", "thumb", "text").inOrder()
+        assertThat(last.isCompleted).isTrue()
+        assertThat(stats.queueDepth).isEqualTo(5)
+        assertThat(stats[RenderPriority.VISIBLE].queued).isEqualTo(2)
+    }
+
+    @Test
+    fun `a request for a scheduled key shares the job and raises its priority`() {
+        val release = holdThread()
+        val prefetch = record(RenderPriority.BACKGROUND, "page 3", key = 3)
+        record(RenderPriority.THUMBNAIL, "thumb")
+        val visible = record(RenderPriority.VISIBLE, "page 3 again", key = 3)
+        release.countDown()
+        visible.get()
+        scheduler.schedule(RenderPriority.BACKGROUND) { }.get()
+
+        assertThat(visible).isSameInstanceAs(prefetch)
+        assertThat(visible.priority).isEqualTo(RenderPriority.VISIBLE)
+        assertThat(ran).containsExactly("page 3", "thumb").inOrder()
+        val stats = scheduler.getStats()
+        assertThat(stats[RenderPriority.VISIBLE].coalesced).isEqualTo(1)
+        assertThat(stats[RenderPriority.VISIBLE].submitted).isEqualTo(1)
+        assertThat(stats[RenderPriority.VISIBLE].completed).isEqualTo(1)
+    }
+
+    @Test
+    fun `cancelIf drops queued jobs before they run`() {
+        val release = holdThread()
+        val jobs = (1..3).map { record(RenderPriority.NEAR_PREFETCH, "page $it", key = it) }
+
+        assertThat(scheduler.cancelIf { it.key == 2 }).isEqualTo(1)
+        release.countDown()
+        jobs[2].get()
+
+        assertThat(jobs[1].isCancelled).isTrue()
+        assertThrows<CancellationException> { jobs[1].get() }
+        assertThat(ran).containsExactly("page 1", "page 3").inOrder()
+        assertThat(scheduler.getStats()[RenderPriority.NEAR_PREFETCH].cancelled).isEqualTo(1)
+    }
+
+    @Test
+    fun `a job is only cancelled once every caller sharing it has withdrawn`() {
+        val release = holdThread()
+        val first = record(RenderPriority.THUMBNAIL, "page 1", key = 1)
+        val second = record(RenderPriority.THUMBNAIL, "page 1", key = 1)
+
+        first.cancel()
+        assertThat(second.isCancelled).isFalse()
+        second.cancel()
+        release.countDown()
+        scheduler.schedule(RenderPriority.BACKGROUND) { }.get()
+
+        assertThat(first.isCancelled).isTrue()
+        assertThat(ran).isEmpty()
+    }
+
+    @Test
+    fun `cancelling a running job cancels its token`() {
+        val started = CountDownLatch(1)
+        val cancelled = CountDownLatch(1)
+        val job =
+            scheduler.schedule(RenderPriority.VISIBLE) { token ->
+                token.invokeOnCancel { cancelled.countDown() }
+                started.countDown()
+                cancelled.await(5, TimeUnit.SECONDS)
+            }
+        assertThat(started.await(5, TimeUnit.SECONDS)).isTrue()
+
+        job.cancel()
+
+        assertThrows<CancellationException> { job.get() }
+        assertThat(scheduler.getStats()[RenderPriority.VISIBLE].cancelled).isEqualTo(1)
+    }
+
+    @Test
+    fun `cancelIf reaches a running job scheduled without a key`() {
+        val started = CountDownLatch(1)
+        val cancelled = CountDownLatch(1)
+        val job =
+            scheduler.schedule(RenderPriority.NEAR_PREFETCH) { token ->
+                token.invokeOnCancel { cancelled.countDown() }
+                started.countDown()
+                cancelled.await(5, TimeUnit.SECONDS)
+            }
+        assertThat(started.await(5, TimeUnit.SECONDS)).isTrue()
+
+        assertThat(scheduler.cancelIf { it.priority == RenderPriority.NEAR_PREFETCH }).isEqualTo(1)
+
+        assertThrows<CancellationException> { job.get() }
+        assertThat(scheduler.getStats()[RenderPriority.NEAR_PREFETCH].cancelled).isEqualTo(1)
+    }
+
+    @Test
+    fun `jobs run holding the PDFium lock and failures reach the caller`() {
+        val locked = scheduler.schedule(RenderPriority.VISIBLE) { PdfiumCoreU.lock.status() }.get()
+        val failing = scheduler.schedule(RenderPriority.VISIBLE) { error("no page") }
+
+        assertThat(locked).isTrue()
+        assertThrows<IllegalStateException> { failing.get() }
+        assertThat(scheduler.getStats()[RenderPriority.VISIBLE].completed).isEqualTo(2)
+    }
+
+    @Test
+    fun `close cancels queued jobs and refuses new ones`() {
+        val release = holdThread()
+        val queued = record(RenderPriority.VISIBLE, "visible")
+
+        scheduler.close()
+        release.countDown()
+
+        assertThat(queued.isCancelled).isTrue()
+        assertThrows<IllegalStateException> { record(RenderPriority.VISIBLE, "late") }
+        assertThat(ran).isEmpty()
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+import java.nio.ByteBuffer
+
+class DocumentTextTest {
+    private fun textOf(
+        encoding: TextEncoding,
+        vararg pages: String,
+    ): DocumentText {
+        val buffer = ByteBuffer.allocateDirect(256)
+        val ends =
+            IntArray(pages.size) {
+                buffer.put(pages[it].toByteArray(encoding.charset))
+                buffer.position()
+            }
+        buffer.flip()
+        return DocumentText(buffer, encoding, 4, ends)
+    }
+
+    @Test
+    fun splitsPagesByTheirEnds() {
+        val text = textOf(TextEncoding.UTF_16LE, "First page", "", "Third")
+
+        assertThat(text.pageCount).isEqualTo(3)
+        assertThat(text.pageStart(0)).isEqualTo(0)
+        assertThat(text.pageEnd(0)).isEqualTo(20)
+        assertThat(text.pageStart(2)).isEqualTo(20)
+        assertThat(text.pageText(0)).isEqualTo("First page")
+        assertThat(text.pageText(1)).isEmpty()
+        assertThat(text.pageText(2)).isEqualTo("Third")
+    }
+
+    @Test
+    fun decodesUtf8PagesWithoutMovingTheBuffer() {
+        val text = textOf(TextEncoding.UTF_8, "naïve", "日本語")
+
+        assertThat(text.pageText(1)).isEqualTo("日本語")
+        assertThat(text.pageBuffer(1).remaining()).isEqualTo(9)
+        assertThat(text.buffer.position()).isEqualTo(0)
+        assertThat(text.firstPage).isEqualTo(4)
+    }
+}
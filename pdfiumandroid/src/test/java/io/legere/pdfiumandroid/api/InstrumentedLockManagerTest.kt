@@ -0,0 +1,114 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import com.google.common.truth.Truth.assertThat
+import kotlinx.coroutines.test.runTest
+import org.junit.jupiter.api.Test
+import java.util.concurrent.CountDownLatch
+import kotlin.concurrent.thread
+
+class InstrumentedLockManagerTest {
+    @Test
+    fun recordsEachCallUnderItsTag() =
+        runTest {
+            val lock = InstrumentedLockManager(LockManagerReentrantLock())
+
+            lock.withLockBlocking(LockTag.RENDER_PAGE) { Thread.sleep(2) }
+            lock.withLockBlocking(LockTag.RENDER_PAGE) { }
+            lock.withLock(LockTag.FIND_START) { }
+            lock.withLockBlocking { }
+
+            val stats = lock.snapshot()
+            assertThat(stats.operations.keys)
+                .containsExactly(LockTag.RENDER_PAGE, LockTag.FIND_START, LockTag.UNTAGGED)
+            assertThat(stats[LockTag.RENDER_PAGE]!!.hold.count).isEqualTo(2)
+            assertThat(stats[LockTag.RENDER_PAGE]!!.hold.maxNanos).isAtLeast(2_000_000)
+            assertThat(stats[LockTag.FIND_START]!!.wait.count).isEqualTo(1)
+        }
+
+    @Test
+    fun waitTimeCoversTheTimeAnotherCallHeldTheLock() {
+        val lock = InstrumentedLockManager(LockManagerReentrantLock())
+        val held = CountDownLatch(1)
+        val holder =
+            thread {
+                lock.withLockBlocking(LockTag.RENDER_PAGE) {
+                    held.countDown()
+                    Thread.sleep(20)
+                }
+            }
+        held.await()
+
+        lock.withLockBlocking(LockTag.OPEN_TEXT_PAGE) { }
+        holder.join()
+
+        val waited = lock.snapshot()[LockTag.OPEN_TEXT_PAGE]!!.wait
+        assertThat(waited.maxNanos).isAtLeast(10_000_000)
+    }
+
+    @Test
+    fun failedBlockIsStillRecordedAndRethrown() {
+        val lock = InstrumentedLockManager(LockManagerReentrantLock())
+
+        val result = runCatching { lock.withLockBlocking<Unit>(LockTag.OPEN_PAGE) { error("boom") } }
+
+        assertThat(result.exceptionOrNull()).isInstanceOf(IllegalStateException::class.java)
+        assertThat(lock.snapshot()[LockTag.OPEN_PAGE]!!.hold.count).isEqualTo(1)
+        assertThat(lock.status()).isFalse()
+    }
+
+    @Test
+    fun resetDropsTimings() {
+        val lock = InstrumentedLockManager(LockManagerReentrantLock())
+        lock.withLockBlocking(LockTag.RENDER_PAGES) { }
+
+        lock.reset()
+
+        assertThat(lock.snapshot().operations).isEmpty()
+    }
+
+    @Test
+    fun histogramBucketsAndPercentiles() {
+        assertThat(LockTimeHistogram.bucketFor(0)).isEqualTo(0)
+        assertThat(LockTimeHistogram.bucketFor(1)).isEqualTo(0)
+        assertThat(LockTimeHistogram.bucketFor(2)).isEqualTo(1)
+        assertThat(LockTimeHistogram.bucketFor(1_000)).isEqualTo(9)
+        assertThat(LockTimeHistogram.bucketFor(Long.MAX_VALUE)).isEqualTo(LockTimeHistogram.BUCKET_COUNT - 1)
+
+        val buckets = MutableList(LockTimeHistogram.BUCKET_COUNT) { 0L }
+        buckets[LockTimeHistogram.bucketFor(1_000)] = 9
+        buckets[LockTimeHistogram.bucketFor(1_000_000)] = 1
+        val histogram = LockTimeHistogram(count = 10, totalNanos = 1_009_000, maxNanos = 1_000_000, buckets = buckets)
+
+        assertThat(histogram.percentileNanos(50.0)).isEqualTo(LockTimeHistogram.bucketUpperBoundNanos(9))
+        assertThat(histogram.percentileNanos(99.0)).isEqualTo(1_000_000)
+        assertThat(histogram.meanNanos).isEqualTo(100_900)
+    }
+
+    @Test
+    fun untaggedLockManagerIgnoresTheTag() {
+        val lock = LockManagerReentrantLock()
+
+        val result = lock.withLockBlocking(LockTag.RENDER_PAGE) { 42 }
+
+        assertThat(result).isEqualTo(42)
+    }
+}
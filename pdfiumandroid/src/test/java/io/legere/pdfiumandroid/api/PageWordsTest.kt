@@ -0,0 +1,78 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+
+class PageWordsTest {
+    // "Hello, wo-" / "rld again" on two lines, as the native segmentation packs it.
+    private val words =
+        PageWords(
+            word(10f, 700f, 40f, 688f, start = 0, length = 5, line = 0) +
+                word(45f, 700f, 62f, 688f, start = 7, length = 3, line = 0, flags = PageWords.FLAG_HYPHENATED) +
+                word(10f, 686f, 24f, 674f, start = 12, length = 3, line = 1) +
+                word(28f, 686f, 50f, 674f, start = 16, length = 5, line = 1),
+        )
+
+    @Suppress("LongParameterList")
+    private fun word(
+        left: Float,
+        top: Float,
+        right: Float,
+        bottom: Float,
+        start: Int,
+        length: Int,
+        line: Int,
+        flags: Int = 0,
+    ) = floatArrayOf(left, top, right, bottom, start.toFloat(), length.toFloat(), line.toFloat(), flags.toFloat())
+
+    @Test
+    fun readsPackedWords() {
+        assertThat(words.wordCount).isEqualTo(4)
+        assertThat(words.lineCount).isEqualTo(2)
+        assertThat(words.start(1)).isEqualTo(7)
+        assertThat(words.length(1)).isEqualTo(3)
+        assertThat(words.line(2)).isEqualTo(1)
+        assertThat(words.isHyphenated(1)).isTrue()
+        assertThat(words.isHyphenated(2)).isFalse()
+        assertThat(words.left(3)).isEqualTo(28f)
+        assertThat(words.top(3)).isEqualTo(686f)
+        assertThat(words.right(3)).isEqualTo(50f)
+        assertThat(words.bottom(3)).isEqualTo(674f)
+    }
+
+    @Test
+    fun findsTheWordHoldingACharacter() {
+        assertThat(words.indexOfWordAt(0)).isEqualTo(0)
+        assertThat(words.indexOfWordAt(4)).isEqualTo(0)
+        assertThat(words.indexOfWordAt(5)).isEqualTo(-1)
+        assertThat(words.indexOfWordAt(9)).isEqualTo(1)
+        assertThat(words.indexOfWordAt(20)).isEqualTo(3)
+        assertThat(words.indexOfWordAt(21)).isEqualTo(-1)
+    }
+
+    @Test
+    fun emptyPageHasNoLines() {
+        assertThat(PageWords.EMPTY.wordCount).isEqualTo(0)
+        assertThat(PageWords.EMPTY.lineCount).isEqualTo(0)
+        assertThat(PageWords.EMPTY.indexOfWordAt(0)).isEqualTo(-1)
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+
+class RenderCancellationTokenTest {
+    @Test
+    fun cancelNotifiesListenersOnce() {
+        val token = RenderCancellationToken()
+        var calls = 0
+        token.invokeOnCancel { calls++ }
+
+        token.cancel()
+        token.cancel()
+
+        assertThat(token.isCancelled).isTrue()
+        assertThat(calls).isEqualTo(1)
+    }
+
+    @Test
+    fun listenerAddedAfterCancelRunsImmediately() {
+        val token = RenderCancellationToken()
+        token.cancel()
+        var called = false
+
+        token.invokeOnCancel { called = true }
+
+        assertThat(called).isTrue()
+    }
+
+    @Test
+    fun removedListenerIsNotNotified() {
+        val token = RenderCancellationToken()
+        var called = false
+        val listener: () -> Unit = { called = true }
+        token.invokeOnCancel(listener)
+
+        token.removeOnCancel(listener)
+        token.cancel()
+
+        assertThat(called).isFalse()
+    }
+
+    @Test
+    fun statusFromValue() {
+        assertThat(RenderStatus.fromValue(1)).isEqualTo(RenderStatus.INCOMPLETE)
+        assertThat(RenderStatus.fromValue(4)).isEqualTo(RenderStatus.CANCELLED)
+        assertThat(RenderStatus.fromValue(-1)).isEqualTo(RenderStatus.FAILED)
+        assertThat(RenderStatus.INCOMPLETE.isFinished).isFalse()
+        assertThat(RenderStatus.DONE.isFinished).isTrue()
+    }
+}
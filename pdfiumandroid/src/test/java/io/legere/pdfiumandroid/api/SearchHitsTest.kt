@@ -0,0 +1,66 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.api
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+
+class SearchHitsTest {
+    // Three hits as the native search packs them: one on page 2, two on page 5, the second of
+    // which wraps onto a second line.
+    private val hits =
+        SearchHits(
+            floatArrayOf(2f, 40f, 6f, 1f, 10f, 700f, 40f, 688f) +
+                floatArrayOf(5f, 3f, 6f, 1f, 12f, 650f, 44f, 638f) +
+                floatArrayOf(5f, 90f, 9f, 2f, 400f, 500f, 440f, 488f, 10f, 486f, 30f, 474f),
+        )
+
+    @Test
+    fun readsPackedHits() {
+        assertThat(hits.hitCount).isEqualTo(3)
+        assertThat(hits.pageIndex(0)).isEqualTo(2)
+        assertThat(hits.start(1)).isEqualTo(3)
+        assertThat(hits.length(2)).isEqualTo(9)
+        assertThat(hits.rectCount(1)).isEqualTo(1)
+        assertThat(hits.rectCount(2)).isEqualTo(2)
+        assertThat(hits.rects(2)).hasSize(2)
+    }
+
+    @Test
+    fun findsTheHitsOnAPage() {
+        assertThat(hits.hitsOnPage(2)).isEqualTo(0 until 1)
+        assertThat(hits.hitsOnPage(5)).isEqualTo(1 until 3)
+        assertThat(hits.hitsOnPage(3).isEmpty()).isTrue()
+        assertThat(hits.hitsOnPage(9).isEmpty()).isTrue()
+    }
+
+    @Test
+    fun appendsLaterHits() {
+        val more = SearchHits(floatArrayOf(7f, 0f, 2f, 0f))
+
+        val all = hits + more
+
+        assertThat(all.hitCount).isEqualTo(4)
+        assertThat(all.pageIndex(3)).isEqualTo(7)
+        assertThat(all.start(2)).isEqualTo(90)
+        assertThat(hits + SearchHits.EMPTY).isSameInstanceAs(hits)
+        assertThat(SearchHits.EMPTY.hitCount).isEqualTo(0)
+    }
+}
@@ -19,15 +19,23 @@
 
 package io.legere.pdfiumandroid.core.unlocked
 
+import android.content.ComponentCallbacks2
+import android.graphics.Bitmap
 import android.graphics.Matrix
 import android.graphics.RectF
+import android.view.Surface
 import com.google.common.truth.Truth.assertThat
 import io.legere.pdfiumandroid.PdfDocument
 import io.legere.pdfiumandroid.api.AlreadyClosedBehavior
 import io.legere.pdfiumandroid.api.Config
+import io.legere.pdfiumandroid.api.FindFlags
 import io.legere.pdfiumandroid.api.Meta
 import io.legere.pdfiumandroid.api.PdfWriteCallback
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.RenderLoopStats
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.TextEncoding
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.api.pdfiumConfig
 import io.legere.pdfiumandroid.core.jni.NativeDocument
 import io.legere.pdfiumandroid.core.jni.NativeFactory
@@ -35,6 +43,7 @@ import io.legere.pdfiumandroid.core.jni.NativePage
 import io.legere.pdfiumandroid.core.jni.NativeTextPage
 import io.legere.pdfiumandroid.core.unlocked.testing.ClosableTestContext
 import io.legere.pdfiumandroid.core.unlocked.testing.closableTest
+import io.legere.pdfiumandroid.core.util.RenderLoopBridge
 import io.mockk.every
 import io.mockk.impl.annotations.MockK
 import io.mockk.junit5.MockKExtension
@@ -46,7 +55,9 @@ import io.mockk.verify
 import io.mockk.verifyOrder
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
+import org.junit.jupiter.api.assertThrows
 import org.junit.jupiter.api.extension.ExtendWith
+import java.nio.ByteBuffer
 
 @ExtendWith(MockKExtension::class)
 abstract class PdfDocumentUBaseTest : ClosableTestContext {
@@ -125,6 +136,60 @@ abstract class PdfDocumentUBaseTest : ClosableTestContext {
             }
         }
 
+    @Test
+    fun `extractText happy path`() =
+        closableTest {
+            setupHappy {
+                every { mockNativeDocument.getPageCount(any()) } returns 3
+                every {
+                    mockNativeDocument.extractText(any(), any(), any(), any(), any(), false, any(), any())
+                } answers {
+                    val count = arg<Int>(2)
+                    val ends = arg<IntArray>(6)
+                    repeat(count) { ends[arg<Int>(7) + it] = arg<Int>(4) + (it + 1) * 2 }
+                    count
+                }
+            }
+            apiCall = {
+                pdfDocumentU.extractText()
+            }
+
+            verifyHappy {
+                assertThat(it!!.pageCount).isEqualTo(3)
+                assertThat(it.pageStart(1)).isEqualTo(2)
+                assertThat(it.pageEnd(2)).isEqualTo(6)
+                assertThat(it.buffer.limit()).isEqualTo(6)
+            }
+            verifyDefault {
+                assertThat(it).isNull()
+            }
+        }
+
+    @Test
+    fun `search happy path`() =
+        closableTest {
+            setupHappy {
+                every { mockNativeDocument.getPageCount(any()) } returns 2
+                every {
+                    mockNativeDocument.searchPages(any(), 0, any(), "needle", FindFlags.MatchCase.value)
+                } returns floatArrayOf(1f, 12f, 6f, 1f, 10f, 700f, 40f, 688f)
+            }
+            apiCall = {
+                pdfDocumentU.search("needle", setOf(FindFlags.MatchCase))
+            }
+
+            verifyHappy {
+                assertThat(it!!.hitCount).isEqualTo(1)
+                assertThat(it.pageIndex(0)).isEqualTo(1)
+                assertThat(it.start(0)).isEqualTo(12)
+                assertThat(it.length(0)).isEqualTo(6)
+                assertThat(it.rectCount(0)).isEqualTo(1)
+            }
+            verifyDefault {
+                assertThat(it).isNull()
+            }
+        }
+
     @Test
     fun `deletePage happy path`() =
         closableTest {
@@ -574,6 +639,97 @@ abstract class PdfDocumentUBaseTest : ClosableTestContext {
             }
         }
 
+    @Test
+    fun `renderThumbnailAtlas happy path`() =
+        closableTest {
+            val bitmap = mockk<Bitmap>()
+            setupHappy {
+                every {
+                    mockNativeDocument.renderThumbnailAtlas(any(), 2, any(), bitmap, 100, 140, true, any(), any())
+                } returns FloatArray(12)
+            }
+            apiCall = {
+                pdfDocumentU.renderThumbnailAtlas(bitmap, 2, 4, 100, 140)
+            }
+
+            verifyHappy {
+                assertThat(it).hasSize(3)
+            }
+            verifyDefault {
+                assertThat(it).isEmpty()
+            }
+        }
+
+    @Test
+    fun `renderThumbnailAtlas to buffer happy path`() =
+        closableTest {
+            val buffer = ByteBuffer.allocateDirect(400 * 280 * 4)
+            setupHappy {
+                every {
+                    mockNativeDocument.renderThumbnailAtlasToBuffer(
+                        any(),
+                        0,
+                        any(),
+                        buffer,
+                        400,
+                        280,
+                        100,
+                        140,
+                        false,
+                        any(),
+                        any(),
+                    )
+                } returns FloatArray(8)
+            }
+            apiCall = {
+                pdfDocumentU.renderThumbnailAtlas(buffer, 400, 280, 0, 1, 100, 140, useEmbedded = false)
+            }
+
+            verifyHappy {
+                assertThat(it).hasSize(2)
+            }
+            verifyDefault {
+                assertThat(it).isEmpty()
+            }
+        }
+
+    @Test
+    fun `isPageAvailable happy path`() =
+        closableTest {
+            setupHappy {
+                every { mockNativeDocument.getPageCount(any()) } returns 3
+                every { mockNativeDocument.isPageAvail(any(), 1) } returns 1
+            }
+            apiCall = {
+                pdfDocumentU.isPageAvailable(1)
+            }
+
+            verifyHappy {
+                assertThat(it).isTrue()
+            }
+            verifyDefault {
+                assertThat(it).isFalse()
+            }
+        }
+
+    @Test
+    fun `getFirstAvailablePage happy path`() =
+        closableTest {
+            setupHappy {
+                every { mockNativeDocument.getFirstAvailPage(any()) } returns 4
+            }
+            apiCall = {
+                pdfDocumentU.getFirstAvailablePage()
+            }
+
+            verifyHappy {
+                assertThat(it).isEqualTo(4)
+            }
+            verifyDefault {
+                assertThat(it).isEqualTo(0)
+            }
+        }
+
     @Test
     fun `saveAsCopy flag transmission`() =
         closableTest {
@@ -651,6 +807,24 @@ class PdfDocumentUHappyTest : PdfDocumentUBaseTest() {
         pdfDocumentU.openPage(0)
         verify(exactly = 1) { mockNativeDocument.loadPage(any(), any()) }
     }
+
+    @Test
+    fun `notifyDataAvailable reports each page once, as it becomes available`() {
+        every { mockNativeDocument.getPageCount(any()) } returns 3
+        every { mockNativeDocument.isPageAvail(any(), 0) } returns 1
+        every { mockNativeDocument.isPageAvail(any(), 1) } returns 0
+        every { mockNativeDocument.isPageAvail(any(), 2) } returns 1
+        val reported = mutableListOf<Int>()
+        pdfDocumentU.setOnPageAvailableListener { reported.add(it) }
+
+        assertThat(pdfDocumentU.notifyDataAvailable()).containsExactly(0, 2).inOrder()
+
+        every { mockNativeDocument.isPageAvail(any(), 1) } returns 1
+        assertThat(pdfDocumentU.notifyDataAvailable()).containsExactly(1)
+
+        assertThat(reported).containsExactly(0, 2, 1).inOrder()
+        verify(exactly = 1) { mockNativeDocument.isPageAvail(any(), 0) }
+    }
 }
 
 class PdfDocumentUCloseExceptionTest : PdfDocumentUBaseTest() {
@@ -687,11 +861,24 @@ class PdfDocumentUPageRetentionTest : PdfDocumentUBaseTest() {
     @BeforeEach
     fun setUpNativePage() {
         every { mockNativePage.closePage(any()) } just runs
+        every { mockNativePage.getPageMemoryEstimate(any()) } returns PAGE_BYTES
+        every { mockNativeTextPage.getTextPageMemoryEstimate(any()) } returns PAGE_BYTES
     }
 
-    /** A document that keeps [retaining] pages open after their last holder closes them. */
-    private fun documentRetaining(retaining: Int): PdfDocumentU {
-        pdfiumConfig = Config(alreadyClosedBehavior = getBehavior(), pageRetentionCount = retaining)
+    /**
+     * A document that keeps [retaining] pages open after their last holder closes them, as long as
+     * they hold no more than [budgetBytes] between them.
+     */
+    private fun documentRetaining(
+        retaining: Int,
+        budgetBytes: Long = PAGE_BYTES * 100,
+    ): PdfDocumentU {
+        pdfiumConfig =
+            Config(
+                alreadyClosedBehavior = getBehavior(),
+                pageRetentionCount = retaining,
+                pageRetentionBudgetBytes = budgetBytes,
+            )
         return PdfDocumentU(0, mockNativeFactory)
     }
 
@@ -744,6 +931,143 @@ class PdfDocumentUPageRetentionTest : PdfDocumentUBaseTest() {
         verify(exactly = 0) { mockNativePage.closePage(100) }
     }
 
+    @Test
+    fun `releasing pages past the byte budget closes the least recently released below the count`() {
+        val document = documentRetaining(retaining = 10, budgetBytes = PAGE_BYTES * 5)
+        every { mockNativeDocument.loadPage(any(), 0) } returns 100
+        every { mockNativeDocument.loadPage(any(), 1) } returns 200
+        every { mockNativeDocument.loadPage(any(), 2) } returns 300
+        every { mockNativePage.getPageMemoryEstimate(100) } returns PAGE_BYTES
+        every { mockNativePage.getPageMemoryEstimate(200) } returns PAGE_BYTES * 2
+        every { mockNativePage.getPageMemoryEstimate(300) } returns PAGE_BYTES * 3
+
+        document.openPage(0)?.close()
+        document.openPage(1)?.close()
+        verify(exactly = 0) { mockNativePage.closePage(any()) }
+
+        // Six pages' worth is over the budget of five; dropping page 0 alone brings it to five
+        document.openPage(2)?.close()
+
+        verify(exactly = 1) { mockNativePage.closePage(100) }
+        verify(exactly = 0) { mockNativePage.closePage(200) }
+        verify(exactly = 0) { mockNativePage.closePage(300) }
+    }
+
+    @Test
+    fun `a page larger than the whole budget is closed as soon as it is released`() {
+        val document = documentRetaining(retaining = 10, budgetBytes = PAGE_BYTES * 5)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+        every { mockNativePage.getPageMemoryEstimate(100) } returns PAGE_BYTES * 6
+
+        document.openPage(0)?.close()
+        verify(exactly = 1) { mockNativePage.closePage(100) }
+
+        // It was closed, so opening it again has to load it again
+        document.openPage(0)
+        verify(exactly = 2) { mockNativeDocument.loadPage(any(), any()) }
+    }
+
+    @Test
+    fun `a page is measured once however often it is released`() {
+        val document = documentRetaining(retaining = 4)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+
+        repeat(3) { document.openPage(0)?.close() }
+
+        verify(exactly = 1) { mockNativePage.getPageMemoryEstimate(100) }
+    }
+
+    @Test
+    fun `pages are not measured without a byte budget`() {
+        val document = documentRetaining(retaining = 4, budgetBytes = 0)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+
+        document.openPage(0)?.close()
+
+        verify(exactly = 0) { mockNativePage.getPageMemoryEstimate(any()) }
+    }
+
+    @Test
+    fun `a retained text page counts toward the byte budget with its page`() {
+        val document = documentRetaining(retaining = 10, budgetBytes = PAGE_BYTES * 2)
+        every { mockNativeDocument.loadPage(any(), 0) } returns 100
+        every { mockNativeDocument.loadPage(any(), 1) } returns 200
+        every { mockNativeDocument.loadTextPage(any(), 100) } returns 101
+        every { mockNativeTextPage.closeTextPage(any()) } just runs
+
+        document.openPage(0)?.use { page -> page.openTextPage().close() }
+        // Page 0 and its text page take the whole budget between them, so page 1 pushes them out
+        document.openPage(1)?.close()
+
+        verifyOrder {
+            mockNativeTextPage.closeTextPage(101)
+            mockNativePage.closePage(100)
+        }
+        verify(exactly = 0) { mockNativePage.closePage(200) }
+    }
+
+    @Test
+    fun `a budget of 0 retains by count alone and never measures the pages`() {
+        val document = documentRetaining(retaining = 4, budgetBytes = 0)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+
+        document.openPage(0)?.close()
+
+        verify(exactly = 0) { mockNativePage.closePage(any()) }
+        verify(exactly = 0) { mockNativePage.getPageMemoryEstimate(any()) }
+    }
+
+    @Test
+    fun `trimMemory closes the retained pages but not the ones still held`() {
+        val document = documentRetaining(retaining = 4)
+        every { mockNativeDocument.loadPage(any(), 0) } returns 100
+        every { mockNativeDocument.loadPage(any(), 1) } returns 200
+
+        document.openPage(0)?.close()
+        document.openPage(1)
+
+        val released = document.trimMemory(ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE)
+
+        assertThat(released).isEqualTo(PAGE_BYTES)
+        verify(exactly = 1) { mockNativePage.closePage(100) }
+        verify(exactly = 0) { mockNativePage.closePage(200) }
+
+        // The trimmed page has to be loaded again
+        document.openPage(0)
+        verify(exactly = 2) { mockNativeDocument.loadPage(any(), 0) }
+    }
+
+    @Test
+    fun `trimMemory when running low also closes text pages nobody holds`() {
+        val document = documentRetaining(retaining = 4)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+        every { mockNativeDocument.loadTextPage(any(), 100) } returns 101
+        every { mockNativeTextPage.closeTextPage(any()) } just runs
+
+        val page = document.openPage(0)
+        page?.openTextPage()?.close()
+
+        assertThat(document.trimMemory(ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE)).isEqualTo(0L)
+        verify(exactly = 0) { mockNativeTextPage.closeTextPage(any()) }
+
+        val released = document.trimMemory(ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW)
+
+        assertThat(released).isEqualTo(PAGE_BYTES)
+        verify(exactly = 1) { mockNativeTextPage.closeTextPage(101) }
+        verify(exactly = 0) { mockNativePage.closePage(any()) }
+    }
+
+    @Test
+    fun `trimMemory below the moderate level keeps everything open`() {
+        val document = documentRetaining(retaining = 4)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+
+        document.openPage(0)?.close()
+
+        assertThat(document.trimMemory(0)).isEqualTo(0L)
+        verify(exactly = 0) { mockNativePage.closePage(any()) }
+    }
+
     @Test
     fun `a page held by another caller is not closed when one holder releases it`() {
         val document = documentRetaining(retaining = 0)
@@ -810,6 +1134,171 @@ class PdfDocumentUPageRetentionTest : PdfDocumentUBaseTest() {
         verify(exactly = 0) { mockNativePage.closePage(any()) }
     }
 
+    @Test
+    fun `renderThumbnail opens the page for the call and reuses it once retained`() {
+        val document = documentRetaining(retaining = 4)
+        val bitmap = mockk<Bitmap>()
+        every { mockNativeDocument.loadPage(any(), 3) } returns 300
+        every { mockNativePage.renderThumbnail(300, bitmap, true, any()) } returns 1
+
+        assertThat(document.renderThumbnail(3, bitmap)).isEqualTo(ThumbnailSource.EMBEDDED)
+        assertThat(document.renderThumbnail(3, bitmap)).isEqualTo(ThumbnailSource.EMBEDDED)
+
+        verify(exactly = 1) { mockNativeDocument.loadPage(any(), 3) }
+        verify(exactly = 2) { mockNativePage.renderThumbnail(300, bitmap, true, any()) }
+    }
+
+    @Test
+    fun `renderThumbnail closes the page afterwards when retention is off`() {
+        val document = documentRetaining(retaining = 0)
+        val bitmap = mockk<Bitmap>()
+        every { mockNativeDocument.loadPage(any(), 3) } returns 300
+        every { mockNativePage.renderThumbnail(300, bitmap, false, any()) } returns 0
+
+        assertThat(document.renderThumbnail(3, bitmap, useEmbedded = false)).isEqualTo(ThumbnailSource.RENDERED)
+
+        verify(exactly = 1) { mockNativePage.closePage(300) }
+    }
+
+    @Test
+    fun `scrolled renderPages reuses the frame only after a full render`() {
+        val surface = mockk<Surface>()
+        val reuse = mutableListOf<Boolean>()
+        every { mockNativeDocument.openSurfaceFrame() } returns 77L
+        every { mockNativeDocument.closeSurfaceFrame(77L) } just runs
+        every {
+            mockNativeDocument.renderPagesSurfaceScrolled(
+                77L,
+                any(),
+                surface,
+                any(),
+                any(),
+                0,
+                -12,
+                capture(reuse),
+                any(),
+                any(),
+                any(),
+                any(),
+            )
+        } returnsMany listOf(true, true, false, true, true)
+
+        val frame = pdfDocumentU.openSurfaceFrame()
+        repeat(3) { pdfDocumentU.renderPages(surface, frame, emptyList(), emptyList(), emptyList(), 0, -12) }
+        pdfDocumentU.renderPages(surface, frame, emptyList(), emptyList(), emptyList(), 0, -12)
+        frame.invalidate()
+        pdfDocumentU.renderPages(surface, frame, emptyList(), emptyList(), emptyList(), 0, -12)
+        frame.close()
+        frame.close()
+
+        // The first render has nothing to reuse, a failed one leaves nothing, and invalidate() drops the frame.
+        assertThat(reuse).containsExactly(false, true, true, false, false).inOrder()
+        verify(exactly = 1) { mockNativeDocument.closeSurfaceFrame(77L) }
+    }
+
+    @Test
+    fun `scrolled renderPages into a closed frame does not reach the native layer`() {
+        every { mockNativeDocument.openSurfaceFrame() } returns 77L
+        every { mockNativeDocument.closeSurfaceFrame(77L) } just runs
+        val frame = pdfDocumentU.openSurfaceFrame()
+        frame.close()
+
+        assertThrows<IllegalStateException> {
+            pdfDocumentU.renderPages(mockk<Surface>(), frame, emptyList(), emptyList(), emptyList(), 0, 4)
+        }
+        verify(exactly = 0) {
+            mockNativeDocument.renderPagesSurfaceScrolled(
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+            )
+        }
+    }
+
+    @Test
+    fun `render loop posts frames without the lock and rasterizes under it`() {
+        val document = documentRetaining(retaining = 4)
+        every { mockNativeDocument.loadPage(any(), any()) } returns 100
+        val surface = mockk<Surface>()
+        val bridge = slot<RenderLoopBridge>()
+        val pages = slot<LongArray>()
+        var lockedWhileRasterizing = false
+        every { mockNativeDocument.openRenderLoop(surface, capture(bridge)) } returns 88L
+        every {
+            mockNativeDocument.submitRenderLoopFrame(88L, capture(pages), any(), any(), any(), any(), any())
+        } answers { assertThat(PdfiumCoreU.lock.status()).isFalse() }
+        every { mockNativeDocument.rasterizeRenderLoopFrame(88L) } answers {
+            lockedWhileRasterizing = PdfiumCoreU.lock.status()
+            true
+        }
+        every { mockNativeDocument.closeRenderLoop(88L) } just runs
+
+        val loop = document.openRenderLoop(surface)!!
+        loop.submit(listOf(document.openPage(0)!!), listOf(Matrix()), listOf(RectF()))
+
+        assertThat(pages.captured).asList().containsExactly(100L)
+        // What the native thread calls to rasterize the frame it took
+        assertThat(bridge.captured.rasterize()).isTrue()
+        assertThat(lockedWhileRasterizing).isTrue()
+
+        loop.close()
+        loop.close()
+        verify(exactly = 1) { mockNativeDocument.closeRenderLoop(88L) }
+    }
+
+    @Test
+    fun `render loop stats come from the native counters until it is closed`() {
+        every { mockNativeDocument.openRenderLoop(any(), any()) } returns 88L
+        every { mockNativeDocument.getRenderLoopStats(88L) } returns longArrayOf(10, 6, 4)
+        every { mockNativeDocument.closeRenderLoop(88L) } just runs
+
+        val loop = pdfDocumentU.openRenderLoop(mockk<Surface>())!!
+
+        assertThat(loop.getStats()).isEqualTo(RenderLoopStats(10, 6, 4))
+        loop.close()
+        assertThat(loop.getStats()).isEqualTo(RenderLoopStats(0, 0, 0))
+        assertThrows<IllegalStateException> { loop.submit(emptyList(), emptyList(), emptyList()) }
+        verify(exactly = 0) {
+            mockNativeDocument.submitRenderLoopFrame(any(), any(), any(), any(), any(), any(), any())
+        }
+    }
+
+    @Test
+    fun `renderThumbnailAtlas hands open pages to the native layer and 0 for the rest`() {
+        val document = documentRetaining(retaining = 4)
+        val bitmap = mockk<Bitmap>()
+        val openPages = slot<LongArray>()
+        every { mockNativeDocument.loadPage(any(), 1) } returns 200
+        every {
+            mockNativeDocument.renderThumbnailAtlas(any(), 0, capture(openPages), bitmap, 64, 64, true, any(), any())
+        } returns FloatArray(12)
+
+        document.openPage(1)?.close()
+        document.renderThumbnailAtlas(bitmap, 0, 2, 64, 64)
+
+        assertThat(openPages.captured.toList()).containsExactly(0L, 200L, 0L).inOrder()
+        verify(exactly = 1) { mockNativeDocument.loadPage(any(), any()) }
+    }
+
+    @Test
+    fun `renderThumbnailAtlas rejects an empty cell and a heap buffer`() {
+        assertThrows<IllegalArgumentException> {
+            pdfDocumentU.renderThumbnailAtlas(mockk<Bitmap>(), 0, 2, 0, 64)
+        }
+        assertThrows<IllegalArgumentException> {
+            pdfDocumentU.renderThumbnailAtlas(ByteBuffer.allocate(64 * 64 * 4), 64, 64, 0, 0, 64, 64)
+        }
+    }
+
     @Test
     fun `open-use-close of the same page loads it every time when retention is off`() {
         val document = PdfDocument(documentRetaining(retaining = 0))
@@ -960,4 +1449,102 @@ class PdfDocumentUPageRetentionTest : PdfDocumentUBaseTest() {
         verify(exactly = 1) { mockNativePage.closePage(111) }
         assertThat(pages.map { it.pagePtr }).containsExactly(100L, 200L).inOrder()
     }
+
+    @Test
+    fun `extractText grows the buffer when a page does not fit and keeps what was written`() {
+        val pageBytes = 6000
+        every { mockNativeDocument.getPageCount(any()) } returns 2
+        every {
+            mockNativeDocument.extractText(any(), any(), any(), any(), any(), true, any(), any())
+        } answers {
+            val buffer = arg<ByteBuffer>(3)
+            val position = arg<Int>(4)
+            if (buffer.capacity() - position < pageBytes) {
+                0
+            } else {
+                buffer.put(position, (arg<Int>(1) + 1).toByte())
+                arg<IntArray>(6)[arg<Int>(7)] = position + pageBytes
+                1
+            }
+        }
+
+        val text = pdfDocumentU.extractText(encoding = TextEncoding.UTF_8)!!
+
+        assertThat(text.pageCount).isEqualTo(2)
+        assertThat(text.buffer.capacity()).isAtLeast(pageBytes * 2)
+        assertThat(text.buffer.get(0)).isEqualTo(1.toByte())
+        assertThat(text.buffer.get(pageBytes)).isEqualTo(2.toByte())
+    }
+
+    @Test
+    fun `extractNext stops after the pages asked for`() {
+        every { mockNativeDocument.getPageCount(any()) } returns 5
+        every {
+            mockNativeDocument.extractText(any(), any(), any(), any(), any(), any(), any(), any())
+        } answers { arg<Int>(2) }
+
+        val extraction = pdfDocumentU.startTextExtraction(firstPage = 1)!!
+
+        assertThat(extraction.pageCount).isEqualTo(4)
+        assertThat(extraction.extractNext(3)).isFalse()
+        assertThat(extraction.pagesDone).isEqualTo(3)
+        assertThat(extraction.extractNext(3)).isTrue()
+        verify { mockNativeDocument.extractText(any(), 1, 3, any(), 0, false, any(), 0) }
+        verify { mockNativeDocument.extractText(any(), 4, 1, any(), 0, false, any(), 3) }
+    }
+
+    @Test
+    fun `startTextExtraction rejects pages outside the document`() {
+        every { mockNativeDocument.getPageCount(any()) } returns 2
+
+        assertThrows<IllegalArgumentException> { pdfDocumentU.startTextExtraction(firstPage = 3) }
+        assertThrows<IllegalArgumentException> { pdfDocumentU.startTextExtraction(firstPage = 1, pageCount = 2) }
+    }
+
+    @Test
+    fun `search goes through a retained text page and leaves the other pages to the native layer`() {
+        val document = documentRetaining(retaining = 4)
+        val textPagePtrs = slot<LongArray>()
+        every { mockNativeDocument.getPageCount(any()) } returns 3
+        every { mockNativeDocument.loadPage(any(), 1) } returns 100
+        every { mockNativeDocument.loadTextPage(any(), 100) } returns 500
+        every { mockNativeDocument.searchPages(any(), 0, capture(textPagePtrs), "a", 0) } returns FloatArray(0)
+
+        document.openPage(1)?.use { page -> page.openTextPage().close() }
+        val hits = document.search("a")
+
+        assertThat(hits!!.hitCount).isEqualTo(0)
+        assertThat(textPagePtrs.captured.toList()).containsExactly(0L, 500L, 0L).inOrder()
+    }
+
+    @Test
+    fun `search stops between runs of pages once cancelled and keeps the hits so far`() {
+        val document = PdfDocument(pdfDocumentU)
+        val token = RenderCancellationToken()
+        val progress = mutableListOf<Int>()
+        every { mockNativeDocument.getPageCount(any()) } returns 6
+        every {
+            mockNativeDocument.searchPages(any(), any(), any(), "a", 0)
+        } answers { floatArrayOf(arg<Int>(1).toFloat(), 0f, 1f, 0f) }
+
+        val hits =
+            document.search("a", pagesPerLock = 2, cancellationToken = token) { _, pagesSearched ->
+                progress.add(pagesSearched)
+                if (pagesSearched == 4) token.cancel()
+            }
+
+        assertThat(progress).containsExactly(2, 4).inOrder()
+        assertThat(hits!!.hitCount).isEqualTo(2)
+        assertThat(hits.pageIndex(1)).isEqualTo(2)
+        verify(exactly = 2) { mockNativeDocument.searchPages(any(), any(), any(), any(), any()) }
+    }
+
+    @Test
+    fun `startSearch rejects an empty query`() {
+        assertThrows<IllegalArgumentException> { pdfDocumentU.startSearch("") }
+    }
+
+    companion object {
+        private const val PAGE_BYTES = 1024L
+    }
 }
@@ -30,7 +30,10 @@ import com.google.common.truth.Truth.assertThat
 import io.legere.pdfiumandroid.api.AlreadyClosedBehavior
 import io.legere.pdfiumandroid.api.ImmutableMatrix
 import io.legere.pdfiumandroid.api.PageAttributes
+import io.legere.pdfiumandroid.api.RenderCancellationToken
+import io.legere.pdfiumandroid.api.RenderStatus
 import io.legere.pdfiumandroid.api.Size
+import io.legere.pdfiumandroid.api.ThumbnailSource
 import io.legere.pdfiumandroid.api.pdfiumConfig
 import io.legere.pdfiumandroid.core.jni.NativeDocument
 import io.legere.pdfiumandroid.core.jni.NativeFactory
@@ -45,6 +48,7 @@ import io.mockk.junit5.MockKExtension
 import io.mockk.just
 import io.mockk.mockk
 import io.mockk.runs
+import io.mockk.verify
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
 import org.junit.jupiter.api.assertThrows
@@ -605,6 +609,199 @@ abstract class PdfPageUBaseTest : ClosableTestContext {
         pdfPage.renderPageBitmap(null, matrix, clipRect)
     }
 
+    @Test
+    fun `startRenderPageBitmap success`() =
+        closableTest {
+            val bitmap = mockk<Bitmap>()
+            setupHappy {
+                every { mockNativePage.openProgressiveRender() } returns 42L
+                every {
+                    mockNativePage.startProgressiveRender(
+                        42L,
+                        any(),
+                        bitmap,
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                        any(),
+                    )
+                } returns RenderStatus.DONE.value
+                every { mockNativePage.closeProgressiveRender(42L, true) } just runs
+            }
+            apiCall = {
+                pdfPage.startRenderPageBitmap(bitmap, 0, 0, 100, 100)?.status
+            }
+            verifyHappy {
+                assertThat(it).isEqualTo(RenderStatus.DONE)
+                // A finished render releases its native state by itself.
+                verify { mockNativePage.closeProgressiveRender(42L, true) }
+            }
+            verifyDefault {
+                assertThat(it).isNull()
+            }
+        }
+
+    @Test
+    fun `startRenderPageBitmap resumes until done`() {
+        if (isStateClosed()) return
+
+        val bitmap = mockk<Bitmap>()
+        every { mockNativePage.openProgressiveRender() } returns 42L
+        every {
+            mockNativePage.startProgressiveRender(
+                42L,
+                any(),
+                bitmap,
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                10L,
+            )
+        } returns RenderStatus.INCOMPLETE.value
+        every { mockNativePage.continueProgressiveRender(42L, bitmap, 10L) } returnsMany
+            listOf(RenderStatus.INCOMPLETE.value, RenderStatus.DONE.value)
+        every { mockNativePage.closeProgressiveRender(42L, true) } just runs
+
+        val render = pdfPage.startRenderPageBitmap(bitmap, 0, 0, 100, 100, timeBudgetMillis = 10L)!!
+        assertThat(render.status).isEqualTo(RenderStatus.INCOMPLETE)
+        assertThat(render.resume(10L)).isEqualTo(RenderStatus.INCOMPLETE)
+        assertThat(render.resume(10L)).isEqualTo(RenderStatus.DONE)
+        // Nothing left to resume.
+        assertThat(render.resume(10L)).isEqualTo(RenderStatus.DONE)
+        verify(exactly = 2) { mockNativePage.continueProgressiveRender(42L, bitmap, 10L) }
+        verify(exactly = 1) { mockNativePage.closeProgressiveRender(42L, true) }
+    }
+
+    @Test
+    fun `startRenderPageBitmap cancelled by token`() {
+        if (isStateClosed()) return
+
+        val bitmap = mockk<Bitmap>()
+        val token = RenderCancellationToken()
+        every { mockNativePage.openProgressiveRender() } returns 42L
+        every {
+            mockNativePage.startProgressiveRender(
+                42L,
+                any(),
+                bitmap,
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+            )
+        } returns RenderStatus.INCOMPLETE.value
+        every { mockNativePage.cancelProgressiveRender(42L) } just runs
+        every { mockNativePage.continueProgressiveRender(42L, bitmap, any()) } returns
+            RenderStatus.CANCELLED.value
+        every { mockNativePage.closeProgressiveRender(42L, true) } just runs
+
+        val render =
+            pdfPage.startRenderPageBitmap(bitmap, 0, 0, 100, 100, cancellationToken = token, timeBudgetMillis = 10L)!!
+        token.cancel()
+        verify { mockNativePage.cancelProgressiveRender(42L) }
+        assertThat(render.resume()).isEqualTo(RenderStatus.CANCELLED)
+    }
+
+    @Test
+    fun `closing the page abandons an incomplete progressive render`() {
+        if (isStateClosed()) return
+
+        val bitmap = mockk<Bitmap>()
+        every { mockNativePage.openProgressiveRender() } returns 42L
+        every {
+            mockNativePage.startProgressiveRender(
+                42L,
+                any(),
+                bitmap,
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+                any(),
+            )
+        } returns RenderStatus.INCOMPLETE.value
+        every { mockNativePage.closeProgressiveRender(42L, true) } just runs
+
+        val render = pdfPage.startRenderPageBitmap(bitmap, 0, 0, 100, 100, timeBudgetMillis = 10L)!!
+        pdfPage.close()
+        pdfPage.close()
+        assertThat(render.status).isEqualTo(RenderStatus.CANCELLED)
+        verify(exactly = 1) { mockNativePage.closeProgressiveRender(42L, true) }
+    }
+
+    @Test
+    fun `renderThumbnail uses embedded thumbnail`() =
+        closableTest {
+            val bitmap = mockk<Bitmap>()
+            setupHappy {
+                every { mockNativePage.renderThumbnail(any(), bitmap, true, any()) } returns 1
+            }
+            apiCall = {
+                pdfPage.renderThumbnail(bitmap)
+            }
+            verifyHappy {
+                assertThat(it).isEqualTo(ThumbnailSource.EMBEDDED)
+            }
+            verifyDefault {
+                assertThat(it).isNull()
+            }
+        }
+
+    @Test
+    fun `renderThumbnail falls back to render`() {
+        if (isStateClosed()) return
+        val bitmap = mockk<Bitmap>()
+        every { mockNativePage.renderThumbnail(any(), bitmap, false, 0x12345678) } returns 0
+
+        assertThat(pdfPage.renderThumbnail(bitmap, 0x12345678, useEmbedded = false))
+            .isEqualTo(ThumbnailSource.RENDERED)
+    }
+
+    @Test
+    fun `renderThumbnail failure returns null`() {
+        if (isStateClosed()) return
+        val bitmap = mockk<Bitmap>()
+        every { mockNativePage.renderThumbnail(any(), bitmap, any(), any()) } returns -1
+
+        assertThat(pdfPage.renderThumbnail(bitmap)).isNull()
+    }
+
+    @Test
+    fun `hasEmbeddedThumbnail success`() =
+        closableTest {
+            setupHappy {
+                every { mockNativePage.hasEmbeddedThumbnail(any()) } returns true
+            }
+            apiCall = {
+                pdfPage.hasEmbeddedThumbnail()
+            }
+            verifyHappy {
+                assertThat(it).isTrue()
+            }
+            verifyDefault {
+                assertThat(it).isFalse()
+            }
+        }
+
     @Test
     fun `getPageLinks success`() =
         closableTest {
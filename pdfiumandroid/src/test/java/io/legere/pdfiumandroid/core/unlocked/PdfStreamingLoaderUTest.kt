@@ -0,0 +1,120 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.core.unlocked
+
+import com.google.common.truth.Truth.assertThat
+import io.legere.pdfiumandroid.api.StreamingPdfiumSource
+import io.legere.pdfiumandroid.core.jni.NativeCore
+import io.legere.pdfiumandroid.core.jni.NativeDocument
+import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.mockk.every
+import io.mockk.junit5.MockKExtension
+import io.mockk.just
+import io.mockk.mockk
+import io.mockk.runs
+import io.mockk.verify
+import org.junit.jupiter.api.BeforeEach
+import org.junit.jupiter.api.Test
+import org.junit.jupiter.api.assertThrows
+import org.junit.jupiter.api.extension.ExtendWith
+import java.io.IOException
+
+@ExtendWith(MockKExtension::class)
+class PdfStreamingLoaderUTest {
+    private val mockNativeFactory: NativeFactory = mockk()
+
+    private val nativeCore: NativeCore = mockk()
+
+    private val nativeDocument: NativeDocument = mockk()
+
+    private val source: StreamingPdfiumSource = mockk()
+
+    private lateinit var loader: PdfStreamingLoaderU
+
+    @BeforeEach
+    fun setup() {
+        every { mockNativeFactory.getNativeCore() } returns nativeCore
+        every { mockNativeFactory.getNativeDocument() } returns nativeDocument
+        every { source.length } returns 1000
+        every { source.close() } just runs
+        every { nativeCore.openAvail(any(), any()) } returns 7
+        every { nativeCore.closeAvail(any()) } just runs
+
+        loader = PdfStreamingLoaderU(source, mockNativeFactory)
+    }
+
+    @Test
+    fun `isDocumentAvailable maps the native result`() {
+        every { nativeCore.isDocAvail(7) } returns 0
+        assertThat(loader.isDocumentAvailable()).isFalse()
+
+        every { nativeCore.isDocAvail(7) } returns 1
+        assertThat(loader.isDocumentAvailable()).isTrue()
+    }
+
+    @Test
+    fun `isDocumentAvailable throws on a native error`() {
+        every { nativeCore.isDocAvail(7) } returns -1
+        assertThrows<IOException> { loader.isDocumentAvailable() }
+    }
+
+    @Test
+    fun `isLinearized is unknown until enough data has arrived`() {
+        every { nativeCore.isLinearized(7) } returns -1
+        assertThat(loader.isLinearized()).isNull()
+
+        every { nativeCore.isLinearized(7) } returns 1
+        assertThat(loader.isLinearized()).isTrue()
+    }
+
+    @Test
+    fun `openDocument hands the source over to the document`() {
+        every { nativeCore.openAvailDocument(7, "pw") } returns 42
+
+        val document = loader.openDocument("pw")
+
+        assertThat(document.mNativeDocPtr).isEqualTo(42)
+        assertThat(document.source).isSameInstanceAs(source)
+        assertThat(loader.isClosed).isTrue()
+
+        loader.close()
+        verify(exactly = 0) { nativeCore.closeAvail(any()) }
+        verify(exactly = 0) { source.close() }
+    }
+
+    @Test
+    fun `openDocument leaves the loader open when it fails`() {
+        every { nativeCore.openAvailDocument(7, any()) } throws IOException("bad password")
+
+        assertThrows<IOException> { loader.openDocument("wrong") }
+
+        assertThat(loader.isClosed).isFalse()
+    }
+
+    @Test
+    fun `close releases the native loader and the source`() {
+        loader.close()
+        loader.close()
+
+        assertThat(loader.isClosed).isTrue()
+        verify(exactly = 1) { nativeCore.closeAvail(7) }
+        verify(exactly = 1) { source.close() }
+    }
+}
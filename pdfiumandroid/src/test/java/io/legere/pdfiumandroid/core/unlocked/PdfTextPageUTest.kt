@@ -22,6 +22,7 @@ package io.legere.pdfiumandroid.core.unlocked
 import android.graphics.RectF
 import com.google.common.truth.Truth.assertThat
 import io.legere.pdfiumandroid.api.AlreadyClosedBehavior
+import io.legere.pdfiumandroid.api.CharGeometry
 import io.legere.pdfiumandroid.api.Config
 import io.legere.pdfiumandroid.api.pdfiumConfig
 import io.legere.pdfiumandroid.core.jni.NativeDocument
@@ -512,6 +513,106 @@ class PdfTextPageHappyPathTest : PdfTextPageBaseTest() {
         assertThat(rect).isNull()
     }
 
+    @Test
+    fun `textPageGetCharGeometry fills the rest of the page in one call`() {
+        // Verify that the whole remaining page is asked for, and the count shrinks to what native filled.
+        every {
+            mockNativeTextPage.textGetCharGeometry(any(), 4, 6, any(), any(), any(), any(), any(), any(), any())
+        } answers {
+            arg<IntArray>(3)[0] = 'A'.code
+            arg<FloatArray>(4)[2] = 12f
+            arg<IntArray>(9)[1] = CharGeometry.FLAG_GENERATED or CharGeometry.FLAG_HYPHEN
+            2
+        }
+
+        val geometry = pdfTextPage.textPageGetCharGeometry(startIndex = 4)
+
+        assertThat(geometry.startIndex).isEqualTo(4)
+        assertThat(geometry.count).isEqualTo(2)
+        assertThat(geometry.capacity).isEqualTo(6)
+        assertThat(geometry.char(0)).isEqualTo('A')
+        assertThat(geometry.looseBoxes[2]).isEqualTo(12f)
+        assertThat(geometry.isGenerated(1)).isTrue()
+        assertThat(geometry.isHyphen(1)).isTrue()
+        assertThat(geometry.hasUnicodeMapError(1)).isFalse()
+    }
+
+    @Test
+    fun `textPageGetCharGeometry reuses the arrays`() {
+        // Verify that a smaller run reuses the arrays, and a failed call leaves no characters.
+        every {
+            mockNativeTextPage.textGetCharGeometry(any(), any(), any(), any(), any(), any(), any(), any(), any(), any())
+        } answers { arg<Int>(2) } andThen (-1)
+        val geometry = CharGeometry(8)
+        val unicodes = geometry.unicodes
+
+        pdfTextPage.textPageGetCharGeometry(geometry, 0, 5)
+        assertThat(geometry.count).isEqualTo(5)
+        assertThat(geometry.unicodes).isSameInstanceAs(unicodes)
+
+        pdfTextPage.textPageGetCharGeometry(geometry, 0, 5)
+        assertThat(geometry.count).isEqualTo(0)
+    }
+
+    @Test
+    fun `textPageGetWords wraps the packed words`() {
+        every { mockNativeTextPage.textGetWords(any()) } returns floatArrayOf(1f, 20f, 9f, 10f, 3f, 4f, 0f, 0f)
+
+        val words = pdfTextPage.textPageGetWords()
+
+        assertThat(words?.wordCount).isEqualTo(1)
+        assertThat(words?.start(0)).isEqualTo(3)
+        assertThat(words?.length(0)).isEqualTo(4)
+    }
+
+    @Test
+    fun `textPageGetWords native failure`() {
+        every { mockNativeTextPage.textGetWords(any()) } returns null
+
+        assertThat(pdfTextPage.textPageGetWords()).isNull()
+    }
+
+    @Test
+    fun `textPageHitTestChar uses the spatial index`() {
+        every { mockNativeTextPage.textHitTestChar(any(), 10.0, 20.0, 2.0, 3.0) } returns 7
+
+        assertThat(pdfTextPage.textPageHitTestChar(10.0, 20.0, 2.0, 3.0)).isEqualTo(7)
+        verify(exactly = 0) { mockNativeTextPage.textGetCharIndexAtPos(any(), any(), any(), any(), any()) }
+    }
+
+    @Test
+    fun `textPageHitTestCharRange converts start and count`() {
+        every { mockNativeTextPage.textHitTestCharRange(any(), any(), any(), any(), any()) } returns
+            intArrayOf(4, 3) andThen intArrayOf(-1, 0)
+
+        assertThat(pdfTextPage.textPageHitTestCharRange(RectF())).isEqualTo(4..6)
+        assertThat(pdfTextPage.textPageHitTestCharRange(RectF())).isEmpty()
+    }
+
+    @Test
+    fun `textPageHitTestLink prefers link annotations`() {
+        every { mockNativeTextPage.textHitTestLink(any(), any(), any(), any()) } returns 55L
+        every { mockNativePage.getDestPageIndex(any(), 55L) } returns 3
+        every { mockNativePage.getLinkURI(any(), 55L) } returns null
+        every { mockNativePage.getLinkRect(any(), 55L) } returns floatArrayOf(0f, 10f, 10f, 0f)
+
+        val link = pdfTextPage.textPageHitTestLink(pdfPage, 5.0, 5.0)
+
+        assertThat(link?.destPageIdx).isEqualTo(3)
+        verify(exactly = 0) { mockNativeTextPage.textHitTestWebLink(any(), any(), any()) }
+    }
+
+    @Test
+    fun `textPageHitTestLink falls back to web links`() {
+        every { mockNativeTextPage.textHitTestLink(any(), any(), any(), any()) } returns 0L
+        every { mockNativeTextPage.textHitTestWebLink(any(), any(), any()) } returns
+            floatArrayOf(2f, 0f, 10f, 10f, 0f) andThen null
+        every { mockNativeTextPage.textGetWebLinkURL(any(), 2) } returns "https://example.com"
+
+        assertThat(pdfTextPage.textPageHitTestLink(pdfPage, 5.0, 5.0)?.uri).isEqualTo("https://example.com")
+        assertThat(pdfTextPage.textPageHitTestLink(pdfPage, 50.0, 50.0)).isNull()
+    }
+
     @Test
     fun `textPageGetCharIndexAtPos no character found`() {
         // Verify that textPageGetCharIndexAtPos returns -1 if no character exists at the given
@@ -19,23 +19,33 @@
 
 package io.legere.pdfiumandroid.core.unlocked
 
+import android.content.ComponentCallbacks2
 import android.content.Context
 import android.os.ParcelFileDescriptor
+import io.legere.pdfiumandroid.api.Config
+import io.legere.pdfiumandroid.api.DEFAULT_LIBRARY_IDLE_TIMEOUT_MILLIS
+import io.legere.pdfiumandroid.api.FileOpenMode
+import io.legere.pdfiumandroid.api.LibraryLifetime
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.core.jni.NativeCore
 import io.legere.pdfiumandroid.core.jni.NativeDocument
 import io.legere.pdfiumandroid.core.jni.NativeFactory
+import io.mockk.clearMocks
 import io.mockk.every
 import io.mockk.junit5.MockKExtension
 import io.mockk.just
 import io.mockk.mockk
 import io.mockk.runs
+import io.mockk.verify
+import io.mockk.verifyOrder
 import org.junit.jupiter.api.Assertions
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
 import org.junit.jupiter.api.TestInstance
 import org.junit.jupiter.api.TestInstance.Lifecycle
 import org.junit.jupiter.api.extension.ExtendWith
+import java.nio.ByteBuffer
 
 @ExtendWith(MockKExtension::class)
 @TestInstance(Lifecycle.PER_CLASS)
@@ -59,6 +69,8 @@ class PdfiumCoreUTest {
         every { mockNativeFactory.getNativeCore() } returns nativeCore
         every { mockNativeFactory.getNativeDocument() } returns nativeDocument
         every { libraryLoader.load(any()) } just runs
+        every { nativeCore.setLibraryLifetime(any(), any()) } just runs
+        every { nativeCore.initLibrary() } just runs
         every { context.resources } returns
             mockk {
                 every { displayMetrics } returns
@@ -86,6 +98,28 @@ class PdfiumCoreUTest {
         println("end newDocument fd successful load")
     }
 
+    @Test
+    fun `newDocument fd memory mapped`() {
+        // Verify that Config.fileOpenMode MEMORY_MAP opens file descriptors through the mapped path.
+        pdfiumCore =
+            PdfiumCoreU(
+                context = context,
+                config = Config(fileOpenMode = FileOpenMode.MEMORY_MAP),
+                nativeFactory = mockNativeFactory,
+                libraryLoader = libraryLoader,
+            )
+        every { nativeCore.openMappedDocument(any(), any()) } returns 1
+        pdfiumCore.newDocument(
+            mockk<ParcelFileDescriptor> {
+                every { fd } returns 1
+                every { fileDescriptor } returns mockk()
+                every { close() } just runs
+            },
+            "password",
+        )
+        verify { nativeCore.openMappedDocument(1, "password") }
+    }
+
     @Test
     fun `newDocument byteArray successful load`() {
         println("start newDocument byteArray successful load")
@@ -97,6 +131,25 @@ class PdfiumCoreUTest {
         println("end newDocument byteArray successful load")
     }
 
+    @Test
+    fun `newDocument direct ByteBuffer opens the remaining bytes in place`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        val buffer = ByteBuffer.allocateDirect(100)
+        buffer.position(10)
+        buffer.limit(90)
+        every { nativeCore.openDirectBufferDocument(any(), any(), any(), any()) } returns 1
+        pdfiumCore.newDocument(buffer)
+        verify { nativeCore.openDirectBufferDocument(buffer, 10, 80, null) }
+    }
+
+    @Test
+    fun `newDocument heap ByteBuffer is rejected`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            pdfiumCore.newDocument(ByteBuffer.allocate(100))
+        }
+    }
+
     @Test
     fun `newDocument PdfiumSource successful load`() {
         println("start newDocument PdfiumSource successful load")
@@ -146,6 +199,109 @@ class PdfiumCoreUTest {
         println("end newDocument native crash resilience")
     }
 
+    @Test
+    fun `tile cache budget from the config is applied`() {
+        every { nativeCore.setTileCacheBudget(any()) } just runs
+        pdfiumCore =
+            PdfiumCoreU(
+                context = context,
+                config = Config(tileCacheBudgetBytes = 32L * 1024 * 1024),
+                nativeFactory = mockNativeFactory,
+                libraryLoader = libraryLoader,
+            )
+        verify { nativeCore.setTileCacheBudget(32L * 1024 * 1024) }
+    }
+
+    @Test
+    fun `library lifetime from the config is applied before the library is set up on load`() {
+        pdfiumCore =
+            PdfiumCoreU(
+                context = context,
+                config = Config(libraryLifetime = LibraryLifetime.PROCESS, libraryIdleTimeoutMillis = 5_000),
+                nativeFactory = mockNativeFactory,
+                libraryLoader = libraryLoader,
+            )
+        verifyOrder {
+            nativeCore.setLibraryLifetime(LibraryLifetime.PROCESS.ordinal, 5_000)
+            nativeCore.initLibrary()
+        }
+    }
+
+    @Test
+    fun `library is left to the first document when it is not set up on load`() {
+        clearMocks(nativeCore, answers = false)
+        pdfiumCore =
+            PdfiumCoreU(
+                context = context,
+                config = Config(initLibraryOnLoad = false),
+                nativeFactory = mockNativeFactory,
+                libraryLoader = libraryLoader,
+            )
+        verify(exactly = 0) { nativeCore.initLibrary() }
+        verify { nativeCore.setLibraryLifetime(LibraryLifetime.REFERENCE_COUNTED.ordinal, DEFAULT_LIBRARY_IDLE_TIMEOUT_MILLIS) }
+    }
+
+    @Test
+    fun `RGB_565 dithering from the config is applied`() {
+        every { nativeCore.setRgb565Dither(any()) } just runs
+        pdfiumCore =
+            PdfiumCoreU(
+                context = context,
+                config = Config(ditherRgb565 = true),
+                nativeFactory = mockNativeFactory,
+                libraryLoader = libraryLoader,
+            )
+        verify { nativeCore.setRgb565Dither(true) }
+    }
+
+    @Test
+    fun `getTileCacheStats maps the native counters`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        every { nativeCore.getTileCacheStats() } returns longArrayOf(30, 10, 2, 8, 2_097_152, 4_194_304)
+
+        val stats = pdfiumCore.getTileCacheStats()
+
+        Assertions.assertEquals(TileCacheStats(30, 10, 2, 8, 2_097_152, 4_194_304), stats)
+        Assertions.assertEquals(0.75, stats.hitRate)
+    }
+
+    @Test
+    fun `trimMemory when running low clears the tile cache and reports what it held`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        every { nativeCore.getTileCacheStats() } returns longArrayOf(30, 10, 2, 8, 2_097_152, 4_194_304)
+        every { nativeCore.clearTileCache(any()) } just runs
+        every { nativeCore.setLimitedImageCache(any()) } just runs
+
+        val released = pdfiumCore.trimMemory(ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW)
+
+        Assertions.assertEquals(2_097_152L, released)
+        verify { nativeCore.clearTileCache(false) }
+        verify { nativeCore.setLimitedImageCache(false) }
+    }
+
+    @Test
+    fun `trimMemory in the background limits the image cache until a lower level restores it`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        every { nativeCore.getTileCacheStats() } returns longArrayOf(0, 0, 0, 0, 0, 0)
+        every { nativeCore.clearTileCache(any()) } just runs
+        every { nativeCore.setLimitedImageCache(any()) } just runs
+
+        pdfiumCore.trimMemory(ComponentCallbacks2.TRIM_MEMORY_BACKGROUND)
+        verify(exactly = 1) { nativeCore.setLimitedImageCache(true) }
+
+        Assertions.assertEquals(0L, pdfiumCore.trimMemory(0))
+        verify(exactly = 1) { nativeCore.setLimitedImageCache(false) }
+        verify(exactly = 1) { nativeCore.clearTileCache(any()) }
+    }
+
+    @Test
+    fun `setTileCacheBudget rejects a negative budget`() {
+        pdfiumCore = PdfiumCoreU(context = context, nativeFactory = mockNativeFactory, libraryLoader = libraryLoader)
+        Assertions.assertThrows(IllegalArgumentException::class.java) {
+            pdfiumCore.setTileCacheBudget(-1)
+        }
+    }
+
     @Test
     fun `Native library initialization failure`() {
         println("start Native library initialization failure")
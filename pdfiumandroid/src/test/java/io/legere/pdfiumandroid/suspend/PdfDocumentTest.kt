@@ -200,4 +200,19 @@ class PdfDocumentTest {
         assertThat(result).isFalse()
         verify { pdfDocumentU.close() }
     }
+
+    @Test
+    fun batch() =
+        runTest {
+            val pageU = mockk<PdfPageU>()
+            val page = PdfPageKt(pageU, Dispatchers.Main)
+            coEvery { pdfDocumentU.getPageCount() } returns 3
+            val result =
+                pdfDocument.batch {
+                    assertThat(page.unlocked).isSameInstanceAs(pageU)
+                    document.getPageCount()
+                }
+            assertThat(result).isEqualTo(3)
+            coVerify { pdfDocumentU.getPageCount() }
+        }
 }
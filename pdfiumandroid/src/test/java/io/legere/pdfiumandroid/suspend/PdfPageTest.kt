@@ -30,9 +30,11 @@ import com.google.common.truth.Truth.assertThat
 import io.legere.pdfiumandroid.PdfPage
 import io.legere.pdfiumandroid.api.Link
 import io.legere.pdfiumandroid.api.PageAttributes
+import io.legere.pdfiumandroid.api.RenderStatus
 import io.legere.pdfiumandroid.api.Size
 import io.legere.pdfiumandroid.core.unlocked.PdfPageU
 import io.legere.pdfiumandroid.core.unlocked.PdfTextPageU
+import io.legere.pdfiumandroid.core.unlocked.ProgressiveRenderU
 import io.legere.pdfiumandroid.testing.StandardTestDispatcherExtension
 import io.mockk.every
 import io.mockk.impl.annotations.MockK
@@ -295,6 +297,34 @@ class PdfPageTest {
             verify { pdfPageU.renderPageBitmap(bitmap, matrix, clip) }
         }
 
+    @Test
+    fun renderPageBitmapProgressive() =
+        runTest {
+            val bitmap = mockk<Bitmap>()
+            val render = mockk<ProgressiveRenderU>()
+            every {
+                pdfPageU.startRenderPageBitmap(bitmap, 0, 0, 100, 100, false, false, any(), any(), null, 5L)
+            } returns render
+            every { render.status } returnsMany listOf(RenderStatus.INCOMPLETE, RenderStatus.DONE)
+            every { render.resume(5L) } returns RenderStatus.DONE
+
+            val result = pdfPage.renderPageBitmapProgressive(bitmap, 0, 0, 100, 100, sliceMillis = 5L)
+
+            assertThat(result).isEqualTo(RenderStatus.DONE)
+            verify(exactly = 1) { render.resume(5L) }
+        }
+
+    @Test
+    fun renderPageBitmapProgressiveClosed() =
+        runTest {
+            val bitmap = mockk<Bitmap>()
+            every {
+                pdfPageU.startRenderPageBitmap(bitmap, 0, 0, 100, 100, false, false, any(), any(), null, any())
+            } returns null
+
+            assertThat(pdfPage.renderPageBitmapProgressive(bitmap, 0, 0, 100, 100)).isEqualTo(RenderStatus.FAILED)
+        }
+
     @Test
     fun getPageLinks() =
         runTest {
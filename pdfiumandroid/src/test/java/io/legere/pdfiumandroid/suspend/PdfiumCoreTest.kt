@@ -24,6 +24,7 @@ import com.google.common.truth.Truth.assertThat
 import io.legere.pdfiumandroid.api.LockManager
 import io.legere.pdfiumandroid.api.LockManagerReentrantLock
 import io.legere.pdfiumandroid.api.PdfiumSource
+import io.legere.pdfiumandroid.api.TileCacheStats
 import io.legere.pdfiumandroid.core.unlocked.PdfDocumentU
 import io.legere.pdfiumandroid.core.unlocked.PdfiumCoreU
 import io.legere.pdfiumandroid.testing.StandardTestDispatcherExtension
@@ -31,12 +32,15 @@ import io.mockk.coEvery
 import io.mockk.coVerify
 import io.mockk.impl.annotations.MockK
 import io.mockk.junit5.MockKExtension
+import io.mockk.just
 import io.mockk.mockk
+import io.mockk.runs
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.test.runTest
 import org.junit.jupiter.api.BeforeEach
 import org.junit.jupiter.api.Test
 import org.junit.jupiter.api.extension.ExtendWith
+import java.nio.ByteBuffer
 
 @ExtendWith(MockKExtension::class, StandardTestDispatcherExtension::class)
 class PdfiumCoreTest {
@@ -74,6 +78,16 @@ class PdfiumCoreTest {
             coVerify { coreInternal.newDocument(any<ParcelFileDescriptor>(), any()) }
         }
 
+    @Test
+    fun testNewDocumentByteBuffer() =
+        runTest {
+            val data = ByteBuffer.allocateDirect(4)
+            coEvery { coreInternal.newDocument(any<ByteBuffer>()) } returns document
+            val result = core.newDocument(data)
+            assertThat(result.document).isEqualTo(document)
+            coVerify { coreInternal.newDocument(data) }
+        }
+
     @Test
     fun testNewDocument1() =
         runTest {
@@ -114,6 +128,22 @@ class PdfiumCoreTest {
             coVerify { coreInternal.newDocument(any<PdfiumSource>(), any()) }
         }
 
+    @Test
+    fun getTileCacheStats() =
+        runTest {
+            val expected = TileCacheStats(3, 1, 0, 4, 1_048_576, 4_194_304)
+            coEvery { coreInternal.getTileCacheStats() } returns expected
+            assertThat(core.getTileCacheStats()).isEqualTo(expected)
+        }
+
+    @Test
+    fun setTileCacheBudget() =
+        runTest {
+            coEvery { coreInternal.setTileCacheBudget(any()) } just runs
+            core.setTileCacheBudget(8_388_608)
+            coVerify { coreInternal.setTileCacheBudget(8_388_608) }
+        }
+
     @Test
     fun setLockManager() =
         runTest {
@@ -0,0 +1,55 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+import android.os.ParcelFileDescriptor
+import com.google.common.truth.Truth.assertThat
+import io.mockk.every
+import io.mockk.just
+import io.mockk.mockk
+import io.mockk.runs
+import io.mockk.verify
+import org.junit.jupiter.api.Test
+import org.junit.jupiter.api.assertThrows
+import java.io.IOException
+
+class OpenOwningTest {
+    private val fd =
+        mockk<ParcelFileDescriptor> {
+            every { close() } just runs
+        }
+
+    @Test
+    fun `a document that opens keeps its file descriptor open`() {
+        val opened = openOwning(fd) { "document" }
+
+        assertThat(opened).isEqualTo("document")
+        verify(exactly = 0) { fd.close() }
+    }
+
+    @Test
+    fun `a document that fails to open closes its file descriptor`() {
+        assertThrows<IOException> {
+            openOwning(fd) { throw IOException("bad pdf") }
+        }
+
+        verify(exactly = 1) { fd.close() }
+    }
+}
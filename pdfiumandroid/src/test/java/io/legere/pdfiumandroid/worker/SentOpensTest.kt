@@ -0,0 +1,55 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+
+class SentOpensTest {
+    @Test
+    fun `a document waiting for the first connection is not reopened`() {
+        val sentOpens = SentOpens()
+
+        assertThat(sentOpens.toReopen()).isEmpty()
+    }
+
+    @Test
+    fun `documents sent to a worker are reopened when it restarts`() {
+        val sentOpens = SentOpens()
+        sentOpens.sent(2)
+        sentOpens.sent(1)
+
+        assertThat(sentOpens.toReopen()).containsExactly(1, 2).inOrder()
+        // Reopening sends them again, which must not make them reopen twice next time
+        sentOpens.sent(1)
+        assertThat(sentOpens.toReopen()).containsExactly(1, 2).inOrder()
+    }
+
+    @Test
+    fun `closed documents are not reopened`() {
+        val sentOpens = SentOpens()
+        sentOpens.sent(1)
+        sentOpens.sent(2)
+
+        sentOpens.closed(1)
+
+        assertThat(sentOpens.toReopen()).containsExactly(2)
+    }
+}
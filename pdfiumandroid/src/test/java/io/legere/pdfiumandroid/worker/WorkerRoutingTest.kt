@@ -0,0 +1,52 @@
+/*
+ * Original work Copyright 2015 Bekket McClane
+ * Modified work Copyright 2016 Bartosz Schiller
+ * Modified work Copyright 2023-2026 John Gray
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+package io.legere.pdfiumandroid.worker
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.jupiter.api.Test
+import java.util.concurrent.atomic.AtomicInteger
+
+class WorkerRoutingTest {
+    @Test
+    fun `page affinity sends a page to the same worker every time`() {
+        val turn = AtomicInteger()
+        val workers = (0..9).map { routeToWorker(WorkerRouting.PAGE_AFFINITY, it, 4, turn) }
+
+        assertThat(workers).containsExactly(0, 1, 2, 3, 0, 1, 2, 3, 0, 1).inOrder()
+        assertThat(routeToWorker(WorkerRouting.PAGE_AFFINITY, 5, 4, turn)).isEqualTo(1)
+        assertThat(turn.get()).isEqualTo(0)
+    }
+
+    @Test
+    fun `round robin takes turns whatever the page`() {
+        val turn = AtomicInteger()
+        val workers = (0..4).map { routeToWorker(WorkerRouting.ROUND_ROBIN, 7, 3, turn) }
+
+        assertThat(workers).containsExactly(0, 1, 2, 0, 1).inOrder()
+    }
+
+    @Test
+    fun `round robin stays in range when its counter wraps`() {
+        val turn = AtomicInteger(Int.MAX_VALUE - 1)
+        val workers = (0..4).map { routeToWorker(WorkerRouting.ROUND_ROBIN, 0, 3, turn) }
+
+        assertThat(workers.all { it in 0..2 }).isTrue()
+    }
+}